@@ -0,0 +1,156 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "bench/Benchmark.h"
+#include "bench/BigPath.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkMatrix.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkPath.h"
+#include "include/core/SkPoint.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkScalar.h"
+#include "include/core/SkString.h"
+#include "include/core/SkSurface.h"
+#include "include/core/SkSurfaceProps.h"
+#include "src/base/SkRandom.h"
+
+#include <vector>
+
+// Fills paths through the analytic AA scan converter (SkScan_AAAPath.cpp), next to the same
+// fills without anti-aliasing as a baseline for the scan conversion cost alone. The shapes are
+// the ones that dominate vector icon and map rendering: a large path with long edges, many small
+// curved icons, and many thin, nearly horizontal polygons. The sparse strip rasterizer
+// (SkScan_SparseStrip.cpp) fills the same shapes for comparison.
+
+enum class Shape {
+    kBigPath,  // BigPathBench's path, filled.
+    kIcons,    // Small shapes made of cubics, like PathBench's random paths.
+    kMap,      // Long thin polygons, giving wide rows with shallow edges.
+};
+
+static const char* shape_name(Shape shape) {
+    switch (shape) {
+        case Shape::kBigPath: return "bigpath";
+        case Shape::kIcons:   return "icons";
+        case Shape::kMap:     return "map";
+    }
+    SkUNREACHABLE;
+}
+
+enum class Engine {
+    kAliased,      // SkScan::FillPath, without anti-aliasing.
+    kAnalytic,     // SkScan::AntiFillPath.
+    kSparseStrip,  // SkScan::SparseStripFillPath, via kSparseStripRasterizer_Flag.
+};
+
+static const char* engine_name(Engine engine) {
+    switch (engine) {
+        case Engine::kAliased:     return "aliased";
+        case Engine::kAnalytic:    return "aaa";
+        case Engine::kSparseStrip: return "sparse_strip";
+    }
+    SkUNREACHABLE;
+}
+
+class AnalyticAABench : public Benchmark {
+public:
+    AnalyticAABench(Shape shape, Engine engine) : fShape(shape), fEngine(engine) {
+        fName.printf("path_fill_%s_%s", shape_name(shape), engine_name(engine));
+    }
+
+protected:
+    static constexpr int kSize = 640;
+
+    const char* onGetName() override { return fName.c_str(); }
+    bool isSuitableFor(Backend backend) override { return backend == Backend::kNonRendering; }
+
+    void onDelayedSetup() override {
+        const SkSurfaceProps props(fEngine == Engine::kSparseStrip
+                                           ? SkSurfaceProps::kSparseStripRasterizer_Flag
+                                           : 0,
+                                   kUnknown_SkPixelGeometry);
+        fSurface = SkSurfaces::Raster(SkImageInfo::MakeN32Premul(kSize, kSize), &props);
+
+        SkRandom rand;
+        switch (fShape) {
+            case Shape::kBigPath: {
+                SkPath path = BenchUtils::make_big_path();
+                const SkRect bounds = path.getBounds();
+                path.transform(SkMatrix::RectToRect(bounds, SkRect::MakeWH(kSize, kSize)));
+                fPaths.push_back(path);
+                break;
+            }
+            case Shape::kIcons:
+                for (int i = 0; i < 200; ++i) {
+                    SkScalar x = rand.nextRangeScalar(0, kSize - 32),
+                             y = rand.nextRangeScalar(0, kSize - 32);
+                    SkPath path;
+                    auto pt = [&] {
+                        return SkPoint{x + rand.nextRangeScalar(0, 32),
+                                       y + rand.nextRangeScalar(0, 32)};
+                    };
+                    path.moveTo(x, y + 16);
+                    for (int j = 0; j < 4; ++j) {
+                        SkPoint p1 = pt(), p2 = pt(), p3 = pt();
+                        path.cubicTo(p1, p2, p3);
+                    }
+                    path.close();
+                    fPaths.push_back(path);
+                }
+                break;
+            case Shape::kMap:
+                for (int i = 0; i < 100; ++i) {
+                    SkScalar x0 = rand.nextRangeScalar(0, kSize),
+                             y0 = rand.nextRangeScalar(0, kSize),
+                             x1 = rand.nextRangeScalar(0, kSize),
+                             y1 = y0 + rand.nextRangeScalar(-40, 40);
+                    SkPath path;
+                    path.moveTo(x0, y0);
+                    path.lineTo(x1, y1);
+                    path.lineTo(x1, y1 + rand.nextRangeScalar(1, 6));
+                    path.lineTo(x0, y0 + rand.nextRangeScalar(1, 6));
+                    path.close();
+                    fPaths.push_back(path);
+                }
+                break;
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkPaint paint;
+        paint.setAntiAlias(fEngine != Engine::kAliased);
+        paint.setColor(0x80204080);
+
+        SkCanvas* canvas = fSurface->getCanvas();
+        for (int i = 0; i < loops; i++) {
+            for (const SkPath& path : fPaths) {
+                canvas->drawPath(path, paint);
+            }
+        }
+    }
+
+private:
+    Shape               fShape;
+    Engine              fEngine;
+    SkString            fName;
+    sk_sp<SkSurface>    fSurface;
+    std::vector<SkPath> fPaths;
+};
+
+DEF_BENCH(return new AnalyticAABench(Shape::kBigPath, Engine::kAnalytic);)
+DEF_BENCH(return new AnalyticAABench(Shape::kBigPath, Engine::kAliased);)
+DEF_BENCH(return new AnalyticAABench(Shape::kBigPath, Engine::kSparseStrip);)
+DEF_BENCH(return new AnalyticAABench(Shape::kIcons, Engine::kAnalytic);)
+DEF_BENCH(return new AnalyticAABench(Shape::kIcons, Engine::kAliased);)
+DEF_BENCH(return new AnalyticAABench(Shape::kIcons, Engine::kSparseStrip);)
+DEF_BENCH(return new AnalyticAABench(Shape::kMap, Engine::kAnalytic);)
+DEF_BENCH(return new AnalyticAABench(Shape::kMap, Engine::kAliased);)
+DEF_BENCH(return new AnalyticAABench(Shape::kMap, Engine::kSparseStrip);)
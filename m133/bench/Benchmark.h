@@ -95,6 +95,11 @@ public:
                              skia_private::TArray<SkString>* keys,
                              skia_private::TArray<double>* values) {}
 
+    // Metrics other than time, written to the JSON results for every backend. Called once the
+    // benchmark has been timed on a canvas, before perCanvasPostDraw().
+    virtual void getStats(skia_private::TArray<SkString>* keys,
+                          skia_private::TArray<double>* values) {}
+
     // Replaces the GrRecordingContext's dmsaaStats() with a single frame of this benchmark.
     virtual bool getDMSAAStats(GrRecordingContext*) { return false; }
 
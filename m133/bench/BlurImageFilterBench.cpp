@@ -10,6 +10,7 @@
 #include "include/core/SkCanvas.h"
 #include "include/core/SkPaint.h"
 #include "include/core/SkShader.h"
+#include "include/core/SkSize.h"
 #include "include/core/SkString.h"
 #include "include/effects/SkImageFilters.h"
 #include "src/base/SkRandom.h"
@@ -161,3 +162,49 @@ DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_LARGE, BLUR_SIGMA_LARGE, tr
 DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_LARGE, BLUR_SIGMA_LARGE, false, true, true);)
 DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_HUGE, BLUR_SIGMA_HUGE, true, true, true);)
 DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_HUGE, BLUR_SIGMA_HUGE, false, true, true);)
+
+// Blurs a full-screen layer, as a background blur behind a dialog or a sheet would. On the CPU,
+// these are split into bands that run on the default SkExecutor (see --threads).
+class BlurImageFilterScreenBench : public Benchmark {
+public:
+    BlurImageFilterScreenBench(SkISize size, SkScalar sigma) : fSize(size), fSigma(sigma) {
+        fName.printf("blur_image_filter_screen_%dx%d_%.2f", size.width(), size.height(), sigma);
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    SkISize onGetSize() override { return fSize; }
+
+    void onDelayedSetup() override {
+        if (!fCheckerboard) {
+            fCheckerboard = make_checkerboard(fSize.width(), fSize.height());
+        }
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        SkPaint paint;
+        paint.setImageFilter(SkImageFilters::Blur(fSigma, fSigma, nullptr));
+        for (int i = 0; i < loops; i++) {
+            canvas->drawImage(fCheckerboard, 0, 0, SkSamplingOptions(), &paint);
+        }
+    }
+
+private:
+    SkString fName;
+    SkISize fSize;
+    SkScalar fSigma;
+    sk_sp<SkImage> fCheckerboard;
+};
+
+static constexpr SkISize k1080p = {1920, 1080};
+static constexpr SkISize k4K = {3840, 2160};
+
+DEF_BENCH(return new BlurImageFilterScreenBench(k1080p, 5);)
+DEF_BENCH(return new BlurImageFilterScreenBench(k1080p, 20);)
+DEF_BENCH(return new BlurImageFilterScreenBench(k1080p, 50);)
+DEF_BENCH(return new BlurImageFilterScreenBench(k1080p, 100);)
+DEF_BENCH(return new BlurImageFilterScreenBench(k4K, 5);)
+DEF_BENCH(return new BlurImageFilterScreenBench(k4K, 20);)
+DEF_BENCH(return new BlurImageFilterScreenBench(k4K, 50);)
+DEF_BENCH(return new BlurImageFilterScreenBench(k4K, 100);)
@@ -6,11 +6,16 @@
  */
 
 #include "bench/Benchmark.h"
+#include "include/codec/SkCodec.h"
+#include "include/codec/SkJpegDecoder.h"
+#include "include/codec/SkPngDecoder.h"
 #include "include/core/SkBitmap.h"
 #include "include/core/SkFontMgr.h"
 #include "include/core/SkPicture.h"
 #include "include/core/SkPictureRecorder.h"
+#include "include/core/SkStream.h"
 #include "modules/skottie/include/Skottie.h"
+#include "src/core/SkOSFile.h"
 #include "tools/DecodeUtils.h"
 #include "tools/Resources.h"
 #include "tools/fonts/FontToolUtils.h"
@@ -59,6 +64,59 @@ private:
 };
 
 
+// Decodes straight from the resource file, either memory mapped (the codec reads the mapping in
+// place) or through an SkFILEStream (the codec reads into its own buffers). Opening the file is
+// part of each loop. Run a single variant with --match to compare nanobench's max_rss_mb.
+class FileDecodeBench final : public Benchmark {
+public:
+    FileDecodeBench(const char* name, const char* source, bool mapped)
+        : fName(SkStringPrintf("decode_%s_%s", mapped ? "mapped" : "stream", name))
+        , fSource(source)
+        , fMapped(mapped)
+    {}
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == Backend::kNonRendering;
+    }
+
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        fPath = GetResourcePath(fSource);
+        std::unique_ptr<SkCodec> codec = this->makeCodec();
+        SkASSERT(codec);
+        fBitmap.allocPixels(codec->getInfo().makeColorType(kN32_SkColorType));
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        while (loops-- > 0) {
+            std::unique_ptr<SkCodec> codec = this->makeCodec();
+            SkAssertResult(codec->getPixels(fBitmap.pixmap()) == SkCodec::kSuccess);
+        }
+    }
+
+private:
+    std::unique_ptr<SkCodec> makeCodec() const {
+        const SkCodecs::Decoder decoders[] = {SkPngDecoder::Decoder(), SkJpegDecoder::Decoder()};
+        if (!fMapped) {
+            return SkCodec::MakeFromStream(SkFILEStream::Make(fPath.c_str()), decoders);
+        }
+        FILE* file = sk_fopen(fPath.c_str(), kRead_SkFILE_Flag);
+        if (!file) {
+            return nullptr;
+        }
+        std::unique_ptr<SkCodec> codec = SkCodec::MakeFromFD(sk_fileno(file), decoders);
+        sk_fclose(file);
+        return codec;
+    }
+
+    const SkString fName;
+    const char*    fSource;
+    const bool     fMapped;
+    SkString       fPath;
+    SkBitmap       fBitmap;
+};
+
 class SkottieDecodeBench final : public DecodeBench {
 public:
     SkottieDecodeBench(const char* name, const char* source)
@@ -241,3 +299,12 @@ DEF_BENCH(return new BitmapDecodeBench("png_small"    /*  32x  32*/, "images/man
 DEF_BENCH(return new BitmapDecodeBench("png_phonehub_connecting"   , "images/Connecting.png"));
 DEF_BENCH(return new BitmapDecodeBench("png_phonehub_generic_error", "images/Generic_Error.png"));
 DEF_BENCH(return new BitmapDecodeBench("png_phonehub_onboard"      , "images/Onboard.png"));
+
+DEF_BENCH(return new FileDecodeBench("png_large",  "images/mandrill_1600.png", true));
+DEF_BENCH(return new FileDecodeBench("png_large",  "images/mandrill_1600.png", false));
+DEF_BENCH(return new FileDecodeBench("png_medium", "images/mandrill_512.png",  true));
+DEF_BENCH(return new FileDecodeBench("png_medium", "images/mandrill_512.png",  false));
+DEF_BENCH(return new FileDecodeBench("jpg_large",  "images/iphone_13_pro.jpeg", true));
+DEF_BENCH(return new FileDecodeBench("jpg_large",  "images/iphone_13_pro.jpeg", false));
+DEF_BENCH(return new FileDecodeBench("jpg_medium", "images/mandrill_512_q075.jpg", true));
+DEF_BENCH(return new FileDecodeBench("jpg_medium", "images/mandrill_512_q075.jpg", false));
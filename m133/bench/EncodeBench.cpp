@@ -7,6 +7,7 @@
 
 #include "bench/Benchmark.h"
 #include "include/core/SkBitmap.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkStream.h"
 #include "include/encode/SkJpegEncoder.h"
 #include "include/encode/SkPngEncoder.h"
@@ -82,6 +83,13 @@ static bool encode_png(SkWStream* dst,
     return SkPngEncoder::Encode(dst, src, opts);
 }
 
+static bool encode_png_striped(SkWStream* dst, const SkPixmap& src) {
+    static SkExecutor* gExecutor = SkExecutor::MakeFIFOThreadPool().release();
+    SkPngEncoder::Options opts;
+    opts.fExecutor = gExecutor;
+    return SkPngEncoder::Encode(dst, src, opts);
+}
+
 #define PNG(FLAG, ZLIBLEVEL) [](SkWStream* d, const SkPixmap& s) { \
            return encode_png(d, s, SkPngEncoder::FilterFlag::FLAG, ZLIBLEVEL); }
 
@@ -122,4 +130,7 @@ DEF_BENCH(return new EncodeBench(srcs[1], PNG(kNone, 6), "PNG_6n"));
 DEF_BENCH(return new EncodeBench(srcs[1], PNG(kNone, 3), "PNG_3n"));
 DEF_BENCH(return new EncodeBench(srcs[1], PNG(kNone, 1), "PNG_1n"));
 
+DEF_BENCH(return new EncodeBench(srcs[0], encode_png_striped, "PNG_striped"));
+DEF_BENCH(return new EncodeBench(srcs[1], encode_png_striped, "PNG_striped"));
+
 #undef PNG
@@ -6,7 +6,12 @@
  */
 
 #include "bench/Benchmark.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkString.h"
 #include "src/core/SkResourceCache.h"
+#include "src/core/SkTaskGroup.h"
+
+#include <memory>
 
 namespace {
 static void* gGlobalAddress;
@@ -75,3 +80,54 @@ private:
 ///////////////////////////////////////////////////////////////////////////////
 
 DEF_BENCH( return new ImageCacheBench(); )
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Finds and adds entries in the global cache from several threads at once, the way raster
+// threads share decoded and scaled images. Contention shows up as poor scaling with threads.
+class ImageCacheMTBench : public Benchmark {
+    enum {
+        CACHE_COUNT = 500,
+        OPS_PER_TASK = 1000,
+    };
+public:
+    ImageCacheMTBench(int threads) : fThreads(threads) {
+        fName.printf("imagecache_global_mt_%dthreads", threads);
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+    bool isSuitableFor(Backend backend) override { return backend == Backend::kNonRendering; }
+
+    void onDelayedSetup() override {
+        fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkTaskGroup tg(*fExecutor);
+        for (int i = 0; i < loops; ++i) {
+            tg.batch(fThreads, [](int task) {
+                // Keys are shared between tasks, except one lookup in eight. Misses are added.
+                for (int j = 0; j < OPS_PER_TASK; ++j) {
+                    intptr_t value = (task * OPS_PER_TASK + j) % CACHE_COUNT;
+                    if (j % 8 == 0) {
+                        value += CACHE_COUNT * (1 + task);
+                    }
+                    if (!SkResourceCache::Find(TestKey(value), TestRec::Visitor, nullptr)) {
+                        SkResourceCache::Add(new TestRec(TestKey(value), value));
+                    }
+                }
+            });
+            tg.wait();
+        }
+    }
+
+private:
+    int                         fThreads;
+    SkString                    fName;
+    std::unique_ptr<SkExecutor> fExecutor;
+};
+
+DEF_BENCH( return new ImageCacheMTBench(1); )
+DEF_BENCH( return new ImageCacheMTBench(4); )
+DEF_BENCH( return new ImageCacheMTBench(8); )
@@ -6,18 +6,31 @@
  */
 
 #include "bench/Benchmark.h"
+#include "include/core/SkBitmap.h"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkData.h"
+#include "include/core/SkGraphics.h"
 #include "include/core/SkImage.h"
+#include "include/core/SkImageGenerator.h"
+#include "include/core/SkPixmap.h"
+#include "include/core/SkStream.h"
 #include "include/core/SkSurface.h"
+#include "include/encode/SkPngEncoder.h"
 #include "include/gpu/ganesh/GrDirectContext.h"
+#include "src/base/SkRandom.h"
+#include "src/codec/SkCodecImageGenerator.h"
 #include "src/gpu/ganesh/GrDirectContextPriv.h"
 #include "src/gpu/ganesh/GrResourceCache.h"
 #include "tools/ToolUtils.h"
 
 
+#include <memory>
 #include <utility>
 
-/** These benchmarks were designed to measure changes to GrResourceCache's replacement policy */
+/**
+ * These benchmarks were designed to measure changes to GrResourceCache's replacement policy, and
+ * (ImageCacheRasterBudgetBench) to SkResourceCache's.
+ */
 
 //////////////////////////////////////////////////////////////////////////////
 
@@ -268,3 +281,152 @@ private:
 
 DEF_BENCH( return new ImageCacheBudgetDynamicBench(ImageCacheBudgetDynamicBench::Mode::kPingPong); )
 DEF_BENCH( return new ImageCacheBudgetDynamicBench(ImageCacheBudgetDynamicBench::Mode::kFlipFlop); )
+
+//////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Draws lazy images to a raster canvas, so they are decoded into SkResourceCache, with a budget
+ * that only fits half of them. A few of the images are PNGs, which are slow to decode; the rest
+ * are just as large but cheap to make again. Drawing them all in the same order every frame
+ * defeats LRU, which purges every image before it's drawn again. The number of times each kind
+ * was decoded per draw is reported as the expensive_decode_ratio and cheap_decode_ratio metrics.
+ */
+class ImageCacheRasterBudgetBench : public Benchmark {
+public:
+    using Policy = SkGraphics::ResourceCacheEvictionPolicy;
+
+    ImageCacheRasterBudgetBench(Policy policy) : fPolicy(policy) {
+        fName.printf("image_cache_raster_budget_%s",
+                     policy == Policy::kCostAware ? "cost_aware" : "lru");
+    }
+
+    bool isSuitableFor(Backend backend) override { return Backend::kRaster == backend; }
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    void onDelayedSetup() override {
+        SkBitmap noise;
+        noise.allocN32Pixels(kS, kS, true);
+        SkRandom random;
+        for (int y = 0; y < kS; ++y) {
+            for (int x = 0; x < kS; ++x) {
+                *noise.getAddr32(x, y) = random.nextU() | 0xFF000000;
+            }
+        }
+        SkDynamicMemoryWStream stream;
+        SkAssertResult(SkPngEncoder::Encode(&stream, noise.pixmap(), {}));
+        fPng = stream.detachAsData();
+    }
+
+    void onPerCanvasPreDraw(SkCanvas*) override {
+        fOldBytes = SkGraphics::SetResourceCacheTotalByteLimit(
+                kImagesInBudget * SkImageInfo::MakeN32Premul(kS, kS).computeMinByteSize());
+        fOldPolicy = SkGraphics::SetResourceCacheEvictionPolicy(fPolicy);
+        SkGraphics::PurgeResourceCache();
+
+        for (int i = 0; i < kImagesToDraw; ++i) {
+            // Every kExpensiveStride'th image is a PNG.
+            std::unique_ptr<SkImageGenerator> gen;
+            int* decodeCount;
+            if (i % kExpensiveStride == 0) {
+                gen = SkCodecImageGenerator::MakeFromEncodedCodec(fPng);
+                decodeCount = &fExpensiveDecodes;
+            } else {
+                gen = std::make_unique<SolidGenerator>();
+                decodeCount = &fCheapDecodes;
+            }
+            fImages[i] = SkImages::DeferredFromGenerator(
+                    std::make_unique<CountingGenerator>(std::move(gen), decodeCount));
+        }
+        fExpensiveDecodes = fCheapDecodes = fFrames = 0;
+    }
+
+    void getStats(skia_private::TArray<SkString>* keys,
+                  skia_private::TArray<double>* values) override {
+        if (fFrames == 0) {
+            return;
+        }
+        constexpr int kExpensiveImages = (kImagesToDraw + kExpensiveStride - 1) / kExpensiveStride;
+        keys->push_back(SkString("expensive_decode_ratio"));
+        values->push_back(double(fExpensiveDecodes) / (fFrames * kExpensiveImages));
+        keys->push_back(SkString("cheap_decode_ratio"));
+        values->push_back(double(fCheapDecodes) / (fFrames * (kImagesToDraw - kExpensiveImages)));
+    }
+
+    void onPerCanvasPostDraw(SkCanvas*) override {
+        for (int i = 0; i < kImagesToDraw; ++i) {
+            fImages[i].reset();
+        }
+        SkGraphics::SetResourceCacheEvictionPolicy(fOldPolicy);
+        SkGraphics::SetResourceCacheTotalByteLimit(fOldBytes);
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        for (int i = 0; i < loops; ++i) {
+            for (int frame = 0; frame < kSimulatedFrames; ++frame) {
+                for (int j = 0; j < kImagesToDraw; ++j) {
+                    draw_image(canvas, fImages[j].get());
+                }
+            }
+            fFrames += kSimulatedFrames;
+        }
+    }
+
+private:
+    // Counts how many times the image it wraps is decoded.
+    class CountingGenerator : public SkImageGenerator {
+    public:
+        CountingGenerator(std::unique_ptr<SkImageGenerator> gen, int* decodeCount)
+                : SkImageGenerator(gen->getInfo())
+                , fGenerator(std::move(gen))
+                , fDecodeCount(decodeCount) {}
+
+    protected:
+        bool onGetPixels(const SkImageInfo& info, void* pixels, size_t rowBytes,
+                         const Options&) override {
+            *fDecodeCount += 1;
+            return fGenerator->getPixels(info, pixels, rowBytes);
+        }
+
+    private:
+        std::unique_ptr<SkImageGenerator> fGenerator;
+        int*                              fDecodeCount;
+    };
+
+    class SolidGenerator : public SkImageGenerator {
+    public:
+        SolidGenerator() : SkImageGenerator(SkImageInfo::MakeN32Premul(kS, kS)) {}
+
+    protected:
+        bool onGetPixels(const SkImageInfo& info, void* pixels, size_t rowBytes,
+                         const Options&) override {
+            return SkPixmap(info, pixels, rowBytes).erase(SK_ColorCYAN);
+        }
+    };
+
+    inline static constexpr int kS = 128;
+    inline static constexpr int kImagesToDraw = 24;
+    inline static constexpr int kImagesInBudget = 12;
+    inline static constexpr int kExpensiveStride = 4;
+    inline static constexpr int kSimulatedFrames = 5;
+
+    Policy                      fPolicy;
+    Policy                      fOldPolicy;
+    SkString                    fName;
+    sk_sp<SkData>               fPng;
+    sk_sp<SkImage>              fImages[kImagesToDraw];
+    size_t                      fOldBytes;
+    int                         fExpensiveDecodes = 0;
+    int                         fCheapDecodes = 0;
+    int                         fFrames = 0;
+
+    using INHERITED = Benchmark;
+};
+
+DEF_BENCH( return new ImageCacheRasterBudgetBench(SkGraphics::ResourceCacheEvictionPolicy::kLRU); )
+DEF_BENCH(
+    return new ImageCacheRasterBudgetBench(SkGraphics::ResourceCacheEvictionPolicy::kCostAware);
+)
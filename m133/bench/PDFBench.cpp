@@ -8,6 +8,7 @@
 #include "bench/Benchmark.h"
 
 #include "include/core/SkBitmap.h"
+#include "include/core/SkColorPriv.h"
 #include "include/core/SkData.h"
 #include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
@@ -188,6 +189,53 @@ private:
     std::unique_ptr<SkStreamAsset> fAsset;
 };
 
+/** Test serializing a multi-megabyte image, whose stream is too big to compress efficiently
+    in one piece. With an executor, its deflate is split up and run in parallel. */
+class PDFBigImageBench : public Benchmark {
+public:
+    PDFBigImageBench(bool parallel) : fParallel(parallel) {}
+
+protected:
+    const char* onGetName() override {
+        return fParallel ? "PDFBigImage_parallel" : "PDFBigImage";
+    }
+    bool isSuitableFor(Backend backend) override {
+        return backend == Backend::kNonRendering;
+    }
+    void onDelayedSetup() override {
+        // A smooth gradient with some noise, which is roughly as hard to compress as a photo.
+        SkAutoPixmapStorage pixmap;
+        pixmap.alloc(SkImageInfo::MakeN32Premul(2048, 2048));
+        SkRandom random;
+        for (int y = 0; y < pixmap.height(); ++y) {
+            for (int x = 0; x < pixmap.width(); ++x) {
+                uint32_t noise = random.nextU() & 0x0F0F0F;
+                *pixmap.writable_addr32(x, y) = SkPackARGB32(0xFF,
+                                                             ((x >> 3) ^ noise) & 0xFF,
+                                                             ((y >> 3) ^ noise >> 8) & 0xFF,
+                                                             ((x + y) >> 4 ^ noise >> 16) & 0xFF);
+            }
+        }
+        fImage = SkImages::RasterFromPixmapCopy(pixmap);
+        fExecutor = fParallel ? SkExecutor::MakeFIFOThreadPool() : nullptr;
+    }
+    void onDraw(int loops, SkCanvas*) override {
+        while (loops-- > 0) {
+            SkNullWStream nullStream;
+            SkPDF::Metadata metadata;
+            metadata.fExecutor = fExecutor.get();
+            SkPDFDocument doc(&nullStream, metadata);
+            doc.beginPage(256, 256);
+            (void)SkPDFSerializeImage(fImage.get(), &doc);
+        }
+    }
+
+private:
+    bool fParallel;
+    sk_sp<SkImage> fImage;
+    std::unique_ptr<SkExecutor> fExecutor;
+};
+
 struct PDFColorComponentBench : public Benchmark {
     bool isSuitableFor(Backend b) override {
         return b == Backend::kNonRendering;
@@ -310,6 +358,8 @@ struct PDFClipPathBenchmark : public Benchmark {
 DEF_BENCH(return new PDFImageBench;)
 DEF_BENCH(return new PDFJpegImageBench;)
 DEF_BENCH(return new PDFCompressionBench;)
+DEF_BENCH(return new PDFBigImageBench(false);)
+DEF_BENCH(return new PDFBigImageBench(true);)
 DEF_BENCH(return new PDFColorComponentBench;)
 DEF_BENCH(return new PDFShaderBench;)
 DEF_BENCH(return new WritePDFTextBenchmark;)
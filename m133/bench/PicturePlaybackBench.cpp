@@ -8,8 +8,12 @@
 
 #include "bench/Benchmark.h"
 #include "include/core/SkBBHFactory.h"
+#include "include/core/SkBitmap.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkMatrix.h"
 #include "include/core/SkPaint.h"
 #include "include/core/SkPicture.h"
 #include "include/core/SkPictureRecorder.h"
@@ -17,6 +21,10 @@
 #include "include/core/SkRect.h"
 #include "include/core/SkString.h"
 #include "src/base/SkRandom.h"
+#include "src/core/SkRecord.h"
+#include "src/core/SkRecordDraw.h"
+#include "src/core/SkRecordOpts.h"
+#include "src/core/SkRecorder.h"
 
 // This is designed to emulate about 4 screens of textual content
 
@@ -98,3 +106,128 @@ DEF_BENCH( return new TiledPlaybackBench(kNone,     kRandom); )
 DEF_BENCH( return new TiledPlaybackBench(kNone,     kTiled ); )
 DEF_BENCH( return new TiledPlaybackBench(kRTree,    kRandom); )
 DEF_BENCH( return new TiledPlaybackBench(kRTree,    kTiled ); )
+
+// Replays a large picture into a raster bitmap, either serially or with
+// SkPicture::playbackTiled() on a thread pool.
+class ParallelPlaybackBench : public Benchmark {
+public:
+    ParallelPlaybackBench(int threads) : fThreads(threads), fName("parallel_playback") {
+        if (fThreads > 0) {
+            fName.appendf("_%dthreads", fThreads);
+        } else {
+            fName.append("_serial");
+        }
+    }
+
+    const char* onGetName() override { return fName.c_str(); }
+    bool isSuitableFor(Backend backend) override { return backend == Backend::kNonRendering; }
+
+    void onDelayedSetup() override {
+        SkRTreeFactory factory;
+        SkPictureRecorder recorder;
+        SkCanvas* canvas = recorder.beginRecording(1024, 1024, &factory);
+            SkRandom rand;
+            SkPaint paint;
+            paint.setAntiAlias(true);
+            for (int i = 0; i < 10000; i++) {
+                SkScalar x = rand.nextRangeScalar(0, 1024),
+                         y = rand.nextRangeScalar(0, 1024),
+                         r = rand.nextRangeScalar(1, 64);
+                paint.setColor(rand.nextU());
+                canvas->drawCircle(x, y, r, paint);
+            }
+        fPic = recorder.finishRecordingAsPicture();
+
+        fBitmap.allocN32Pixels(1024, 1024);
+        if (fThreads > 0) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; i++) {
+            if (fExecutor) {
+                fPic->playbackTiled(fBitmap.pixmap(), SkMatrix::I(), fExecutor.get(), {256, 256});
+            } else {
+                SkCanvas canvas(fBitmap);
+                fPic->playback(&canvas);
+            }
+        }
+    }
+
+private:
+    int                         fThreads;
+    SkString                    fName;
+    sk_sp<SkPicture>            fPic;
+    SkBitmap                    fBitmap;
+    std::unique_ptr<SkExecutor> fExecutor;
+};
+
+DEF_BENCH( return new ParallelPlaybackBench(0); )
+DEF_BENCH( return new ParallelPlaybackBench(2); )
+DEF_BENCH( return new ParallelPlaybackBench(4); )
+DEF_BENCH( return new ParallelPlaybackBench(8); )
+
+// Replays a UI-like frame with the sort of redundancy SkRecordOptimize() removes: a stale
+// background painted over, a matrix and clip reset for every row, and rows of same-paint rects
+// and images. Compares replaying the frame as recorded against replaying the optimized frame.
+class OptimizedPlaybackBench : public Benchmark {
+public:
+    OptimizedPlaybackBench(bool optimize)
+            : fOptimize(optimize)
+            , fName(optimize ? "playback_optimized_record" : "playback_unoptimized_record") {}
+
+    const char* onGetName() override { return fName.c_str(); }
+    SkISize onGetSize() override { return SkISize::Make(1024, 1024); }
+
+    void onDelayedSetup() override {
+        SkBitmap bitmap;
+        bitmap.allocN32Pixels(32, 32);
+        bitmap.eraseColor(0x8000FF00);
+        sk_sp<SkImage> image = bitmap.asImage();
+
+        fRecord = sk_make_sp<SkRecord>();
+        SkRecorder recorder(fRecord.get(), 1024, 1024);
+        SkRandom rand;
+        SkPaint paint;
+        for (int i = 0; i < 256; i++) {
+            paint.setColor(rand.nextU() | 0xFF000000);
+            recorder.drawRect(SkRect::MakeXYWH(rand.nextRangeScalar(0, 960),
+                                               rand.nextRangeScalar(0, 960), 64, 64), paint);
+        }
+        recorder.drawPaint(SkPaint(SkColors::kWhite));
+
+        for (int row = 0; row < 32; row++) {
+            recorder.setMatrix(SkMatrix::I());
+            recorder.setMatrix(SkMatrix::Translate(0, 32 * row));
+            recorder.clipRect(SkRect::MakeWH(1024, 32));
+            paint.setColor(rand.nextU() | 0xFF000000);
+            for (int col = 0; col < 32; col++) {
+                if (row % 2) {
+                    recorder.drawImageRect(image, SkRect::MakeXYWH(32 * col + 1, 1, 30, 30),
+                                           SkSamplingOptions(), &paint);
+                } else {
+                    recorder.drawRect(SkRect::MakeXYWH(32 * col + 1, 1, 30, 30), paint);
+                }
+            }
+        }
+
+        if (fOptimize) {
+            SkRecordOptimize(fRecord.get(), nullptr, /*cullOccludedDraws=*/true);
+        }
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        for (int i = 0; i < loops; i++) {
+            SkRecordDraw(*fRecord, canvas, nullptr, nullptr, 0, nullptr, nullptr);
+        }
+    }
+
+private:
+    bool             fOptimize;
+    SkString         fName;
+    sk_sp<SkRecord>  fRecord;
+};
+
+DEF_BENCH( return new OptimizedPlaybackBench(false); )
+DEF_BENCH( return new OptimizedPlaybackBench(true); )
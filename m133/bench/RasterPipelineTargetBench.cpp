@@ -0,0 +1,155 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "bench/Benchmark.h"
+#include "include/core/SkBlendMode.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkMatrix.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkPoint.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkSamplingOptions.h"
+#include "include/core/SkShader.h"
+#include "include/core/SkSurface.h"
+#include "include/core/SkTileMode.h"
+#include "include/effects/SkGradientShader.h"
+#include "src/core/SkOpts.h"
+
+#include <iterator>
+#include <string>
+
+extern bool gSkForceRasterPipelineBlitter;
+
+// Draws the same raster pipeline workloads with the stage tables pointed at each SkOpts target,
+// so e.g. RasterPipeline_gradient_hsw and RasterPipeline_gradient_skx can be compared directly.
+// Targets this CPU (or build) can't run are skipped.
+
+enum class Workload {
+    kBlend,        // A solid color with a non-srcover blend mode.
+    kGradient,     // A linear gradient with more than two stops.
+    kImageShader,  // A rotated, bilinearly filtered image.
+};
+
+static const char* workload_name(Workload w) {
+    switch (w) {
+        case Workload::kBlend:       return "blend";
+        case Workload::kGradient:    return "gradient";
+        case Workload::kImageShader: return "image_shader";
+    }
+    SkUNREACHABLE;
+}
+
+static const char* target_name(SkOpts::RasterPipelineTarget t) {
+    switch (t) {
+        case SkOpts::RasterPipelineTarget::kNative:  return "native";
+        case SkOpts::RasterPipelineTarget::kDefault: return "default";
+        case SkOpts::RasterPipelineTarget::kHSW:     return "hsw";
+        case SkOpts::RasterPipelineTarget::kSKX:     return "skx";
+        case SkOpts::RasterPipelineTarget::kLASX:    return "lasx";
+    }
+    SkUNREACHABLE;
+}
+
+class RasterPipelineTargetBench : public Benchmark {
+public:
+    RasterPipelineTargetBench(Workload workload, SkOpts::RasterPipelineTarget target)
+            : fWorkload(workload), fTarget(target) {
+        fName = std::string("RasterPipeline_") + workload_name(workload) + "_" +
+                target_name(target);
+    }
+
+protected:
+    static constexpr int kSize = 512;
+
+    const char* onGetName() override { return fName.c_str(); }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == Backend::kNonRendering &&
+               SkOpts::SupportsRasterPipelineTarget(fTarget);
+    }
+
+    void onDelayedSetup() override {
+        fSurface = SkSurfaces::Raster(SkImageInfo::MakeN32Premul(kSize, kSize));
+
+        switch (fWorkload) {
+            case Workload::kBlend:
+                fPaint.setColor(0xC0408020);
+                fPaint.setBlendMode(SkBlendMode::kMultiply);
+                break;
+
+            case Workload::kGradient: {
+                const SkPoint pts[] = {{0, 0}, {kSize, kSize}};
+                const SkColor colors[] = {SK_ColorRED, SK_ColorGREEN, SK_ColorBLUE,
+                                          SK_ColorWHITE, SK_ColorBLACK};
+                const SkScalar pos[] = {0, 0.1f, 0.45f, 0.8f, 1};
+                fPaint.setShader(SkGradientShader::MakeLinear(pts, colors, pos, std::size(colors),
+                                                              SkTileMode::kClamp));
+                break;
+            }
+            case Workload::kImageShader: {
+                sk_sp<SkSurface> src = SkSurfaces::Raster(SkImageInfo::MakeN32Premul(256, 256));
+                SkPaint checker;
+                for (int y = 0; y < 256; y += 16) {
+                    for (int x = 0; x < 256; x += 16) {
+                        checker.setColor((x ^ y) & 16 ? SK_ColorWHITE : 0xFF2060A0);
+                        src->getCanvas()->drawRect(SkRect::MakeXYWH(x, y, 16, 16), checker);
+                    }
+                }
+                SkMatrix lm = SkMatrix::RotateDeg(17, {128, 128});
+                lm.preScale(1.3f, 1.3f);
+                fPaint.setShader(src->makeImageSnapshot()->makeShader(
+                        SkTileMode::kRepeat, SkTileMode::kMirror,
+                        SkSamplingOptions(SkFilterMode::kLinear), lm));
+                break;
+            }
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        // Switching targets flushes the per-thread cache of solid-color blitters, so everything
+        // drawn here (cached or not) runs with fTarget's stages.
+        bool forceRP = gSkForceRasterPipelineBlitter;
+        gSkForceRasterPipelineBlitter = true;
+        SkOpts::SetRasterPipelineTarget(fTarget);
+
+        SkCanvas* canvas = fSurface->getCanvas();
+        for (int i = 0; i < loops; i++) {
+            canvas->drawRect(SkRect::MakeWH(kSize, kSize), fPaint);
+        }
+
+        SkOpts::SetRasterPipelineTarget(SkOpts::RasterPipelineTarget::kNative);
+        gSkForceRasterPipelineBlitter = forceRP;
+    }
+
+private:
+    Workload                     fWorkload;
+    SkOpts::RasterPipelineTarget fTarget;
+    std::string                  fName;
+    sk_sp<SkSurface>             fSurface;
+    SkPaint                      fPaint;
+};
+
+using Target = SkOpts::RasterPipelineTarget;
+
+DEF_BENCH(return new RasterPipelineTargetBench(Workload::kBlend, Target::kDefault);)
+DEF_BENCH(return new RasterPipelineTargetBench(Workload::kBlend, Target::kHSW);)
+DEF_BENCH(return new RasterPipelineTargetBench(Workload::kBlend, Target::kSKX);)
+DEF_BENCH(return new RasterPipelineTargetBench(Workload::kBlend, Target::kLASX);)
+
+DEF_BENCH(return new RasterPipelineTargetBench(Workload::kGradient, Target::kDefault);)
+DEF_BENCH(return new RasterPipelineTargetBench(Workload::kGradient, Target::kHSW);)
+DEF_BENCH(return new RasterPipelineTargetBench(Workload::kGradient, Target::kSKX);)
+DEF_BENCH(return new RasterPipelineTargetBench(Workload::kGradient, Target::kLASX);)
+
+DEF_BENCH(return new RasterPipelineTargetBench(Workload::kImageShader, Target::kDefault);)
+DEF_BENCH(return new RasterPipelineTargetBench(Workload::kImageShader, Target::kHSW);)
+DEF_BENCH(return new RasterPipelineTargetBench(Workload::kImageShader, Target::kSKX);)
+DEF_BENCH(return new RasterPipelineTargetBench(Workload::kImageShader, Target::kLASX);)
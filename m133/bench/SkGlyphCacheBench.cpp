@@ -10,6 +10,7 @@
 #include "bench/Benchmark.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColorSpace.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFontMgr.h"
 #include "include/core/SkGraphics.h"
 #include "include/core/SkTypeface.h"
@@ -117,10 +118,56 @@ private:
     SkString fName;
 };
 
+// Draws the same text from a fixed number of threads once the strikes and glyphs are all
+// cached, so nearly every strike and glyph lookup is a hit. Compare across thread counts to see
+// how well lookups scale.
+class SkGlyphCacheMultiThreadBench : public Benchmark {
+public:
+    explicit SkGlyphCacheMultiThreadBench(int threads) : fThreads(threads) {
+        fName.printf("SkGlyphCacheMultiThread_%dthreads", threads);
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == Backend::kNonRendering;
+    }
+
+    void onDelayedSetup() override {
+        fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+        fTypefaces[0] = ToolUtils::CreatePortableTypeface("serif", SkFontStyle::Italic());
+        fTypefaces[1] = ToolUtils::CreatePortableTypeface("sans-serif", SkFontStyle::Italic());
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkTaskGroup tg(*fExecutor);
+        for (int work = 0; work < loops; work++) {
+            tg.batch(fThreads, [&](int threadIndex) {
+                SkFont font = ToolUtils::DefaultFont();
+                font.setEdging(SkFont::Edging::kAntiAlias);
+                font.setSubpixel(true);
+                font.setTypeface(fTypefaces[threadIndex % 2]);
+                do_font_stuff(&font);
+            });
+            tg.wait();
+        }
+    }
+
+private:
+    const int                   fThreads;
+    SkString                    fName;
+    std::unique_ptr<SkExecutor> fExecutor;
+    sk_sp<SkTypeface>           fTypefaces[2];
+};
+
 DEF_BENCH( return new SkGlyphCacheBasic(256 * 1024); )
 DEF_BENCH( return new SkGlyphCacheBasic(32 * 1024 * 1024); )
 DEF_BENCH( return new SkGlyphCacheStressTest(256 * 1024); )
 DEF_BENCH( return new SkGlyphCacheStressTest(32 * 1024 * 1024); )
+DEF_BENCH( return new SkGlyphCacheMultiThreadBench(1); )
+DEF_BENCH( return new SkGlyphCacheMultiThreadBench(4); )
+DEF_BENCH( return new SkGlyphCacheMultiThreadBench(8); )
 
 namespace {
 class DiscardableManager : public SkStrikeServer::DiscardableHandleManager,
@@ -8,8 +8,17 @@
 #include "bench/ResultsWriter.h"
 #include "bench/SkSLBench.h"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkShader.h"
+#include "include/core/SkSpan.h"
+#include "include/core/SkString.h"
+#include "include/effects/SkRuntimeEffect.h"
 #include "src/base/SkArenaAlloc.h"
 #include "src/core/SkRasterPipeline.h"
+#include "src/core/SkRuntimeEffectPriv.h"
 #include "src/gpu/ganesh/GrCaps.h"
 #include "src/gpu/ganesh/GrRecordingContextPriv.h"
 #include "src/gpu/ganesh/mock/GrMockCaps.h"
@@ -26,6 +35,8 @@
 #include "src/sksl/ir/SkSLProgram.h"
 
 #include <regex>
+#include <string>
+#include <vector>
 
 #include "src/sksl/generated/sksl_shared.minified.sksl"
 #include "src/sksl/generated/sksl_compute.minified.sksl"
@@ -622,6 +633,125 @@ void main()
 }
 )");
 
+///////////////////////////////////////////////////////////////////////////////
+
+// Draws a runtime shader with the raster backend. Most of the time goes to dispatching Raster
+// Pipeline stages, so these track how many stages the SkSL turns into; the stage counts are also
+// logged by RunSkSLModuleBenchmarks, below.
+class SkSLRasterPipelineDrawBench : public Benchmark {
+public:
+    SkSLRasterPipelineDrawBench(const char* name, const char* src)
+            : fName(std::string("sksl_rp_draw_") + name), fSrc(src) {}
+
+    // Returns the number of Raster Pipeline stages the SkSL compiles to, or -1 on failure.
+    static int CountStages(const char* src) {
+        SkSL::Compiler compiler;
+        SkSL::ProgramSettings settings;
+        std::unique_ptr<SkSL::Program> program =
+                compiler.convertProgram(SkSL::ProgramKind::kRuntimeShader, src, settings);
+        const SkSL::FunctionDeclaration* main = program ? program->getFunction("main") : nullptr;
+        if (!main) {
+            return -1;
+        }
+        std::unique_ptr<SkSL::RP::Program> rasterProg = SkSL::MakeRasterPipelineProgram(
+                *program, *main->definition(), /*debugTrace=*/nullptr, /*writeTraceOps=*/false);
+        if (!rasterProg) {
+            return -1;
+        }
+        // The uniform values don't matter, since the pipeline won't run.
+        std::vector<float> uniforms(rasterProg->numUniforms());
+        SkSTArenaAlloc<2048> alloc;
+        SkRasterPipeline pipeline(&alloc);
+        if (!rasterProg->appendStages(&pipeline, &alloc, /*callbacks=*/nullptr,
+                                      SkSpan(uniforms))) {
+            return -1;
+        }
+        return pipeline.getNumStages();
+    }
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == Backend::kRaster;
+    }
+
+    void onDelayedSetup() override {
+        auto [effect, error] = SkRuntimeEffect::MakeForShader(SkString(fSrc));
+        if (!effect) {
+            SK_ABORT("shader compilation failed: %s\n", error.c_str());
+        }
+        // Every uniform is a float, so a ramp of values gives each shader something to work on.
+        sk_sp<SkData> uniforms = SkData::MakeUninitialized(effect->uniformSize());
+        float* values = static_cast<float*>(uniforms->writable_data());
+        for (size_t i = 0; i < effect->uniformSize() / sizeof(float); ++i) {
+            values[i] = 0.25f + 0.125f * (i % 4);
+        }
+        fPaint.setShader(effect->makeShader(std::move(uniforms), /*children=*/{}));
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        for (int i = 0; i < loops; i++) {
+            canvas->drawRect(SkRect::MakeWH(256, 256), fPaint);
+        }
+    }
+
+private:
+    std::string fName;
+    const char* fSrc;
+    SkPaint fPaint;
+};
+
+// Shaders built from the patterns the SkSL Raster Pipeline builder fuses: multiply-adds, clamps,
+// dot products and matrix-vector products.
+static constexpr struct {
+    const char* name;
+    const char* src;
+} kRasterPipelineDrawShaders[] = {
+    {"mad", R"(
+        uniform float4 scale;
+        uniform float4 bias;
+        half4 main(float2 xy) {
+            float4 v = xy.xyxy * scale + bias;
+            v = fract(v) * scale + bias;
+            return half4(fract(v * v + bias));
+        }
+    )"},
+    {"clamp", R"(
+        uniform half4 gain;
+        uniform half4 lift;
+        uniform half4 lo;
+        uniform half4 hi;
+        half4 main(float2 xy) {
+            half4 c = half4(fract(xy.xyxy / 64));
+            c = clamp(c * gain + lift, lo, hi);
+            return saturate(c.bgra * gain + lift);
+        }
+    )"},
+    {"color_matrix", R"(
+        uniform half4x4 m;
+        uniform half4 offset;
+        uniform half3 luma;
+        half4 main(float2 xy) {
+            half4 c = saturate(m * half4(fract(xy.xyxy / 64)) + offset);
+            return half4(half3(dot(c.rgb, luma)), c.a);
+        }
+    )"},
+};
+
+#define RASTER_PIPELINE_DRAW_BENCH(index)                                     \
+    DEF_BENCH(return new SkSLRasterPipelineDrawBench(                         \
+                          kRasterPipelineDrawShaders[index].name,             \
+                          kRasterPipelineDrawShaders[index].src);)
+
+RASTER_PIPELINE_DRAW_BENCH(0)
+RASTER_PIPELINE_DRAW_BENCH(1)
+RASTER_PIPELINE_DRAW_BENCH(2)
+
+#undef RASTER_PIPELINE_DRAW_BENCH
+
 #if defined(SK_BUILD_FOR_UNIX)
 
 #include <malloc.h>
@@ -647,11 +777,12 @@ static int64_t heap_bytes_used() {
 
 #endif
 
-static void bench(NanoJSONResultsWriter* log, const char* name, int bytes) {
-    SkDEBUGCODE(SkDebugf("%s: %d bytes\n", name, bytes);)
+static void bench(NanoJSONResultsWriter* log, const char* name, int value,
+                  const char* unit = "bytes") {
+    SkDEBUGCODE(SkDebugf("%s: %d %s\n", name, value, unit);)
     log->beginObject(name);          // test
     log->beginObject("meta");        //   config
-    log->appendS32("bytes", bytes);  //     sub_result
+    log->appendS32(unit, value);     //     sub_result
     log->endObject();                //   config
     log->endObject();                // test
 }
@@ -725,12 +856,65 @@ void RunSkSLModuleBenchmarks(NanoJSONResultsWriter* log) {
 
     int compilerComputeBinarySize = std::size(SKSL_MINIFIED_sksl_compute);
     bench(log, "sksl_binary_size_compute", compilerComputeBinarySize);
+
+    // Report how many Raster Pipeline stages each of the draw benchmarks' shaders becomes.
+    for (const auto& shader : kRasterPipelineDrawShaders) {
+        std::string name = std::string("sksl_rp_stages_") + shader.name;
+        bench(log, name.c_str(), SkSLRasterPipelineDrawBench::CountStages(shader.src), "stages");
+    }
 }
 
+// Makes `count` distinct effects through the runtime effect cache each loop, as deserializing a
+// picture with that many runtime shaders does. While they all fit in the cache, nothing is compiled
+// after the first loop.
+class SkSLCachedEffectBench : public Benchmark {
+public:
+    explicit SkSLCachedEffectBench(int count) : fCount(count) {
+        fName.printf("sksl_cached_effects_%d", count);
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == Backend::kNonRendering;
+    }
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    void onDelayedSetup() override {
+        for (int i = 0; i < fCount; ++i) {
+            fSkSL.push_back(SkStringPrintf(
+                    "uniform half4 uColor%d; half4 main(float2 p) { return uColor%d * half(p.x); }",
+                    i, i));
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; ++i) {
+            for (const SkString& sksl : fSkSL) {
+                SkMakeCachedRuntimeEffect(SkRuntimeEffect::MakeForShader, sksl);
+            }
+        }
+    }
+
+private:
+    SkString fName;
+    int fCount;
+    std::vector<SkString> fSkSL;
+};
+
+DEF_BENCH(return new SkSLCachedEffectBench(8);)
+DEF_BENCH(return new SkSLCachedEffectBench(64);)
+
+// With `threads` > 0, the modules are preloaded on a thread pool of that size, so modules which
+// don't depend on each other are compiled in parallel.
 class SkSLModuleLoaderBench : public Benchmark {
 public:
-    SkSLModuleLoaderBench(const char* name, std::vector<SkSL::ProgramKind> moduleList)
-            : fName(name), fModuleList(std::move(moduleList)) {}
+    SkSLModuleLoaderBench(const char* name,
+                          std::vector<SkSL::ProgramKind> moduleList,
+                          int threads = 0)
+            : fName(name), fModuleList(std::move(moduleList)), fThreads(threads) {}
 
     const char* onGetName() override {
         return fName;
@@ -750,6 +934,13 @@ public:
 
     void onDraw(int loops, SkCanvas*) override {
         SkASSERT(loops == 1);
+        // The thread pool is torn down before returning, so no preload task outlives the draw
+        // and races with the next onPreDraw's unloadModules().
+        std::unique_ptr<SkExecutor> executor;
+        if (fThreads > 0) {
+            executor = SkExecutor::MakeFIFOThreadPool(fThreads);
+            SkSL::ModuleLoader::PreloadModules(fModuleList, *executor);
+        }
         SkSL::Compiler compiler;
         for (SkSL::ProgramKind kind : fModuleList) {
             compiler.moduleForProgramKind(kind);
@@ -758,6 +949,7 @@ public:
 
     const char* fName;
     std::vector<SkSL::ProgramKind> fModuleList;
+    int fThreads;
 };
 
 DEF_BENCH(return new SkSLModuleLoaderBench("sksl_module_loader_ganesh",
@@ -787,3 +979,19 @@ DEF_BENCH(return new SkSLModuleLoaderBench("sksl_module_loader_graphite",
                                                    SkSL::ProgramKind::kGraphiteVertex,
                                                    SkSL::ProgramKind::kGraphiteFragment,
                                            });)
+
+DEF_BENCH(return new SkSLModuleLoaderBench("sksl_module_loader_graphite_parallel",
+                                           {
+                                                   SkSL::ProgramKind::kVertex,
+                                                   SkSL::ProgramKind::kFragment,
+                                                   SkSL::ProgramKind::kRuntimeColorFilter,
+                                                   SkSL::ProgramKind::kRuntimeShader,
+                                                   SkSL::ProgramKind::kRuntimeBlender,
+                                                   SkSL::ProgramKind::kPrivateRuntimeColorFilter,
+                                                   SkSL::ProgramKind::kPrivateRuntimeShader,
+                                                   SkSL::ProgramKind::kPrivateRuntimeBlender,
+                                                   SkSL::ProgramKind::kCompute,
+                                                   SkSL::ProgramKind::kGraphiteVertex,
+                                                   SkSL::ProgramKind::kGraphiteFragment,
+                                           },
+                                           /*threads=*/4);)
@@ -6,29 +6,98 @@
  */
 
 #include "bench/Benchmark.h"
+#include "include/codec/SkCodec.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkString.h"
+#include "include/private/SkEncodedInfo.h"
 #include "src/codec/SkSwizzler.h"
 #include "src/core/SkSwizzlePriv.h"
 
+#include <memory>
+
 class SwizzleBench : public Benchmark {
 public:
 
     SwizzleBench(const char* name, SkOpts::Swizzle_8888_u32 fn) : fName(name), fFn_u32(fn) {}
     SwizzleBench(const char* name, SkOpts::Swizzle_8888_u8  fn) : fName(name), fFn_u8 (fn) {}
+    SwizzleBench(const char* name, SkOpts::Swizzle_565_u8   fn) : fName(name), fFn_565(fn) {}
+    SwizzleBench(const char* name, SkOpts::Swizzle_8888_index8 fn)
+            : fName(name), fFn_index8(fn) {}
 
     bool isSuitableFor(Backend backend) override { return backend == Backend::kNonRendering; }
     const char* onGetName() override { return fName; }
     void onDraw(int loops, SkCanvas*) override {
         static const int K = 1023; // Arbitrary, but nice to be a non-power-of-two to trip up SIMD.
-        uint32_t dst[K], src[K];
+        // 16-bit sources need up to 8 bytes per pixel.
+        uint32_t dst[K], src[2*K], table[256] = {};
         while (loops --> 0) {
-            if (fFn_u32) { fFn_u32(dst,                 src, K); }
-            if (fFn_u8)  { fFn_u8 (dst, (const uint8_t*)src, K); }
+            if (fFn_u32)    { fFn_u32   (dst,                 src, K); }
+            if (fFn_u8)     { fFn_u8    (dst, (const uint8_t*)src, K); }
+            if (fFn_565)    { fFn_565   ((uint16_t*)dst, (const uint8_t*)src, K); }
+            if (fFn_index8) { fFn_index8(dst, (const uint8_t*)src, K, table); }
         }
     }
 private:
     const char* fName;
-    SkOpts::Swizzle_8888_u32 fFn_u32 = nullptr;
-    SkOpts::Swizzle_8888_u8  fFn_u8  = nullptr;
+    SkOpts::Swizzle_8888_u32    fFn_u32    = nullptr;
+    SkOpts::Swizzle_8888_u8     fFn_u8     = nullptr;
+    SkOpts::Swizzle_565_u8      fFn_565    = nullptr;
+    SkOpts::Swizzle_8888_index8 fFn_index8 = nullptr;
+};
+
+// Swizzles a whole row through SkSwizzler, as a codec would, to cover the sampled paths and the
+// formats that have no SkOpts function of their own.
+class SkSwizzlerBench : public Benchmark {
+public:
+    SkSwizzlerBench(const char* srcName, SkEncodedInfo::Color color, SkEncodedInfo::Alpha alpha,
+                    int bitsPerComponent, const char* dstName, SkColorType colorType,
+                    SkAlphaType alphaType, int sampleX)
+            : fEncodedInfo(SkEncodedInfo::Make(kWidth, 1, color, alpha, bitsPerComponent))
+            , fDstInfo(SkImageInfo::Make(kWidth, 1, colorType, alphaType))
+            , fSampleX(sampleX) {
+        fName.printf("SkSwizzler_%s_to_%s%s", srcName, dstName,
+                     alphaType == kPremul_SkAlphaType ? "_premul" : "");
+        if (sampleX > 1) {
+            fName.appendf("_sample%d", sampleX);
+        }
+    }
+
+    bool isSuitableFor(Backend backend) override { return backend == Backend::kNonRendering; }
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        for (int i = 0; i < 256; i++) {
+            fColorTable[i] = 0xFF000000 | (i * 0x010101);
+        }
+        for (int i = 0; i < kWidth * 8; i++) {
+            fSrc[i] = (uint8_t)(i * 7);
+        }
+        fSwizzler = SkSwizzler::Make(fEncodedInfo, fColorTable, fDstInfo, SkCodec::Options());
+        if (fSwizzler) {
+            fSwizzler->setSampleX(fSampleX);
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        if (!fSwizzler) {
+            return;
+        }
+        while (loops --> 0) {
+            fSwizzler->swizzle(fDst, fSrc);
+        }
+    }
+
+private:
+    static constexpr int kWidth = 1023;
+
+    SkString                    fName;
+    const SkEncodedInfo         fEncodedInfo;
+    const SkImageInfo           fDstInfo;
+    const int                   fSampleX;
+    std::unique_ptr<SkSwizzler> fSwizzler;
+    SkPMColor                   fColorTable[256];
+    uint8_t                     fSrc[kWidth * 8];
+    uint32_t                    fDst[kWidth];
 };
 
 
@@ -42,3 +111,69 @@ DEF_BENCH(return new SwizzleBench("SkOpts::grayA_to_RGBA", SkOpts::grayA_to_RGBA
 DEF_BENCH(return new SwizzleBench("SkOpts::grayA_to_rgbA", SkOpts::grayA_to_rgbA));
 DEF_BENCH(return new SwizzleBench("SkOpts::inverted_CMYK_to_RGB1", SkOpts::inverted_CMYK_to_RGB1));
 DEF_BENCH(return new SwizzleBench("SkOpts::inverted_CMYK_to_BGR1", SkOpts::inverted_CMYK_to_BGR1));
+DEF_BENCH(return new SwizzleBench("SkOpts::RGB16_to_RGB1",  SkOpts::RGB16_to_RGB1));
+DEF_BENCH(return new SwizzleBench("SkOpts::RGB16_to_BGR1",  SkOpts::RGB16_to_BGR1));
+DEF_BENCH(return new SwizzleBench("SkOpts::RGBA16_to_RGBA", SkOpts::RGBA16_to_RGBA));
+DEF_BENCH(return new SwizzleBench("SkOpts::RGBA16_to_BGRA", SkOpts::RGBA16_to_BGRA));
+DEF_BENCH(return new SwizzleBench("SkOpts::RGBA16_to_rgbA", SkOpts::RGBA16_to_rgbA));
+DEF_BENCH(return new SwizzleBench("SkOpts::RGBA16_to_bgrA", SkOpts::RGBA16_to_bgrA));
+DEF_BENCH(return new SwizzleBench("SkOpts::RGB_to_565",     SkOpts::RGB_to_565));
+DEF_BENCH(return new SwizzleBench("SkOpts::gray_to_565",    SkOpts::gray_to_565));
+DEF_BENCH(return new SwizzleBench("SkOpts::index8_to_8888", SkOpts::index8_to_8888));
+
+#define SWIZZLER_BENCH(src, color, alpha, bits, dst, colorType, alphaType)                   \
+    DEF_BENCH(return new SkSwizzlerBench(src, SkEncodedInfo::color, SkEncodedInfo::alpha,     \
+                                         bits, dst, colorType, alphaType, 1));               \
+    DEF_BENCH(return new SkSwizzlerBench(src, SkEncodedInfo::color, SkEncodedInfo::alpha,     \
+                                         bits, dst, colorType, alphaType, 2));               \
+    DEF_BENCH(return new SkSwizzlerBench(src, SkEncodedInfo::color, SkEncodedInfo::alpha,     \
+                                         bits, dst, colorType, alphaType, 4))
+
+SWIZZLER_BENCH("gray",     kGray_Color,         kOpaque_Alpha,    8, "n32", kN32_SkColorType,
+               kOpaque_SkAlphaType);
+SWIZZLER_BENCH("gray",     kGray_Color,         kOpaque_Alpha,    8, "565", kRGB_565_SkColorType,
+               kOpaque_SkAlphaType);
+SWIZZLER_BENCH("gray",     kGray_Color,         kOpaque_Alpha,    8, "gray", kGray_8_SkColorType,
+               kOpaque_SkAlphaType);
+SWIZZLER_BENCH("grayA",    kGrayAlpha_Color,    kUnpremul_Alpha,  8, "n32", kN32_SkColorType,
+               kPremul_SkAlphaType);
+SWIZZLER_BENCH("grayA",    kGrayAlpha_Color,    kUnpremul_Alpha,  8, "n32", kN32_SkColorType,
+               kUnpremul_SkAlphaType);
+SWIZZLER_BENCH("index8",   kPalette_Color,      kUnpremul_Alpha,  8, "n32", kN32_SkColorType,
+               kPremul_SkAlphaType);
+SWIZZLER_BENCH("index8",   kPalette_Color,      kUnpremul_Alpha,  8, "565", kRGB_565_SkColorType,
+               kOpaque_SkAlphaType);
+SWIZZLER_BENCH("index4",   kPalette_Color,      kUnpremul_Alpha,  4, "n32", kN32_SkColorType,
+               kPremul_SkAlphaType);
+SWIZZLER_BENCH("rgb",      kRGB_Color,          kOpaque_Alpha,    8, "rgba", kRGBA_8888_SkColorType,
+               kOpaque_SkAlphaType);
+SWIZZLER_BENCH("rgb",      kRGB_Color,          kOpaque_Alpha,    8, "bgra", kBGRA_8888_SkColorType,
+               kOpaque_SkAlphaType);
+SWIZZLER_BENCH("rgb",      kRGB_Color,          kOpaque_Alpha,    8, "565", kRGB_565_SkColorType,
+               kOpaque_SkAlphaType);
+SWIZZLER_BENCH("rgba",     kRGBA_Color,         kUnpremul_Alpha,  8, "rgba", kRGBA_8888_SkColorType,
+               kPremul_SkAlphaType);
+SWIZZLER_BENCH("rgba",     kRGBA_Color,         kUnpremul_Alpha,  8, "bgra", kBGRA_8888_SkColorType,
+               kPremul_SkAlphaType);
+SWIZZLER_BENCH("rgba",     kRGBA_Color,         kUnpremul_Alpha,  8, "bgra", kBGRA_8888_SkColorType,
+               kUnpremul_SkAlphaType);
+SWIZZLER_BENCH("bgra",     kBGRA_Color,         kUnpremul_Alpha,  8, "bgra", kBGRA_8888_SkColorType,
+               kPremul_SkAlphaType);
+SWIZZLER_BENCH("rgb16",    kRGB_Color,          kOpaque_Alpha,   16, "rgba", kRGBA_8888_SkColorType,
+               kOpaque_SkAlphaType);
+SWIZZLER_BENCH("rgb16",    kRGB_Color,          kOpaque_Alpha,   16, "bgra", kBGRA_8888_SkColorType,
+               kOpaque_SkAlphaType);
+SWIZZLER_BENCH("rgb16",    kRGB_Color,          kOpaque_Alpha,   16, "565", kRGB_565_SkColorType,
+               kOpaque_SkAlphaType);
+SWIZZLER_BENCH("rgba16",   kRGBA_Color,         kUnpremul_Alpha, 16, "rgba", kRGBA_8888_SkColorType,
+               kPremul_SkAlphaType);
+SWIZZLER_BENCH("rgba16",   kRGBA_Color,         kUnpremul_Alpha, 16, "rgba", kRGBA_8888_SkColorType,
+               kUnpremul_SkAlphaType);
+SWIZZLER_BENCH("rgba16",   kRGBA_Color,         kUnpremul_Alpha, 16, "bgra", kBGRA_8888_SkColorType,
+               kPremul_SkAlphaType);
+SWIZZLER_BENCH("rgba16",   kRGBA_Color,         kUnpremul_Alpha, 16, "bgra", kBGRA_8888_SkColorType,
+               kUnpremul_SkAlphaType);
+SWIZZLER_BENCH("cmyk",     kInvertedCMYK_Color, kOpaque_Alpha,    8, "rgba", kRGBA_8888_SkColorType,
+               kOpaque_SkAlphaType);
+SWIZZLER_BENCH("cmyk",     kInvertedCMYK_Color, kOpaque_Alpha,    8, "565", kRGB_565_SkColorType,
+               kOpaque_SkAlphaType);
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "bench/Benchmark.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkPixmap.h"
+#include "include/core/SkSize.h"
+#include "include/core/SkString.h"
+#include "include/core/SkYUVAInfo.h"
+#include "include/core/SkYUVAPixmaps.h"
+#include "src/base/SkRandom.h"
+#include "src/core/SkYUVToRGB.h"
+
+// Converts a 1080p frame of 8-bit YUV planes to N32, as SkImages::RasterFromYUVAPixmaps() does
+// for each decoded JPEG or video frame, without the allocation of the result.
+class YUVToRGBBench : public Benchmark {
+public:
+    YUVToRGBBench(SkYUVAInfo::PlaneConfig config,
+                  SkYUVAInfo::Subsampling subsampling,
+                  SkYUVColorSpace cs)
+            : fYUVAInfo({1920, 1080}, config, subsampling, cs) {
+        fName.printf("YUVToRGB_%s_%s_%s",
+                     subsampling == SkYUVAInfo::Subsampling::k444 ? "444" :
+                     subsampling == SkYUVAInfo::Subsampling::k422 ? "422" : "420",
+                     config == SkYUVAInfo::PlaneConfig::kY_U_V ? "planar" : "interleaved",
+                     cs == kJPEG_Full_SkYUVColorSpace ? "jpeg" : "rec709_limited");
+    }
+
+    bool isSuitableFor(Backend backend) override { return backend == Backend::kNonRendering; }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        fPixmaps = SkYUVAPixmaps::Allocate(
+                SkYUVAPixmapInfo(fYUVAInfo, SkYUVAPixmapInfo::DataType::kUnorm8, nullptr));
+        SkRandom random;
+        for (int i = 0; i < fPixmaps.numPlanes(); ++i) {
+            const SkPixmap& plane = fPixmaps.plane(i);
+            for (int y = 0; y < plane.height(); ++y) {
+                auto* row = static_cast<uint8_t*>(plane.writable_addr(0, y));
+                for (size_t x = 0; x < plane.info().minRowBytes(); ++x) {
+                    row[x] = random.nextU() & 0xFF;
+                }
+            }
+        }
+        fDst.allocPixels(SkImageInfo::MakeN32Premul(fYUVAInfo.dimensions()));
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; ++i) {
+            SkConvertYUVAPixmapsToRGBA(fPixmaps, fDst.pixmap());
+        }
+    }
+
+private:
+    SkString      fName;
+    SkYUVAInfo    fYUVAInfo;
+    SkYUVAPixmaps fPixmaps;
+    SkBitmap      fDst;
+};
+
+using Config = SkYUVAInfo::PlaneConfig;
+using Subsampling = SkYUVAInfo::Subsampling;
+
+DEF_BENCH(return new YUVToRGBBench(Config::kY_U_V, Subsampling::k420, kJPEG_Full_SkYUVColorSpace);)
+DEF_BENCH(return new YUVToRGBBench(Config::kY_U_V, Subsampling::k422, kJPEG_Full_SkYUVColorSpace);)
+DEF_BENCH(return new YUVToRGBBench(Config::kY_U_V, Subsampling::k444, kJPEG_Full_SkYUVColorSpace);)
+DEF_BENCH(return new YUVToRGBBench(Config::kY_UV,
+                                   Subsampling::k420,
+                                   kRec709_Limited_SkYUVColorSpace);)
+DEF_BENCH(return new YUVToRGBBench(Config::kY_UV,
+                                   Subsampling::k444,
+                                   kRec709_Limited_SkYUVColorSpace);)
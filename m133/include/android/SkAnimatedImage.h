@@ -8,15 +8,21 @@
 #ifndef SkAnimatedImage_DEFINED
 #define SkAnimatedImage_DEFINED
 
+#include "include/codec/SkCodec.h"
 #include "include/codec/SkCodecAnimation.h"
 #include "include/core/SkBitmap.h"
 #include "include/core/SkDrawable.h"
 #include "include/core/SkMatrix.h"
 #include "include/core/SkRect.h"
 
+#include <memory>
+#include <vector>
+
 class SkAndroidCodec;
+class SkExecutor;
 class SkImage;
 class SkPicture;
+class SkTaskGroup;
 
 /**
  *  Thread unsafe drawable for drawing animated images (e.g. GIF).
@@ -123,6 +129,30 @@ public:
      */
     SkFilterMode getFilterMode() const { return fFilterMode; }
 
+    /**
+     *  Keep up to this many bytes of decoded frames, so that later repetitions of the
+     *  animation, and reset(), can show them without decoding them again.
+     *
+     *  Frames are kept in the order they are first shown, until the budget is used up.
+     *  Lowering the budget drops the frames that come last in the animation. By default the
+     *  budget is zero, and only the few frames needed to decode the next one are kept.
+     */
+    void setFrameCacheBudget(size_t bytes);
+
+    /**
+     *  Return the number of bytes of decoded frames that may be kept.
+     */
+    size_t getFrameCacheBudget() const { return fFrameCacheBudget; }
+
+    /**
+     *  If not null, whenever a new frame is shown, the frame after it is decoded ahead of
+     *  time on this executor, so that decodeNextFrame() usually only has to swap it in.
+     *
+     *  The executor must outlive this SkAnimatedImage, or until setExecutor() is called
+     *  again. By default frames are decoded when decodeNextFrame() is called.
+     */
+    void setExecutor(SkExecutor*);
+
 protected:
     SkRect onGetBounds() override;
     void onDraw(SkCanvas*) override;
@@ -167,12 +197,36 @@ private:
     int                             fRepetitionsCompleted;
     SkFilterMode                    fFilterMode = SkFilterMode::kLinear;
 
+    // Indexed by frame. A Frame with fIndex == SkCodec::kNoFrame isn't cached.
+    std::vector<Frame>              fFrameCache;
+    size_t                          fFrameCacheBudget = 0;
+    size_t                          fFrameCacheBytes = 0;
+
+    // Decodes the next frame into fDecodingFrame. While it's running, only it may touch
+    // fCodec, fDecodingFrame and fRestoreFrame.
+    SkExecutor*                     fExecutor = nullptr;
+    std::unique_ptr<SkTaskGroup>    fLookAhead;
+
     SkAnimatedImage(std::unique_ptr<SkAndroidCodec>, const SkImageInfo& requestedInfo,
             SkIRect cropRect, sk_sp<SkPicture> postProcess);
 
     int computeNextFrame(int current, bool* animationEnded);
     double finish();
 
+    /**
+     *  Decodes frameToDecode into fDecodingFrame, reusing whichever kept frame it can as the
+     *  prior frame. On failure, fDecodingFrame no longer holds any frame.
+     */
+    bool decodeFrame(int frameToDecode, const SkCodec::FrameInfo& frameInfo);
+
+    /**
+     *  Called once fDisplayFrame holds the frame decodeNextFrame() is returning.
+     */
+    int onFrameShown(bool animationEnded);
+    void cacheDisplayFrame();
+    void startLookAhead();
+    void waitForLookAhead();
+
     /**
      *  True if there is no crop, orientation, or post decoding scaling.
      */
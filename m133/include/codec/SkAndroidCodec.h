@@ -257,6 +257,20 @@ public:
      */
     SkCodec::Result getAndroidPixels(const SkImageInfo& info, void* pixels, size_t rowBytes);
 
+    /**
+     *  Decode the whole image scaled to info's dimensions, which may be any size no larger
+     *  than the image (in both dimensions), and need not match a sample size.
+     *
+     *  The codec decodes at the smallest scale it supports natively that is at least as large
+     *  as the request (e.g. libjpeg-turbo's n/8 DCT scales), then box filters that down to the
+     *  requested size in one pass. Decoding a JPEG thumbnail therefore reads only the DCT
+     *  coefficients it needs, and each output pixel averages all of the pixels it covers.
+     *
+     *  If the image data is incomplete, the partially decoded image is still scaled, and
+     *  kIncompleteInput or kErrorInInput is returned.
+     */
+    SkCodec::Result getPixelsAtSize(const SkImageInfo& info, void* pixels, size_t rowBytes);
+
     SkCodec::Result getPixels(const SkImageInfo& info, void* pixels, size_t rowBytes) {
         return this->getAndroidPixels(info, pixels, rowBytes);
     }
@@ -33,6 +33,7 @@
 #endif
 
 class SkData;
+class SkExecutor;
 class SkFrameHolder;
 class SkImage;
 class SkPngChunkReader;
@@ -220,6 +221,22 @@ public:
     // deprecated
     static std::unique_ptr<SkCodec> MakeFromData(sk_sp<SkData>, SkPngChunkReader* = nullptr);
 
+    /**
+     *  Memory maps the file open as |fd| (read-only) and returns an SkCodec that decodes from
+     *  the mapping, or NULL if the file could not be mapped or is not an image we know how to
+     *  decode.
+     *
+     *  Codecs that can read from memory (e.g. JPEG and PNG) read the mapped bytes in place,
+     *  rather than copying them into intermediate buffers. The codec keeps the mapping alive,
+     *  so the caller may close |fd| as soon as this returns.
+     *
+     *  Result and SkPngChunkReader are as in MakeFromStream.
+     */
+    static std::unique_ptr<SkCodec> MakeFromFD(int fd,
+                                               SkSpan<const SkCodecs::Decoder> decoders,
+                                               Result* = nullptr,
+                                               SkPngChunkReader* = nullptr);
+
     virtual ~SkCodec();
 
     /**
@@ -337,6 +354,8 @@ public:
             , fSubset(nullptr)
             , fFrameIndex(0)
             , fPriorFrame(kNoFrame)
+            , fExecutor(nullptr)
+            , fProgressivePreview(false)
         {}
 
         ZeroInitialized            fZeroInitialized;
@@ -380,6 +399,26 @@ public:
          *  If set to kNoFrame, the codec will decode any necessary required frame(s) first.
          */
         int                        fPriorFrame;
+
+        /**
+         *  If not NULL, getPixels() may split the decode into independent parts and run them
+         *  concurrently on this executor. The result is the same as a serial decode.
+         *
+         *  Currently only used by the JPEG codec, for full size decodes of baseline images
+         *  with restart markers. Ignored by scanline and incremental decodes.
+         */
+        SkExecutor*                fExecutor;
+
+        /**
+         *  If true, getPixels() decodes a progressive image only up to its first complete
+         *  scan, which is usually just the DC coefficients (i.e. a 1/8 scale image), and does
+         *  not read the rest of the data. Combined with getScaledDimensions(0.125f), this is a
+         *  cheap, coarse preview.
+         *
+         *  Currently only used by the JPEG codec. Ignored for images that are not progressive,
+         *  and by scanline and incremental decodes.
+         */
+        bool                       fProgressivePreview;
     };
 
     /**
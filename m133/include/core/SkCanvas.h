@@ -2558,6 +2558,7 @@ private:
     friend class SkCanvasPriv;      // needs to expose android functions for testing outside android
     friend class AutoLayerForImageFilter;
     friend class SkSurface_Raster;  // needs getDevice()
+    friend class SkTiledRasterCanvas;  // needs predrawNotify() and drawSlug()
     friend class SkNoDrawCanvas;    // needs resetForNextPicture()
     friend class SkNWayCanvas;
     friend class SkPictureRecord;   // predrawNotify (why does it need it? <reed>)
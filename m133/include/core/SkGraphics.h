@@ -18,6 +18,7 @@
 class SkData;
 class SkImageGenerator;
 class SkOpenTypeSVGDecoder;
+class SkRuntimeEffect;
 class SkTraceMemoryDump;
 
 class SK_API SkGraphics {
@@ -109,6 +110,40 @@ public:
     static size_t GetResourceCacheTotalByteLimit();
     static size_t SetResourceCacheTotalByteLimit(size_t newLimit);
 
+    /**
+     *  The resource cache is split into shards by key, each with its own lock. A shard may always
+     *  use an equal share of the byte limit (its fByteLimit), and borrows whatever the others
+     *  leave unused. These report the state of each shard, e.g. to check that entries and lookups
+     *  are spread evenly across them. An index out of range gets all zeros.
+     */
+    struct ResourceCacheShardStats {
+        size_t   fBytesUsed;
+        size_t   fByteLimit;
+        int      fCount;   // Number of entries in the shard.
+        uint64_t fHits;    // Lookups that found a valid entry.
+        uint64_t fMisses;  // Lookups that found nothing, or a stale entry.
+    };
+    static int GetResourceCacheShardCount();
+    static ResourceCacheShardStats GetResourceCacheShardStats(int index);
+
+    /**
+     *  How the resource cache picks entries to purge when it is over its limit.
+     *
+     *  kLRU purges the least recently used entries first. This is the default.
+     *
+     *  kCostAware also weighs how long each entry took to make per byte (e.g. how long an image
+     *  took to decode) and how often it has been used, so that large images which are slow to
+     *  decode are not purged in favor of entries that are cheap to make again.
+     *
+     *  SetResourceCacheEvictionPolicy() returns the previous policy.
+     */
+    enum class ResourceCacheEvictionPolicy {
+        kLRU,
+        kCostAware,
+    };
+    static ResourceCacheEvictionPolicy GetResourceCacheEvictionPolicy();
+    static ResourceCacheEvictionPolicy SetResourceCacheEvictionPolicy(ResourceCacheEvictionPolicy);
+
     /**
      *  For debugging purposes, this will attempt to purge the resource cache. It
      *  does not change the limit.
@@ -126,6 +161,44 @@ public:
     static size_t GetResourceCacheSingleAllocationByteLimit();
     static size_t SetResourceCacheSingleAllocationByteLimit(size_t newLimit);
 
+    /**
+     *  Runtime effects that Skia makes from SkSL itself, e.g. when deserializing runtime shaders,
+     *  color filters and blenders, are kept in a process-wide cache so that each SkSL string is
+     *  compiled once. The cache is budgeted by the approximate memory held by each effect's
+     *  compiled programs. When it is over its limit, the least recently used effects are purged,
+     *  except for pinned ones.
+     *
+     *  SetRuntimeEffectCacheByteLimit() returns the previous limit.
+     */
+    static size_t GetRuntimeEffectCacheByteLimit();
+    static size_t SetRuntimeEffectCacheByteLimit(size_t newLimit);
+
+    struct RuntimeEffectCacheStats {
+        size_t   fBytesUsed;
+        size_t   fByteLimit;
+        int      fCount;        // Number of cached effects, including pinned ones.
+        int      fPinnedCount;
+        uint64_t fHits;         // Lookups that found a cached effect.
+        uint64_t fMisses;       // Lookups that had to compile the SkSL.
+        uint64_t fEvictions;    // Effects purged to stay within the limit.
+    };
+    static RuntimeEffectCacheStats GetRuntimeEffectCacheStats();
+
+    /**
+     *  Pinning an effect keeps it in the runtime effect cache, whatever the limit, until it is
+     *  unpinned, so that its SkSL is never compiled again however many other effects are used.
+     *  Effects are matched by their SkSL: if an effect with the same SkSL is already cached, that
+     *  one is pinned instead.
+     */
+    static void PinRuntimeEffect(sk_sp<SkRuntimeEffect> effect);
+    static void UnpinRuntimeEffect(const SkRuntimeEffect* effect);
+
+    /**
+     *  For debugging purposes, this purges every effect that is not pinned from the runtime
+     *  effect cache. It does not change the limit.
+     */
+    static void PurgeRuntimeEffectCache();
+
     /**
      *  Dumps memory usage of caches using the SkTraceMemoryDump interface. See SkTraceMemoryDump
      *  for usage of this method.
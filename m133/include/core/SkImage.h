@@ -35,6 +35,7 @@ class SkPicture;
 class SkPixmap;
 class SkShader;
 class SkSurfaceProps;
+class SkYUVAPixmaps;
 enum SkColorType : int;
 enum class SkTextureCompressionType;
 enum class SkTileMode;
@@ -218,6 +219,23 @@ SK_API sk_sp<SkImage> RasterFromData(const SkImageInfo& info,
                                      sk_sp<SkData> pixels,
                                      size_t rowBytes);
 
+/** Creates a CPU-backed SkImage by converting the planes of pixmaps to RGB, applying its
+    SkYUVColorSpace and origin. Chroma planes are upsampled by replicating samples.
+
+    The planes must have 8-bit channels, with 4:4:4, 4:2:2, 4:4:0 or 4:2:0 subsampling. Y and A
+    must each be in a single channel plane, and U and V must each be in a single channel plane
+    or be interleaved in one two channel plane; this is the layout of decoded JPEG and video
+    frames. Those layouts are converted with SIMD code in one pass.
+
+    The returned SkImage is kN32_SkColorType, and is opaque if pixmaps has no alpha plane.
+
+    @param pixmaps          Y, U, V and (optional) A planes
+    @param imageColorSpace  range of colors of the RGB values; may be nullptr
+    @return                 created SkImage, or nullptr if pixmaps is invalid or unsupported
+*/
+SK_API sk_sp<SkImage> RasterFromYUVAPixmaps(const SkYUVAPixmaps& pixmaps,
+                                            sk_sp<SkColorSpace> imageColorSpace = nullptr);
+
 /** Creates a filtered SkImage on the CPU. filter processes the src image, potentially changing
     the color, position, and size. subset is the bounds of src that are processed
     by filter. clipBounds is the expected bounds of the filtered SkImage. outSubset
@@ -19,11 +19,15 @@
 
 class SkCanvas;
 class SkData;
+class SkExecutor;
 class SkMatrix;
+class SkPixmap;
 class SkStream;
+class SkSurfaceProps;
 class SkWStream;
 enum class SkFilterMode;
 struct SkDeserialProcs;
+struct SkISize;
 struct SkSerialProcs;
 
 // TODO(kjlubick) Remove this after cleaning up clients
@@ -135,6 +139,34 @@ public:
     */
     virtual void playback(SkCanvas* canvas, AbortCallback* callback = nullptr) const = 0;
 
+    /** Replays the drawing commands into the pixels of dst, concurrently on executor.
+
+        dst is split into tiles of tileSize, and each tile replays only the commands
+        whose bounds reach it, through its own canvas clipped to that tile. Tiles write
+        disjoint pixels, so no merge step is needed. Pictures with commands that read
+        pixels outside of the tile they draw, such as backdrop filters, are replayed
+        serially. The result is identical to playback() into a raster canvas on dst with
+        matrix, with one exception: a path that crosses a tile boundary is clipped to each
+        tile before it is scan converted, which can move its anti-aliased edge by a fraction
+        of a pixel. Only the pixels within about a pixel of such an edge may differ from
+        playback(), by at most half of their coverage, along with whatever an image
+        filter computes from those pixels.
+
+        If executor is nullptr, SkExecutor::GetDefault() is used. The picture must not
+        contain drawables that are only safe to draw on the calling thread; those
+        pictures are also replayed serially.
+
+        @param dst       pixels to draw into
+        @param matrix    transform applied to the picture's commands
+        @param executor  runs tiles concurrently; may be nullptr
+        @param tileSize  size of each tile; must not be empty
+        @param props     LCD striping orientation and setting for device independent fonts;
+                         may be nullptr
+        @return          true if dst was drawn into
+    */
+    bool playbackTiled(const SkPixmap& dst, const SkMatrix& matrix, SkExecutor* executor,
+                       SkISize tileSize, const SkSurfaceProps* props = nullptr) const;
+
     /** Returns cull SkRect for this picture, passed in when SkPicture was created.
         Returned SkRect does not specify clipping SkRect for SkPicture; cull is hint
         of SkPicture bounds.
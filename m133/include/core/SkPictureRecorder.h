@@ -90,6 +90,26 @@ public:
      */
     sk_sp<SkDrawable> finishRecordingAsDrawable();
 
+    /** Counts of the commands the finishRecording* methods optimized away. */
+    struct OptimizationStats {
+        int fRecordedOps       = 0;  //!< commands recorded, before optimization
+        int fRemovedOps        = 0;  //!< commands removed by all optimizations together
+        int fMergedDraws       = 0;  //!< draws merged into another draw of the same run
+        int fCulledDraws       = 0;  //!< draws completely covered by a later opaque draw
+        int fRedundantStateOps = 0;  //!< matrix and clip changes that had no effect
+    };
+
+    /** Returns what was optimized away when the last recording was finished. */
+    const OptimizationStats& optimizationStats() const { return fOptimizationStats; }
+
+    /**
+     *  If set, finishing the recording removes draws that later opaque draws completely cover.
+     *  This is only exact if the result is never drawn under an anti-aliased clip, where the
+     *  partially covered pixels of the later draw would have let the earlier draw show through,
+     *  so it is off by default. Stays set for subsequent recordings.
+     */
+    void setCullOccludedDraws(bool cull) { fCullOccludedDraws = cull; }
+
 private:
     void reset();
 
@@ -107,6 +127,8 @@ private:
     sk_sp<SkBBoxHierarchy>      fBBH;
     std::unique_ptr<SkRecorder> fRecorder;
     sk_sp<SkRecord>             fRecord;
+    OptimizationStats           fOptimizationStats;
+    bool                        fCullOccludedDraws = false;
 
     SkPictureRecorder(SkPictureRecorder&&) = delete;
     SkPictureRecorder& operator=(SkPictureRecorder&&) = delete;
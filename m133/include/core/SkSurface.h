@@ -30,6 +30,7 @@ class SkBitmap;
 class SkCanvas;
 class SkCapabilities;
 class SkColorSpace;
+class SkExecutor;
 class SkPaint;
 class SkSurface;
 struct SkIRect;
@@ -82,6 +83,32 @@ inline sk_sp<SkSurface> Raster(const SkImageInfo& imageInfo,
     return Raster(imageInfo, 0, props);
 }
 
+/** Allocates raster SkSurface whose SkCanvas defers drawing until the pixels are needed.
+    Draws are recorded and binned into tiles by their bounds; the tiles are then rasterized
+    concurrently on executor when the pixels are read, snapshotted, written, or drawn. Tiles
+    draw in the same device coordinates as a surface made with Raster(), so the resulting pixels
+    are identical to it, with one exception: a path that crosses a tile boundary is clipped to
+    each tile before it is scan converted, which can move its anti-aliased edge by a fraction of
+    a pixel. Only the pixels within about a pixel of such an edge may differ from Raster(), by
+    at most half of their coverage, along with whatever an image filter computes from
+    those pixels.
+
+    Pixel memory is zeroed before use and deleted when SkSurface is deleted.
+
+    @param imageInfo     width, height, SkColorType, SkAlphaType, SkColorSpace,
+                         of raster surface; width and height must be greater than zero
+    @param executor      runs the tile rasterization; if nullptr, SkExecutor::GetDefault()
+                         is used. Must outlive the returned SkSurface.
+    @param tileSize      dimensions of each tile; width and height must be greater than zero
+    @param surfaceProps  LCD striping orientation and setting for device independent fonts;
+                         may be nullptr
+    @return              SkSurface if parameters are valid and memory was allocated, else nullptr.
+*/
+SK_API sk_sp<SkSurface> RasterTiled(const SkImageInfo& imageInfo,
+                                    SkExecutor* executor,
+                                    SkISize tileSize,
+                                    const SkSurfaceProps* surfaceProps = nullptr);
+
 /** Allocates raster SkSurface. SkCanvas returned by SkSurface draws directly into the
     provided pixels.
 
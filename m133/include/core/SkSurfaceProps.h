@@ -60,6 +60,9 @@ public:
         // If set, all rendering will have dithering enabled
         // Currently this only impacts GPU backends
         kAlwaysDither_Flag = 1 << 2,
+        // Fill anti-aliased paths with the sparse strip rasterizer instead of the analytic AA
+        // scan converter. Only impacts raster surfaces.
+        kSparseStripRasterizer_Flag = 1 << 3,
     };
 
     /** No flags, unknown pixel geometry, platform-default contrast/gamma. */
@@ -94,6 +97,10 @@ public:
         return SkToBool(fFlags & kAlwaysDither_Flag);
     }
 
+    bool isSparseStripRasterizer() const {
+        return SkToBool(fFlags & kSparseStripRasterizer_Flag);
+    }
+
     bool operator==(const SkSurfaceProps& that) const {
         return fFlags == that.fFlags && fPixelGeometry == that.fPixelGeometry &&
         fTextContrast == that.fTextContrast && fTextGamma == that.fTextGamma;
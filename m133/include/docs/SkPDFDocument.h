@@ -162,7 +162,10 @@ struct Metadata {
     /** Executor to handle threaded work within PDF Backend. If this is nullptr,
         then all work will be done serially on the main thread. To have worker
         threads assist with various tasks, set this to a valid SkExecutor
-        instance. Currently used for executing Deflate algorithm in parallel.
+        instance. Currently used for executing Deflate algorithm in parallel, both
+        across streams and within large streams (e.g. multi-megabyte images).
+        Large streams are compressed while the document's caller waits, so the
+        document must not be drawn to from work running on this executor.
 
         If set, the PDF output will be non-reproducible in the order and
         internal numbering of objects, but should render the same.
@@ -26,6 +26,7 @@
 #include "include/sksl/SkSLDebugTrace.h"
 #include "include/sksl/SkSLVersion.h"
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
@@ -249,6 +250,24 @@ public:
     };
     static TracedShader MakeTraced(sk_sp<SkShader> shader, const SkIPoint& traceCoord);
 
+    /**
+     * When an effect is first drawn on the CPU, its SkSL is compiled to a Raster Pipeline program.
+     * To avoid paying for that at startup, an app can save the compiled programs of its effects
+     * and load them into a later run of the same build.
+     *
+     * SerializeRasterPipelinePrograms compiles each of the effects, if it hasn't been drawn yet,
+     * and returns all of their programs as one blob, which may be written to disk.
+     *
+     * LoadRasterPipelinePrograms makes the programs in such a blob available to any effect made
+     * afterwards (or not yet drawn) with the same SkSL and Options, which then skips compiling.
+     * It returns the number of programs loaded; blobs written by a different build of Skia
+     * load none. The blob is only checked for structural validity, so it must come from a
+     * trusted source, like a cache file written by the app itself.
+     */
+    static sk_sp<SkData> SerializeRasterPipelinePrograms(
+            SkSpan<const sk_sp<SkRuntimeEffect>> effects);
+    static int LoadRasterPipelinePrograms(sk_sp<SkData> data);
+
     // Returns the SkSL source of the runtime effect shader.
     const std::string& source() const;
 
@@ -329,6 +348,7 @@ private:
     std::unique_ptr<SkSL::Program> fBaseProgram;
     std::unique_ptr<SkSL::RP::Program> fRPProgram;
     mutable SkOnce fCompileRPProgramOnce;
+    mutable std::atomic<size_t> fRPProgramSize{0};  // Set once fRPProgram has been compiled.
     const SkSL::FunctionDefinition& fMain;
     std::vector<Uniform> fUniforms;
     std::vector<Child> fChildren;
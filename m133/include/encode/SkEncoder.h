@@ -15,6 +15,9 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <functional>
+
+class SkCanvas;
 
 class SK_API SkEncoder : SkNoncopyable {
 public:
@@ -43,6 +46,27 @@ public:
      */
     bool encodeRows(int numRows);
 
+    /**
+     *  Encode |rows| as the next rows.height() rows of the image, instead of reading them from
+     *  the pixmap the encoder was made with. This is how rows are supplied to encoders made
+     *  from just an SkImageInfo (e.g. SkJpegEncoder::Make(SkWStream*, const SkImageInfo&, ...)),
+     *  which never hold the whole image in memory.
+     *
+     *  |rows| must have the width, color type, alpha type and color space of the image. Its
+     *  pixels are only read during this call. If it has more rows than remain in the image,
+     *  this will encode all of the remaining rows.
+     */
+    bool encodeRows(const SkPixmap& rows);
+
+    /**
+     *  Encode all of the remaining rows by drawing them, |bandHeight| rows at a time, so that
+     *  only one band of pixels is ever in memory. |draw| is called once per band, with a canvas
+     *  in the coordinate space of the whole image and clipped to the band. Each band starts out
+     *  transparent. The edges of paths may rasterize slightly differently than they would if
+     *  the whole image were drawn at once.
+     */
+    bool encodeBands(int bandHeight, const std::function<void(SkCanvas*)>& draw);
+
     virtual ~SkEncoder() {}
 
 protected:
@@ -55,9 +79,22 @@ protected:
         , fStorage(storageBytes)
     {}
 
-    const SkPixmap&        fSrc;
+    /**
+     *  Returns row |y| of the image, from the rows passed to encodeRows(const SkPixmap&) while
+     *  it is encoding them, and from fSrc otherwise.
+     */
+    const void* srcRow(int y) const;
+
+    // Only the info of fSrc is used when rows are passed to encodeRows(const SkPixmap&), and
+    // encoders made from just an SkImageInfo have no pixels here at all.
+    const SkPixmap         fSrc;
     int                    fCurrRow;
     skia_private::AutoTMalloc<uint8_t> fStorage;
+    // The rows passed to encodeRows(const SkPixmap&), while it is encoding them.
+    SkPixmap               fRows;
+
+private:
+    int                    fRowsTop = 0;
 };
 
 #endif
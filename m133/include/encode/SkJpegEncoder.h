@@ -23,6 +23,7 @@ class SkWStream;
 class SkImage;
 class GrDirectContext;
 class SkYUVAPixmaps;
+struct SkImageInfo;
 struct skcms_ICCProfile;
 
 namespace SkJpegEncoder {
@@ -127,6 +128,20 @@ SK_API std::unique_ptr<SkEncoder> Make(SkWStream* dst,
                                        const SkYUVAPixmaps& src,
                                        const SkColorSpace* srcColorSpace,
                                        const Options& options);
+
+/**
+ *  Create a jpeg encoder for an image described by |info|, whose pixels are not available up
+ *  front. They must be passed to SkEncoder::encodeRows(const SkPixmap&) a band at a time, or
+ *  drawn with SkEncoder::encodeBands(), so the whole image never needs to be in memory.
+ *
+ *  |dst| is unowned but must remain valid for the lifetime of the object.
+ *
+ *  This returns nullptr on an invalid or unsupported |info|.
+ */
+SK_API std::unique_ptr<SkEncoder> Make(SkWStream* dst,
+                                       const SkImageInfo& info,
+                                       const Options& options);
+
 }  // namespace SkJpegEncoder
 
 #endif
@@ -19,11 +19,13 @@
 
 class GrDirectContext;
 class SkData;
+class SkExecutor;
 class SkImage;
 class SkPixmap;
 class SkWStream;
 struct skcms_ICCProfile;
 struct SkGainmapInfo;
+struct SkImageInfo;
 
 namespace SkPngEncoder {
 
@@ -94,6 +96,16 @@ struct Options {
      */
     const SkPixmap* fGainmap = nullptr;
     const SkGainmapInfo* fGainmapInfo = nullptr;
+
+    /**
+     *  If non-null, Encode() splits large images into stripes of rows, and filters and
+     *  compresses the stripes in parallel on this executor.  Each stripe is compressed
+     *  independently, so the result is typically slightly larger than a serial encode, and
+     *  its bytes differ, but it decodes to the same pixels.
+     *
+     *  The incremental encoder returned by Make() ignores this.
+     */
+    SkExecutor* fExecutor = nullptr;
 };
 
 /**
@@ -126,6 +138,19 @@ SK_API sk_sp<SkData> Encode(GrDirectContext* ctx, const SkImage* img, const Opti
  */
 SK_API std::unique_ptr<SkEncoder> Make(SkWStream* dst, const SkPixmap& src, const Options& options);
 
+/**
+ *  Create a png encoder for an image described by |info|, whose pixels are not available up
+ *  front. They must be passed to SkEncoder::encodeRows(const SkPixmap&) a band at a time, or
+ *  drawn with SkEncoder::encodeBands(), so the whole image never needs to be in memory.
+ *
+ *  |dst| is unowned but must remain valid for the lifetime of the object.
+ *
+ *  This returns nullptr on an invalid or unsupported |info|.
+ */
+SK_API std::unique_ptr<SkEncoder> Make(SkWStream* dst,
+                                       const SkImageInfo& info,
+                                       const Options& options);
+
 }  // namespace SkPngEncoder
 
 #endif
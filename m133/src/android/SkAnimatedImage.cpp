@@ -16,6 +16,7 @@
 #include "src/codec/SkCodecPriv.h"
 #include "src/codec/SkPixmapUtilsPriv.h"
 #include "src/core/SkImagePriv.h"
+#include "src/core/SkTaskGroup.h"
 
 #include <limits.h>
 #include <utility>
@@ -103,7 +104,9 @@ SkAnimatedImage::SkAnimatedImage(std::unique_ptr<SkAndroidCodec> codec,
     this->decodeNextFrame();
 }
 
-SkAnimatedImage::~SkAnimatedImage() { }
+SkAnimatedImage::~SkAnimatedImage() {
+    this->waitForLookAhead();
+}
 
 SkRect SkAnimatedImage::onGetBounds() {
     return SkRect::MakeIWH(fCropRect.width(), fCropRect.height());
@@ -151,6 +154,7 @@ bool SkAnimatedImage::Frame::copyTo(Frame* dst) const {
 }
 
 void SkAnimatedImage::reset() {
+    this->waitForLookAhead();
     fFinished = false;
     fRepetitionsCompleted = 0;
     if (fDisplayFrame.fIndex != 0) {
@@ -191,6 +195,7 @@ int SkAnimatedImage::decodeNextFrame() {
     if (fFinished) {
         return kFinished;
     }
+    this->waitForLookAhead();
 
     bool animationEnded = false;
     const int frameToDecode = this->computeNextFrame(fDisplayFrame.fIndex, &animationEnded);
@@ -232,13 +237,42 @@ int SkAnimatedImage::decodeNextFrame() {
         if (frameToDecode == frame->fIndex) {
             using std::swap;
             swap(fDisplayFrame, *frame);
-            if (animationEnded) {
-                return this->finish();
-            }
-            return fCurrentFrameDuration;
+            return this->onFrameShown(animationEnded);
+        }
+    }
+
+    if (frameToDecode < (int) fFrameCache.size() &&
+            fFrameCache[frameToDecode].fIndex == frameToDecode) {
+        // Keep the frame being replaced around, in case it's needed to decode a later one.
+        using std::swap;
+        swap(fDisplayFrame, fDecodingFrame);
+        fDisplayFrame = fFrameCache[frameToDecode];
+        return this->onFrameShown(animationEnded);
+    }
+
+    if (!this->decodeFrame(frameToDecode, frameInfo)) {
+        return this->finish();
+    }
+
+    using std::swap;
+    swap(fDecodingFrame, fDisplayFrame);
+
+    if (!animationEnded && fCodec->getEncodedFormat() == SkEncodedImageFormat::kHEIF) {
+        // HEIF doesn't know the frame duration until after decoding. Update to
+        // the correct value. Note that earlier returns in this method either
+        // return kFinished, or fCurrentFrameDuration. If they return the
+        // latter, it is a frame that was previously decoded, so it has the
+        // updated value.
+        if (fCodec->codec()->getFrameInfo(frameToDecode, &frameInfo)) {
+            fCurrentFrameDuration = frameInfo.fDuration;
+        } else {
+            SkCodecPrintf("Failed to getFrameInfo on second attempt (HEIF)");
         }
     }
+    return this->onFrameShown(animationEnded);
+}
 
+bool SkAnimatedImage::decodeFrame(int frameToDecode, const SkCodec::FrameInfo& frameInfo) {
     // The following code makes an effort to avoid overwriting a frame that will
     // be used again. If frame |i| is_restore_previous, frame |i+1| will not
     // depend on frame |i|, so do not overwrite frame |i-1|, which may be needed
@@ -278,7 +312,7 @@ int SkAnimatedImage::decodeNextFrame() {
         } else if (validPriorFrame(fDisplayFrame)) {
             if (!fDisplayFrame.copyTo(&fDecodingFrame)) {
                 SkCodecPrintf("Failed to allocate pixels for frame\n");
-                return this->finish();
+                return false;
             }
             options.fPriorFrame = fDecodingFrame.fIndex;
         } else if (validPriorFrame(fRestoreFrame)) {
@@ -287,7 +321,7 @@ int SkAnimatedImage::decodeNextFrame() {
                 swap(fDecodingFrame, fRestoreFrame);
             } else if (!fRestoreFrame.copyTo(&fDecodingFrame)) {
                 SkCodecPrintf("Failed to restore frame\n");
-                return this->finish();
+                return false;
             }
             options.fPriorFrame = fDecodingFrame.fIndex;
         }
@@ -297,8 +331,10 @@ int SkAnimatedImage::decodeNextFrame() {
                      kOpaque_SkAlphaType : kPremul_SkAlphaType;
     auto info = fDecodeInfo.makeAlphaType(alphaType);
     SkBitmap* dst = &fDecodingFrame.fBitmap;
+    // From here on, fDecodingFrame's pixels may no longer match its fIndex.
+    fDecodingFrame.fIndex = SkCodec::kNoFrame;
     if (!fDecodingFrame.init(info, Frame::OnInit::kRestoreIfNecessary)) {
-        return this->finish();
+        return false;
     }
 
     auto result = fCodec->getAndroidPixels(dst->info(), dst->getPixels(), dst->rowBytes(),
@@ -306,33 +342,100 @@ int SkAnimatedImage::decodeNextFrame() {
     if (result != SkCodec::kSuccess) {
         SkCodecPrintf("%s, frame %i of %i\n", SkCodec::ResultToString(result),
                       frameToDecode, fFrameCount);
-        return this->finish();
+        return false;
     }
 
     fDecodingFrame.fIndex = frameToDecode;
     fDecodingFrame.fDisposalMethod = frameInfo.fDisposalMethod;
+    dst->notifyPixelsChanged();
+    return true;
+}
 
-    using std::swap;
-    swap(fDecodingFrame, fDisplayFrame);
-    fDisplayFrame.fBitmap.notifyPixelsChanged();
-
+int SkAnimatedImage::onFrameShown(bool animationEnded) {
+    this->cacheDisplayFrame();
     if (animationEnded) {
         return this->finish();
-    } else if (fCodec->getEncodedFormat() == SkEncodedImageFormat::kHEIF) {
-        // HEIF doesn't know the frame duration until after decoding. Update to
-        // the correct value. Note that earlier returns in this method either
-        // return kFinished, or fCurrentFrameDuration. If they return the
-        // latter, it is a frame that was previously decoded, so it has the
-        // updated value.
-        if (fCodec->codec()->getFrameInfo(frameToDecode, &frameInfo)) {
-            fCurrentFrameDuration = frameInfo.fDuration;
-        } else {
-            SkCodecPrintf("Failed to getFrameInfo on second attempt (HEIF)");
-        }
     }
+    this->startLookAhead();
     return fCurrentFrameDuration;
 }
 
+void SkAnimatedImage::setFrameCacheBudget(size_t bytes) {
+    fFrameCacheBudget = bytes;
+    for (int i = (int) fFrameCache.size() - 1; i >= 0 && fFrameCacheBytes > bytes; i--) {
+        if (fFrameCache[i].fIndex != SkCodec::kNoFrame) {
+            fFrameCacheBytes -= fFrameCache[i].fBitmap.computeByteSize();
+            fFrameCache[i] = Frame();
+        }
+    }
+    if (0 == bytes) {
+        fFrameCache.clear();
+    }
+    this->cacheDisplayFrame();
+}
+
+void SkAnimatedImage::cacheDisplayFrame() {
+    const int index = fDisplayFrame.fIndex;
+    if (0 == fFrameCacheBudget || index < 0 || index >= fFrameCount) {
+        return;
+    }
+    if (fFrameCache.empty()) {
+        fFrameCache.resize(fFrameCount);
+    }
+    if (fFrameCache[index].fIndex == index) {
+        return;
+    }
+
+    // The cache shares the frame's pixels. Frame::init copies them before they are decoded
+    // over.
+    const size_t bytes = fDisplayFrame.fBitmap.computeByteSize();
+    if (fFrameCacheBytes + bytes <= fFrameCacheBudget) {
+        fFrameCache[index] = fDisplayFrame;
+        fFrameCacheBytes += bytes;
+    }
+}
+
+void SkAnimatedImage::setExecutor(SkExecutor* executor) {
+    this->waitForLookAhead();
+    fLookAhead.reset();
+    fExecutor = executor;
+    if (!fFinished) {
+        this->startLookAhead();
+    }
+}
+
+void SkAnimatedImage::startLookAhead() {
+    if (!fExecutor || fFrameCount < 2 || fDisplayFrame.fIndex == SkCodec::kNoFrame) {
+        return;
+    }
+
+    // The frame decodeNextFrame() will look for, unless the animation ends first.
+    const int nextFrame = (fDisplayFrame.fIndex + 1) % fFrameCount;
+    if (nextFrame == fDecodingFrame.fIndex || nextFrame == fRestoreFrame.fIndex ||
+            (nextFrame < (int) fFrameCache.size() &&
+             fFrameCache[nextFrame].fIndex == nextFrame)) {
+        return;
+    }
+    SkCodec::FrameInfo frameInfo;
+    if (!fCodec->codec()->getFrameInfo(nextFrame, &frameInfo) || !frameInfo.fFullyReceived) {
+        return;
+    }
+
+    if (!fLookAhead) {
+        fLookAhead = std::make_unique<SkTaskGroup>(*fExecutor);
+    }
+    fLookAhead->add([this, nextFrame, frameInfo] {
+        // On failure, decodeNextFrame() tries again, and reports the error.
+        this->decodeFrame(nextFrame, frameInfo);
+    });
+}
+
+void SkAnimatedImage::waitForLookAhead() {
+    if (fLookAhead) {
+        fLookAhead->wait();
+    }
+}
+
 void SkAnimatedImage::onDraw(SkCanvas* canvas) {
     auto image = this->getCurrentFrameSimple();
 
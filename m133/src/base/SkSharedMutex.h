@@ -0,0 +1,89 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkSharedMutex_DEFINED
+#define SkSharedMutex_DEFINED
+
+#include "include/private/base/SkAssert.h"
+#include "include/private/base/SkDebug.h"
+#include "include/private/base/SkThreadAnnotations.h"
+#include "include/private/base/SkThreadID.h"
+
+#include <shared_mutex>
+
+// A mutex that many threads can hold shared at once, or one thread exclusively, annotated for
+// clang's thread safety analysis like SkMutex.
+class SK_CAPABILITY("mutex") SkSharedMutex {
+public:
+    SkSharedMutex() = default;
+
+    ~SkSharedMutex() {
+        this->assertNotHeld();
+    }
+
+    void acquire() SK_ACQUIRE() {
+        fMutex.lock();
+        SkDEBUGCODE(fOwner = SkGetThreadID();)
+    }
+
+    void release() SK_RELEASE_CAPABILITY() {
+        this->assertHeld();
+        SkDEBUGCODE(fOwner = kIllegalThreadID;)
+        fMutex.unlock();
+    }
+
+    void acquireShared() SK_ACQUIRE_SHARED() {
+        fMutex.lock_shared();
+    }
+
+    void releaseShared() SK_RELEASE_SHARED_CAPABILITY() {
+        fMutex.unlock_shared();
+    }
+
+    // Only exclusive ownership is tracked.
+    void assertHeld() SK_ASSERT_CAPABILITY(this) {
+        SkASSERT(fOwner == SkGetThreadID());
+    }
+
+    void assertNotHeld() {
+        SkASSERT(fOwner == kIllegalThreadID);
+    }
+
+private:
+    std::shared_mutex fMutex;
+    SkDEBUGCODE(SkThreadID fOwner{kIllegalThreadID};)
+};
+
+class SK_SCOPED_CAPABILITY SkAutoSharedMutexExclusive {
+public:
+    SkAutoSharedMutexExclusive(SkSharedMutex& mutex) SK_ACQUIRE(mutex) : fMutex(mutex) {
+        fMutex.acquire();
+    }
+    ~SkAutoSharedMutexExclusive() SK_RELEASE_CAPABILITY() { fMutex.release(); }
+
+    SkAutoSharedMutexExclusive(const SkAutoSharedMutexExclusive&) = delete;
+    SkAutoSharedMutexExclusive& operator=(const SkAutoSharedMutexExclusive&) = delete;
+
+private:
+    SkSharedMutex& fMutex;
+};
+
+class SK_SCOPED_CAPABILITY SkAutoSharedMutexShared {
+public:
+    SkAutoSharedMutexShared(SkSharedMutex& mutex) SK_ACQUIRE_SHARED(mutex) : fMutex(mutex) {
+        fMutex.acquireShared();
+    }
+    ~SkAutoSharedMutexShared() SK_RELEASE_CAPABILITY() { fMutex.releaseShared(); }
+
+    SkAutoSharedMutexShared(const SkAutoSharedMutexShared&) = delete;
+    SkAutoSharedMutexShared& operator=(const SkAutoSharedMutexShared&) = delete;
+
+private:
+    SkSharedMutex& fMutex;
+};
+
+#endif  // SkSharedMutex_DEFINED
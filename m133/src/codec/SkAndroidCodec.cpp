@@ -12,17 +12,23 @@
 #include "include/core/SkAlphaType.h"
 #include "include/core/SkColorType.h"
 #include "include/core/SkData.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkPixmap.h"
+#include "include/core/SkSamplingOptions.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkStream.h"
 #include "modules/skcms/skcms.h"
+#include "src/base/SkVx.h"
 #include "src/codec/SkAndroidCodecAdapter.h"
 #include "src/codec/SkCodecPriv.h"
 #include "src/codec/SkSampledCodec.h"
+#include "src/core/SkAutoPixmapStorage.h"
 
 #include <algorithm>
 #include <cstdint>
 #include <functional>
 #include <utility>
+#include <vector>
 
 class SkPngChunkReader;
 
@@ -541,6 +547,105 @@ SkCodec::Result SkAndroidCodec::getAndroidPixels(const SkImageInfo& info, void*
     return this->getAndroidPixels(info, pixels, rowBytes, nullptr);
 }
 
+namespace {
+// For each destination pixel along one axis, the source pixels it covers, each weighted by how
+// much of it is covered. The weights of a destination pixel sum to 1.
+struct BoxTaps {
+    BoxTaps(int srcSize, int dstSize) : fFirst(dstSize + 1) {
+        const double scale = (double) srcSize / dstSize;
+        for (int d = 0; d < dstSize; d++) {
+            const double lo = d * scale,
+                         hi = std::min((d + 1) * scale, (double) srcSize);
+            fFirst[d] = (int) fSrc.size();
+            for (int s = (int) lo; s < hi; s++) {
+                fSrc.push_back(s);
+                fWeight.push_back((float) ((std::min(s + 1.0, hi) - std::max((double) s, lo))
+                                           / scale));
+            }
+        }
+        fFirst[dstSize] = (int) fSrc.size();
+    }
+
+    // Taps for destination pixel d are [fFirst[d], fFirst[d + 1]).
+    std::vector<int>   fFirst;
+    std::vector<int>   fSrc;
+    std::vector<float> fWeight;
+};
+}  // namespace
+
+// Averages each 4 byte (8888, premul or opaque) pixel of dst over the area of src it covers.
+// Channel order doesn't matter. Each dst row sums the src rows it covers into a row of floats,
+// then sums across that row.
+static void box_filter_8888(const SkPixmap& src, const SkPixmap& dst) {
+    const BoxTaps xTaps(src.width(), dst.width()),
+                  yTaps(src.height(), dst.height());
+    std::vector<skvx::float4> row(src.width());
+    for (int dy = 0; dy < dst.height(); dy++) {
+        std::fill(row.begin(), row.end(), skvx::float4(0));
+        for (int t = yTaps.fFirst[dy]; t < yTaps.fFirst[dy + 1]; t++) {
+            const uint32_t* srcRow = src.addr32(0, yTaps.fSrc[t]);
+            const float w = yTaps.fWeight[t];
+            for (int x = 0; x < src.width(); x++) {
+                row[x] += w * skvx::cast<float>(skvx::byte4::Load(srcRow + x));
+            }
+        }
+
+        uint32_t* dstRow = dst.writable_addr32(0, dy);
+        for (int dx = 0; dx < dst.width(); dx++) {
+            skvx::float4 sum(0);
+            for (int t = xTaps.fFirst[dx]; t < xTaps.fFirst[dx + 1]; t++) {
+                sum += xTaps.fWeight[t] * row[xTaps.fSrc[t]];
+            }
+            skvx::cast<uint8_t>(skvx::pin(sum + 0.5f, skvx::float4(0), skvx::float4(255)))
+                    .store(dstRow + dx);
+        }
+    }
+}
+
+SkCodec::Result SkAndroidCodec::getPixelsAtSize(const SkImageInfo& info, void* pixels,
+                                                size_t rowBytes) {
+    if (!pixels || rowBytes < info.minRowBytes() || info.isEmpty() ||
+            smaller_than(fCodec->dimensions(), info.dimensions())) {
+        return SkCodec::kInvalidParameters;
+    }
+
+    // The smallest native scale that still covers the requested size. Codecs that can't scale
+    // report their full size for every scale.
+    SkISize nativeSize = fCodec->dimensions();
+    for (int num = 1; num < 8; num++) {
+        const SkISize scaled = fCodec->getScaledDimensions(num / 8.0f);
+        if (!smaller_than(scaled, info.dimensions())) {
+            nativeSize = scaled;
+            break;
+        }
+    }
+    // getAndroidPixels() decodes any size the codec supports natively, and handles rewinding.
+    if (nativeSize == info.dimensions()) {
+        return this->getAndroidPixels(info, pixels, rowBytes);
+    }
+
+    SkAutoPixmapStorage native;
+    if (!native.tryAlloc(info.makeDimensions(nativeSize))) {
+        return SkCodec::kInternalError;
+    }
+    const SkCodec::Result result =
+            this->getAndroidPixels(native.info(), native.writable_addr(), native.rowBytes());
+    if (result != SkCodec::kSuccess && result != SkCodec::kIncompleteInput &&
+            result != SkCodec::kErrorInInput) {
+        return result;
+    }
+
+    const SkPixmap dst(info, pixels, rowBytes);
+    if ((info.colorType() == kRGBA_8888_SkColorType ||
+         info.colorType() == kBGRA_8888_SkColorType) &&
+            info.alphaType() != kUnpremul_SkAlphaType) {
+        box_filter_8888(native, dst);
+    } else if (!native.scalePixels(dst, SkSamplingOptions(SkFilterMode::kLinear))) {
+        return SkCodec::kInvalidConversion;
+    }
+    return result;
+}
+
 bool SkAndroidCodec::getGainmapAndroidCodec(SkGainmapInfo* info,
                                             std::unique_ptr<SkAndroidCodec>* outCodec) {
     if (outCodec) {
@@ -262,6 +262,22 @@ std::unique_ptr<SkCodec> SkCodec::MakeFromData(sk_sp<SkData> data,
     return MakeFromStream(SkMemoryStream::Make(std::move(data)), decoders, nullptr, reader);
 }
 
+std::unique_ptr<SkCodec> SkCodec::MakeFromFD(int fd,
+                                             SkSpan<const SkCodecs::Decoder> decoders,
+                                             Result* outResult,
+                                             SkPngChunkReader* reader) {
+    sk_sp<SkData> data = SkData::MakeFromFD(fd);
+    if (!data) {
+        if (outResult) {
+            *outResult = kInvalidInput;
+        }
+        return nullptr;
+    }
+    // SkMemoryStream exposes the mapping through getMemoryBase(), which the codecs use to read
+    // it in place.
+    return MakeFromStream(SkMemoryStream::Make(std::move(data)), decoders, outResult, reader);
+}
+
 SkCodec::SkCodec(SkEncodedInfo&& info,
                  XformFormat srcFormat,
                  std::unique_ptr<SkStream> stream,
@@ -20,23 +20,29 @@
 #include "include/core/SkYUVAInfo.h"
 #include "include/private/base/SkAlign.h"
 #include "include/private/base/SkTemplates.h"
+#include "include/private/base/SkTo.h"
 #include "modules/skcms/skcms.h"
 #include "src/codec/SkCodecPriv.h"
 #include "src/codec/SkJpegConstants.h"
 #include "src/codec/SkJpegDecoderMgr.h"
 #include "src/codec/SkJpegMetadataDecoderImpl.h"
 #include "src/codec/SkJpegPriv.h"
+#include "src/codec/SkJpegSegmentScan.h"
 #include "src/codec/SkParseEncodedOrigin.h"
 #include "src/codec/SkSwizzler.h"
+#include "src/core/SkTaskGroup.h"
 
 #ifdef SK_CODEC_DECODES_JPEG_GAINMAPS
 #include "include/private/SkGainmapInfo.h"
 #endif  // SK_CODEC_DECODES_JPEG_GAINMAPS
 
+#include <algorithm>
 #include <array>
 #include <csetjmp>
 #include <cstring>
+#include <numeric>
 #include <utility>
+#include <vector>
 
 using namespace skia_private;
 
@@ -489,6 +495,223 @@ static inline bool needs_swizzler_to_convert_from_cmyk(J_COLOR_SPACE jpegColorTy
     return !hasCMYKColorSpace || !hasColorSpaceXform;
 }
 
+namespace {
+
+// The layout of the single scan of a sequential jpeg that uses restart intervals.
+struct RestartScan {
+    int fMcuHeight = 0;
+    int fMcusPerRow = 0;
+    int fMcuRows = 0;
+    // The number of MCUs in each restart interval.
+    int fRestartInterval = 0;
+    // Whether upsampling a row of a chroma plane reads the rows above and below it, which may
+    // belong to neighboring rows of MCUs.
+    bool fNeedsContextRows = false;
+    size_t fStartOfFrameOffset = 0;
+    // The first byte of entropy-coded data, just past the StartOfScan segment.
+    size_t fScanDataOffset = 0;
+    size_t fEndOfImageOffset = 0;
+    std::vector<size_t> fRestartMarkerOffsets;
+};
+
+}  // namespace
+
+static uint16_t read_be16(const uint8_t* data) { return (data[0] << 8) | data[1]; }
+
+// Finds the restart markers in a baseline or extended sequential jpeg with a single, interleaved
+// scan. Returns false for anything else.
+static bool find_restart_scan(const uint8_t* data, size_t size, RestartScan* scan) {
+    SkJpegSegmentScanner scanner(kJpegMarkerEndOfImage);
+    scanner.onBytes(data, size);
+    if (!scanner.isDone()) {
+        return false;
+    }
+
+    int componentCount = 0, maxH = 0, maxV = 0;
+    bool seenStartOfFrame = false, seenStartOfScan = false;
+    for (const SkJpegSegment& segment : scanner.getSegments()) {
+        const uint8_t* params = data + segment.offset + kJpegMarkerCodeSize;
+        const uint8_t marker = segment.marker;
+        if (seenStartOfScan) {
+            if (marker >= kJpegMarkerRestart0 && marker <= kJpegMarkerRestart7) {
+                scan->fRestartMarkerOffsets.push_back(segment.offset);
+            } else if (marker == kJpegMarkerEndOfImage) {
+                scan->fEndOfImageOffset = segment.offset;
+            } else {
+                // A second scan, or some other marker within the scan.
+                return false;
+            }
+        } else if (marker == kJpegMarkerStartOfFrame0 || marker == kJpegMarkerStartOfFrame1) {
+            // Parameters are length, precision, height, width, the number of components, and
+            // then three bytes per component.
+            if (seenStartOfFrame || segment.parameterLength < 8) {
+                return false;
+            }
+            componentCount = params[7];
+            if (componentCount == 0 || segment.parameterLength != 8 + 3 * componentCount) {
+                return false;
+            }
+            const int height = read_be16(params + 3),
+                      width = read_be16(params + 5);
+            if (height == 0 || width == 0) {
+                // The height is given by a DefineNumberOfLines marker after the first scan.
+                return false;
+            }
+            int minV = 4;
+            for (int i = 0; i < componentCount; i++) {
+                const int h = params[9 + 3 * i] >> 4,
+                          v = params[9 + 3 * i] & 0xF;
+                if (h < 1 || h > 4 || v < 1 || v > 4) {
+                    return false;
+                }
+                maxH = std::max(maxH, h);
+                maxV = std::max(maxV, v);
+                minV = std::min(minV, v);
+            }
+            // A single component scan is made of individual 8x8 blocks, whatever the sampling.
+            const int mcuWidth = componentCount == 1 ? 8 : 8 * maxH;
+            scan->fMcuHeight = componentCount == 1 ? 8 : 8 * maxV;
+            scan->fMcusPerRow = (width + mcuWidth - 1) / mcuWidth;
+            scan->fMcuRows = (height + scan->fMcuHeight - 1) / scan->fMcuHeight;
+            scan->fNeedsContextRows = componentCount > 1 && minV < maxV;
+            scan->fStartOfFrameOffset = segment.offset;
+            seenStartOfFrame = true;
+        } else if (marker > kJpegMarkerStartOfFrame1 && marker <= 0xCF && marker != 0xC4 &&
+                   marker != 0xC8 && marker != 0xCC) {
+            // Progressive, lossless, hierarchical or arithmetic coded.
+            return false;
+        } else if (marker == kJpegMarkerDefineRestartInterval) {
+            if (segment.parameterLength != 4) {
+                return false;
+            }
+            scan->fRestartInterval = read_be16(params + 2);
+        } else if (marker == kJpegMarkerStartOfScan) {
+            // Only an interleaved scan of every component covers whole rows of MCUs at once.
+            if (!seenStartOfFrame || segment.parameterLength < 3 ||
+                params[2] != componentCount) {
+                return false;
+            }
+            scan->fScanDataOffset = segment.offset + kJpegMarkerCodeSize + segment.parameterLength;
+            seenStartOfScan = true;
+        }
+    }
+    if (!seenStartOfScan || scan->fRestartInterval == 0 || scan->fEndOfImageOffset == 0) {
+        return false;
+    }
+
+    // Every restart interval but the first starts right after a marker.
+    const int64_t mcuCount = (int64_t)scan->fMcusPerRow * scan->fMcuRows;
+    const int64_t intervalCount = (mcuCount + scan->fRestartInterval - 1) / scan->fRestartInterval;
+    return (int64_t)scan->fRestartMarkerOffsets.size() == intervalCount - 1;
+}
+
+// Decoding a band of rows needs rows of MCUs that start on a restart interval. Bands also start
+// and end within a few rows of MCUs, so this doesn't bother with images that are small enough to
+// be decoded quickly anyway.
+static constexpr int kMinRowsPerBand = 256;
+
+bool SkJpegCodec::decodeRestartIntervalsInParallel(const SkImageInfo& dstInfo, void* dst,
+                                                   size_t rowBytes, const Options& options) {
+    SkASSERT(options.fExecutor && !options.fSubset);
+    if (dstInfo.dimensions() != this->dimensions()) {
+        // Scaled decodes go through libjpeg-turbo's DCT scaling, serially.
+        return false;
+    }
+    const uint8_t* data = static_cast<const uint8_t*>(this->stream()->getMemoryBase());
+    if (!data || !this->stream()->hasLength()) {
+        return false;
+    }
+
+    RestartScan scan;
+    if (!find_restart_scan(data, this->stream()->getLength(), &scan)) {
+        return false;
+    }
+
+    // Rows of MCUs that start on a restart interval come every |period| rows.
+    const int period = scan.fRestartInterval / std::gcd(scan.fRestartInterval, scan.fMcusPerRow);
+    // Bands that need context rows also decode a period of rows above and below themselves, so
+    // keep those bands large enough that this overlap is cheap.
+    int mcuRowsPerBand = std::max((kMinRowsPerBand + scan.fMcuHeight - 1) / scan.fMcuHeight,
+                                  scan.fNeedsContextRows ? 4 * period : period);
+    mcuRowsPerBand = (mcuRowsPerBand + period - 1) / period * period;
+    const int bandCount = (scan.fMcuRows + mcuRowsPerBand - 1) / mcuRowsPerBand;
+    if (bandCount < 2) {
+        return false;
+    }
+    const int contextMcuRows = scan.fNeedsContextRows ? period : 0;
+    const int height = dstInfo.height();
+
+    std::vector<char> succeeded(bandCount, false);
+    SkTaskGroup(*options.fExecutor).batch(bandCount, [&](int band) {
+        const int firstMcuRow = band * mcuRowsPerBand,
+                  endMcuRow = std::min(scan.fMcuRows, firstMcuRow + mcuRowsPerBand),
+                  decodeFirstMcuRow = std::max(0, firstMcuRow - contextMcuRows),
+                  decodeEndMcuRow = std::min(scan.fMcuRows, endMcuRow + contextMcuRows);
+        const int decodeTop = decodeFirstMcuRow * scan.fMcuHeight,
+                  decodeBottom = std::min(height, decodeEndMcuRow * scan.fMcuHeight),
+                  top = firstMcuRow * scan.fMcuHeight,
+                  bottom = std::min(height, endMcuRow * scan.fMcuHeight);
+
+        // The band is a jpeg of its own: the original headers, with the height of the band,
+        // followed by its restart intervals, renumbered from zero, and an EndOfImage marker.
+        const int firstInterval =
+                decodeFirstMcuRow * scan.fMcusPerRow / scan.fRestartInterval;
+        const int endInterval = decodeEndMcuRow == scan.fMcuRows
+                ? SkToInt(scan.fRestartMarkerOffsets.size()) + 1
+                : decodeEndMcuRow * scan.fMcusPerRow / scan.fRestartInterval;
+        const size_t start = firstInterval == 0
+                ? scan.fScanDataOffset
+                : scan.fRestartMarkerOffsets[firstInterval - 1] + kJpegMarkerCodeSize;
+        const size_t end = endInterval == SkToInt(scan.fRestartMarkerOffsets.size()) + 1
+                ? scan.fEndOfImageOffset
+                : scan.fRestartMarkerOffsets[endInterval - 1];
+
+        const size_t headerSize = scan.fScanDataOffset;
+        sk_sp<SkData> bandData =
+                SkData::MakeUninitialized(headerSize + (end - start) + kJpegMarkerCodeSize);
+        uint8_t* bytes = static_cast<uint8_t*>(bandData->writable_data());
+        memcpy(bytes, data, headerSize);
+        uint8_t* heightBytes = bytes + scan.fStartOfFrameOffset + kJpegMarkerCodeSize + 3;
+        heightBytes[0] = (decodeBottom - decodeTop) >> 8;
+        heightBytes[1] = (decodeBottom - decodeTop) & 0xFF;
+        memcpy(bytes + headerSize, data + start, end - start);
+        for (int i = firstInterval; i < endInterval - 1; i++) {
+            size_t offset = headerSize + scan.fRestartMarkerOffsets[i] - start;
+            bytes[offset + 1] = kJpegMarkerRestart0 + (i - firstInterval) % 8;
+        }
+        bytes[bandData->size() - 2] = 0xFF;
+        bytes[bandData->size() - 1] = kJpegMarkerEndOfImage;
+
+        // Use our color profile even if it didn't come from the headers.
+        std::unique_ptr<SkEncodedInfo::ICCProfile> profile;
+        if (const skcms_ICCProfile* p = this->getEncodedInfo().profile()) {
+            profile = SkEncodedInfo::ICCProfile::Make(*p);
+        }
+        Result result;
+        std::unique_ptr<SkCodec> codec = MakeFromStream(
+                SkMemoryStream::Make(std::move(bandData)), &result, std::move(profile));
+        if (!codec) {
+            return;
+        }
+        const SkImageInfo bandInfo = dstInfo.makeWH(dstInfo.width(), decodeBottom - decodeTop);
+        Options bandOptions = options;
+        bandOptions.fExecutor = nullptr;
+        if (codec->startScanlineDecode(bandInfo, &bandOptions) != kSuccess) {
+            return;
+        }
+        // Decode, rather than skip, the rows above the band, since they're the context for its
+        // first row.
+        AutoTMalloc<uint8_t> contextRow(bandInfo.minRowBytes());
+        if (codec->getScanlines(contextRow.get(), top - decodeTop, 0) != top - decodeTop) {
+            return;
+        }
+        void* bandDst = SkTAddOffset<void>(dst, rowBytes * top);
+        succeeded[band] = codec->getScanlines(bandDst, bottom - top, rowBytes) == bottom - top;
+    });
+
+    return std::all_of(succeeded.begin(), succeeded.end(), [](char s) { return s; });
+}
+
 /*
  * Performs the jpeg decode
  */
@@ -501,6 +724,11 @@ SkCodec::Result SkJpegCodec::onGetPixels(const SkImageInfo& dstInfo,
         return kUnimplemented;
     }
 
+    if (options.fExecutor &&
+        this->decodeRestartIntervalsInParallel(dstInfo, dst, dstRowBytes, options)) {
+        return kSuccess;
+    }
+
     // Get a pointer to the decompress info since we will use it quite frequently
     jpeg_decompress_struct* dinfo = fDecoderMgr->dinfo();
 
@@ -546,6 +774,9 @@ SkCodec::Result SkJpegCodec::onGetPixels(const SkImageInfo& dstInfo,
         }
         if (res == JPEG_SCAN_COMPLETED) {
            last_scan_completed = dinfo->input_scan_number;
+           if (options.fProgressivePreview) {
+               break;
+           }
         }
       }
       if (last_scan_completed >  0) {
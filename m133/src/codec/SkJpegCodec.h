@@ -135,6 +135,15 @@ private:
     Result readRows(const SkImageInfo& dstInfo, void* dst, size_t rowBytes, int count,
                   const Options&, int* rowsDecoded);
 
+    /*
+     * If the image is a baseline jpeg with restart markers, splits the scan at the markers into
+     * bands of rows and decodes the bands concurrently on options.fExecutor.
+     * Returns false, without having decoded anything useful, if the image can't be decoded this
+     * way, in which case the caller should decode serially.
+     */
+    bool decodeRestartIntervalsInParallel(const SkImageInfo& dstInfo, void* dst,
+                                          size_t rowBytes, const Options& options);
+
     /*
      * Scanline decoding.
      */
@@ -20,6 +20,19 @@ static constexpr uint8_t kJpegMarkerEndOfImage = 0xD9;
 // The header of a JPEG file is the data in all segments before the first StartOfScan.
 static constexpr uint8_t kJpegMarkerStartOfScan = 0xDA;
 
+// Baseline and extended sequential, Huffman coded, images start with StartOfFrame0 and
+// StartOfFrame1 respectively. Markers 0xC2 through 0xCF, other than 0xC4, 0xC8 and 0xCC, start
+// other kinds of frames.
+static constexpr uint8_t kJpegMarkerStartOfFrame0 = 0xC0;
+static constexpr uint8_t kJpegMarkerStartOfFrame1 = 0xC1;
+
+// Entropy-coded data may be split into restart intervals, of the number of MCUs given by the
+// DefineRestartInterval segment. The intervals are separated by the markers Restart0 through
+// Restart7, in turn.
+static constexpr uint8_t kJpegMarkerDefineRestartInterval = 0xDD;
+static constexpr uint8_t kJpegMarkerRestart0 = 0xD0;
+static constexpr uint8_t kJpegMarkerRestart7 = 0xD7;
+
 // Metadata and auxiliary images are stored in the APP1 through APP15 markers.
 static constexpr uint8_t kJpegMarkerAPP0 = 0xE0;
 
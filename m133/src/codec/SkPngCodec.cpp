@@ -145,10 +145,24 @@ static inline bool is_chunk(const png_byte* chunk, const char* tag) {
 
 static inline bool process_data(png_structp png_ptr, png_infop info_ptr,
         SkStream* stream, void* buffer, size_t bufferSize, size_t length) {
+    // If the stream is already in memory (e.g. a mapped file), hand libpng the bytes in place
+    // instead of copying them into |buffer|. libpng only reads them. Either way, the stream is
+    // advanced before libpng sees the bytes, since a row callback may longjmp out of
+    // png_process_data().
+    const uint8_t* memoryBase = stream->hasPosition()
+            ? static_cast<const uint8_t*>(stream->getMemoryBase())
+            : nullptr;
     while (length > 0) {
         const size_t bytesToProcess = std::min(bufferSize, length);
-        const size_t bytesRead = stream->read(buffer, bytesToProcess);
-        png_process_data(png_ptr, info_ptr, (png_bytep) buffer, bytesRead);
+        png_bytep bytes = static_cast<png_bytep>(buffer);
+        size_t bytesRead;
+        if (memoryBase) {
+            bytes = const_cast<png_bytep>(memoryBase + stream->getPosition());
+            bytesRead = stream->skip(bytesToProcess);
+        } else {
+            bytesRead = stream->read(buffer, bytesToProcess);
+        }
+        png_process_data(png_ptr, info_ptr, bytes, bytesRead);
         if (bytesRead < bytesToProcess) {
             return false;
         }
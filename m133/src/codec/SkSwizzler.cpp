@@ -26,6 +26,7 @@
     #include "include/android/SkAndroidFrameworkUtils.h"
 #endif
 
+#include <algorithm>
 #include <cstring>
 
 static void copy(void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
@@ -270,6 +271,17 @@ static void swizzle_index_to_n32_skipZ(
     }
 }
 
+static void fast_swizzle_index_to_n32(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::index8_to_8888((uint32_t*) dst, src + offset, width, ctable);
+}
+
 static void swizzle_index_to_565(
       void* SK_RESTRICT dstRow, const uint8_t* SK_RESTRICT src, int dstWidth,
       int bytesPerPixel, int deltaSrc, int offset, const SkPMColor ctable[]) {
@@ -320,6 +332,17 @@ static void swizzle_gray_to_565(
     }
 }
 
+static void fast_swizzle_gray_to_565(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::gray_to_565((uint16_t*) dst, src + offset, width);
+}
+
 // kGrayAlpha
 
 static void swizzle_grayalpha_to_n32_unpremul(
@@ -457,6 +480,17 @@ static void swizzle_rgb_to_565(
     }
 }
 
+static void fast_swizzle_rgb_to_565(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc,
+        int offset, const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::RGB_to_565((uint16_t*) dst, src + offset, width);
+}
+
 // kRGBA
 
 static void swizzle_rgba_to_rgba_premul(
@@ -546,6 +580,17 @@ static void swizzle_rgb16_to_rgba(
     }
 }
 
+static void fast_swizzle_rgb16_to_rgba(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::RGB16_to_RGB1((uint32_t*) dst, src + offset, width);
+}
+
 static void swizzle_rgb16_to_bgra(
         void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
         const SkPMColor ctable[]) {
@@ -561,6 +606,17 @@ static void swizzle_rgb16_to_bgra(
     }
 }
 
+static void fast_swizzle_rgb16_to_bgra(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::RGB16_to_BGR1((uint32_t*) dst, src + offset, width);
+}
+
 static void swizzle_rgb16_to_565(
         void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
         const SkPMColor ctable[]) {
@@ -591,6 +647,17 @@ static void swizzle_rgba16_to_rgba_unpremul(
     }
 }
 
+static void fast_swizzle_rgba16_to_rgba_unpremul(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::RGBA16_to_RGBA((uint32_t*) dst, src + offset, width);
+}
+
 static void swizzle_rgba16_to_rgba_premul(
         void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
         const SkPMColor ctable[]) {
@@ -606,6 +673,17 @@ static void swizzle_rgba16_to_rgba_premul(
     }
 }
 
+static void fast_swizzle_rgba16_to_rgba_premul(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::RGBA16_to_rgbA((uint32_t*) dst, src + offset, width);
+}
+
 static void swizzle_rgba16_to_bgra_unpremul(
         void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
         const SkPMColor ctable[]) {
@@ -621,6 +699,17 @@ static void swizzle_rgba16_to_bgra_unpremul(
     }
 }
 
+static void fast_swizzle_rgba16_to_bgra_unpremul(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::RGBA16_to_BGRA((uint32_t*) dst, src + offset, width);
+}
+
 static void swizzle_rgba16_to_bgra_premul(
         void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
         const SkPMColor ctable[]) {
@@ -636,6 +725,17 @@ static void swizzle_rgba16_to_bgra_premul(
     }
 }
 
+static void fast_swizzle_rgba16_to_bgra_premul(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::RGBA16_to_bgrA((uint32_t*) dst, src + offset, width);
+}
+
 // kCMYK
 //
 // CMYK is stored as four bytes per pixel.
@@ -751,6 +851,29 @@ static void swizzle_cmyk_to_565(
     }
 }
 
+template <int kBPP>
+static void gather_samples(uint8_t* dst, const uint8_t* src, int count, int deltaSrc) {
+    for (int x = 0; x < count; x++) {
+        memcpy(dst, src, kBPP);
+        dst += kBPP;
+        src += deltaSrc;
+    }
+}
+
+// Copies every sampled pixel of a row next to each other, so an optimized RowProc can convert
+// them as if we were not sampling.
+static void gather_samples(uint8_t* dst, const uint8_t* src, int count, int bpp, int deltaSrc) {
+    switch (bpp) {
+        case 1: gather_samples<1>(dst, src, count, deltaSrc); break;
+        case 2: gather_samples<2>(dst, src, count, deltaSrc); break;
+        case 3: gather_samples<3>(dst, src, count, deltaSrc); break;
+        case 4: gather_samples<4>(dst, src, count, deltaSrc); break;
+        case 6: gather_samples<6>(dst, src, count, deltaSrc); break;
+        case 8: gather_samples<8>(dst, src, count, deltaSrc); break;
+        default: SkUNREACHABLE;
+    }
+}
+
 template <SkSwizzler::RowProc proc>
 void SkSwizzler::SkipLeadingGrayAlphaZerosThen(
         void* dst, const uint8_t* src, int width,
@@ -876,6 +999,7 @@ std::unique_ptr<SkSwizzler> SkSwizzler::Make(const SkEncodedInfo& encodedInfo,
                             break;
                         case kRGB_565_SkColorType:
                             proc = &swizzle_gray_to_565;
+                            fastProc = &fast_swizzle_gray_to_565;
                             break;
                         default:
                             return nullptr;
@@ -947,6 +1071,7 @@ std::unique_ptr<SkSwizzler> SkSwizzler::Make(const SkEncodedInfo& encodedInfo,
                                 proc = &swizzle_index_to_n32_skipZ;
                             } else {
                                 proc = &swizzle_index_to_n32;
+                                fastProc = &fast_swizzle_index_to_n32;
                             }
                             break;
                         case kRGB_565_SkColorType:
@@ -969,6 +1094,7 @@ std::unique_ptr<SkSwizzler> SkSwizzler::Make(const SkEncodedInfo& encodedInfo,
                 case kRGBA_8888_SkColorType:
                     if (16 == encodedInfo.bitsPerComponent()) {
                         proc = &swizzle_rgb16_to_rgba;
+                        fastProc = &fast_swizzle_rgb16_to_rgba;
                         break;
                     }
 
@@ -979,6 +1105,7 @@ std::unique_ptr<SkSwizzler> SkSwizzler::Make(const SkEncodedInfo& encodedInfo,
                 case kBGRA_8888_SkColorType:
                     if (16 == encodedInfo.bitsPerComponent()) {
                         proc = &swizzle_rgb16_to_bgra;
+                        fastProc = &fast_swizzle_rgb16_to_bgra;
                         break;
                     }
 
@@ -993,6 +1120,7 @@ std::unique_ptr<SkSwizzler> SkSwizzler::Make(const SkEncodedInfo& encodedInfo,
                     }
 
                     proc = &swizzle_rgb_to_565;
+                    fastProc = &fast_swizzle_rgb_to_565;
                     break;
                 default:
                     return nullptr;
@@ -1004,6 +1132,8 @@ std::unique_ptr<SkSwizzler> SkSwizzler::Make(const SkEncodedInfo& encodedInfo,
                     if (16 == encodedInfo.bitsPerComponent()) {
                         proc = premultiply ? &swizzle_rgba16_to_rgba_premul :
                                              &swizzle_rgba16_to_rgba_unpremul;
+                        fastProc = premultiply ? &fast_swizzle_rgba16_to_rgba_premul :
+                                                 &fast_swizzle_rgba16_to_rgba_unpremul;
                         break;
                     }
 
@@ -1031,6 +1161,8 @@ std::unique_ptr<SkSwizzler> SkSwizzler::Make(const SkEncodedInfo& encodedInfo,
                     if (16 == encodedInfo.bitsPerComponent()) {
                         proc = premultiply ? &swizzle_rgba16_to_bgra_premul :
                                              &swizzle_rgba16_to_bgra_unpremul;
+                        fastProc = premultiply ? &fast_swizzle_rgba16_to_bgra_premul :
+                                                 &fast_swizzle_rgba16_to_bgra_unpremul;
                         break;
                     }
 
@@ -1240,10 +1372,11 @@ int SkSwizzler::onSetSampleX(int sampleX) {
         }
     }
 
-    // The optimized swizzler functions do not support sampling.  Sampled swizzles
-    // are already fast because they skip pixels.  We haven't seen a situation
-    // where speeding up sampling has a significant impact on total decode time.
-    if (1 == fSampleX && fFastProc) {
+    // The optimized swizzler functions expect contiguous pixels, so when sampling, swizzle()
+    // first gathers the pixels it keeps into a small buffer.  That pays for itself whenever the
+    // optimized function does real work per pixel, but not for a plain copy.
+    const bool isCopy = fFastProc == &copy || fFastProc == &SkipLeading8888ZerosThen<copy>;
+    if (fFastProc && (1 == fSampleX || !isCopy)) {
         fActualProc = fFastProc;
     } else {
         fActualProc = fSlowProc;
@@ -1254,6 +1387,24 @@ int SkSwizzler::onSetSampleX(int sampleX) {
 
 void SkSwizzler::swizzle(void* dst, const uint8_t* SK_RESTRICT src) {
     SkASSERT(nullptr != dst && nullptr != src);
-    fActualProc(SkTAddOffset<void>(dst, fDstOffsetBytes), src, fSwizzleWidth, fSrcBPP,
-            fSampleX * fSrcBPP, fSrcOffsetUnits, fColorTable);
+    dst = SkTAddOffset<void>(dst, fDstOffsetBytes);
+    if (fSampleX > 1 && fActualProc == fFastProc) {
+        // Only formats with whole bytes per pixel have optimized functions.
+        alignas(8) uint8_t samples[1024];
+        const int samplesPerChunk = sizeof(samples) / fSrcBPP;
+        const int deltaSrc = fSampleX * fSrcBPP;
+
+        src += fSrcOffsetUnits;
+        for (int x = 0; x < fSwizzleWidth; x += samplesPerChunk) {
+            const int count = std::min(samplesPerChunk, fSwizzleWidth - x);
+            gather_samples(samples, src, count, fSrcBPP, deltaSrc);
+            fFastProc(SkTAddOffset<void>(dst, x * fDstBPP), samples, count, fSrcBPP, fSrcBPP, 0,
+                      fColorTable);
+            src += count * deltaSrc;
+        }
+        return;
+    }
+
+    fActualProc(dst, src, fSwizzleWidth, fSrcBPP, fSampleX * fSrcBPP, fSrcOffsetUnits,
+                fColorTable);
 }
@@ -0,0 +1,29 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkAnalyticCoverage_DEFINED
+#define SkAnalyticCoverage_DEFINED
+
+#include <cstdint>
+
+// Row operations used by the analytic AA scan converter (SkScan_AAAPath.cpp) to build and
+// accumulate per-pixel coverage.
+namespace SkOpts {
+    // dst[i] = min(dst[i] + src[i], 0xFF)
+    extern void (*accumulate_alphas)(uint8_t dst[], const uint8_t src[], int count);
+    // dst[i] = min(dst[i] + alpha, 0xFF)
+    extern void (*accumulate_alpha)(uint8_t dst[], uint8_t alpha, int count);
+    // dst[i] = max(dst[i] - src[i], 0)
+    extern void (*subtract_alphas)(uint8_t dst[], const uint8_t src[], int count);
+    // dst[i] = (start + i*step) >> 8, truncated to 8 bits. Every start + i*step must be in
+    // [0, SK_MaxS32]; step may be negative.
+    extern void (*alpha_ramp)(uint8_t dst[], int count, int32_t start, int32_t step);
+
+    void Init_AnalyticCoverage();
+}  // namespace SkOpts
+
+#endif // SkAnalyticCoverage_DEFINED
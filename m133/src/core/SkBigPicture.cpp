@@ -9,12 +9,19 @@
 
 #include "include/core/SkBBHFactory.h"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkPixmap.h"
 #include "include/private/base/SkAssert.h"
+#include "include/private/base/SkTemplates.h"
+#include "include/utils/SkNoDrawCanvas.h"
+#include "src/core/SkRTree.h"
+#include "src/core/SkRectPriv.h"
 #include "src/core/SkRecord.h"
 #include "src/core/SkRecordDraw.h"
 #include "src/core/SkRecords.h"
 
+#include <algorithm>
 #include <utility>
+#include <vector>
 
 SkBigPicture::SkBigPicture(const SkRect& cull,
                            sk_sp<SkRecord> record,
@@ -43,6 +50,117 @@ void SkBigPicture::playback(SkCanvas* canvas, AbortCallback* callback) const {
                  callback);
 }
 
+namespace {
+
+// Searches the picture's BBH, adding the ops that reach outside of the cull rect it clips them to.
+class TileBBH final : public SkBBoxHierarchy {
+public:
+    explicit TileBBH(const SkBBoxHierarchy& bbh) : fBBH(bbh) {}
+
+    void add(int op, const SkRect& bounds) {
+        fOps.push_back(op);
+        fBounds.push_back(bounds);
+    }
+
+    void insert(const SkRect[], int) override { SkDEBUGFAIL("TileBBH is search only."); }
+
+    void search(const SkRect& query, std::vector<int>* results) const override {
+        fBBH.search(query, results);
+        const size_t found = results->size();
+        for (size_t i = 0; i < fOps.size(); ++i) {
+            if (SkRect::Intersects(fBounds[i], query)) {
+                results->push_back(fOps[i]);
+            }
+        }
+        // Both lists are in op order, and an op may be in both.
+        std::inplace_merge(results->begin(), results->begin() + found, results->end());
+        results->erase(std::unique(results->begin(), results->end()), results->end());
+    }
+
+    size_t bytesUsed() const override {
+        return sizeof(*this) + fOps.capacity() * sizeof(int) +
+               fBounds.capacity() * sizeof(SkRect);
+    }
+
+private:
+    const SkBBoxHierarchy& fBBH;
+    std::vector<int>       fOps;
+    std::vector<SkRect>    fBounds;
+};
+
+}  // namespace
+
+// Bounds every op of record without clipping it to a cull rect.
+static void fill_unclipped_bounds(const SkRecord& record,
+                                  SkRect bounds[],
+                                  SkBBoxHierarchy::Metadata meta[]) {
+    SkRecordFillBounds(SkRectPriv::MakeLargeS32(), record, bounds, meta);
+}
+
+const SkBigPicture::OutsideCullOps& SkBigPicture::outsideCullOps() const {
+    fOutsideCullOnce([this] {
+        const int count = fRecord->count();
+        skia_private::AutoTArray<SkRect> bounds(count);
+        skia_private::AutoTMalloc<SkBBoxHierarchy::Metadata> meta(count);
+        fill_unclipped_bounds(*fRecord, bounds.data(), meta);
+        for (int i = 0; i < count; ++i) {
+            if (!bounds[i].isEmpty() && !fCullRect.contains(bounds[i])) {
+                fOutsideCull.fOps.push_back(i);
+                fOutsideCull.fBounds.push_back(bounds[i]);
+                fOutsideCull.fHasDraws |= meta[i].isDraw;
+            }
+        }
+    });
+    return fOutsideCull;
+}
+
+const SkBBoxHierarchy* SkBigPicture::unclippedBBH() const {
+    fUnclippedBBHOnce([this] {
+        const int count = fRecord->count();
+        skia_private::AutoTArray<SkRect> bounds(count);
+        skia_private::AutoTMalloc<SkBBoxHierarchy::Metadata> meta(count);
+        fill_unclipped_bounds(*fRecord, bounds.data(), meta);
+        fUnclippedBBH = sk_make_sp<SkRTree>();
+        fUnclippedBBH->insert(bounds.data(), meta, count);
+    });
+    return fUnclippedBBH.get();
+}
+
+bool SkBigPicture::drawsOutsideCullRect() const {
+    return this->outsideCullOps().fHasDraws;
+}
+
+void SkBigPicture::playbackTiled(const SkPixmap& dst, const SkMatrix& matrix,
+                                 const SkSurfaceProps& props, SkExecutor& executor,
+                                 SkISize tileSize) const {
+    // Without a BBH, playback() draws every op, and each tile draws those that reach it.
+    if (!fBBH) {
+        SkRecordDrawTiled(*fRecord, fRecord->count(), this->drawablePicts(), this->drawableCount(),
+                          this->unclippedBBH(), dst, matrix, props, executor, tileSize);
+        return;
+    }
+
+    // What playback() would query the BBH with, drawing into all of dst at once.
+    SkNoDrawCanvas canvas(dst.width(), dst.height());
+    canvas.concat(matrix);
+    const SkRect query = canvas.getLocalClipBounds();
+    const bool useBBH = !query.contains(fCullRect);
+
+    // Tiles search fBBH, which is exact for ops within the cull rect. The ops that reach outside
+    // of it are added with their unclipped bounds, if playback() would draw them at all.
+    TileBBH bbh(*fBBH);
+    const OutsideCullOps& outside = this->outsideCullOps();
+    for (size_t i = 0; i < outside.fOps.size(); ++i) {
+        SkRect clipped = outside.fBounds[i];
+        if (!useBBH || (clipped.intersect(fCullRect) && SkRect::Intersects(clipped, query))) {
+            bbh.add(outside.fOps[i], outside.fBounds[i]);
+        }
+    }
+
+    SkRecordDrawTiled(*fRecord, fRecord->count(), this->drawablePicts(), this->drawableCount(),
+                      &bbh, dst, matrix, props, executor, tileSize);
+}
+
 struct NestedApproxOpCounter {
     int fCount = 0;
 
@@ -13,13 +13,22 @@
 #include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
 #include "include/private/base/SkNoncopyable.h"
+#include "include/private/base/SkOnce.h"
 #include "include/private/base/SkTemplates.h"
 #include "src/core/SkRecord.h"
 
 #include <cstddef>
 #include <memory>
+#include <vector>
 
 class SkCanvas;
+class SkExecutor;
+class SkMatrix;
+class SkPixmap;
+class SkSurfaceProps;
+struct SkISize;
+
+namespace SkRecords { class TileIndependent; }
 
 // An implementation of SkPicture supporting an arbitrary number of drawing commands.
 // This is called "big" because there used to be a "mini" that only supported a subset of the
@@ -57,15 +66,46 @@ public:
     const SkBBoxHierarchy* bbh() const { return fBBH.get(); }
     const SkRecord*     record() const { return fRecord.get(); }
 
+    // Used by SkPicture::playbackTiled()
+    void playbackTiled(const SkPixmap& dst, const SkMatrix&, const SkSurfaceProps&,
+                       SkExecutor&, SkISize tileSize) const;
+
+    // Used by SkRecordDrawTiled(). True if some op may draw outside of cullRect(), like clear()
+    // or drawPaint(), so that how far playback() reaches depends on the canvas's clip. Computed
+    // on first use.
+    bool drawsOutsideCullRect() const;
+
 private:
+    friend class SkRecords::TileIndependent;  // for drawableCount() and drawablePicts()
+
     int drawableCount() const;
     SkPicture const* const* drawablePicts() const;
 
+    // fBBH clips the bounds of every op to fCullRect, but playback() draws an op as far as the
+    // canvas's clip lets it. These are the ops whose bounds reach outside of fCullRect when they
+    // aren't clipped to it, including the control ops around them, and those bounds.
+    struct OutsideCullOps {
+        std::vector<int>    fOps;
+        std::vector<SkRect> fBounds;
+        bool                fHasDraws = false;
+    };
+    const OutsideCullOps& outsideCullOps() const;
+
+    // A BBH over the bounds of every op, not clipped to fCullRect, for tiles to search when the
+    // picture has no fBBH.
+    const SkBBoxHierarchy* unclippedBBH() const;
+
     const SkRect                         fCullRect;
     const size_t                         fApproxBytesUsedBySubPictures;
     sk_sp<const SkRecord>                fRecord;
     std::unique_ptr<const SnapshotArray> fDrawablePicts;
     sk_sp<const SkBBoxHierarchy>         fBBH;
+
+    // Computed on first use by playbackTiled() or drawsOutsideCullRect().
+    mutable SkOnce                       fOutsideCullOnce;
+    mutable OutsideCullOps               fOutsideCull;
+    mutable SkOnce                       fUnclippedBBHOnce;
+    mutable sk_sp<SkBBoxHierarchy>       fUnclippedBBH;
 };
 
 #endif//SkBigPicture_DEFINED
@@ -106,6 +106,8 @@ public:
         SkAutoMutexExclusive ama(fMutex);
         return fExternalCounter == 0;
     }
+    double cost() const override { return fDecodeNanos; }
+    void setDecodeNanos(double nanos) { fDecodeNanos = nanos; }
     void postAddInstall(void* payload) override {
         SkAssertResult(this->install(static_cast<SkBitmap*>(payload)));
     }
@@ -176,6 +178,7 @@ private:
     SkImageInfo fInfo;
     size_t      fRowBytes;
     uint32_t    fPrUniqueID;
+    double      fDecodeNanos = 0;
 
     // This field counts the number of external pixelrefs we have created.
     // They notify us when they are destroyed so we can decrement this.
@@ -213,7 +216,8 @@ SkBitmapCache::RecPtr SkBitmapCache::Alloc(const SkBitmapCacheDesc& desc, const
     return RecPtr(new Rec(desc, info, rb, std::move(dm), block));
 }
 
-void SkBitmapCache::Add(RecPtr rec, SkBitmap* bitmap) {
+void SkBitmapCache::Add(RecPtr rec, SkBitmap* bitmap, double decodeNanos) {
+    rec->setDecodeNanos(decodeNanos);
     SkResourceCache::Add(rec.release(), bitmap);
 }
 
@@ -53,7 +53,12 @@ public:
     typedef std::unique_ptr<Rec, RecDeleter> RecPtr;
 
     static RecPtr Alloc(const SkBitmapCacheDesc&, const SkImageInfo&, SkPixmap*);
-    static void Add(RecPtr, SkBitmap*);
+    /**
+     *  Adds the rec to the cache, and installs its pixels in the bitmap. If known, decodeNanos
+     *  is how long it took to produce the pixels, which the cost-aware eviction policy uses to
+     *  decide what to keep.
+     */
+    static void Add(RecPtr, SkBitmap*, double decodeNanos = 0);
 
 private:
     static void PrivateDeleteRec(Rec*);
@@ -115,6 +115,12 @@ public:
 
     void* getRasterHandle() const override { return fRasterHandle; }
 
+protected:
+    bool onReadPixels(const SkPixmap&, int x, int y) override;
+    bool onWritePixels(const SkPixmap&, int, int) override;
+    bool onPeekPixels(SkPixmap*) override;
+    bool onAccessPixels(SkPixmap*) override;
+
 private:
     friend class SkDraw;
     friend class SkDrawBase;
@@ -131,11 +137,6 @@ private:
 
     void onDrawGlyphRunList(SkCanvas*, const sktext::GlyphRunList&, const SkPaint& paint) override;
 
-    bool onReadPixels(const SkPixmap&, int x, int y) override;
-    bool onWritePixels(const SkPixmap&, int, int) override;
-    bool onPeekPixels(SkPixmap*) override;
-    bool onAccessPixels(SkPixmap*) override;
-
     void drawBitmap(const SkBitmap&, const SkMatrix&, const SkRect* dstOrNull,
                     const SkSamplingOptions&, const SkPaint&);
 
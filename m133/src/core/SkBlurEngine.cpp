@@ -14,6 +14,7 @@
 #include "include/core/SkColor.h"
 #include "include/core/SkColorSpace.h" // IWYU pragma: keep
 #include "include/core/SkColorType.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkM44.h"
 #include "include/core/SkMatrix.h"
@@ -36,12 +37,14 @@
 #include "src/core/SkDevice.h"
 #include "src/core/SkKnownRuntimeEffects.h"
 #include "src/core/SkSpecialImage.h"
+#include "src/core/SkTaskGroup.h"
 
 #include <algorithm>
 #include <array>
 #include <cmath>
 #include <cstdint>
 #include <cstring>
+#include <memory>
 #include <utility>
 
 
@@ -714,6 +717,12 @@ private:
 
 class Raster8888BlurAlgorithm : public SkBlurEngine::Algorithm {
 public:
+    // If 'splitIntoBands' is true, large passes are split into bands which run on 'executor', or
+    // on SkExecutor::GetDefault() if it's null.
+    Raster8888BlurAlgorithm(bool splitIntoBands, SkExecutor* executor)
+            : fSplitIntoBands(splitIntoBands)
+            , fExecutor(executor) {}
+
     // See analysis in description of TentPass for the max supported sigma.
     float maxSigma() const override {
         // TentPass supports a sigma up to 2183, and was added so that the CPU blur algorithm's
@@ -792,15 +801,16 @@ public:
         }
         dst.eraseColor(SK_ColorTRANSPARENT);
 
-        auto buffer = alloc.makeBytesAlignedTo(std::max(makerX->bufferSizeBytes(),
-                                                        makerY->bufferSizeBytes()),
-                                            alignof(skvx::Vec<4, uint32_t>));
-
         // Basic Plan: The three cases to handle
         // * Horizontal and Vertical - blur horizontally while copying values from the source to
         //     the destination. Then, do an in-place vertical blur.
         // * Horizontal only - blur horizontally copying values from the source to the destination.
         // * Vertical only - blur vertically copying values from the source to the destination.
+        //
+        // Large passes are split into bands of rows for X and bands of columns for Y. A band never
+        // reads pixels that another band of the same pass writes, and the X pass finishes before
+        // the Y pass starts, so the rows outset above and below originalDstBounds are the only halo
+        // the Y bands need.
 
         // Initialize these assuming the Y-only case
         int loopStart  = std::max(srcBounds.left(),  dstBounds.left());
@@ -813,20 +823,24 @@ public:
             loopStart = std::max(srcBounds.top(),    dstBounds.top());
             loopEnd   = std::min(srcBounds.bottom(), dstBounds.bottom());
 
-            auto srcAddr = src.getAddr32(0, loopStart - srcBounds.top());
-            auto dstAddr = dst.getAddr32(0, loopStart - dstBounds.top());
-
             // Iterate over each row to calculate 1D blur along X.
-            Pass* pass = makerX->makePass(buffer, &alloc);
-            for (int y = loopStart; y < loopEnd; ++y) {
-                pass->blur(srcBounds.left()  - dstBounds.left(),
-                           srcBounds.right() - dstBounds.left(),
-                           dstBounds.width(),
-                           srcAddr, 1,
-                           dstAddr, 1);
-                srcAddr += src.rowBytesAsPixels();
-                dstAddr += dst.rowBytesAsPixels();
-            }
+            this->forEachBand(loopStart, loopEnd, dstBounds.width(), /*multiple=*/1,
+                              [&](int bandStart, int bandEnd) {
+                SkSTArenaAlloc<kBandAllocSize> bandAlloc;
+                Pass* pass = make_pass(*makerX, &bandAlloc);
+
+                auto srcAddr = src.getAddr32(0, bandStart - srcBounds.top());
+                auto dstAddr = dst.getAddr32(0, bandStart - dstBounds.top());
+                for (int y = bandStart; y < bandEnd; ++y) {
+                    pass->blur(srcBounds.left()  - dstBounds.left(),
+                               srcBounds.right() - dstBounds.left(),
+                               dstBounds.width(),
+                               srcAddr, 1,
+                               dstAddr, 1);
+                    srcAddr += src.rowBytesAsPixels();
+                    dstAddr += dst.rowBytesAsPixels();
+                }
+            });
 
             // Set up the Y pass to blur from the full dst into the non-outset portion of dst
             src = dst;
@@ -845,25 +859,74 @@ public:
         // into dst for a 1D blur; or it's blurring from dst into dst for the second pass of a 2D
         // blur.
         if (makerY->window() > 1) {
-            auto srcAddr = src.getAddr32(loopStart - srcBounds.left(), 0);
-            auto dstAddr = dst.getAddr32(loopStart - dstBounds.left(), dstYOffset);
-
-            Pass* pass = makerY->makePass(buffer, &alloc);
-            for (int x = loopStart; x < loopEnd; ++x) {
-                pass->blur(srcBounds.top()    - dstBounds.top(),
-                           srcBounds.bottom() - dstBounds.top(),
-                           dstBounds.height(),
-                           srcAddr, src.rowBytesAsPixels(),
-                           dstAddr, dst.rowBytesAsPixels());
-                srcAddr += 1;
-                dstAddr += 1;
-            }
+            // Column bands are a multiple of a cache line wide, so that no two bands write to the
+            // same line unless the start of dst's rows isn't aligned.
+            this->forEachBand(loopStart, loopEnd, srcBounds.height(), /*multiple=*/16,
+                              [&](int bandStart, int bandEnd) {
+                SkSTArenaAlloc<kBandAllocSize> bandAlloc;
+                Pass* pass = make_pass(*makerY, &bandAlloc);
+
+                auto srcAddr = src.getAddr32(bandStart - srcBounds.left(), 0);
+                auto dstAddr = dst.getAddr32(bandStart - dstBounds.left(), dstYOffset);
+                for (int x = bandStart; x < bandEnd; ++x) {
+                    pass->blur(srcBounds.top()    - dstBounds.top(),
+                               srcBounds.bottom() - dstBounds.top(),
+                               dstBounds.height(),
+                               srcAddr, src.rowBytesAsPixels(),
+                               dstAddr, dst.rowBytesAsPixels());
+                    srcAddr += 1;
+                    dstAddr += 1;
+                }
+            });
         }
 
         dstBounds = originalDstBounds.makeOffset(-dstOrigin); // Make relative to dst's pixels
         return SkSpecialImages::MakeFromRaster(dstBounds, dst, SkSurfaceProps{});
     }
 
+private:
+    // A pass smaller than kMinBandPixels * 2 runs on the calling thread. Otherwise it's split into
+    // at most kMaxBands bands of at least kMinBandPixels each, which is enough to keep the task
+    // overhead small while still giving a thread pool on a phone or desktop work to balance.
+    static constexpr int kMinBandPixels = 1 << 15;
+    static constexpr int kMaxBands = 32;
+    // Holds a band's Pass and the buffer of small windows; the arena allocates larger buffers.
+    static constexpr size_t kBandAllocSize = 1024;
+
+    static Pass* make_pass(const PassMaker& maker, SkArenaAlloc* alloc) {
+        void* buffer = alloc->makeBytesAlignedTo(maker.bufferSizeBytes(),
+                                                 alignof(skvx::Vec<4, uint32_t>));
+        return maker.makePass(buffer, alloc);
+    }
+
+    // Calls blurBand(bandStart, bandEnd) to cover the rows or columns in [start, end), where each
+    // is 'length' pixels long. Every row or column is blurred independently of the others, so the
+    // bands may run concurrently and still produce exactly the pixels of a single band. Band
+    // boundaries other than 'end' fall on multiples of 'multiple' from 'start'.
+    template <typename BlurBandFn>
+    void forEachBand(int start, int end, int length, int multiple, BlurBandFn&& blurBand) const {
+        const int64_t pixels = SkToS64(end - start) * length;
+        const int bandCount = fSplitIntoBands
+                ? SkToInt(std::min<int64_t>(pixels / kMinBandPixels, kMaxBands))
+                : 1;
+        if (bandCount <= 1) {
+            blurBand(start, end);
+            return;
+        }
+
+        int bandSize = (end - start + bandCount - 1) / bandCount;
+        bandSize = (bandSize + multiple - 1) / multiple * multiple;
+
+        SkTaskGroup bands(fExecutor ? *fExecutor : SkExecutor::GetDefault());
+        for (int bandStart = start; bandStart < end; bandStart += bandSize) {
+            const int bandEnd = std::min(bandStart + bandSize, end);
+            bands.add([&blurBand, bandStart, bandEnd] { blurBand(bandStart, bandEnd); });
+        }
+        bands.wait();
+    }
+
+    const bool fSplitIntoBands;
+    SkExecutor* const fExecutor;
 };
 
 class RasterShaderBlurAlgorithm : public SkShaderBlurAlgorithm {
@@ -878,6 +941,9 @@ public:
 
 class RasterBlurEngine : public SkBlurEngine {
 public:
+    RasterBlurEngine(bool splitIntoBands, SkExecutor* executor)
+            : fRGBA8BlurAlgorithm(splitIntoBands, executor) {}
+
     const Algorithm* findAlgorithm(SkSize sigma,  SkColorType colorType) const override {
         static constexpr float kBoxBlurMinSigma = 2.f;
 
@@ -911,10 +977,14 @@ private:
 } // anonymous namespace
 
 const SkBlurEngine* SkBlurEngine::GetRasterBlurEngine() {
-    static const RasterBlurEngine kInstance;
+    static const RasterBlurEngine kInstance{/*splitIntoBands=*/true, /*executor=*/nullptr};
     return &kInstance;
 }
 
+std::unique_ptr<SkBlurEngine> SkBlurEngine::MakeRasterBlurEngine(SkExecutor* executor) {
+    return std::make_unique<RasterBlurEngine>(/*splitIntoBands=*/executor != nullptr, executor);
+}
+
 // SkShaderBlurAlgorithm
 // ----------------------------------------------------------------------------
 
@@ -17,8 +17,10 @@
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <memory>
 
 class SkDevice;
+class SkExecutor;
 class SkRuntimeEffect;
 class SkRuntimeEffectBuilder;
 class SkSpecialImage;
@@ -74,8 +76,16 @@ public:
     // Get the default CPU-backed SkBlurEngine. This has specialized algorithms for 32-bit RGBA
     // and BGRA colors, and A8 alpha-only images when the sigma is large enough. For small blurs
     // and other color types, it uses SkShaderBlurAlgorithm backed by the raster pipeline.
+    //
+    // Large 32-bit blurs are split into bands of rows for the horizontal pass and bands of columns
+    // for the vertical pass, which run on SkExecutor::GetDefault().
     static const SkBlurEngine* GetRasterBlurEngine();
 
+    // Returns a CPU-backed SkBlurEngine like GetRasterBlurEngine(), except that the bands of large
+    // 32-bit blurs run on 'executor'. If 'executor' is null, every pass runs on the calling thread
+    // without being split.
+    static std::unique_ptr<SkBlurEngine> MakeRasterBlurEngine(SkExecutor* executor);
+
     // TODO: These are internal functions of the raster blur engine but need to be public for legacy
     // code paths to invoke them directly.
 
@@ -148,4 +148,13 @@ SkBlitter* SkCreateRasterPipelineBlitter(const SkPixmap&, const SkPaint&,
                                          bool shader_is_opaque,
                                          SkArenaAlloc*, sk_sp<SkShader> clipShader);
 
+// Solid color raster pipeline blitters are cached per thread (see SkRasterPipelineBlitter.cpp).
+// These count, across all threads, how often a draw found its blitter in the cache or had to
+// build a new one.
+struct SkRasterPipelineBlitterCacheStats {
+    int fHits;
+    int fMisses;
+};
+SkRasterPipelineBlitterCacheStats SkGetRasterPipelineBlitterCacheStats();
+
 #endif
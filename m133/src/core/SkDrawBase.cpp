@@ -17,6 +17,7 @@
 #include "include/core/SkRect.h"
 #include "include/core/SkScalar.h"
 #include "include/core/SkStrokeRec.h"
+#include "include/core/SkSurfaceProps.h"
 #include "include/private/base/SkAssert.h"
 #include "include/private/base/SkCPUTypes.h"
 #include "include/private/base/SkDebug.h"
@@ -97,6 +98,14 @@ static inline SkPoint compute_stroke_size(const SkPaint& paint, const SkMatrix&
     return SkPoint::Make(SkScalarAbs(size.fX), SkScalarAbs(size.fY));
 }
 
+static bool use_sparse_strip_rasterizer(const SkSurfaceProps* props) {
+#if defined(SK_USE_SPARSE_STRIP_RASTERIZER)
+    return true;
+#else
+    return props && props->isSparseStripRasterizer();
+#endif
+}
+
 static bool easy_rect_join(const SkRect& rect, const SkPaint& paint, const SkMatrix& matrix,
                            SkPoint* strokeSize) {
     if (rect.isEmpty() || SkPaint::kMiter_Join != paint.getStrokeJoin() ||
@@ -345,7 +354,9 @@ void SkDrawBase::drawDevPath(const SkPath& devPath, const SkPaint& paint, bool d
 
     void (*proc)(const SkPath&, const SkRasterClip&, SkBlitter*);
     if (doFill) {
-        if (paint.isAntiAlias()) {
+        if (paint.isAntiAlias() && use_sparse_strip_rasterizer(fProps)) {
+            proc = SkScan::SparseStripFillPath;
+        } else if (paint.isAntiAlias()) {
             proc = SkScan::AntiFillPath;
         } else {
             proc = SkScan::FillPath;
@@ -7,6 +7,7 @@
 
 #include "include/core/SkGraphics.h"
 
+#include "src/core/SkAnalyticCoverage.h"
 #include "src/core/SkBitmapProcState.h"
 #include "src/core/SkBlitMask.h"
 #include "src/core/SkBlitRow.h"
@@ -15,19 +16,23 @@
 #include "src/core/SkMemset.h"
 #include "src/core/SkOpts.h"
 #include "src/core/SkResourceCache.h"
+#include "src/core/SkRuntimeEffectCache.h"
 #include "src/core/SkStrikeCache.h"
 #include "src/core/SkSwizzlePriv.h"
 #include "src/core/SkTypefaceCache.h"
+#include "src/core/SkYUVToRGB.h"
 
 void SkGraphics::Init() {
     // SkGraphics::Init() must be thread-safe and idempotent.
     SkCpu::CacheRuntimeFeatures();
     SkOpts::Init();
+    SkOpts::Init_AnalyticCoverage();
     SkOpts::Init_BitmapProcState();
     SkOpts::Init_BlitMask();
     SkOpts::Init_BlitRow();
     SkOpts::Init_Memset();
     SkOpts::Init_Swizzler();
+    SkOpts::Init_YUVToRGB();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -35,11 +40,13 @@ void SkGraphics::Init() {
 void SkGraphics::DumpMemoryStatistics(SkTraceMemoryDump* dump) {
   SkResourceCache::DumpMemoryStatistics(dump);
   SkStrikeCache::DumpMemoryStatistics(dump);
+  SkRuntimeEffectCache::DumpMemoryStatistics(dump);
 }
 
 void SkGraphics::PurgeAllCaches() {
     SkGraphics::PurgeFontCache();
     SkGraphics::PurgeResourceCache();
+    SkGraphics::PurgeRuntimeEffectCache();
     SkImageFilter_Base::PurgeCache();
 }
 
@@ -17,6 +17,8 @@
 
 #include "src/opts/SkOpts_RestoreTarget.h"
 
+#include <atomic>
+
 namespace SkOpts {
     // Define default function pointer values here...
     // If our global compile options are set high enough, these defaults might even be
@@ -71,4 +73,84 @@ namespace SkOpts {
     void Init() {
         [[maybe_unused]] static bool gInitialized = init();
     }
+
+    // Puts back the defaults defined at the top of this file.
+    static void init_default() {
+        raster_pipeline_lowp_stride  = SK_OPTS_NS::raster_pipeline_lowp_stride();
+        raster_pipeline_highp_stride = SK_OPTS_NS::raster_pipeline_highp_stride();
+
+    #define M(st) ops_highp[(int)SkRasterPipelineOp::st] = (StageFn)SK_OPTS_NS::st;
+        SK_RASTER_PIPELINE_OPS_ALL(M)
+        just_return_highp = (StageFn)SK_OPTS_NS::just_return;
+        start_pipeline_highp = SK_OPTS_NS::start_pipeline;
+    #undef M
+
+    #define M(st) ops_lowp[(int)SkRasterPipelineOp::st] = (StageFn)SK_OPTS_NS::lowp::st;
+        SK_RASTER_PIPELINE_OPS_LOWP(M)
+        just_return_lowp = (StageFn)SK_OPTS_NS::lowp::just_return;
+        start_pipeline_lowp = SK_OPTS_NS::lowp::start_pipeline;
+    #undef M
+    }
+
+    bool SupportsRasterPipelineTarget(RasterPipelineTarget target) {
+        switch (target) {
+            case RasterPipelineTarget::kNative:
+            case RasterPipelineTarget::kDefault:
+                return true;
+
+            case RasterPipelineTarget::kHSW:
+            #if !defined(SK_ENABLE_OPTIMIZE_SIZE) && defined(SK_CPU_X86) && \
+                    SK_CPU_SSE_LEVEL < SK_CPU_SSE_LEVEL_AVX2
+                return SkCpu::Supports(SkCpu::HSW);
+            #else
+                return false;
+            #endif
+
+            case RasterPipelineTarget::kSKX:
+            #if !defined(SK_ENABLE_OPTIMIZE_SIZE) && defined(SK_CPU_X86) && \
+                    SK_CPU_SSE_LEVEL < SK_CPU_SSE_LEVEL_SKX && defined(SK_ENABLE_AVX512_OPTS)
+                return SkCpu::Supports(SkCpu::SKX);
+            #else
+                return false;
+            #endif
+
+            case RasterPipelineTarget::kLASX:
+            #if !defined(SK_ENABLE_OPTIMIZE_SIZE) && defined(SK_CPU_LOONGARCH) && \
+                    SK_CPU_LSX_LEVEL < SK_CPU_LSX_LEVEL_LASX
+                return SkCpu::Supports(SkCpu::LOONGARCH_ASX);
+            #else
+                return false;
+            #endif
+        }
+        SkUNREACHABLE;
+    }
+
+    static std::atomic<uint32_t> gRasterPipelineTargetGeneration{0};
+
+    uint32_t RasterPipelineTargetGeneration() {
+        return gRasterPipelineTargetGeneration.load(std::memory_order_acquire);
+    }
+
+    bool SetRasterPipelineTarget(RasterPipelineTarget target) {
+        if (!SupportsRasterPipelineTarget(target)) {
+            return false;
+        }
+        // Make sure a later call to Init() can't undo what we do here.
+        Init();
+
+        init_default();
+        switch (target) {
+            case RasterPipelineTarget::kNative:  init();      break;
+            case RasterPipelineTarget::kDefault:              break;
+        #if !defined(SK_ENABLE_OPTIMIZE_SIZE) && defined(SK_CPU_X86)
+            case RasterPipelineTarget::kHSW:     Init_hsw();  break;
+            case RasterPipelineTarget::kSKX:     Init_skx();  break;
+        #elif !defined(SK_ENABLE_OPTIMIZE_SIZE) && defined(SK_CPU_LOONGARCH)
+            case RasterPipelineTarget::kLASX:    Init_lasx(); break;
+        #endif
+            default:                                          SkUNREACHABLE;
+        }
+        gRasterPipelineTargetGeneration.fetch_add(1, std::memory_order_release);
+        return true;
+    }
 }  // namespace SkOpts
@@ -83,6 +83,23 @@ namespace SkOpts {
 
     extern size_t raster_pipeline_lowp_stride;
     extern size_t raster_pipeline_highp_stride;
+
+    // The raster pipeline stage tables above can be pointed at one specific target, e.g. so that
+    // benchmarks can compare the same pipeline across targets. kNative is whatever Init() picks.
+    // Pipelines capture the tables when they're compiled, so switching only affects pipelines
+    // built afterwards. This is not thread-safe; it's meant for tools, not for normal drawing.
+    enum class RasterPipelineTarget {
+        kNative,
+        kDefault,  // The target Skia itself was compiled for, e.g. SSE2 or NEON.
+        kHSW,
+        kSKX,
+        kLASX,
+    };
+    bool SupportsRasterPipelineTarget(RasterPipelineTarget);
+    bool SetRasterPipelineTarget(RasterPipelineTarget);  // False (and no change) if unsupported.
+    // Changes every time SetRasterPipelineTarget() succeeds. Anything that holds on to compiled
+    // pipelines across draws compares this to know when they were built for another target.
+    uint32_t RasterPipelineTargetGeneration();
 }  // namespace SkOpts
 
 #endif // SkOpts_DEFINED
@@ -7,13 +7,20 @@
 
 #include "include/core/SkPicture.h"
 
+#include "include/core/SkCanvas.h"
 #include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkMatrix.h"
 #include "include/core/SkPictureRecorder.h"
+#include "include/core/SkPixmap.h"
 #include "include/core/SkSerialProcs.h"
+#include "include/core/SkSize.h"
 #include "include/core/SkStream.h"
+#include "include/core/SkSurfaceProps.h"
 #include "include/private/base/SkTFitsIn.h"
 #include "include/private/base/SkTo.h"
 #include "src/base/SkMathPriv.h"
+#include "src/core/SkBigPicture.h"
 #include "src/core/SkCanvasPriv.h"
 #include "src/core/SkPictureData.h"
 #include "src/core/SkPicturePlayback.h"
@@ -22,6 +29,7 @@
 #include "src/core/SkReadBuffer.h"
 #include "src/core/SkResourceCache.h"
 #include "src/core/SkStreamPriv.h"
+#include "src/core/SkSurfacePriv.h"
 #include "src/core/SkWriteBuffer.h"
 
 #include <atomic>
@@ -242,6 +250,32 @@ SkPictureData* SkPicture::backport() const {
     return new SkPictureData(rec, info);
 }
 
+bool SkPicture::playbackTiled(const SkPixmap& dst, const SkMatrix& matrix, SkExecutor* executor,
+                              SkISize tileSize, const SkSurfaceProps* props) const {
+    if (!dst.addr() || dst.info().isEmpty() || tileSize.isEmpty() || !matrix.isFinite()) {
+        return false;
+    }
+    if (!executor) {
+        executor = &SkExecutor::GetDefault();
+    }
+    const SkSurfaceProps surfaceProps = SkSurfacePropsCopyOrDefault(props);
+
+    if (const SkBigPicture* bp = this->asSkBigPicture()) {
+        bp->playbackTiled(dst, matrix, surfaceProps, *executor, tileSize);
+        return true;
+    }
+
+    // Other pictures are too small to be worth splitting up.
+    std::unique_ptr<SkCanvas> canvas = SkCanvas::MakeRasterDirect(
+            dst.info(), dst.writable_addr(), dst.rowBytes(), &surfaceProps);
+    if (!canvas) {
+        return false;
+    }
+    canvas->concat(matrix);
+    this->playback(canvas.get());
+    return true;
+}
+
 void SkPicture::serialize(SkWStream* stream, const SkSerialProcs* procs) const {
     this->serialize(stream, procs, nullptr);
 }
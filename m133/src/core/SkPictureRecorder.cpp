@@ -38,6 +38,7 @@ SkCanvas* SkPictureRecorder::beginRecording(const SkRect& userCullRect,
 
     fCullRect = cullRect;
     fBBH = std::move(bbh);
+    fOptimizationStats = {};
 
     if (!fRecord) {
         fRecord.reset(new SkRecord);
@@ -73,7 +74,7 @@ sk_sp<SkPicture> SkPictureRecorder::finishRecordingAsPicture() {
     }
 
     // TODO: delay as much of this work until just before first playback?
-    SkRecordOptimize(fRecord.get());
+    SkRecordOptimize(fRecord.get(), &fOptimizationStats, fCullOccludedDraws);
 
     SkDrawableList* drawableList = fRecorder->getDrawableList();
     std::unique_ptr<SkBigPicture::SnapshotArray> pictList{
@@ -133,7 +134,7 @@ sk_sp<SkDrawable> SkPictureRecorder::finishRecordingAsDrawable() {
     fActivelyRecording = false;
     fRecorder->restoreToCount(1);  // If we were missing any restores, add them now.
 
-    SkRecordOptimize(fRecord.get());
+    SkRecordOptimize(fRecord.get(), &fOptimizationStats, fCullOccludedDraws);
 
     if (fBBH) {
         AutoTArray<SkRect> bounds(fRecord->count());
@@ -285,6 +285,10 @@ void SkRasterPipeline::appendConstantColor(SkArenaAlloc* alloc, const float rgba
     }
 }
 
+void SkRasterPipeline::appendUniformColor(bool bounded, SkRasterPipeline_UniformColorCtx* ctx) {
+    this->uncheckedAppend(bounded ? Op::uniform_color : Op::unbounded_uniform_color, ctx);
+}
+
 void SkRasterPipeline::appendMatrix(SkArenaAlloc* alloc, const SkMatrix& matrix) {
     SkMatrix::TypeMask mt = matrix.getType();
 
@@ -118,6 +118,10 @@ public:
         this->appendConstantColor(alloc, color.vec());
     }
 
+    // Appends a stage reading a uniform color from ctx, which the caller fills in and may change
+    // between runs of the compiled pipeline. The color must be in range if bounded is true.
+    void appendUniformColor(bool bounded, SkRasterPipeline_UniformColorCtx* ctx);
+
     // Like appendConstantColor() but only affecting r,g,b, ignoring the alpha channel.
     void appendSetRGB(SkArenaAlloc*, const float rgb[3]);
 
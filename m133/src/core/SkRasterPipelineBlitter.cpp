@@ -19,6 +19,7 @@
 #include "include/core/SkSurfaceProps.h"
 #include "include/private/base/SkAssert.h"
 #include "include/private/base/SkCPUTypes.h"
+#include "include/private/base/SkTPin.h"
 #include "include/private/base/SkTemplates.h"
 #include "src/base/SkArenaAlloc.h"
 #include "src/core/SkBlendModePriv.h"
@@ -26,18 +27,24 @@
 #include "src/core/SkBlitter.h"
 #include "src/core/SkColorSpacePriv.h"
 #include "src/core/SkColorSpaceXformSteps.h"
+#include "src/core/SkCoreBlitters.h"
 #include "src/core/SkEffectPriv.h"
+#include "src/core/SkImageInfoPriv.h"
+#include "src/core/SkLRUCache.h"
 #include "src/core/SkMask.h"
 #include "src/core/SkMemset.h"
+#include "src/core/SkOpts.h"
 #include "src/core/SkRasterPipeline.h"
 #include "src/core/SkRasterPipelineOpContexts.h"
 #include "src/core/SkRasterPipelineOpList.h"
 #include "src/effects/colorfilters/SkColorFilterBase.h"
 #include "src/shaders/SkShaderBase.h"
 
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 #include <functional>
+#include <memory>
 #include <optional>
 #include <utility>
 
@@ -56,6 +63,13 @@ public:
                              bool is_constant,
                              const SkShader* clipShader);
 
+    // Like Create(), for a paint that's just a color and a blend mode, but returns a blitter from
+    // this thread's cache whenever it can. Returns nullptr if the cache can't be used right now.
+    static SkBlitter* CreateCached(const SkPixmap& dst,
+                                   const SkPaint& paint,
+                                   const SkColor4f& dstPaintColor,
+                                   SkArenaAlloc* alloc);
+
     SkRasterPipelineBlitter(SkPixmap dst,
                             SkArenaAlloc* alloc)
         : fDst(std::move(dst))
@@ -111,6 +125,10 @@ private:
     float fCurrentCoverage = 0.0f;
     float fDitherRate      = 0.0f;
 
+    // Scratch row of per-pixel coverage used by blitAntiH(), allocated on first use.
+    SkAlpha* fAntiHCoverage         = nullptr;
+    int      fAntiHCoverageCapacity = 0;
+
     using INHERITED = SkBlitter;
 };
 
@@ -135,6 +153,12 @@ SkBlitter* SkCreateRasterPipelineBlitter(const SkPixmap& dst,
 
     SkRasterPipeline_<256> shaderPipeline;
     if (!shader) {
+        if (!clipShader) {
+            if (SkBlitter* blitter = SkRasterPipelineBlitter::CreateCached(dst, paint,
+                                                                           dstPaintColor, alloc)) {
+                return blitter;
+            }
+        }
         // Having no shader makes things nice and easy... just use the paint color
         shaderPipeline.appendConstantColor(alloc, dstPaintColor.premul().vec());
         bool is_opaque    = dstPaintColor.fA == 1.0f,
@@ -172,6 +196,33 @@ SkBlitter* SkCreateRasterPipelineBlitter(const SkPixmap& dst,
                                            clipShader.get());
 }
 
+static void (*memset_2d_proc(const SkPixmap& dst))(SkPixmap*, int, int, int, int, uint64_t) {
+    switch (dst.shiftPerPixel()) {
+        case 0: return [](SkPixmap* dst, int x,int y, int w,int h, uint64_t c) {
+            void* p = dst->writable_addr(x,y);
+            while (h --> 0) {
+                memset(p, c, w);
+                p = SkTAddOffset<void>(p, dst->rowBytes());
+            }
+        };
+
+        case 1: return [](SkPixmap* dst, int x,int y, int w,int h, uint64_t c) {
+            SkOpts::rect_memset16(dst->writable_addr16(x,y), c, w, dst->rowBytes(), h);
+        };
+
+        case 2: return [](SkPixmap* dst, int x,int y, int w,int h, uint64_t c) {
+            SkOpts::rect_memset32(dst->writable_addr32(x,y), c, w, dst->rowBytes(), h);
+        };
+
+        case 3: return [](SkPixmap* dst, int x,int y, int w,int h, uint64_t c) {
+            SkOpts::rect_memset64(dst->writable_addr64(x,y), c, w, dst->rowBytes(), h);
+        };
+
+        // TODO(F32)?
+    }
+    return nullptr;
+}
+
 SkBlitter* SkRasterPipelineBlitter::Create(const SkPixmap& dst,
                                            const SkPaint& paint,
                                            const SkColor4f& dstPaintColor,
@@ -316,29 +367,7 @@ SkBlitter* SkRasterPipelineBlitter::Create(const SkPixmap& dst,
         blitter->appendStore(&p);
         p.run(0,0,1,1);
 
-        switch (blitter->fDst.shiftPerPixel()) {
-            case 0: blitter->fMemset2D = [](SkPixmap* dst, int x,int y, int w,int h, uint64_t c) {
-                void* p = dst->writable_addr(x,y);
-                while (h --> 0) {
-                    memset(p, c, w);
-                    p = SkTAddOffset<void>(p, dst->rowBytes());
-                }
-            }; break;
-
-            case 1: blitter->fMemset2D = [](SkPixmap* dst, int x,int y, int w,int h, uint64_t c) {
-                SkOpts::rect_memset16(dst->writable_addr16(x,y), c, w, dst->rowBytes(), h);
-            }; break;
-
-            case 2: blitter->fMemset2D = [](SkPixmap* dst, int x,int y, int w,int h, uint64_t c) {
-                SkOpts::rect_memset32(dst->writable_addr32(x,y), c, w, dst->rowBytes(), h);
-            }; break;
-
-            case 3: blitter->fMemset2D = [](SkPixmap* dst, int x,int y, int w,int h, uint64_t c) {
-                SkOpts::rect_memset64(dst->writable_addr64(x,y), c, w, dst->rowBytes(), h);
-            }; break;
-
-            // TODO(F32)?
-        }
+        blitter->fMemset2D = memset_2d_proc(blitter->fDst);
     }
 
     {
@@ -359,6 +388,151 @@ SkBlitter* SkRasterPipelineBlitter::Create(const SkPixmap& dst,
     return blitter;
 }
 
+// Solid color draws with a plain blend mode are by far the most common (most rects and all mask
+// text), and their pipelines differ only in the color. Each thread keeps a few of those blitters
+// around so their lazily compiled pipelines can be reused from draw to draw; on reuse we only
+// patch the dst and the uniform color.
+namespace {
+
+struct CachedBlitter {
+    SkSTArenaAlloc<2048>              fAlloc;
+    SkRasterPipelineBlitter*          fBlitter    = nullptr;
+    SkRasterPipeline_UniformColorCtx* fColor      = nullptr;
+    bool                              fBounded    = true;
+    // Runs the color pipeline through to whatever the blitter memsets, if it can.
+    std::function<void(size_t, size_t, size_t, size_t)> fStoreMemsetColor;
+};
+
+struct BlitterCache {
+    static constexpr int kMaxEntries = 16;
+
+    SkLRUCache<uint32_t, std::unique_ptr<CachedBlitter>> fLRU{kMaxEntries};
+    // Number of cached blitters currently lent out on this thread. A draw can kick off other
+    // draws (e.g. rasterizing a color glyph) while its blitter is still in use; we don't touch
+    // the cache while that's happening, so we never patch or evict a blitter that's in use.
+    int fLent = 0;
+    // The SkOpts raster pipeline target the cached blitters were compiled for.
+    uint32_t fTargetGeneration = 0;
+};
+
+BlitterCache& thread_blitter_cache() {
+    static thread_local BlitterCache gCache;
+    return gCache;
+}
+
+std::atomic<int> gCacheHits{0},
+                 gCacheMisses{0};
+
+// Lives in the draw's arena and returns the cached blitter when the draw is done with it.
+struct BlitterLease {
+    ~BlitterLease() { thread_blitter_cache().fLent--; }
+};
+
+}  // namespace
+
+SkBlitter* SkRasterPipelineBlitter::CreateCached(const SkPixmap& dst,
+                                                 const SkPaint& paint,
+                                                 const SkColor4f& dstPaintColor,
+                                                 SkArenaAlloc* alloc) {
+    std::optional<SkBlendMode> mode = paint.asBlendMode();
+    if (!mode || paint.getColorFilter() || paint.getShader()) {
+        return nullptr;
+    }
+    BlitterCache& cache = thread_blitter_cache();
+    if (cache.fLent > 0) {
+        return nullptr;
+    }
+    // Cached pipelines hold on to the stage functions of the target they were compiled for.
+    if (uint32_t generation = SkOpts::RasterPipelineTargetGeneration();
+            generation != cache.fTargetGeneration) {
+        cache.fLRU.reset();
+        cache.fTargetGeneration = generation;
+    }
+
+    // This is the constant color Create() would end up with: premul, and clamped if dst is.
+    SkPMColor4f color = dstPaintColor.premul();
+    if (SkColorTypeIsNormalized(dst.colorType())) {
+        color = {SkTPin(color.fR, 0.0f, 1.0f), SkTPin(color.fG, 0.0f, 1.0f),
+                 SkTPin(color.fB, 0.0f, 1.0f), SkTPin(color.fA, 0.0f, 1.0f)};
+    }
+    const bool bounded = 0 <= color.fR && color.fR <= color.fA &&
+                         0 <= color.fG && color.fG <= color.fA &&
+                         0 <= color.fB && color.fB <= color.fA;
+
+    // We can strength-reduce SrcOver into Src when opaque.
+    if (color.fA == 1.0f && *mode == SkBlendMode::kSrcOver) {
+        mode = SkBlendMode::kSrc;
+    }
+
+    // Everything else that shapes the pipelines comes from the dst.
+    const bool hasColorSpace = dst.colorSpace() != nullptr;
+    const uint32_t key = (uint32_t)dst.colorType()
+                       | (uint32_t)dst.alphaType() <<  8
+                       | (uint32_t)*mode           << 16
+                       | (uint32_t)hasColorSpace   << 24
+                       | (uint32_t)bounded         << 25;
+
+    std::unique_ptr<CachedBlitter>* found = cache.fLRU.find(key);
+    CachedBlitter* entry;
+    if (found) {
+        gCacheHits.fetch_add(1, std::memory_order_relaxed);
+        entry = found->get();
+        entry->fBlitter->fDst = dst;
+    } else {
+        gCacheMisses.fetch_add(1, std::memory_order_relaxed);
+        entry = cache.fLRU.insert(key, std::make_unique<CachedBlitter>())->get();
+
+        auto blitter = entry->fAlloc.make<SkRasterPipelineBlitter>(dst, &entry->fAlloc);
+        entry->fBlitter = blitter;
+        entry->fBounded = bounded;
+        entry->fColor   = entry->fAlloc.make<SkRasterPipeline_UniformColorCtx>();
+        blitter->fColorPipeline.appendUniformColor(bounded, entry->fColor);
+        SkBlendMode_AppendStages(*mode, &blitter->fBlendPipeline);
+        blitter->fBlendMode = *mode;
+
+        if (*mode == SkBlendMode::kSrc &&
+            dst.info().bytesPerPixel() <= static_cast<int>(sizeof(blitter->fMemsetColor))) {
+            SkRasterPipeline p(&entry->fAlloc);
+            p.extend(blitter->fColorPipeline);
+            blitter->appendStore(&p);
+            entry->fStoreMemsetColor = p.compile();
+            blitter->fMemset2D = memset_2d_proc(dst);
+        }
+    }
+
+    SkRasterPipeline_UniformColorCtx* ctx = entry->fColor;
+    ctx->r = color.fR;
+    ctx->g = color.fG;
+    ctx->b = color.fB;
+    ctx->a = color.fA;
+    if (entry->fBounded) {
+        // To make loads more direct, we store 8-bit values in 16-bit slots.
+        ctx->rgba[0] = (uint16_t)(color.fR * 255.0f + 0.5f);
+        ctx->rgba[1] = (uint16_t)(color.fG * 255.0f + 0.5f);
+        ctx->rgba[2] = (uint16_t)(color.fB * 255.0f + 0.5f);
+        ctx->rgba[3] = (uint16_t)(color.fA * 255.0f + 0.5f);
+    }
+
+    SkRasterPipelineBlitter* blitter = entry->fBlitter;
+    if (entry->fStoreMemsetColor) {
+        blitter->fDstPtr = SkRasterPipeline_MemoryCtx{&blitter->fMemsetColor, 0};
+        entry->fStoreMemsetColor(0,0,1,1);
+    }
+    blitter->fDstPtr = SkRasterPipeline_MemoryCtx{
+        blitter->fDst.writable_addr(),
+        blitter->fDst.rowBytesAsPixels(),
+    };
+
+    cache.fLent++;
+    alloc->make<BlitterLease>();
+    return blitter;
+}
+
+SkRasterPipelineBlitterCacheStats SkGetRasterPipelineBlitterCacheStats() {
+    return {gCacheHits.load(std::memory_order_relaxed),
+            gCacheMisses.load(std::memory_order_relaxed)};
+}
+
 void SkRasterPipelineBlitter::appendLoadDst(SkRasterPipeline* p) const {
     p->appendLoadDst(fDst.info().colorType(), &fDstPtr);
     if (fDst.info().alphaType() == kUnpremul_SkAlphaType) {
@@ -453,18 +627,66 @@ void SkRasterPipelineBlitter::blitAntiH(int x, int y, const SkAlpha aa[], const
         fBlitAntiH = p.compile();
     }
 
+    // Partial coverage runs are typically very short (often one pixel each along an AA edge),
+    // so running fBlitAntiH once per run spends most of its time entering and leaving the
+    // pipeline. Instead we gather neighbouring partial runs, and any short transparent gaps
+    // between them, into one span of per-pixel coverage and blit it with the A8 mask pipeline
+    // in a single pass. Opaque runs still go through blitRect() so they can use its fast paths.
+    static constexpr int kMaxGapInSpan = 8;
+
+    int spanX     = x,
+        spanWidth = 0,
+        spanRuns  = 0,
+        gap       = 0;
+    SkAlpha spanAlpha = 0;   // The coverage of the first run in the span.
+
+    auto flushSpan = [&] {
+        if (spanRuns == 1) {
+            fCurrentCoverage = spanAlpha * (1/255.0f);
+            fBlitAntiH(spanX,y,spanWidth,1);
+        } else if (spanRuns > 1) {
+            SkIRect bounds = {spanX, y, spanX + spanWidth, y + 1};
+            SkMask mask(fAntiHCoverage, bounds, spanWidth, SkMask::kA8_Format);
+            this->blitMask(mask, bounds);
+        }
+        spanWidth = spanRuns = gap = 0;
+    };
+
     for (int16_t run = *runs; run > 0; run = *runs) {
         switch (*aa) {
-            case 0x00:                                break;
-            case 0xff:this->blitRectWithTrace(x,y,run, 1, false); break;
+            case 0x00:
+                if (spanRuns > 0) {
+                    gap += run;
+                    if (gap > kMaxGapInSpan) {
+                        flushSpan();
+                    }
+                }
+                break;
+            case 0xff:
+                flushSpan();
+                this->blitRectWithTrace(x,y,run, 1, false);
+                break;
             default:
-                fCurrentCoverage = *aa * (1/255.0f);
-                fBlitAntiH(x,y,run,1);
+                if (spanRuns == 0) {
+                    if (fAntiHCoverageCapacity < fDst.width()) {
+                        // A cached blitter may be reused with a wider dst than it first saw.
+                        fAntiHCoverage = fAlloc->makeArrayDefault<SkAlpha>(fDst.width());
+                        fAntiHCoverageCapacity = fDst.width();
+                    }
+                    spanX     = x;
+                    spanAlpha = *aa;
+                }
+                memset(fAntiHCoverage + spanWidth, 0x00, gap);
+                memset(fAntiHCoverage + spanWidth + gap, *aa, run);
+                spanWidth += gap + run;
+                spanRuns  += 1;
+                gap = 0;
         }
         x    += run;
         runs += run;
         aa   += run;
     }
+    flushSpan();
 }
 
 void SkRasterPipelineBlitter::blitAntiH2(int x, int y, U8CPU a0, U8CPU a1) {
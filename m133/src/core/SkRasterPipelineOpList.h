@@ -131,6 +131,8 @@
     M(mod_n_floats)       M(mod_float)    M(mod_2_floats)   M(mod_3_floats)   M(mod_4_floats)   \
     M(mix_n_floats)       M(mix_float)    M(mix_2_floats)   M(mix_3_floats)   M(mix_4_floats)   \
     M(mix_n_ints)         M(mix_int)      M(mix_2_ints)     M(mix_3_ints)     M(mix_4_ints)     \
+    M(mad_n_floats)       M(mad_float)    M(mad_2_floats)   M(mad_3_floats)   M(mad_4_floats)   \
+    M(clamp_n_floats)     M(clamp_float)  M(clamp_2_floats) M(clamp_3_floats) M(clamp_4_floats) \
     M(cmplt_imm_float)                                                                          \
         M(cmplt_n_floats) M(cmplt_float)  M(cmplt_2_floats) M(cmplt_3_floats) M(cmplt_4_floats) \
     M(cmplt_imm_int)                                                                            \
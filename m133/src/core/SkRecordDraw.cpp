@@ -10,33 +10,42 @@
 #include "include/core/SkBBHFactory.h"
 #include "include/core/SkBlendMode.h"
 #include "include/core/SkBlender.h"
+#include "include/core/SkCanvas.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkMatrix.h"
 #include "include/core/SkMesh.h"
 #include "include/core/SkPaint.h"
+#include "include/core/SkPixmap.h"
 #include "include/core/SkRRect.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkRegion.h"
 #include "include/core/SkScalar.h"
 #include "include/core/SkShader.h"
+#include "include/core/SkSize.h"
 #include "include/core/SkString.h"
+#include "include/core/SkSurfaceProps.h"
 #include "include/core/SkTextBlob.h"
 #include "include/core/SkVertices.h"
 #include "include/private/base/SkAssert.h"
 #include "include/private/base/SkPoint_impl.h"
 #include "include/private/base/SkTDArray.h"
 #include "include/private/base/SkTemplates.h"
+#include "include/private/base/SkTo.h"
 #include "include/private/chromium/Slug.h"
+#include "src/core/SkBigPicture.h"
 #include "src/core/SkCanvasPriv.h"
 #include "src/core/SkDrawShadowInfo.h"
 #include "src/core/SkImageFilter_Base.h"
+#include "src/core/SkPicturePriv.h"
 #include "src/core/SkRecord.h"
 #include "src/core/SkRecords.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/effects/colorfilters/SkColorFilterBase.h"
 #include "src/utils/SkPatchUtils.h"
 
 #include <algorithm>
+#include <memory>
 #include <optional>
 #include <vector>
 
@@ -89,6 +98,110 @@ void SkRecordDraw(const SkRecord& record,
 
 namespace SkRecords {
 
+// Tiles are replayed concurrently into the same pixels, so an op may only be tiled if it never
+// reads destination pixels outside of the tile it is drawing, and never widens the tile's clip.
+class TileIndependent {
+public:
+    TileIndependent(SkPicture const* const drawablePicts[], int drawableCount)
+            : fDrawablePicts(drawablePicts), fDrawableCount(drawableCount) {}
+
+    bool operator()(const SkRecords::SaveLayer& op) { return !op.backdrop; }
+    bool operator()(const SkRecords::SaveBehind&)   { return false; }
+    bool operator()(const SkRecords::DrawBehind&)   { return false; }
+    bool operator()(const SkRecords::ResetClip&)    { return false; }
+    bool operator()(const SkRecords::DrawPicture& op) {
+        const SkPaint* paint = op.paint;
+        return CheckPicture(op.picture.get(), /*clippedToCull=*/paint != nullptr);
+    }
+    bool operator()(const SkRecords::DrawDrawable& op) {
+        // Live drawables may not be safe to draw from several threads at once.
+        return op.index < fDrawableCount && fDrawablePicts &&
+               CheckPicture(fDrawablePicts[op.index], /*clippedToCull=*/false);
+    }
+    template <typename T>
+    bool operator()(const T&) { return true; }
+
+    static bool Check(const SkRecord& record, int count,
+                      SkPicture const* const drawablePicts[], int drawableCount) {
+        TileIndependent visitor(drawablePicts, drawableCount);
+        for (int i = 0; i < count; ++i) {
+            if (!record.visit(i, visitor)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    // Each tile quick-rejects a nested picture by its cull rect against the tile's clip, but once
+    // the picture isn't rejected its ops reach as far as the clip lets them, e.g. a clear() fills
+    // all of it. So tiles only agree with a single pass if the ops stay within the cull rect, or
+    // are drawn into a layer bounded by it, as they are when the picture is drawn with a paint.
+    static bool CheckPicture(const SkPicture* picture, bool clippedToCull) {
+        const SkBigPicture* bp = SkPicturePriv::AsSkBigPicture(sk_ref_sp(picture));
+        if (!bp) {
+            return true;
+        }
+        return (clippedToCull || !bp->drawsOutsideCullRect()) &&
+               Check(*bp->record(), bp->record()->count(),
+                     bp->drawablePicts(), bp->drawableCount());
+    }
+
+    SkPicture const* const* fDrawablePicts;
+    int                     fDrawableCount;
+};
+
+}  // namespace SkRecords
+
+void SkRecordDrawTiled(const SkRecord& record,
+                       int count,
+                       SkPicture const* const drawablePicts[],
+                       int drawableCount,
+                       const SkBBoxHierarchy* bbh,
+                       const SkPixmap& dst,
+                       const SkMatrix& matrix,
+                       const SkSurfaceProps& props,
+                       SkExecutor& executor,
+                       SkISize tileSize) {
+    SkASSERT(bbh);
+    SkASSERT(!tileSize.isEmpty());
+
+    const SkIRect dstBounds = dst.bounds();
+    std::vector<SkIRect> tiles;
+    if (SkRecords::TileIndependent::Check(record, count, drawablePicts, drawableCount)) {
+        for (int y = 0; y < dstBounds.height(); y += tileSize.height()) {
+            for (int x = 0; x < dstBounds.width(); x += tileSize.width()) {
+                SkIRect tile = SkIRect::MakeXYWH(x, y, tileSize.width(), tileSize.height());
+                SkAssertResult(tile.intersect(dstBounds));
+                tiles.push_back(tile);
+            }
+        }
+    } else {
+        tiles.push_back(dstBounds);
+    }
+
+    // Every tile draws through its own canvas on the shared pixels, in device space, so AA,
+    // dithering and shader evaluation see the same coordinates as an unclipped draw would.
+    // Tiles don't overlap, so there is nothing to merge afterwards.
+    auto drawTile = [&](int i) {
+        std::unique_ptr<SkCanvas> canvas = SkCanvas::MakeRasterDirect(
+                dst.info(), dst.writable_addr(), dst.rowBytes(), &props);
+        canvas->clipIRect(tiles[i]);
+        canvas->concat(matrix);
+        SkRecordDraw(record, canvas.get(), drawablePicts, nullptr, drawableCount, bbh, nullptr);
+    };
+
+    if (tiles.size() == 1) {
+        drawTile(0);
+    } else {
+        SkTaskGroup tg(executor);
+        tg.batch(SkToInt(tiles.size()), drawTile);
+        tg.wait();
+    }
+}
+
+namespace SkRecords {
+
 // NoOps draw nothing.
 template <> void Draw::draw(const NoOp&) {}
 
@@ -15,7 +15,12 @@
 #include "include/private/base/SkNoncopyable.h"
 
 class SkDrawable;
+class SkExecutor;
+class SkMatrix;
+class SkPixmap;
 class SkRecord;
+class SkSurfaceProps;
+struct SkISize;
 struct SkRect;
 
 // Calculate conservative identity space bounds for each op in the record.
@@ -27,6 +32,17 @@ void SkRecordDraw(const SkRecord&, SkCanvas*, SkPicture const* const drawablePic
                   SkDrawable* const drawables[], int drawableCount,
                   const SkBBoxHierarchy*, SkPicture::AbortCallback*);
 
+// Draw an SkRecord into the pixels of dst, concurrently on an SkExecutor.  dst is split into tiles
+// of tileSize; each tile replays, through its own canvas clipped to that tile, just the ops the
+// bbh finds there.  The bbh must only hold the first count ops.  Records that can't be split,
+// e.g. because a backdrop filter reads pixels from other tiles, are drawn as a single tile.
+// The result matches a single pass except along the anti-aliased edges of paths that cross a
+// tile, which the tile's clip can move by a fraction of a pixel.
+void SkRecordDrawTiled(const SkRecord&, int count,
+                       SkPicture const* const drawablePicts[], int drawableCount,
+                       const SkBBoxHierarchy*, const SkPixmap& dst, const SkMatrix&,
+                       const SkSurfaceProps&, SkExecutor&, SkISize tileSize);
+
 namespace SkRecords {
 
 // This is an SkRecord visitor that will draw that SkRecord to an SkCanvas.
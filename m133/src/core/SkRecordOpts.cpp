@@ -10,16 +10,25 @@
 #include "include/core/SkBlendMode.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
+#include "include/core/SkImage.h"
 #include "include/core/SkPaint.h"
+#include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkRegion.h"
+#include "include/core/SkSamplingOptions.h"
 #include "include/private/base/SkMath.h"
 #include "include/private/base/SkTemplates.h"
+#include "include/private/base/SkTo.h"
+#include "src/core/SkPaintPriv.h"
 #include "src/core/SkRecord.h"
 #include "src/core/SkRecordPattern.h"
 #include "src/core/SkRecords.h"
 
 #include <cstdint>
+#include <new>
 #include <optional>
+#include <utility>
+#include <vector>
 
 using namespace SkRecords;
 
@@ -266,7 +275,392 @@ void SkRecordMergeSvgOpacityAndFilterLayers(SkRecord* record) {
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
-void SkRecordOptimize(SkRecord* record) {
+// What a command does to the canvas state, as far as SkRecordNoopRedundantStateOps cares.
+struct StateOpKind {
+    enum Kind { kNoOp, kSetMatrix, kChangeMatrix, kClip, kRestore, kOther };
+
+    Kind operator()(const NoOp&)       { return kNoOp; }
+    Kind operator()(const Restore&)    { return kRestore; }
+    Kind operator()(const SetMatrix&)  { return kSetMatrix; }
+    Kind operator()(const SetM44&)     { return kSetMatrix; }
+    Kind operator()(const Concat&)     { return kChangeMatrix; }
+    Kind operator()(const Concat44&)   { return kChangeMatrix; }
+    Kind operator()(const Translate&)  { return kChangeMatrix; }
+    Kind operator()(const Scale&)      { return kChangeMatrix; }
+    Kind operator()(const ClipPath&)   { return kClip; }
+    Kind operator()(const ClipRRect&)  { return kClip; }
+    Kind operator()(const ClipRect&)   { return kClip; }
+    Kind operator()(const ClipRegion&) { return kClip; }
+    Kind operator()(const ClipShader&) { return kClip; }
+    template <typename T>
+    Kind operator()(const T&)          { return kOther; }
+};
+
+// Finds the rect of a non-AA intersecting ClipRect, or nullptr for any other command.
+struct NonAAIntersectClipRect {
+    const SkRect* operator()(const ClipRect& op) {
+        return op.opAA.op() == SkClipOp::kIntersect && !op.opAA.aa() ? &op.rect : nullptr;
+    }
+    template <typename T>
+    const SkRect* operator()(const T&) { return nullptr; }
+};
+
+int SkRecordNoopRedundantStateOps(SkRecord* record) {
+    int removed = 0;
+
+    // Walking backwards, a matrix change is dead if the matrix is replaced or restored before
+    // anything uses it, and a clip is dead if it's restored before anything draws. SkRecordDraw
+    // restores the canvas when it's done, so everything left at the end of the record is dead too.
+    // Clips use the matrix, and we play safe and assume every other command uses both.
+    bool matrixDead = true,
+         clipDead   = true;
+    for (int i = record->count() - 1; i >= 0; i--) {
+        switch (record->visit(i, StateOpKind())) {
+            case StateOpKind::kNoOp:
+                break;
+            case StateOpKind::kRestore:
+                matrixDead = clipDead = true;
+                break;
+            case StateOpKind::kSetMatrix:
+                if (matrixDead) {
+                    record->replace<NoOp>(i);
+                    removed++;
+                }
+                matrixDead = true;
+                break;
+            case StateOpKind::kChangeMatrix:
+                if (matrixDead) {
+                    record->replace<NoOp>(i);
+                    removed++;
+                }
+                break;
+            case StateOpKind::kClip:
+                if (clipDead) {
+                    record->replace<NoOp>(i);
+                    removed++;
+                } else {
+                    matrixDead = false;
+                }
+                break;
+            case StateOpKind::kOther:
+                matrixDead = clipDead = false;
+                break;
+        }
+    }
+
+    // Within a run of clips with no matrix changes in between, intersecting with a rect that
+    // contains another rect of the run does nothing. This only holds exactly for non-AA clips;
+    // AA clips of the same rect still multiply their coverage together.
+    for (int begin = 0; begin < record->count();) {
+        int end = begin;
+        bool hasRectClips = false;
+        for (; end < record->count(); end++) {
+            StateOpKind::Kind kind = record->visit(end, StateOpKind());
+            if (kind != StateOpKind::kClip && kind != StateOpKind::kNoOp) {
+                break;
+            }
+            hasRectClips |= record->visit(end, NonAAIntersectClipRect()) != nullptr;
+        }
+        for (int i = begin; hasRectClips && i < end; i++) {
+            const SkRect* outer = record->visit(i, NonAAIntersectClipRect());
+            if (!outer) {
+                continue;
+            }
+            for (int j = begin; j < end; j++) {
+                const SkRect* inner = record->visit(j, NonAAIntersectClipRect());
+                // Of two identical clips, keep the first.
+                if (j != i && inner && outer->contains(*inner) && (*inner != *outer || j < i)) {
+                    record->replace<NoOp>(i);
+                    removed++;
+                    break;
+                }
+            }
+        }
+        begin = end + 1;
+    }
+    return removed;
+}
+
+// How a draw can hide the draws before it, or be hidden by the draws after it.
+struct OcclusionInfo {
+    enum Covers { kNothing, kEverything, kBounds };
+    Covers covers = kNothing;
+    // The local bounds covered opaquely if covers is kBounds.
+    SkRect coverBounds = SkRect::MakeEmpty();
+    // Whether a later draw can hide this one, and if so, the local bounds it may draw to. Draws
+    // with infinite or unknown bounds can only be hidden by draws that cover everything.
+    bool occludable = false;
+    std::optional<SkRect> bounds;
+};
+
+struct ComputeOcclusionInfo {
+    // Returns the bounds of a non-AA draw of rect with paint, if they're known and no larger than
+    // the pixels it could touch.
+    static std::optional<SkRect> NonAABounds(const SkPaint* paint, const SkRect& rect) {
+        if (!paint) {
+            return rect.makeSorted();
+        }
+        // Hairlines are a pixel wide whatever the matrix is, so their local bounds aren't enough.
+        if (paint->isAntiAlias() || paint->getMaskFilter() || paint->getImageFilter() ||
+            (paint->getStyle() != SkPaint::kFill_Style && paint->getStrokeWidth() == 0) ||
+            !paint->canComputeFastBounds()) {
+            return std::nullopt;
+        }
+        SkRect storage;
+        return paint->computeFastBounds(rect.makeSorted(), &storage);
+    }
+
+    static OcclusionInfo Occludable(std::optional<SkRect> bounds) {
+        OcclusionInfo info;
+        info.occludable = true;
+        info.bounds = bounds;
+        return info;
+    }
+
+    OcclusionInfo operator()(const DrawPaint& op) {
+        OcclusionInfo info = Occludable(std::nullopt);
+        if (SkPaintPriv::Overwrites(&op.paint, SkPaintPriv::kNone_ShaderOverrideOpacity) &&
+            !op.paint.getMaskFilter() && !op.paint.getImageFilter()) {
+            info.covers = OcclusionInfo::kEverything;
+        }
+        return info;
+    }
+    OcclusionInfo operator()(const DrawRect& op) {
+        OcclusionInfo info = Occludable(NonAABounds(&op.paint, op.rect));
+        if (SkPaintPriv::Overwrites(&op.paint, SkPaintPriv::kNone_ShaderOverrideOpacity) &&
+            op.paint.getStyle() == SkPaint::kFill_Style && !op.paint.isAntiAlias() &&
+            !op.paint.getPathEffect() && !op.paint.getMaskFilter() &&
+            !op.paint.getImageFilter() && op.rect.isFinite()) {
+            info.covers = OcclusionInfo::kBounds;
+            info.coverBounds = op.rect.makeSorted();
+        }
+        return info;
+    }
+    OcclusionInfo operator()(const DrawRRect& op) {
+        return Occludable(NonAABounds(&op.paint, op.rrect.getBounds()));
+    }
+    OcclusionInfo operator()(const DrawDRRect& op) {
+        return Occludable(NonAABounds(&op.paint, op.outer.getBounds()));
+    }
+    OcclusionInfo operator()(const DrawOval& op) {
+        return Occludable(NonAABounds(&op.paint, op.oval));
+    }
+    OcclusionInfo operator()(const DrawPath& op) {
+        return Occludable(op.path.isInverseFillType()
+                                  ? std::nullopt
+                                  : NonAABounds(&op.paint, op.path.getBounds()));
+    }
+    OcclusionInfo operator()(const DrawRegion& op) {
+        return Occludable(NonAABounds(&op.paint, SkRect::Make(op.region.getBounds())));
+    }
+    OcclusionInfo operator()(const DrawImage& op) {
+        return Occludable(NonAABounds(op.paint, SkRect::MakeXYWH(op.left, op.top,
+                                                                 op.image->width(),
+                                                                 op.image->height())));
+    }
+    OcclusionInfo operator()(const DrawImageRect& op) {
+        return Occludable(NonAABounds(op.paint, op.dst));
+    }
+    // Pictures and drawables may annotate as well as draw, so we never cull them.
+    OcclusionInfo operator()(const DrawPicture&)  { return OcclusionInfo(); }
+    OcclusionInfo operator()(const DrawDrawable&) { return OcclusionInfo(); }
+    // Other draws can only be hidden by draws that cover everything.
+    template <typename T>
+    std::enable_if_t<(T::kTags & kDraw_Tag) != 0, OcclusionInfo> operator()(const T&) {
+        return Occludable(std::nullopt);
+    }
+    template <typename T>
+    std::enable_if_t<(T::kTags & kDraw_Tag) == 0, OcclusionInfo> operator()(const T&) {
+        return OcclusionInfo();
+    }
+};
+
+int SkRecordCullOccludedDraws(SkRecord* record) {
+    // Bounds the work done for long runs of draws that don't hide each other.
+    static constexpr size_t kMaxRunLength = 256;
+
+    struct Draw {
+        int index;
+        std::optional<SkRect> bounds;
+    };
+    std::vector<Draw> run;
+    int culled = 0;
+    for (int i = 0; i < record->count(); i++) {
+        Is<NoOp> isNoOp;
+        Is<DrawAnnotation> isAnnotation;
+        Is<DrawBehind> isDrawBehind;
+        if (record->mutate(i, isNoOp) || record->mutate(i, isAnnotation)) {
+            // Annotations don't draw, and are never culled.
+            continue;
+        }
+        OcclusionInfo info = record->visit(i, ComputeOcclusionInfo());
+        if (!info.occludable || record->mutate(i, isDrawBehind)) {
+            // Any change of state, and draws we can't cull, end the run.
+            run.clear();
+            continue;
+        }
+
+        if (info.covers == OcclusionInfo::kEverything) {
+            for (const Draw& draw : run) {
+                record->replace<NoOp>(draw.index);
+            }
+            culled += SkToInt(run.size());
+            run.clear();
+        } else if (info.covers == OcclusionInfo::kBounds) {
+            size_t kept = 0;
+            for (const Draw& draw : run) {
+                if (draw.bounds && info.coverBounds.contains(*draw.bounds)) {
+                    record->replace<NoOp>(draw.index);
+                    culled++;
+                } else {
+                    run[kept++] = draw;
+                }
+            }
+            run.resize(kept);
+        }
+
+        if (run.size() == kMaxRunLength) {
+            run.erase(run.begin());
+        }
+        run.push_back({i, info.bounds});
+    }
+    return culled;
+}
+
+// A DrawRect's paint that draws the same as a DrawRegion's when the region is made of its rect.
+static bool can_merge_into_region(const SkPaint& paint) {
+    return paint.getStyle() == SkPaint::kFill_Style && !paint.isAntiAlias() &&
+           !paint.getPathEffect() && !paint.getMaskFilter() && !paint.getImageFilter();
+}
+
+static bool is_integer_rect(const SkRect& rect, SkIRect* irect) {
+    *irect = rect.round();
+    return !irect->isEmpty() && SkRect::Make(*irect) == rect;
+}
+
+int SkRecordMergeDrawRects(SkRecord* record) {
+    // SkRegion gets slower to build as it grows, so don't let it grow without bound.
+    static constexpr size_t kMaxMergedDraws = 128;
+
+    int merged = 0;
+    for (int begin = 0; begin < record->count(); begin++) {
+        Is<DrawRect> first;
+        SkIRect irect;
+        if (!record->mutate(begin, first) || !can_merge_into_region(first.get()->paint) ||
+            !is_integer_rect(first.get()->rect, &irect)) {
+            continue;
+        }
+
+        // The rects must not overlap, or the region would draw their intersection only once.
+        SkRegion region(irect);
+        std::vector<int> others;
+        int end = begin + 1;
+        for (; end < record->count() && others.size() < kMaxMergedDraws; end++) {
+            Is<NoOp> isNoOp;
+            Is<DrawRect> next;
+            if (record->mutate(end, isNoOp)) {
+                continue;
+            }
+            if (!record->mutate(end, next) || next.get()->paint != first.get()->paint ||
+                !is_integer_rect(next.get()->rect, &irect) || region.intersects(irect)) {
+                break;
+            }
+            region.op(irect, SkRegion::kUnion_Op);
+            others.push_back(end);
+        }
+
+        if (!others.empty()) {
+            SkPaint paint = first.get()->paint;
+            new (record->replace<DrawRegion>(begin)) DrawRegion{std::move(paint), region};
+            for (int i : others) {
+                record->replace<NoOp>(i);
+            }
+            merged += SkToInt(others.size());
+        }
+        begin = end - 1;
+    }
+    return merged;
+}
+
+// A DrawImageRect's paint that draws the same when it's used for a DrawEdgeAAImageSet.
+static bool can_merge_into_image_set(const SkPaint* paint) {
+    return !paint || (!paint->getMaskFilter() && !paint->getImageFilter());
+}
+
+// Whether SkCanvas::drawImageRect() would draw op, rather than skip it.
+static bool draws_image(const DrawImageRect& op) {
+    return op.image && op.src.isFinite() && !op.src.isEmpty() &&
+           op.dst.isFinite() && !op.dst.isEmpty();
+}
+
+static bool same_image_paint(const SkPaint* a, const SkPaint* b) {
+    return a == b || (a && b && *a == *b);
+}
+
+int SkRecordMergeDrawImageRects(SkRecord* record) {
+    int merged = 0;
+    for (int begin = 0; begin < record->count(); begin++) {
+        Is<DrawImageRect> first;
+        if (!record->mutate(begin, first) || !can_merge_into_image_set(first.get()->paint) ||
+            !draws_image(*first.get())) {
+            continue;
+        }
+
+        std::vector<int> draws = {begin};
+        int end = begin + 1;
+        for (; end < record->count(); end++) {
+            Is<NoOp> isNoOp;
+            Is<DrawImageRect> next;
+            if (record->mutate(end, isNoOp)) {
+                continue;
+            }
+            if (!record->mutate(end, next) || !draws_image(*next.get()) ||
+                !same_image_paint(next.get()->paint, first.get()->paint) ||
+                next.get()->sampling != first.get()->sampling ||
+                next.get()->constraint != first.get()->constraint) {
+                break;
+            }
+            draws.push_back(end);
+        }
+
+        if (draws.size() > 1) {
+            const SkPaint* firstPaint = first.get()->paint;
+            // Each entry is drawn with the set's paint, anti-aliased only if all edges are.
+            const unsigned aaFlags = firstPaint && firstPaint->isAntiAlias()
+                                             ? SkCanvas::kAll_QuadAAFlags
+                                             : SkCanvas::kNone_QuadAAFlags;
+            SkPaint* paint = firstPaint ? new (record->alloc<SkPaint>()) SkPaint(*firstPaint)
+                                        : nullptr;
+            const SkSamplingOptions sampling = first.get()->sampling;
+            const SkCanvas::SrcRectConstraint constraint = first.get()->constraint;
+
+            skia_private::AutoTArray<SkCanvas::ImageSetEntry> set(draws.size());
+            for (size_t i = 0; i < draws.size(); i++) {
+                Is<DrawImageRect> draw;
+                record->mutate(draws[i], draw);
+                set[i] = SkCanvas::ImageSetEntry(draw.get()->image, draw.get()->src,
+                                                 draw.get()->dst, /*matrixIndex=*/-1,
+                                                 /*alpha=*/1.f, aaFlags, /*hasClip=*/false);
+            }
+            for (size_t i = 1; i < draws.size(); i++) {
+                record->replace<NoOp>(draws[i]);
+            }
+            new (record->replace<DrawEdgeAAImageSet>(begin))
+                    DrawEdgeAAImageSet{paint, std::move(set), SkToInt(draws.size()),
+                                       nullptr, nullptr, sampling, constraint};
+            merged += SkToInt(draws.size()) - 1;
+        }
+        begin = end - 1;
+    }
+    return merged;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+void SkRecordOptimize(SkRecord* record, SkPictureRecorder::OptimizationStats* stats,
+                      bool cullOccludedDraws) {
+    const int recordedOps = record->count();
+
     // This might be useful  as a first pass in the future if we want to weed
     // out junk for other optimization passes.  Right now, nothing needs it,
     // and the bounding box hierarchy will do the work of skipping no-op
@@ -284,5 +678,19 @@ void SkRecordOptimize(SkRecord* record) {
 #endif
     SkRecordMergeSvgOpacityAndFilterLayers(record);
 
+    // Dropping dead state changes first lets more draws end up next to each other, and culling
+    // before merging saves merging draws that would be culled anyway.
+    const int redundantStateOps = SkRecordNoopRedundantStateOps(record);
+    const int culledDraws = cullOccludedDraws ? SkRecordCullOccludedDraws(record) : 0;
+    const int mergedDraws = SkRecordMergeDrawRects(record) + SkRecordMergeDrawImageRects(record);
+
     record->defrag();
+
+    if (stats) {
+        stats->fRecordedOps       = recordedOps;
+        stats->fRemovedOps        = recordedOps - record->count();
+        stats->fMergedDraws       = mergedDraws;
+        stats->fCulledDraws       = culledDraws;
+        stats->fRedundantStateOps = redundantStateOps;
+    }
 }
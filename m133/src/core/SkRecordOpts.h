@@ -8,10 +8,15 @@
 #ifndef SkRecordOpts_DEFINED
 #define SkRecordOpts_DEFINED
 
+#include "include/core/SkPictureRecorder.h"
+
 class SkRecord;
 
-// Run all optimizations in recommended order.
-void SkRecordOptimize(SkRecord*);
+// Run all optimizations in recommended order. If stats is not null, it's filled in with what they
+// removed. Culling occluded draws is only exact if the record is never played back under an
+// anti-aliased clip, so it's only done when asked for.
+void SkRecordOptimize(SkRecord*, SkPictureRecorder::OptimizationStats* stats = nullptr,
+                      bool cullOccludedDraws = false);
 
 // Turns logical no-op Save-[non-drawing command]*-Restore patterns into actual no-ops.
 void SkRecordNoopSaveRestores(SkRecord*);
@@ -26,4 +31,20 @@ void SkRecordNoopSaveLayerDrawRestores(SkRecord*);
 // the alpha of the first SaveLayer to the second SaveLayer.
 void SkRecordMergeSvgOpacityAndFilterLayers(SkRecord*);
 
+// No-ops matrix and clip changes that nothing after them uses, and intersecting rect clips that
+// contain another rect clip made at the same time. Returns the number of commands no-oped.
+int SkRecordNoopRedundantStateOps(SkRecord*);
+
+// No-ops draws that a later opaque DrawPaint or non-AA DrawRect completely covers, as long as
+// nothing but draws come in between. Returns the number of draws no-oped.
+int SkRecordCullOccludedDraws(SkRecord*);
+
+// Merges runs of DrawRects with the same simple paint and disjoint integer rects into a single
+// DrawRegion. Returns the number of draws merged away.
+int SkRecordMergeDrawRects(SkRecord*);
+
+// Merges runs of DrawImageRects with the same paint and sampling into a single
+// DrawEdgeAAImageSet. Returns the number of draws merged away.
+int SkRecordMergeDrawImageRects(SkRecord*);
+
 #endif//SkRecordOpts_DEFINED
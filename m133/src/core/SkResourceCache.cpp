@@ -15,9 +15,9 @@
 #include "include/private/base/SkDebug.h"
 #include "include/private/base/SkMalloc.h"
 #include "include/private/base/SkMath.h"
-#include "include/private/base/SkMutex.h"
 #include "include/private/base/SkTArray.h"
 #include "include/private/base/SkTo.h"
+#include "src/base/SkSharedMutex.h"
 #include "src/core/SkCachedData.h"
 #include "src/core/SkChecksum.h"
 #include "src/core/SkImageFilter_Base.h"
@@ -29,6 +29,7 @@
 #endif
 
 #include <algorithm>
+#include <atomic>
 
 using namespace skia_private;
 
@@ -96,6 +97,8 @@ void SkResourceCache::init() {
     fTotalBytesUsed = 0;
     fCount = 0;
     fSingleAllocationByteLimit = 0;
+    fEvictionPolicy = EvictionPolicy::kLRU;
+    fPriorityFloor = 0;
 
     // One of these should be explicit set by the caller after we return.
     fTotalByteLimit = 0;
@@ -133,6 +136,7 @@ bool SkResourceCache::find(const Key& key, FindVisitor visitor, void* context) {
         Rec* rec = *found;
         if (visitor(*rec, context)) {
             this->moveToHead(rec);  // for our LRU
+            this->updatePriority(rec);
             return true;
         } else {
             this->remove(rec);  // stale
@@ -174,6 +178,8 @@ void SkResourceCache::add(Rec* rec, void* payload) {
 
     this->addToHead(rec);
     fHash->set(rec);
+    rec->fUseCount = 0;
+    this->updatePriority(rec);
     rec->postAddInstall(payload);
 
     if (gDumpCacheTransactions) {
@@ -224,6 +230,18 @@ void SkResourceCache::purgeAsNeeded(bool forcePurge) {
         byteLimit = fTotalByteLimit;
     }
 
+    if (fEvictionPolicy == EvictionPolicy::kCostAware && !forcePurge) {
+        while (fTotalBytesUsed >= byteLimit || fCount >= countLimit) {
+            Rec* victim = this->findCostAwareVictim();
+            if (!victim) {
+                break;
+            }
+            fPriorityFloor = victim->fPriority;
+            this->remove(victim);
+        }
+        return;
+    }
+
     Rec* rec = fTail;
     while (rec) {
         if (!forcePurge && fTotalBytesUsed < byteLimit && fCount < countLimit) {
@@ -231,13 +249,59 @@ void SkResourceCache::purgeAsNeeded(bool forcePurge) {
         }
 
         Rec* prev = rec->fPrev;
-        if (rec->canBePurged()) {
+        if (!this->promoteIfUsed(rec) && rec->canBePurged()) {
             this->remove(rec);
         }
         rec = prev;
     }
 }
 
+bool SkResourceCache::promoteIfUsed(Rec* rec) {
+    if (!rec->fUsed.exchange(false, std::memory_order_relaxed)) {
+        return false;
+    }
+    this->moveToHead(rec);
+    this->updatePriority(rec);
+    return true;
+}
+
+/*
+ *  The cost-aware policy is a sampled GreedyDual-Size-Frequency: a rec's priority is how long it
+ *  took to make per byte of cache it occupies, times how often it has been used (up to a point),
+ *  on top of the priority floor at the time it was last used. Rather than keep the recs sorted by
+ *  priority, we only consider the least recently used few, and purge the one with the lowest
+ *  priority. Recs of unknown cost are purged in LRU order ahead of any with a known cost.
+ */
+static constexpr int      kCostAwareCandidates = 8;
+static constexpr uint32_t kMaxUseCount = 16;
+
+void SkResourceCache::updatePriority(Rec* rec) {
+    rec->fUseCount = std::min(rec->fUseCount + 1, kMaxUseCount);
+    const size_t bytes = std::max<size_t>(rec->bytesUsed(), 1);
+    rec->fPriority = fPriorityFloor + rec->fUseCount * rec->cost() / bytes;
+}
+
+SkResourceCache::Rec* SkResourceCache::findCostAwareVictim() {
+    Rec* victim = nullptr;
+    int candidates = 0;
+    for (Rec* rec = fTail, *prev; rec && candidates < kCostAwareCandidates; rec = prev) {
+        prev = rec->fPrev;
+        if (!this->promoteIfUsed(rec) && rec->canBePurged()) {
+            candidates += 1;
+            if (!victim || rec->fPriority < victim->fPriority) {
+                victim = rec;
+            }
+        }
+    }
+    return victim;
+}
+
+SkResourceCache::EvictionPolicy SkResourceCache::setEvictionPolicy(EvictionPolicy policy) {
+    EvictionPolicy prevPolicy = fEvictionPolicy;
+    fEvictionPolicy = policy;
+    return prevPolicy;
+}
+
 //#define SK_TRACK_PURGE_SHAREDID_HITRATE
 
 #ifdef SK_TRACK_PURGE_SHAREDID_HITRATE
@@ -463,99 +527,320 @@ void SkResourceCache::checkMessages() {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-static SkResourceCache* gResourceCache = nullptr;
-static SkMutex& resource_cache_mutex() {
-    static SkMutex& mutex = *(new SkMutex);
-    return mutex;
+#ifndef SK_RESOURCE_CACHE_SHARD_COUNT
+    #define SK_RESOURCE_CACHE_SHARD_COUNT    4
+#endif
+
+/*
+ *  The global cache is split into shards by key hash. Each shard is a separate SkResourceCache
+ *  with its own lock and LRU list, so threads working with unrelated keys rarely wait on each
+ *  other. Finding a key's shard doesn't take any lock.
+ *
+ *  Find() only takes its shard's lock shared, so threads looking up the same shard don't wait on
+ *  each other either. Instead of moving a rec it finds to the head of the LRU, it marks the rec
+ *  as used, and the shard moves it once it next looks for recs to purge. Find() still takes the
+ *  lock exclusively to purge a stale rec, or after PostPurgeSharedID().
+ *
+ *  The shards share the total byte limit. Each may always use an equal slice of it, and may
+ *  borrow whatever the other shards leave unused, so a single entry can be as large as the
+ *  whole budget. An entry larger than its shard's slice first makes room across all the shards,
+ *  instead of flushing everything else in the shard it lands in. When the other shards later
+ *  need their slices back, the shards that borrowed are purged until the total fits again.
+ *
+ *  Defining SK_RESOURCE_CACHE_SHARD_COUNT as 1 gives back a single cache with a single LRU.
+ */
+namespace {
+struct Shard {
+    SkSharedMutex         fMutex;
+    SkResourceCache*      fCache = nullptr;
+    // Mirrors fCache->getTotalBytesUsed(), so other shards can see it without taking fMutex.
+    std::atomic<size_t>   fBytesUsed{0};
+    // Counted by Find() while only holding fMutex shared.
+    std::atomic<uint64_t> fHits{0};
+    std::atomic<uint64_t> fMisses{0};
+    // The value of gPurgeMessagesPosted when Find() last read the shard's purge messages.
+    std::atomic<uint32_t> fPurgeMessagesSeen{0};
+};
+}  // namespace
+
+static constexpr int kShardCount = SK_RESOURCE_CACHE_SHARD_COUNT;
+static_assert(kShardCount > 0, "SK_RESOURCE_CACHE_SHARD_COUNT must be positive");
+
+#ifdef SK_USE_DISCARDABLE_SCALEDIMAGECACHE
+static constexpr bool kByteBudget = false;  // Discardable memory is purged by count instead.
+#else
+static constexpr bool kByteBudget = true;
+#endif
+
+// Counts PostPurgeSharedID() calls, so Find() can tell when its shard has messages to read.
+static std::atomic<uint32_t> gPurgeMessagesPosted{0};
+
+static std::atomic<size_t> gTotalByteLimit{kByteBudget ? SK_DEFAULT_IMAGE_CACHE_LIMIT : 0};
+
+// Splits totalLimit as evenly as possible, so the shard slices always add up to it.
+static size_t shard_byte_limit(size_t totalLimit, int index) {
+    return totalLimit / kShardCount + (SkToSizeT(index) < totalLimit % kShardCount ? 1 : 0);
 }
 
-/** Must hold resource_cache_mutex() when calling. */
-static SkResourceCache* get_cache() {
-    // resource_cache_mutex() is always held when this is called, so we don't need to be fancy in here.
-    resource_cache_mutex().assertHeld();
-    if (nullptr == gResourceCache) {
+static Shard* shards() {
+    static Shard* gShards = [] {
+        Shard* shards = new Shard[kShardCount];
+        for (int i = 0; i < kShardCount; ++i) {
 #ifdef SK_USE_DISCARDABLE_SCALEDIMAGECACHE
-        gResourceCache = new SkResourceCache(SkDiscardableMemory::Create);
+            shards[i].fCache = new SkResourceCache(SkDiscardableMemory::Create);
 #else
-        gResourceCache = new SkResourceCache(SK_DEFAULT_IMAGE_CACHE_LIMIT);
+            shards[i].fCache = new SkResourceCache(
+                    shard_byte_limit(SK_DEFAULT_IMAGE_CACHE_LIMIT, i));
 #endif
+        }
+        return shards;
+    }();
+    return gShards;
+}
+
+static int shard_index(const SkResourceCache::Key& key) {
+    // Use the high bits of the hash, since the shard's hash table indexes with the low bits.
+    return (int)(((uint64_t)key.hash() * kShardCount) >> 32);
+}
+
+// Call with the shard's mutex held, after anything that may have changed its size.
+static void update_bytes_used(Shard& shard) {
+    shard.fBytesUsed.store(shard.fCache->getTotalBytesUsed(), std::memory_order_relaxed);
+}
+
+// What all the shards but the one at except use, as of recently.
+static size_t bytes_used(int except = -1) {
+    size_t used = 0;
+    for (int i = 0; i < kShardCount; ++i) {
+        if (i != except) {
+            used += shards()[i].fBytesUsed.load(std::memory_order_relaxed);
+        }
+    }
+    return used;
+}
+
+template <typename Fn>
+static void for_each_shard(Fn&& fn) {
+    for (int i = 0; i < kShardCount; ++i) {
+        Shard& shard = shards()[i];
+        SkAutoSharedMutexExclusive am(shard.fMutex);
+        fn(i, shard.fCache);
+        update_bytes_used(shard);
+    }
+}
+
+// Purges at least bytes from the shards, an equal part from each, starting with the one at
+// first. Whatever part a shard can't free is left to the ones after it.
+static void make_room(size_t bytes, int first) {
+    for (int n = 0; n < kShardCount && bytes > 0; ++n) {
+        Shard& shard = shards()[(first + n) % kShardCount];
+        const size_t part = (bytes + (kShardCount - n) - 1) / (kShardCount - n);
+
+        SkAutoSharedMutexExclusive am(shard.fMutex);
+        SkResourceCache* cache = shard.fCache;
+        const size_t used = cache->getTotalBytesUsed();
+        // Lowering the limit purges down to it; then put the limit back.
+        cache->setTotalByteLimit(cache->setTotalByteLimit(used - std::min(used, part)));
+        update_bytes_used(shard);
+        bytes -= std::min(bytes, used - cache->getTotalBytesUsed());
+    }
+}
+
+// Purges the shards that use more than their slice of totalLimit, but not below their slice,
+// until all the shards fit in it together. Shards within their slice are left alone, since they
+// only use what they are owed.
+static void reclaim_borrowed(size_t totalLimit) {
+    for (int i = 0; i < kShardCount; ++i) {
+        const size_t used = bytes_used();
+        if (used <= totalLimit) {
+            return;
+        }
+        Shard& shard = shards()[i];
+        const size_t slice = shard_byte_limit(totalLimit, i);
+        if (shard.fBytesUsed.load(std::memory_order_relaxed) <= slice) {
+            continue;
+        }
+
+        SkAutoSharedMutexExclusive am(shard.fMutex);
+        SkResourceCache* cache = shard.fCache;
+        const size_t shardUsed = cache->getTotalBytesUsed();
+        if (shardUsed > slice) {
+            // The lowered limit stays until the shard next adds and sees what it may borrow.
+            cache->setTotalByteLimit(
+                    std::max(slice, shardUsed - std::min(shardUsed, used - totalLimit)));
+            update_bytes_used(shard);
+        }
     }
-    return gResourceCache;
 }
 
 size_t SkResourceCache::GetTotalBytesUsed() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->getTotalBytesUsed();
+    size_t used = 0;
+    for_each_shard([&](int, SkResourceCache* cache) { used += cache->getTotalBytesUsed(); });
+    return used;
 }
 
 size_t SkResourceCache::GetTotalByteLimit() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->getTotalByteLimit();
+    return gTotalByteLimit.load(std::memory_order_relaxed);
 }
 
 size_t SkResourceCache::SetTotalByteLimit(size_t newLimit) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->setTotalByteLimit(newLimit);
+    const size_t prevLimit = gTotalByteLimit.exchange(newLimit, std::memory_order_relaxed);
+    // Take back anything borrowed, so the shards fit in the new limit together.
+    for_each_shard([&](int i, SkResourceCache* cache) {
+        cache->setTotalByteLimit(shard_byte_limit(newLimit, i));
+    });
+    return prevLimit;
 }
 
 SkResourceCache::DiscardableFactory SkResourceCache::GetDiscardableFactory() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->discardableFactory();
+    Shard& shard = shards()[0];
+    SkAutoSharedMutexExclusive am(shard.fMutex);
+    return shard.fCache->discardableFactory();
 }
 
 SkCachedData* SkResourceCache::NewCachedData(size_t bytes) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->newCachedData(bytes);
+    Shard& shard = shards()[0];
+    SkAutoSharedMutexExclusive am(shard.fMutex);
+    return shard.fCache->newCachedData(bytes);
 }
 
 void SkResourceCache::Dump() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    get_cache()->dump();
+    for_each_shard([](int, SkResourceCache* cache) { cache->dump(); });
 }
 
 size_t SkResourceCache::SetSingleAllocationByteLimit(size_t size) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->setSingleAllocationByteLimit(size);
+    size_t prevLimit = 0;
+    for_each_shard([&](int i, SkResourceCache* cache) {
+        size_t prev = cache->setSingleAllocationByteLimit(size);
+        if (i == 0) {
+            prevLimit = prev;
+        }
+    });
+    return prevLimit;
 }
 
 size_t SkResourceCache::GetSingleAllocationByteLimit() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->getSingleAllocationByteLimit();
+    Shard& shard = shards()[0];
+    SkAutoSharedMutexExclusive am(shard.fMutex);
+    return shard.fCache->getSingleAllocationByteLimit();
 }
 
 size_t SkResourceCache::GetEffectiveSingleAllocationByteLimit() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->getEffectiveSingleAllocationByteLimit();
+    // Like getEffectiveSingleAllocationByteLimit(), but capped to the whole budget rather than
+    // one shard's slice of it, since an entry can borrow from the other shards.
+    size_t limit = GetSingleAllocationByteLimit();
+    if (kByteBudget) {
+        const size_t totalLimit = GetTotalByteLimit();
+        limit = limit == 0 ? totalLimit : std::min(limit, totalLimit);
+    }
+    return limit;
+}
+
+SkResourceCache::EvictionPolicy SkResourceCache::GetEvictionPolicy() {
+    Shard& shard = shards()[0];
+    SkAutoSharedMutexExclusive am(shard.fMutex);
+    return shard.fCache->getEvictionPolicy();
+}
+
+SkResourceCache::EvictionPolicy SkResourceCache::SetEvictionPolicy(EvictionPolicy policy) {
+    EvictionPolicy prevPolicy = EvictionPolicy::kLRU;
+    for_each_shard([&](int i, SkResourceCache* cache) {
+        EvictionPolicy prev = cache->setEvictionPolicy(policy);
+        if (i == 0) {
+            prevPolicy = prev;
+        }
+    });
+    return prevPolicy;
 }
 
 void SkResourceCache::PurgeAll() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->purgeAll();
+    for_each_shard([](int, SkResourceCache* cache) { cache->purgeAll(); });
 }
 
 void SkResourceCache::CheckMessages() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->checkMessages();
+    for_each_shard([](int, SkResourceCache* cache) { cache->checkMessages(); });
 }
 
 bool SkResourceCache::Find(const Key& key, FindVisitor visitor, void* context) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->find(key, visitor, context);
+    Shard& shard = shards()[shard_index(key)];
+    const uint32_t purgeMessagesPosted = gPurgeMessagesPosted.load(std::memory_order_acquire);
+    if (shard.fPurgeMessagesSeen.load(std::memory_order_relaxed) == purgeMessagesPosted) {
+        SkAutoSharedMutexShared am(shard.fMutex);
+        Rec** found = shard.fCache->fHash->find(key);
+        if (!found) {
+            shard.fMisses.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (visitor(**found, context)) {
+            (*found)->fUsed.store(true, std::memory_order_relaxed);
+            shard.fHits.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    // Purging the rec because it's stale, or any recs the shard was told to purge, means
+    // changing the shard.
+    SkAutoSharedMutexExclusive am(shard.fMutex);
+    bool found = shard.fCache->find(key, visitor, context);
+    shard.fPurgeMessagesSeen.store(purgeMessagesPosted, std::memory_order_relaxed);
+    (found ? shard.fHits : shard.fMisses).fetch_add(1, std::memory_order_relaxed);
+    update_bytes_used(shard);
+    return found;
 }
 
 void SkResourceCache::Add(Rec* rec, void* payload) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    get_cache()->add(rec, payload);
+    const int index = shard_index(rec->getKey());
+    Shard& shard = shards()[index];
+    const size_t totalLimit = GetTotalByteLimit(),
+                 slice = shard_byte_limit(totalLimit, index);
+
+    // Smaller entries make room in their own shard, which keeps the shards evenly used as long
+    // as keys are spread evenly over them.
+    if (kByteBudget && rec->bytesUsed() > slice) {
+        const size_t needed = bytes_used() + rec->bytesUsed();
+        if (needed > totalLimit) {
+            make_room(needed - totalLimit, index + 1);
+        }
+    }
+
+    {
+        SkAutoSharedMutexExclusive am(shard.fMutex);
+        if (kByteBudget) {
+            const size_t others = bytes_used(index);
+            shard.fCache->setTotalByteLimit(
+                    std::max(slice, totalLimit - std::min(totalLimit, others)));
+        }
+        shard.fCache->add(rec, payload);
+        update_bytes_used(shard);
+    }
+
+    // This shard may have only taken back its own slice, which other shards have borrowed.
+    if (kByteBudget && bytes_used() > totalLimit) {
+        reclaim_borrowed(totalLimit);
+    }
 }
 
 void SkResourceCache::VisitAll(Visitor visitor, void* context) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    get_cache()->visitAll(visitor, context);
+    for_each_shard([&](int, SkResourceCache* cache) { cache->visitAll(visitor, context); });
+}
+
+SkResourceCache::ShardStats SkResourceCache::GetShardStats(int index) {
+    if (index < 0 || index >= kShardCount) {
+        return {};
+    }
+    Shard& shard = shards()[index];
+    SkAutoSharedMutexExclusive am(shard.fMutex);
+    return {shard.fCache->fTotalBytesUsed,
+            shard_byte_limit(GetTotalByteLimit(), index),
+            shard.fCache->fCount,
+            shard.fHits.load(std::memory_order_relaxed),
+            shard.fMisses.load(std::memory_order_relaxed)};
 }
 
 void SkResourceCache::PostPurgeSharedID(uint64_t sharedID) {
     if (sharedID) {
         SkMessageBus<PurgeSharedIDMessage, uint32_t>::Post(PurgeSharedIDMessage(sharedID));
+        gPurgeMessagesPosted.fetch_add(1, std::memory_order_release);
     }
 }
 
@@ -581,6 +866,30 @@ size_t SkGraphics::SetResourceCacheSingleAllocationByteLimit(size_t newLimit) {
     return SkResourceCache::SetSingleAllocationByteLimit(newLimit);
 }
 
+int SkGraphics::GetResourceCacheShardCount() {
+    return kShardCount;
+}
+
+SkGraphics::ResourceCacheShardStats SkGraphics::GetResourceCacheShardStats(int index) {
+    SkResourceCache::ShardStats stats = SkResourceCache::GetShardStats(index);
+    return {stats.fBytesUsed, stats.fByteLimit, stats.fCount, stats.fHits, stats.fMisses};
+}
+
+static_assert((int)SkResourceCache::EvictionPolicy::kLRU ==
+              (int)SkGraphics::ResourceCacheEvictionPolicy::kLRU);
+static_assert((int)SkResourceCache::EvictionPolicy::kCostAware ==
+              (int)SkGraphics::ResourceCacheEvictionPolicy::kCostAware);
+
+SkGraphics::ResourceCacheEvictionPolicy SkGraphics::GetResourceCacheEvictionPolicy() {
+    return (ResourceCacheEvictionPolicy)SkResourceCache::GetEvictionPolicy();
+}
+
+SkGraphics::ResourceCacheEvictionPolicy SkGraphics::SetResourceCacheEvictionPolicy(
+        ResourceCacheEvictionPolicy policy) {
+    return (ResourceCacheEvictionPolicy)SkResourceCache::SetEvictionPolicy(
+            (SkResourceCache::EvictionPolicy)policy);
+}
+
 void SkGraphics::PurgeResourceCache() {
     SkImageFilter_Base::PurgeCache();
     return SkResourceCache::PurgeAll();
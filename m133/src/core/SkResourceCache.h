@@ -11,6 +11,7 @@
 #include "include/private/base/SkDebug.h"
 #include "src/core/SkMessageBus.h"
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 
@@ -27,6 +28,8 @@ class SkTraceMemoryDump;
  *
  *  As a convenience, a global instance is also defined, which can be safely
  *  access across threads via the static methods (e.g. FindAndLock, etc.).
+ *  The global instance is sharded by key hash, each shard with its own lock
+ *  and LRU, sharing the total byte limit.
  */
 class SkResourceCache {
 public:
@@ -89,6 +92,10 @@ public:
         // Will only be deleted/removed-from-the-cache when this returns true.
         virtual bool canBePurged() { return true; }
 
+        // Roughly how long it took to make this rec's contents, in nanoseconds, or 0 if unknown.
+        // The cost-aware eviction policy holds on to recs that are expensive to make again.
+        virtual double cost() const { return 0; }
+
         // A rec is first created/initialized, and then added to the cache. As part of the add(),
         // the cache will callback into the rec with postAddInstall, passing in whatever payload
         // was passed to add/Add.
@@ -108,6 +115,14 @@ public:
         Rec*    fNext;
         Rec*    fPrev;
 
+        // Used by the cost-aware eviction policy.
+        double   fPriority = 0;
+        uint32_t fUseCount = 0;
+
+        // Set when the global cache finds this rec without moving it in the LRU. The rec is
+        // moved to the head when the cache next looks for recs to purge.
+        std::atomic<bool> fUsed{false};
+
         friend class SkResourceCache;
     };
 
@@ -119,6 +134,21 @@ public:
 
     typedef const Rec* ID;
 
+    // See SkGraphics::ResourceCacheEvictionPolicy.
+    enum class EvictionPolicy {
+        kLRU,
+        kCostAware,
+    };
+
+    // See SkGraphics::ResourceCacheShardStats.
+    struct ShardStats {
+        size_t   fBytesUsed;
+        size_t   fByteLimit;
+        int      fCount;
+        uint64_t fHits;
+        uint64_t fMisses;
+    };
+
     /**
      *  Callback function for find(). If called, the cache will have found a match for the
      *  specified Key, and will pass in the corresponding Rec, along with a caller-specified
@@ -166,9 +196,16 @@ public:
     static size_t GetSingleAllocationByteLimit();
     static size_t GetEffectiveSingleAllocationByteLimit();
 
+    static EvictionPolicy GetEvictionPolicy();
+    static EvictionPolicy SetEvictionPolicy(EvictionPolicy);
+
     static void PurgeAll();
     static void CheckMessages();
 
+    /** Returns the current state of one shard of the global cache, or all zeros if there is no
+        shard at index. */
+    static ShardStats GetShardStats(int index);
+
     static void TestDumpMemoryStatistics();
 
     /** Dump memory usage statistics of every Rec in the cache using the
@@ -244,6 +281,13 @@ public:
      */
     size_t setTotalByteLimit(size_t newLimit);
 
+    /**
+     *  Set how recs are picked to be purged when the cache is over budget. Returns the previous
+     *  policy. See SkGraphics::ResourceCacheEvictionPolicy.
+     */
+    EvictionPolicy setEvictionPolicy(EvictionPolicy);
+    EvictionPolicy getEvictionPolicy() const { return fEvictionPolicy; }
+
     void purgeSharedID(uint64_t sharedID);
 
     void purgeAll() {
@@ -273,10 +317,20 @@ private:
     size_t  fSingleAllocationByteLimit;
     int     fCount;
 
+    EvictionPolicy fEvictionPolicy;
+    // The priority of the last rec purged by the cost-aware policy. Recs are given priorities
+    // relative to this, so that recs which haven't been used in a while eventually lose out
+    // to newer ones, however expensive they were.
+    double  fPriorityFloor;
+
     SkMessageBus<PurgeSharedIDMessage, uint32_t>::Inbox fPurgeSharedIDInbox;
 
     void checkMessages();
     void purgeAsNeeded(bool forcePurge = false);
+    Rec* findCostAwareVictim();
+    // Moves rec to the head of the LRU if it was found since the LRU was last updated.
+    bool promoteIfUsed(Rec*);
+    void updatePriority(Rec*);
 
     // linklist management
     void moveToHead(Rec*);
@@ -13,6 +13,8 @@
 #include "include/core/SkColor.h"
 #include "include/core/SkColorFilter.h"
 #include "include/core/SkData.h"
+#include "include/core/SkFourByteTag.h"
+#include "include/core/SkStream.h"
 #include "include/private/base/SkAlign.h"
 #include "include/private/base/SkDebug.h"
 #include "include/private/base/SkMutex.h"
@@ -26,13 +28,13 @@
 #include "src/core/SkColorSpacePriv.h"
 #include "src/core/SkColorSpaceXformSteps.h"
 #include "src/core/SkEffectPriv.h"
-#include "src/core/SkLRUCache.h"
 #include "src/core/SkRasterPipeline.h"
 #include "src/core/SkRasterPipelineOpList.h"
 #include "src/core/SkReadBuffer.h"
 #include "src/core/SkRuntimeBlender.h"
 #include "src/core/SkRuntimeEffectPriv.h"
 #include "src/core/SkStreamPriv.h"
+#include "src/core/SkTHash.h"
 #include "src/core/SkWriteBuffer.h"
 #include "src/effects/colorfilters/SkColorFilterBase.h"
 #include "src/effects/colorfilters/SkRuntimeColorFilter.h"
@@ -62,6 +64,8 @@
 #include "src/sksl/transform/SkSLTransform.h"
 
 #include <algorithm>
+#include <string>
+#include <utility>
 
 using namespace skia_private;
 
@@ -215,11 +219,124 @@ sk_sp<const SkData> SkRuntimeEffectPriv::TransformUniforms(
     return data ? data : originalData;
 }
 
+// Raster Pipeline programs loaded by SkRuntimeEffect::LoadRasterPipelinePrograms(), keyed by
+// SkRuntimeEffect::hash(). The hash of the SkSL is kept too, to guard against collisions.
+struct PrecompiledRPProgram {
+    uint64_t fSourceHash;
+    sk_sp<SkData> fProgram;
+};
+
+static SkMutex& precompiled_rp_programs_mutex() {
+    static SkNoDestructor<SkMutex> mutex;
+    return *mutex;
+}
+
+static THashMap<uint32_t, PrecompiledRPProgram>& precompiled_rp_programs() {
+    static SkNoDestructor<THashMap<uint32_t, PrecompiledRPProgram>> programs;
+    return *programs;
+}
+
+static std::unique_ptr<SkSL::RP::Program> find_precompiled_rp_program(uint32_t effectHash,
+                                                                      const std::string& source) {
+    sk_sp<SkData> data;
+    {
+        SkAutoMutexExclusive lock(precompiled_rp_programs_mutex());
+        const PrecompiledRPProgram* found = precompiled_rp_programs().find(effectHash);
+        if (!found || found->fSourceHash != SkChecksum::Hash64(source.data(), source.size())) {
+            return nullptr;
+        }
+        data = found->fProgram;
+    }
+    return SkSL::RP::Program::Deserialize(data->data(), data->size());
+}
+
+static constexpr uint32_t kRPProgramsMagic = SkSetFourByteTag('S', 'k', 'R', 'P');
+static constexpr uint32_t kRPProgramsVersion = 1;
+
+sk_sp<SkData> SkRuntimeEffect::SerializeRasterPipelinePrograms(
+        SkSpan<const sk_sp<SkRuntimeEffect>> effects) {
+    SkDynamicMemoryWStream entries;
+    uint32_t count = 0;
+    for (const sk_sp<SkRuntimeEffect>& effect : effects) {
+        const SkSL::RP::Program* program = effect ? effect->getRPProgram(/*debugTrace=*/nullptr)
+                                                  : nullptr;
+        SkDynamicMemoryWStream programStream;
+        if (!program || !program->serialize(&programStream)) {
+            continue;
+        }
+        const std::string& source = effect->source();
+        const uint64_t sourceHash = SkChecksum::Hash64(source.data(), source.size());
+        entries.write32(effect->hash());
+        entries.write32((uint32_t)sourceHash);
+        entries.write32((uint32_t)(sourceHash >> 32));
+        entries.write32(SkToU32(programStream.bytesWritten()));
+        programStream.writeToAndReset(&entries);
+        ++count;
+    }
+
+    SkDynamicMemoryWStream out;
+    out.write32(kRPProgramsMagic);
+    out.write32(kRPProgramsVersion);
+    out.write32(count);
+    entries.writeToAndReset(&out);
+    return out.detachAsData();
+}
+
+int SkRuntimeEffect::LoadRasterPipelinePrograms(sk_sp<SkData> data) {
+    if (!data) {
+        return 0;
+    }
+    SkMemoryStream stream(data);
+    uint32_t magic, version, count;
+    if (!stream.readU32(&magic) || magic != kRPProgramsMagic ||
+        !stream.readU32(&version) || version != kRPProgramsVersion ||
+        !stream.readU32(&count)) {
+        return 0;
+    }
+
+    TArray<std::pair<uint32_t, PrecompiledRPProgram>> loaded;
+    for (uint32_t index = 0; index < count; ++index) {
+        uint32_t effectHash, sourceHashLo, sourceHashHi, length;
+        if (!stream.readU32(&effectHash) ||
+            !stream.readU32(&sourceHashLo) ||
+            !stream.readU32(&sourceHashHi) ||
+            !stream.readU32(&length) ||
+            length > stream.getLength() - stream.getPosition()) {
+            break;
+        }
+        sk_sp<SkData> program = SkData::MakeSubset(data.get(), stream.getPosition(), length);
+        stream.skip(length);
+        // Check that this build can read the program now, rather than when it's first drawn.
+        if (!SkSL::RP::Program::Deserialize(program->data(), program->size())) {
+            continue;
+        }
+        loaded.push_back({effectHash,
+                          {(uint64_t)sourceHashHi << 32 | sourceHashLo, std::move(program)}});
+    }
+
+    SkAutoMutexExclusive lock(precompiled_rp_programs_mutex());
+    for (auto& [effectHash, program] : loaded) {
+        precompiled_rp_programs().set(effectHash, std::move(program));
+    }
+    return loaded.size();
+}
+
 const SkSL::RP::Program* SkRuntimeEffect::getRPProgram(SkSL::DebugTracePriv* debugTrace) const {
     // Lazily compile the program the first time `getRPProgram` is called.
     // By using an SkOnce, we avoid thread hazards and behave in a conceptually const way, but we
     // can avoid the cost of invoking the RP code generator until it's actually needed.
     fCompileRPProgramOnce([&] {
+        // A program loaded by LoadRasterPipelinePrograms() needs no compilation at all.
+        if (!debugTrace && !kRPEnableLiveTrace) {
+            std::unique_ptr<SkSL::RP::Program> program =
+                    find_precompiled_rp_program(fHash, this->source());
+            if (program && (size_t)program->numUniforms() * sizeof(float) == this->uniformSize()) {
+                fRPProgramSize.store(program->approximateSizeInBytes(), std::memory_order_relaxed);
+                const_cast<SkRuntimeEffect*>(this)->fRPProgram = std::move(program);
+                return;
+            }
+        }
+
         // We generally do not run the inliner when an SkRuntimeEffect program is initially created,
         // because the final compile to native shader code will do this. However, in SkRP, there's
         // no additional compilation occurring, so we need to manually inline here if we want the
@@ -258,11 +375,22 @@ const SkSL::RP::Program* SkRuntimeEffect::getRPProgram(SkSL::DebugTracePriv* deb
                 SkDebugf("----- RP unsupported -----\n\n");
             }
         }
+        if (fRPProgram) {
+            fRPProgramSize.store(fRPProgram->approximateSizeInBytes(), std::memory_order_relaxed);
+        }
     });
 
     return fRPProgram.get();
 }
 
+size_t SkRuntimeEffectPriv::ApproximateSizeInBytes(const SkRuntimeEffect& effect) {
+    // The SkSL IR isn't measured directly; it takes roughly this many bytes per byte of SkSL.
+    static constexpr size_t kIRBytesPerSourceByte = 16;
+    return sizeof(SkRuntimeEffect) +
+           kIRBytesPerSourceByte * effect.source().size() +
+           effect.fRPProgramSize.load(std::memory_order_relaxed);
+}
+
 SkSpan<const float> SkRuntimeEffectPriv::UniformsAsSpan(
         SkSpan<const SkRuntimeEffect::Uniform> uniforms,
         sk_sp<const SkData> originalData,
@@ -693,37 +821,6 @@ SkRuntimeEffect::Result SkRuntimeEffect::MakeForBlender(SkString sksl, const Opt
     return result;
 }
 
-sk_sp<SkRuntimeEffect> SkMakeCachedRuntimeEffect(
-        SkRuntimeEffect::Result (*make)(SkString sksl, const SkRuntimeEffect::Options&),
-        SkString sksl) {
-    static SkNoDestructor<SkMutex> mutex;
-    static SkNoDestructor<SkLRUCache<uint64_t, sk_sp<SkRuntimeEffect>>> cache(11 /*arbitrary*/);
-
-    uint64_t key = SkChecksum::Hash64(sksl.c_str(), sksl.size());
-    {
-        SkAutoMutexExclusive _(*mutex);
-        if (sk_sp<SkRuntimeEffect>* found = cache->find(key)) {
-            return *found;
-        }
-    }
-
-    SkRuntimeEffect::Options options;
-    SkRuntimeEffectPriv::AllowPrivateAccess(&options);
-
-    auto [effect, err] = make(std::move(sksl), options);
-    if (!effect) {
-        SkDEBUGFAILF("%s", err.c_str());
-        return nullptr;
-    }
-    SkASSERT(err.isEmpty());
-
-    {
-        SkAutoMutexExclusive _(*mutex);
-        cache->insert_or_update(key, effect);
-    }
-    return effect;
-}
-
 static size_t uniform_element_size(SkRuntimeEffect::Uniform::Type type) {
     switch (type) {
         case SkRuntimeEffect::Uniform::Type::kFloat:  return sizeof(float);
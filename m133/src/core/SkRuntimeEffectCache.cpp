@@ -0,0 +1,402 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkRuntimeEffectCache.h"
+
+#include "include/core/SkString.h"
+#include "include/core/SkTraceMemoryDump.h"
+#include "include/effects/SkRuntimeEffect.h"
+#include "include/private/base/SkAssert.h"
+#include "include/private/base/SkMutex.h"
+#include "include/private/base/SkTArray.h"
+#include "include/private/base/SkTo.h"
+#include "src/base/SkTInternalLList.h"
+#include "src/core/SkChecksum.h"
+#include "src/core/SkRuntimeEffectPriv.h"
+#include "src/core/SkTHash.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#ifndef SK_RUNTIME_EFFECT_CACHE_SHARD_COUNT
+    #define SK_RUNTIME_EFFECT_CACHE_SHARD_COUNT    4
+#endif
+
+#ifndef SK_DEFAULT_RUNTIME_EFFECT_CACHE_LIMIT
+    #define SK_DEFAULT_RUNTIME_EFFECT_CACHE_LIMIT  (1024 * 1024)
+#endif
+
+namespace {
+
+struct Entry {
+    Entry(uint64_t key, sk_sp<SkRuntimeEffect> effect) : fKey(key), fEffect(std::move(effect)) {}
+
+    uint64_t               fKey;
+    sk_sp<SkRuntimeEffect> fEffect;
+    size_t                 fBytes = 0;
+    bool                   fPinned = false;
+
+    SK_DECLARE_INTERNAL_LLIST_INTERFACE(Entry);
+};
+
+struct Shard {
+    SkMutex                                  fMutex;
+    skia_private::THashMap<uint64_t, Entry*> fMap;
+    SkTInternalLList<Entry>                  fLRU;  // The most recently used entry is the head.
+    // Only changed with fMutex held, but other shards read it without taking fMutex.
+    std::atomic<size_t>                      fBytesUsed{0};
+    int                                      fPinnedCount = 0;
+    uint64_t                                 fHits = 0;
+    uint64_t                                 fMisses = 0;
+    uint64_t                                 fEvictions = 0;
+};
+
+// Effects removed from a shard are released after its mutex is, since freeing an effect's
+// programs is not free.
+using EffectList = skia_private::TArray<sk_sp<SkRuntimeEffect>>;
+
+}  // namespace
+
+static constexpr int kShardCount = SK_RUNTIME_EFFECT_CACHE_SHARD_COUNT;
+static_assert(kShardCount > 0, "SK_RUNTIME_EFFECT_CACHE_SHARD_COUNT must be positive");
+
+static std::atomic<size_t> gByteLimit{SK_DEFAULT_RUNTIME_EFFECT_CACHE_LIMIT};
+
+// Splits totalLimit as evenly as possible, so the shard slices always add up to it.
+static size_t shard_byte_limit(size_t totalLimit, int index) {
+    return totalLimit / kShardCount + (SkToSizeT(index) < totalLimit % kShardCount ? 1 : 0);
+}
+
+static Shard* shards() {
+    static Shard* gShards = new Shard[kShardCount];
+    return gShards;
+}
+
+static int shard_index(uint64_t key) {
+    // Use the high bits of the key, since the shard's hash map indexes with the low bits.
+    return (int)(((key >> 32) * kShardCount) >> 32);
+}
+
+// What all the shards but the one at except use, as of recently.
+static size_t bytes_used(int except = -1) {
+    size_t used = 0;
+    for (int i = 0; i < kShardCount; ++i) {
+        if (i != except) {
+            used += shards()[i].fBytesUsed.load(std::memory_order_relaxed);
+        }
+    }
+    return used;
+}
+
+// A shard may always use its slice of the byte limit, and may borrow whatever the other shards
+// leave unused.
+static size_t shard_budget(int index) {
+    const size_t limit = gByteLimit.load(std::memory_order_relaxed);
+    const size_t others = bytes_used(index);
+    return std::max(shard_byte_limit(limit, index), limit - std::min(limit, others));
+}
+
+static uint64_t key_for(const char* sksl, size_t length) {
+    return SkChecksum::Hash64(sksl, length);
+}
+
+// The shard's mutex must be held by the callers of these helpers.
+
+static void touch(Shard* shard, Entry* entry) {
+    if (entry != shard->fLRU.head()) {
+        shard->fLRU.remove(entry);
+        shard->fLRU.addToHead(entry);
+    }
+    size_t bytes = SkRuntimeEffectPriv::ApproximateSizeInBytes(*entry->fEffect);
+    shard->fBytesUsed = shard->fBytesUsed - entry->fBytes + bytes;
+    entry->fBytes = bytes;
+}
+
+static void remove(Shard* shard, Entry* entry, EffectList* removed) {
+    SkASSERT(!entry->fPinned);
+    shard->fMap.remove(entry->fKey);
+    shard->fLRU.remove(entry);
+    shard->fBytesUsed -= entry->fBytes;
+    removed->push_back(std::move(entry->fEffect));
+    delete entry;
+}
+
+// Purges the least recently used effects which aren't pinned until the shard uses at most bytes.
+static void purge_down_to(Shard* shard, size_t bytes, EffectList* purged) {
+    Entry* entry = shard->fLRU.tail();
+    while (entry && shard->fBytesUsed > bytes) {
+        Entry* prev = entry->fPrev;
+        if (!entry->fPinned) {
+            remove(shard, entry, purged);
+            shard->fEvictions++;
+        }
+        entry = prev;
+    }
+}
+
+static void purge_as_needed(Shard* shard, int index, EffectList* purged) {
+    purge_down_to(shard, shard_budget(index), purged);
+}
+
+// Purges at least bytes from the shards, an equal part from each, starting with the one at
+// first. Whatever part a shard can't free is left to the ones after it. No shard's mutex may be
+// held by the caller.
+static void make_room(size_t bytes, int first) {
+    for (int n = 0; n < kShardCount && bytes > 0; ++n) {
+        Shard& shard = shards()[(first + n) % kShardCount];
+        const size_t part = (bytes + (kShardCount - n) - 1) / (kShardCount - n);
+
+        EffectList purged;
+        SkAutoMutexExclusive am(shard.fMutex);
+        const size_t used = shard.fBytesUsed;
+        purge_down_to(&shard, used - std::min(used, part), &purged);
+        bytes -= std::min(bytes, used - shard.fBytesUsed);
+    }
+}
+
+// Purges the shards that use more than their slice of limit, but not below their slice, until
+// all the shards fit in it together. Shards within their slice are left alone, since they only
+// use what they are owed. No shard's mutex may be held by the caller.
+static void reclaim_borrowed(size_t limit) {
+    for (int i = 0; i < kShardCount; ++i) {
+        const size_t used = bytes_used();
+        if (used <= limit) {
+            return;
+        }
+        Shard& shard = shards()[i];
+        const size_t slice = shard_byte_limit(limit, i);
+        if (shard.fBytesUsed.load(std::memory_order_relaxed) <= slice) {
+            continue;
+        }
+
+        EffectList purged;
+        SkAutoMutexExclusive am(shard.fMutex);
+        const size_t shardUsed = shard.fBytesUsed;
+        if (shardUsed > slice) {
+            purge_down_to(&shard,
+                          std::max(slice, shardUsed - std::min(shardUsed, used - limit)),
+                          &purged);
+        }
+    }
+}
+
+// Called with the mutex of the shard at index held, after entry was added or found there.
+// Smaller entries make room in their own shard, which keeps the shards evenly used as long as
+// keys are spread evenly over them. Returns false if entry is larger than the shard's slice of
+// the byte limit, in which case it is left to fit_in_limit() to make room across the shards,
+// rather than flushing everything else in this one.
+static bool purge_for_entry(Shard* shard, int index, const Entry* entry, EffectList* purged) {
+    if (entry->fBytes > shard_byte_limit(gByteLimit.load(std::memory_order_relaxed), index)) {
+        return false;
+    }
+    purge_as_needed(shard, index, purged);
+    return true;
+}
+
+// Called once the mutex of the shard at index is released, after an entry was added or found
+// there, to bring the shards back within the byte limit together. A small entry may only have
+// taken back its shard's own slice, which other shards borrowed.
+static void fit_in_limit(int index, bool purgedForEntry) {
+    const size_t limit = gByteLimit.load(std::memory_order_relaxed);
+    const size_t used = bytes_used();
+    if (used <= limit) {
+        return;
+    }
+    if (purgedForEntry) {
+        reclaim_borrowed(limit);
+    } else {
+        // The entry's own shard goes last, since the entry is its most recently used.
+        make_room(used - limit, index + 1);
+    }
+}
+
+// Returns the effect cached under key, or null.
+static sk_sp<SkRuntimeEffect> find(uint64_t key) {
+    const int index = shard_index(key);
+    Shard& shard = shards()[index];
+    EffectList purged;
+    sk_sp<SkRuntimeEffect> effect;
+    bool purgedForEntry;
+    {
+        SkAutoMutexExclusive am(shard.fMutex);
+        Entry** found = shard.fMap.find(key);
+        if (!found) {
+            shard.fMisses++;
+            return nullptr;
+        }
+        touch(&shard, *found);
+        effect = (*found)->fEffect;
+        shard.fHits++;
+        purgedForEntry = purge_for_entry(&shard, index, *found, &purged);
+    }
+    fit_in_limit(index, purgedForEntry);
+    return effect;
+}
+
+// Caches effect under key, unless another thread got there first, and returns the cached effect.
+static sk_sp<SkRuntimeEffect> add(uint64_t key, sk_sp<SkRuntimeEffect> effect, bool pin) {
+    const int index = shard_index(key);
+    Shard& shard = shards()[index];
+    EffectList purged;
+    sk_sp<SkRuntimeEffect> cached;
+    bool purgedForEntry;
+    {
+        SkAutoMutexExclusive am(shard.fMutex);
+        Entry* entry;
+        if (Entry** found = shard.fMap.find(key)) {
+            entry = *found;
+        } else {
+            entry = new Entry(key, std::move(effect));
+            shard.fMap.set(key, entry);
+            shard.fLRU.addToHead(entry);
+        }
+        if (pin && !entry->fPinned) {
+            entry->fPinned = true;
+            shard.fPinnedCount++;
+        }
+        touch(&shard, entry);
+        cached = entry->fEffect;
+        purgedForEntry = purge_for_entry(&shard, index, entry, &purged);
+    }
+    fit_in_limit(index, purgedForEntry);
+    return cached;
+}
+
+sk_sp<SkRuntimeEffect> SkMakeCachedRuntimeEffect(
+        SkRuntimeEffect::Result (*make)(SkString sksl, const SkRuntimeEffect::Options&),
+        SkString sksl) {
+    uint64_t key = key_for(sksl.c_str(), sksl.size());
+    if (sk_sp<SkRuntimeEffect> effect = find(key)) {
+        return effect;
+    }
+
+    SkRuntimeEffect::Options options;
+    SkRuntimeEffectPriv::AllowPrivateAccess(&options);
+
+    auto [effect, err] = make(std::move(sksl), options);
+    if (!effect) {
+        SkDEBUGFAILF("%s", err.c_str());
+        return nullptr;
+    }
+    SkASSERT(err.isEmpty());
+
+    return add(key, std::move(effect), /*pin=*/false);
+}
+
+size_t SkRuntimeEffectCache::GetByteLimit() {
+    return gByteLimit.load(std::memory_order_relaxed);
+}
+
+size_t SkRuntimeEffectCache::SetByteLimit(size_t newLimit) {
+    const size_t prevLimit = gByteLimit.exchange(newLimit, std::memory_order_relaxed);
+    // Take back anything borrowed, so the shards fit in the new limit together.
+    for (int i = 0; i < kShardCount; ++i) {
+        Shard& shard = shards()[i];
+        EffectList purged;
+        SkAutoMutexExclusive am(shard.fMutex);
+        purge_down_to(&shard, shard_byte_limit(newLimit, i), &purged);
+    }
+    return prevLimit;
+}
+
+SkGraphics::RuntimeEffectCacheStats SkRuntimeEffectCache::GetStats() {
+    SkGraphics::RuntimeEffectCacheStats stats = {};
+    stats.fByteLimit = GetByteLimit();
+    for (int i = 0; i < kShardCount; ++i) {
+        Shard& shard = shards()[i];
+        SkAutoMutexExclusive am(shard.fMutex);
+        stats.fBytesUsed   += shard.fBytesUsed;
+        stats.fCount       += shard.fMap.count();
+        stats.fPinnedCount += shard.fPinnedCount;
+        stats.fHits        += shard.fHits;
+        stats.fMisses      += shard.fMisses;
+        stats.fEvictions   += shard.fEvictions;
+    }
+    return stats;
+}
+
+void SkRuntimeEffectCache::Pin(sk_sp<SkRuntimeEffect> effect) {
+    if (!effect) {
+        return;
+    }
+    const std::string& sksl = effect->source();
+    add(key_for(sksl.c_str(), sksl.size()), std::move(effect), /*pin=*/true);
+}
+
+void SkRuntimeEffectCache::Unpin(const SkRuntimeEffect* effect) {
+    if (!effect) {
+        return;
+    }
+    const std::string& sksl = effect->source();
+    uint64_t key = key_for(sksl.c_str(), sksl.size());
+    const int index = shard_index(key);
+    Shard& shard = shards()[index];
+    EffectList purged;
+    SkAutoMutexExclusive am(shard.fMutex);
+    if (Entry** found = shard.fMap.find(key); found && (*found)->fPinned) {
+        (*found)->fPinned = false;
+        shard.fPinnedCount--;
+        purge_as_needed(&shard, index, &purged);
+    }
+}
+
+void SkRuntimeEffectCache::PurgeAll() {
+    for (int i = 0; i < kShardCount; ++i) {
+        Shard& shard = shards()[i];
+        EffectList purged;
+        SkAutoMutexExclusive am(shard.fMutex);
+        for (Entry* entry = shard.fLRU.tail(); entry;) {
+            Entry* prev = entry->fPrev;
+            if (!entry->fPinned) {
+                remove(&shard, entry, &purged);
+            }
+            entry = prev;
+        }
+    }
+}
+
+void SkRuntimeEffectCache::DumpMemoryStatistics(SkTraceMemoryDump* dump) {
+    static constexpr char kDumpName[] = "skia/sk_runtime_effect_cache";
+    SkGraphics::RuntimeEffectCacheStats stats = GetStats();
+    dump->dumpNumericValue(kDumpName, "size", "bytes", stats.fBytesUsed);
+    dump->dumpNumericValue(kDumpName, "budget_size", "bytes", stats.fByteLimit);
+    dump->dumpNumericValue(kDumpName, "effect_count", "objects", stats.fCount);
+    dump->dumpNumericValue(kDumpName, "pinned_effect_count", "objects", stats.fPinnedCount);
+    dump->dumpNumericValue(kDumpName, "hits", "objects", stats.fHits);
+    dump->dumpNumericValue(kDumpName, "misses", "objects", stats.fMisses);
+    dump->dumpNumericValue(kDumpName, "evictions", "objects", stats.fEvictions);
+    dump->setMemoryBacking(kDumpName, "malloc", nullptr);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t SkGraphics::GetRuntimeEffectCacheByteLimit() {
+    return SkRuntimeEffectCache::GetByteLimit();
+}
+
+size_t SkGraphics::SetRuntimeEffectCacheByteLimit(size_t newLimit) {
+    return SkRuntimeEffectCache::SetByteLimit(newLimit);
+}
+
+SkGraphics::RuntimeEffectCacheStats SkGraphics::GetRuntimeEffectCacheStats() {
+    return SkRuntimeEffectCache::GetStats();
+}
+
+void SkGraphics::PinRuntimeEffect(sk_sp<SkRuntimeEffect> effect) {
+    SkRuntimeEffectCache::Pin(std::move(effect));
+}
+
+void SkGraphics::UnpinRuntimeEffect(const SkRuntimeEffect* effect) {
+    SkRuntimeEffectCache::Unpin(effect);
+}
+
+void SkGraphics::PurgeRuntimeEffectCache() {
+    SkRuntimeEffectCache::PurgeAll();
+}
@@ -0,0 +1,46 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkRuntimeEffectCache_DEFINED
+#define SkRuntimeEffectCache_DEFINED
+
+#include "include/core/SkGraphics.h"
+#include "include/core/SkRefCnt.h"
+
+#include <cstddef>
+
+class SkRuntimeEffect;
+class SkTraceMemoryDump;
+
+/**
+ *  The process-wide cache behind SkMakeCachedRuntimeEffect(), keyed by the hash of each effect's
+ *  SkSL. It is split into shards by key, each with its own mutex and LRU list. The shards share
+ *  the byte limit: each may always use an equal slice of it, and may borrow whatever the others
+ *  leave unused, so a single effect can be as large as the whole limit. Borrowed bytes are taken
+ *  back as soon as the other shards need them. Effects are budgeted by SkRuntimeEffectPriv::
+ *  ApproximateSizeInBytes(), which grows once an effect has been drawn on the CPU, so an effect
+ *  is re-measured each time it is found.
+ *
+ *  The runtime effect cache functions of SkGraphics call through to these.
+ */
+class SkRuntimeEffectCache {
+public:
+    static size_t GetByteLimit();
+    static size_t SetByteLimit(size_t newLimit);
+
+    static SkGraphics::RuntimeEffectCacheStats GetStats();
+
+    static void Pin(sk_sp<SkRuntimeEffect> effect);
+    static void Unpin(const SkRuntimeEffect* effect);
+
+    // Purges every effect that isn't pinned.
+    static void PurgeAll();
+
+    static void DumpMemoryStatistics(SkTraceMemoryDump* dump);
+};
+
+#endif  // SkRuntimeEffectCache_DEFINED
@@ -137,6 +137,10 @@ public:
     static bool UsesColorTransform(const SkRuntimeEffect* effect) {
         return effect->usesColorTransform();
     }
+
+    // Approximates the memory held by the effect: its SkSL program, plus its Raster Pipeline
+    // program once it has been drawn on the CPU. Used to budget the runtime effect cache.
+    static size_t ApproximateSizeInBytes(const SkRuntimeEffect& effect);
 };
 
 // These internal APIs for creating runtime effects vary from the public API in two ways:
@@ -145,7 +149,8 @@ public:
 //     2) they're cached.
 //
 // Users of the public SkRuntimeEffect::Make*() can of course cache however they like themselves;
-// keeping these APIs private means users will not be forced into our cache or cache policy.
+// keeping these APIs private means users will not be forced into our cache or cache policy. The
+// cache's budget can be tuned, and hot effects pinned in it, through SkGraphics.
 
 sk_sp<SkRuntimeEffect> SkMakeCachedRuntimeEffect(
         SkRuntimeEffect::Result (*make)(SkString sksl, const SkRuntimeEffect::Options&),
@@ -18,6 +18,7 @@
 #include "include/private/base/SkTo.h"
 #include "src/base/SkTSort.h"
 #include "src/core/SkAlphaRuns.h"
+#include "src/core/SkAnalyticCoverage.h"
 #include "src/core/SkAnalyticEdge.h"
 #include "src/core/SkBlitter.h"
 #include "src/core/SkEdge.h"
@@ -237,10 +238,8 @@ void MaskAdditiveBlitter::blitAntiH(int x, int y, SkAlpha alpha) {
 
 void MaskAdditiveBlitter::blitAntiH(int x, int y, int width, SkAlpha alpha) {
     SkASSERT(x >= fMask.fBounds.fLeft - 1);
-    uint8_t* row = this->getRow(y);
-    for (int i = 0; i < width; ++i) {
-        add_alpha(&row[x + i], alpha);
-    }
+    // add_alpha() never sums past 256, so saturating at 255 is the same as CatchOverflow().
+    SkOpts::accumulate_alpha(this->getRow(y) + x, alpha, width);
 }
 
 void MaskAdditiveBlitter::blitV(int x, int y, int height, SkAlpha alpha) {
@@ -424,9 +423,7 @@ void RunBasedAdditiveBlitter::blitAntiH(int x, int y, const SkAlpha antialias[],
         }
         fRuns.fRuns[x + i] = 1;
     }
-    for (int i = 0; i < len; ++i) {
-        add_alpha(&fRuns.fAlpha[x + i], antialias[i]);
-    }
+    SkOpts::accumulate_alphas(fRuns.fAlpha + x, antialias, len);
 }
 
 void RunBasedAdditiveBlitter::blitAntiH(int x, int y, SkAlpha alpha) {
@@ -494,9 +491,7 @@ void SafeRLEAdditiveBlitter::blitAntiH(int x, int y, const SkAlpha antialias[],
         }
         fRuns.fRuns[x + i] = 1;
     }
-    for (int i = 0; i < len; ++i) {
-        safely_add_alpha(&fRuns.fAlpha[x + i], antialias[i]);
-    }
+    SkOpts::accumulate_alphas(fRuns.fAlpha + x, antialias, len);
 }
 
 void SafeRLEAdditiveBlitter::blitAntiH(int x, int y, SkAlpha alpha) {
@@ -586,6 +581,16 @@ static SkFixed approximate_intersection(SkFixed l1, SkFixed r1, SkFixed l2, SkFi
     return (std::max(l1, l2) + std::min(r1, r2)) / 2;
 }
 
+// The alpha ramps below add dY (>= 0) to alpha16 once per pixel, saturating at SK_MaxS32, and
+// every saturated step becomes 0xFF. Returns how many of the count steps stay below saturation.
+static int unsaturated_ramp_length(SkFixed alpha16, SkFixed dY, int count) {
+    SkASSERT(alpha16 >= 0 && dY >= 0);
+    if (count <= 0 || (int64_t)alpha16 + (int64_t)(count - 1) * dY <= SK_MaxS32) {
+        return std::max(count, 0);
+    }
+    return (int)((SK_MaxS32 - alpha16) / dY) + 1;
+}
+
 // Here we always send in l < SK_Fixed1, and the first alpha we want to compute is alphas[0]
 static void compute_alpha_above_line(SkAlpha* alphas,
                                      SkFixed  l,
@@ -605,10 +610,9 @@ static void compute_alpha_above_line(SkAlpha* alphas,
         SkFixed firstH  = SkFixedMul(first, dY);  // vertical edge of the left-most triangle
         alphas[0]       = SkFixedMul(first, firstH) >> 9;  // triangle alpha
         SkFixed alpha16 = Sk32_sat_add(firstH, dY >> 1);                // rectangle plus triangle
-        for (int i = 1; i < R - 1; ++i) {
-            alphas[i] = alpha16 >> 8;
-            alpha16 = Sk32_sat_add(alpha16, dY);
-        }
+        int unsaturated = unsaturated_ramp_length(alpha16, dY, R - 2);
+        SkOpts::alpha_ramp(alphas + 1, unsaturated, alpha16, dY);
+        memset(alphas + 1 + unsaturated, 0xFF, R - 2 - unsaturated);
         alphas[R - 1] = fullAlpha - partial_triangle_to_alpha(last, dY);
     }
 }
@@ -632,9 +636,15 @@ static void compute_alpha_below_line(SkAlpha* alphas,
         SkFixed lastH   = SkFixedMul(last, dY);          // vertical edge of the right-most triangle
         alphas[R - 1]   = SkFixedMul(last, lastH) >> 9;  // triangle alpha
         SkFixed alpha16 = Sk32_sat_add(lastH, dY >> 1);             // rectangle plus triangle
-        for (int i = R - 2; i > 0; i--) {
-            alphas[i] = (alpha16 >> 8) & 0xFF;
-            alpha16 = Sk32_sat_add(alpha16, dY);
+        // This ramp runs right to left, so draw it left to right, from its largest value down.
+        int unsaturated = unsaturated_ramp_length(alpha16, dY, R - 2);
+        int saturated   = R - 2 - unsaturated;
+        memset(alphas + 1, 0xFF, saturated);
+        if (unsaturated > 0) {
+            SkOpts::alpha_ramp(alphas + 1 + saturated,
+                               unsaturated,
+                               alpha16 + (unsaturated - 1) * dY,
+                               -dY);
         }
         alphas[0] = fullAlpha - partial_triangle_to_alpha(first, dY);
     }
@@ -692,9 +702,7 @@ static void blit_full_alpha(AdditiveBlitter* blitter,
                             SkAlpha* maskRow,
                             bool noRealBlitter) {
     if (maskRow) {
-        for (int i = 0; i < len; ++i) {
-            safely_add_alpha(&maskRow[x + i], fullAlpha);
-        }
+        SkOpts::accumulate_alpha(maskRow + x, fullAlpha, len);
     } else {
         if (fullAlpha == 0xFF && !noRealBlitter) {
             blitter->getRealBlitter()->blitH(x, y, len);
@@ -755,13 +763,7 @@ static void blit_aaa_trapezoid_row(AdditiveBlitter* blitter,
     } else {
         compute_alpha_below_line(
                 tempAlphas + uL - L, ul - SkIntToFixed(uL), ll - SkIntToFixed(uL), lDY, fullAlpha);
-        for (int i = uL; i < lL; ++i) {
-            if (alphas[i - L] > tempAlphas[i - L]) {
-                alphas[i - L] -= tempAlphas[i - L];
-            } else {
-                alphas[i - L] = 0;
-            }
-        }
+        SkOpts::subtract_alphas(alphas + uL - L, tempAlphas + uL - L, lL - uL);
     }
 
     int uR = SkFixedFloorToInt(ur);
@@ -776,19 +778,11 @@ static void blit_aaa_trapezoid_row(AdditiveBlitter* blitter,
     } else {
         compute_alpha_above_line(
                 tempAlphas + uR - L, ur - SkIntToFixed(uR), lr - SkIntToFixed(uR), rDY, fullAlpha);
-        for (int i = uR; i < lR; ++i) {
-            if (alphas[i - L] > tempAlphas[i - L]) {
-                alphas[i - L] -= tempAlphas[i - L];
-            } else {
-                alphas[i - L] = 0;
-            }
-        }
+        SkOpts::subtract_alphas(alphas + uR - L, tempAlphas + uR - L, lR - uR);
     }
 
     if (maskRow) {
-        for (int i = 0; i < len; ++i) {
-            safely_add_alpha(&maskRow[L + i], alphas[i]);
-        }
+        SkOpts::accumulate_alphas(maskRow + L, alphas, len);
     } else {
         if (fullAlpha == 0xFF && !noRealBlitter) {
             // Real blitter is faster than RunBasedAdditiveBlitter
@@ -0,0 +1,520 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkPath.h"
+#include "include/core/SkPathTypes.h"
+#include "include/core/SkPoint.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRegion.h"
+#include "include/core/SkScalar.h"
+#include "include/private/base/SkAssert.h"
+#include "include/private/base/SkTArray.h"
+#include "include/private/base/SkTPin.h"
+#include "include/private/base/SkTemplates.h"
+#include "include/private/base/SkTo.h"
+#include "src/core/SkAAClip.h"
+#include "src/core/SkBlitter.h"
+#include "src/core/SkGeometry.h"
+#include "src/core/SkRasterClip.h"
+#include "src/core/SkScan.h"
+#include "src/core/SkScanPriv.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+/*
+The sparse strip rasterizer is an alternative to the analytic AA scan converter for filling
+anti-aliased paths. Instead of walking a sorted edge list scanline by scanline, it:
+
+ 1. flattens the path into line segments, clipped to the draw bounds,
+ 2. bins the lines into bands of kTileHeight pixel rows, and within a band, into the
+    kTileWidth x kTileHeight tiles they cross,
+ 3. accumulates, per tile, the signed area each line covers in every pixel of the tile,
+ 4. walks a band's tiles left to right, turning a running prefix sum of those areas into
+    coverage.
+
+Only tiles that lines cross are stored. Each run of adjacent tiles becomes a strip of
+anti-aliased pixels. The gaps between strips have the same coverage all the way across, so
+they are blitted as solid spans, or as whole rects when every row of the band is covered.
+
+The cost scales with the number of tiles that edges touch, not with how many edges are active
+on each scanline, which suits paths with many edges. Bands never depend on each other except
+through the order they are blitted in.
+*/
+
+namespace {
+
+constexpr int kTileWidth  = 4;
+constexpr int kTileHeight = 4;
+
+// Curves are split into lines no further than this from the curve, in pixels. The lines all
+// lie on the inside of convex curves, so this is also about how much coverage they can lose.
+constexpr float kFlattenTolerance = 1.0f / 16;
+constexpr int   kMaxLinesPerCurve = 256;
+
+struct Line {
+    SkPoint fP0, fP1;       // Relative to the top-left of the bounds, with fP0.fY < fP1.fY.
+    float   fDir;           // +1 if the line originally went down, -1 if it went up.
+    int     fFirstBand, fLastBand;
+};
+
+// The area deltas for one tile. A line that ends in a tile's last column also leaves a delta
+// in the first pixel of the next tile; if that tile isn't stored, it goes in the extra column.
+struct Tile {
+    float fDeltas[kTileHeight][kTileWidth + 1];
+};
+
+// Builds one pixel row of a band as blitAntiH() runs, merging pixels with equal coverage.
+class RowRuns {
+public:
+    void reset(SkAlpha* aa, int16_t* runs) {
+        fAA = aa;
+        fRuns = runs;
+        fLength = 0;
+        fLastRun = -1;
+        fAnyCoverage = false;
+    }
+
+    void append(SkAlpha alpha, int count) {
+        if (fLastRun >= 0 && fAA[fLastRun] == alpha && fRuns[fLastRun] + count <= SK_MaxS16) {
+            fRuns[fLastRun] += count;
+        } else {
+            fLastRun = fLength;
+            fAA[fLastRun] = alpha;
+            fRuns[fLastRun] = SkToS16(count);
+        }
+        fLength += count;
+        fAnyCoverage |= alpha != 0;
+    }
+
+    void blit(SkBlitter* blitter, int x, int y) {
+        if (fAnyCoverage) {
+            fRuns[fLength] = 0;
+            blitter->blitAntiH(x, y, fAA, fRuns);
+        }
+    }
+
+private:
+    SkAlpha* fAA;
+    int16_t* fRuns;
+    int      fLength;
+    int      fLastRun;
+    bool     fAnyCoverage;
+};
+
+class SparseStripRasterizer {
+public:
+    SparseStripRasterizer(const SkIRect& bounds, SkPathFillType fillType, SkBlitter* blitter)
+            : fBounds(bounds)
+            , fWidth(bounds.width())
+            , fHeight(bounds.height())
+            , fBandCount((bounds.height() + kTileHeight - 1) / kTileHeight)
+            , fEvenOdd(SkPathFillType_IsEvenOdd(fillType))
+            , fBlitter(blitter) {}
+
+    void addPath(const SkPath& path) {
+        SkPath::Iter iter(path, true);
+        SkPoint pts[4];
+        SkPath::Verb verb;
+        while ((verb = iter.next(pts)) != SkPath::kDone_Verb) {
+            switch (verb) {
+                case SkPath::kLine_Verb:
+                    this->addLine(pts[0], pts[1]);
+                    break;
+                case SkPath::kQuad_Verb:
+                    this->addQuad(pts);
+                    break;
+                case SkPath::kConic_Verb: {
+                    SkAutoConicToQuads converter;
+                    const SkPoint* quads = converter.computeQuads(pts, iter.conicWeight(),
+                                                                        kFlattenTolerance);
+                    for (int i = 0; i < converter.countQuads(); ++i) {
+                        this->addQuad(quads + 2 * i);
+                    }
+                    break;
+                }
+                case SkPath::kCubic_Verb:
+                    this->addCubic(pts);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    void rasterize() {
+        if (fLines.empty()) {
+            return;
+        }
+
+        // Bucket the lines by band, with a counting sort.
+        skia_private::AutoTArray<int> bandStarts(fBandCount + 1);
+        std::fill_n(bandStarts.get(), fBandCount + 1, 0);
+        for (const Line& line : fLines) {
+            for (int band = line.fFirstBand; band <= line.fLastBand; ++band) {
+                bandStarts[band + 1]++;
+            }
+        }
+        for (int band = 0; band < fBandCount; ++band) {
+            bandStarts[band + 1] += bandStarts[band];
+        }
+        skia_private::AutoTArray<int> bandLines(bandStarts[fBandCount]);
+        skia_private::AutoTArray<int> cursor(fBandCount);
+        std::copy_n(bandStarts.get(), fBandCount, cursor.get());
+        for (int i = 0; i < fLines.size(); ++i) {
+            for (int band = fLines[i].fFirstBand; band <= fLines[i].fLastBand; ++band) {
+                bandLines[cursor[band]++] = i;
+            }
+        }
+
+        fAA.reset(kTileHeight * (fWidth + 1));
+        fRuns.reset(kTileHeight * (fWidth + 1));
+        for (int band = 0; band < fBandCount; ++band) {
+            if (bandStarts[band] < bandStarts[band + 1]) {
+                this->rasterizeBand(band,
+                                    bandLines.get() + bandStarts[band],
+                                    bandStarts[band + 1] - bandStarts[band]);
+            }
+        }
+    }
+
+private:
+    // Calls fn(row, x0, x1, delta) for each pixel row of the band that the line crosses, where
+    // the line enters the row at x0 and leaves at x1, covering delta of its height.
+    template <typename Fn>
+    static void ForEachRow(const Line& line, int bandTop, int rowCount, int width, Fn&& fn) {
+        const float top    = std::max(line.fP0.fY, (float)bandTop),
+                    bottom = std::min(line.fP1.fY, (float)(bandTop + rowCount));
+        const float dxdy = (line.fP1.fX - line.fP0.fX) / (line.fP1.fY - line.fP0.fY);
+        const int firstRow = std::max((int)top - bandTop, 0),
+                  lastRow  = std::min((int)std::ceil(bottom) - bandTop, rowCount);
+
+        for (int row = firstRow; row < lastRow; ++row) {
+            float y0 = std::max(top, (float)(bandTop + row)),
+                  y1 = std::min(bottom, (float)(bandTop + row + 1));
+            if (y1 <= y0) {
+                continue;
+            }
+            float x0 = SkTPin(line.fP0.fX + (y0 - line.fP0.fY) * dxdy, 0.0f, (float)width),
+                  x1 = SkTPin(line.fP0.fX + (y1 - line.fP0.fY) * dxdy, 0.0f, (float)width);
+            fn(row, x0, x1, (y1 - y0) * line.fDir);
+        }
+    }
+
+    void rasterizeBand(int band, const int lineIndices[], int lineCount) {
+        const int bandTop  = band * kTileHeight;
+        const int rowCount = std::min(kTileHeight, fHeight - bandTop);
+
+        // Find the tiles the lines cross.
+        fTileXs.clear();
+        for (int i = 0; i < lineCount; ++i) {
+            ForEachRow(fLines[lineIndices[i]], bandTop, rowCount, fWidth,
+                       [&](int, float x0, float x1, float) {
+                int first = std::min((int)std::min(x0, x1), fWidth - 1) / kTileWidth,
+                    last  = std::min((int)std::max(x0, x1), fWidth - 1) / kTileWidth;
+                for (int tx = first; tx <= last; ++tx) {
+                    fTileXs.push_back(tx);
+                }
+            });
+        }
+        if (fTileXs.empty()) {
+            return;
+        }
+        std::sort(fTileXs.begin(), fTileXs.end());
+        fTileXs.resize(std::unique(fTileXs.begin(), fTileXs.end()) - fTileXs.begin());
+        fTiles.resize(fTileXs.size());
+        memset(fTiles.data(), 0, fTiles.size_bytes());
+
+        // Accumulate each line's area into the pixels it crosses.
+        for (int i = 0; i < lineCount; ++i) {
+            ForEachRow(fLines[lineIndices[i]], bandTop, rowCount, fWidth,
+                       [&](int row, float x0, float x1, float delta) {
+                this->accumulate(row, x0, x1, delta);
+            });
+        }
+
+        // Walk the tiles, turning the running sum of the deltas into coverage.
+        RowRuns rows[kTileHeight];
+        for (int row = 0; row < rowCount; ++row) {
+            rows[row].reset(fAA.get() + row * (fWidth + 1), fRuns.get() + row * (fWidth + 1));
+        }
+        float cover[kTileHeight] = {};
+        const int startX = fTileXs.front() * kTileWidth;
+        int x = startX;
+
+        auto solidSpan = [&](int end) {
+            if (end <= x) {
+                return;
+            }
+            SkAlpha alphas[kTileHeight];
+            bool opaque = true,
+                 empty = true;
+            for (int row = 0; row < rowCount; ++row) {
+                alphas[row] = this->coverageToAlpha(cover[row]);
+                opaque &= alphas[row] == 0xFF;
+                empty &= alphas[row] == 0;
+            }
+            if (empty && end == fWidth) {
+                return;  // Nothing is drawn past the last strip.
+            }
+            if (opaque) {
+                fBlitter->blitRect(fBounds.fLeft + x, fBounds.fTop + bandTop, end - x, rowCount);
+            }
+            for (int row = 0; row < rowCount; ++row) {
+                rows[row].append(opaque ? 0 : alphas[row], end - x);
+            }
+            x = end;
+        };
+
+        for (int i = 0; i < fTileXs.size(); ++i) {
+            solidSpan(fTileXs[i] * kTileWidth);
+
+            const Tile& tile = fTiles[i];
+            const int columns = std::min(kTileWidth, fWidth - x);
+            for (int row = 0; row < rowCount; ++row) {
+                for (int col = 0; col < columns; ++col) {
+                    cover[row] += tile.fDeltas[row][col];
+                    rows[row].append(this->coverageToAlpha(cover[row]), 1);
+                }
+                cover[row] += tile.fDeltas[row][kTileWidth];
+            }
+            x += columns;
+        }
+        // Lines to the right of the bounds were dropped, so coverage can continue to the edge.
+        solidSpan(fWidth);
+
+        for (int row = 0; row < rowCount; ++row) {
+            rows[row].blit(fBlitter, fBounds.fLeft + startX, fBounds.fTop + bandTop + row);
+        }
+    }
+
+    // Adds the signed area a line covers in each pixel of one row. Whatever isn't covered in the
+    // last pixel it crosses carries into the pixel after it, so a prefix sum over the row yields
+    // each pixel's winding-weighted coverage.
+    void accumulate(int row, float xa, float xb, float delta) {
+        const float x0 = std::min(xa, xb),
+                    x1 = std::max(xa, xb);
+        const int x0i = (int)x0;
+        const int x1i = (int)std::ceil(x1);
+
+        // All of the tiles from x0i up to x1 were found in rasterizeBand(), so they're adjacent
+        // in fTileXs.
+        const int firstTile = std::min(x0i, fWidth - 1) / kTileWidth;
+        const int base = std::lower_bound(fTileXs.begin(), fTileXs.end(), firstTile) -
+                         fTileXs.begin();
+        auto add = [&](int px, float d) {
+            if (px >= fWidth) {
+                return;  // Nothing inside the bounds is to the right of this.
+            }
+            const int tx = px / kTileWidth;
+            const int index = base + tx - firstTile;
+            if (index < fTileXs.size() && fTileXs[index] == tx) {
+                fTiles[index].fDeltas[row][px % kTileWidth] += d;
+            } else {
+                SkASSERT(px % kTileWidth == 0 && index > 0 && fTileXs[index - 1] == tx - 1);
+                fTiles[index - 1].fDeltas[row][kTileWidth] += d;
+            }
+        };
+
+        if (x1i <= x0i + 1) {
+            // The line stays within one pixel.
+            const float xmf = 0.5f * (xa + xb) - x0i;
+            add(x0i,     delta - delta * xmf);
+            add(x0i + 1, delta * xmf);
+            return;
+        }
+
+        const float s   = 1.0f / (x1 - x0);
+        const float x0f = x0 - x0i;
+        const float a0  = 0.5f * s * (1.0f - x0f) * (1.0f - x0f);
+        const float x1f = x1 - x1i + 1.0f;
+        const float am  = 0.5f * s * x1f * x1f;
+
+        add(x0i, delta * a0);
+        if (x1i == x0i + 2) {
+            add(x0i + 1, delta * (1.0f - a0 - am));
+        } else {
+            const float a1 = s * (1.5f - x0f);
+            add(x0i + 1, delta * (a1 - a0));
+            for (int px = x0i + 2; px < x1i - 1; ++px) {
+                add(px, delta * s);
+            }
+            const float a2 = a1 + (x1i - x0i - 3) * s;
+            add(x1i - 1, delta * (1.0f - a2 - am));
+        }
+        add(x1i, delta * am);
+    }
+
+    SkAlpha coverageToAlpha(float cover) const {
+        float coverage = std::abs(cover);
+        if (fEvenOdd) {
+            coverage -= 2.0f * std::floor(coverage * 0.5f);
+            coverage = coverage > 1.0f ? 2.0f - coverage : coverage;
+        }
+        return (SkAlpha)(std::min(coverage, 1.0f) * 255.0f + 0.5f);
+    }
+
+    // Takes device space points, and clips the line to the bounds.
+    void addLine(SkPoint p0, SkPoint p1) {
+        p0 -= {(float)fBounds.fLeft, (float)fBounds.fTop};
+        p1 -= {(float)fBounds.fLeft, (float)fBounds.fTop};
+
+        float dir = 1.0f;
+        if (p0.fY > p1.fY) {
+            std::swap(p0, p1);
+            dir = -1.0f;
+        }
+        // Horizontal lines, and lines above or below the bounds, never change coverage.
+        if (p0.fY == p1.fY || p1.fY <= 0 || p0.fY >= fHeight) {
+            return;
+        }
+        if (p0.fY < 0) {
+            p0 = {p0.fX + (p1.fX - p0.fX) * (0 - p0.fY) / (p1.fY - p0.fY), 0};
+        }
+        if (p1.fY > fHeight) {
+            p1 = {p0.fX + (p1.fX - p0.fX) * (fHeight - p0.fY) / (p1.fY - p0.fY), (float)fHeight};
+        }
+
+        // Split the line where it crosses the left and right edges of the bounds. Parts to the
+        // left still affect the winding of everything inside, so they're moved onto the left
+        // edge; parts to the right affect nothing inside and are dropped.
+        float splits[4] = {p0.fY, 0, 0, p1.fY};
+        int splitCount = 1;
+        for (float edge : {0.0f, (float)fWidth}) {
+            if ((p0.fX < edge) != (p1.fX < edge)) {
+                float y = p0.fY + (p1.fY - p0.fY) * (edge - p0.fX) / (p1.fX - p0.fX);
+                splits[splitCount++] = SkTPin(y, p0.fY, p1.fY);
+            }
+        }
+        splits[splitCount++] = p1.fY;
+        std::sort(splits + 1, splits + splitCount - 1);
+
+        for (int i = 0; i + 1 < splitCount; ++i) {
+            const float y0 = splits[i], y1 = splits[i + 1];
+            if (y0 >= y1) {
+                continue;
+            }
+            auto xAt = [&](float y) {
+                return p0.fX + (p1.fX - p0.fX) * (y - p0.fY) / (p1.fY - p0.fY);
+            };
+            const float midX = xAt(0.5f * (y0 + y1));
+            if (midX >= fWidth) {
+                continue;
+            }
+            const bool onLeft = midX <= 0;
+            this->appendLine({onLeft ? 0 : SkTPin(xAt(y0), 0.0f, (float)fWidth), y0},
+                             {onLeft ? 0 : SkTPin(xAt(y1), 0.0f, (float)fWidth), y1},
+                             dir);
+        }
+    }
+
+    void appendLine(SkPoint p0, SkPoint p1, float dir) {
+        const int firstBand = std::max((int)p0.fY / kTileHeight, 0),
+                  lastBand  = std::min(((int)std::ceil(p1.fY) - 1) / kTileHeight, fBandCount - 1);
+        if (firstBand <= lastBand) {
+            fLines.push_back({p0, p1, dir, firstBand, lastBand});
+        }
+    }
+
+    void addQuad(const SkPoint pts[3]) {
+        // The furthest a line through n evenly spaced points strays from the quad.
+        const float dd = (pts[0] - pts[1] - pts[1] + pts[2]).length();
+        const int n = SkTPin((int)std::ceil(std::sqrt(dd / (4 * kFlattenTolerance))),
+                             1, kMaxLinesPerCurve);
+        SkPoint prev = pts[0];
+        for (int i = 1; i < n; ++i) {
+            SkPoint next = SkEvalQuadAt(pts, (float)i / n);
+            this->addLine(prev, next);
+            prev = next;
+        }
+        this->addLine(prev, pts[2]);
+    }
+
+    void addCubic(const SkPoint pts[4]) {
+        const float dd = std::max((pts[0] - pts[1] - pts[1] + pts[2]).length(),
+                                  (pts[1] - pts[2] - pts[2] + pts[3]).length());
+        const int n = SkTPin((int)std::ceil(std::sqrt(3 * dd / (4 * kFlattenTolerance))),
+                             1, kMaxLinesPerCurve);
+        SkPoint prev = pts[0];
+        for (int i = 1; i < n; ++i) {
+            SkPoint next;
+            SkEvalCubicAt(pts, (float)i / n, &next, nullptr, nullptr);
+            this->addLine(prev, next);
+            prev = next;
+        }
+        this->addLine(prev, pts[3]);
+    }
+
+    const SkIRect fBounds;
+    const int     fWidth;
+    const int     fHeight;
+    const int     fBandCount;
+    const bool    fEvenOdd;
+    SkBlitter*    fBlitter;
+
+    skia_private::TArray<Line, true> fLines;
+    skia_private::TArray<int, true>  fTileXs;
+    skia_private::TArray<Tile, true> fTiles;
+    skia_private::AutoTMalloc<SkAlpha> fAA;
+    skia_private::AutoTMalloc<int16_t> fRuns;
+};
+
+}  // namespace
+
+void SkScan::SparseStripFillPath(const SkPath& path, const SkRegion& clip, SkBlitter* blitter) {
+    if (clip.isEmpty()) {
+        return;
+    }
+    // Inverse fills also cover everything outside the path's bounds, which the strips don't
+    // describe; leave those to the analytic AA scan converter.
+    if (path.isInverseFillType()) {
+        SkScan::AntiFillPath(path, clip, blitter, false);
+        return;
+    }
+
+    SkIRect ir;
+    if (!ir.intersect(path.getBounds().roundOut(), clip.getBounds())) {
+        return;
+    }
+    // blitAntiH() takes int16_t runs, so like the other AA scan converters we can only handle
+    // coordinates that fit in 16 bits.
+    constexpr int kMaxCoord = SK_MaxS16;
+    if (ir.fLeft < -kMaxCoord || ir.fTop < -kMaxCoord ||
+        ir.fRight > kMaxCoord || ir.fBottom > kMaxCoord) {
+        SkScan::AntiFillPath(path, clip, blitter, false);
+        return;
+    }
+
+    SkScanClipper clipper(blitter, &clip, ir);
+    if (!clipper.getBlitter()) {
+        return;
+    }
+
+    SparseStripRasterizer rasterizer(ir, path.getFillType(), clipper.getBlitter());
+    rasterizer.addPath(path);
+    rasterizer.rasterize();
+}
+
+void SkScan::SparseStripFillPath(const SkPath& path, const SkRasterClip& clip,
+                                 SkBlitter* blitter) {
+    if (clip.isEmpty() || !path.isFinite()) {
+        return;
+    }
+
+    if (clip.isBW()) {
+        SparseStripFillPath(path, clip.bwRgn(), blitter);
+    } else {
+        SkRegion        tmp;
+        SkAAClipBlitter aaBlitter;
+
+        tmp.setRect(clip.getBounds());
+        aaBlitter.init(blitter, &clip.aaRgn());
+        SparseStripFillPath(path, tmp, &aaBlitter);
+    }
+}
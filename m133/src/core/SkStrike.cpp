@@ -24,6 +24,7 @@
 #include "src/core/SkWriteBuffer.h"
 #include "src/text/StrikeForGPU.h"
 
+#include <atomic>
 #include <cctype>
 #include <new>
 #include <optional>
@@ -451,6 +452,9 @@ void SkStrike::updateMemoryUsage(size_t increase) {
         fMemoryUsed += increase;
         if (!fRemoved) {
             fStrikeCache->fTotalMemoryUsed += increase;
+            if (fStrikeCache->fTotalMemoryUsed > fStrikeCache->fCacheSizeLimit) {
+                fStrikeCache->fPurgeNeeded.store(true, std::memory_order_relaxed);
+            }
         }
     }
 }
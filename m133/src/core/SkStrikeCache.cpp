@@ -18,6 +18,9 @@
 #include "src/core/SkStrikeSpec.h"
 
 #include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
 #include <utility>
 
 class SkScalerContext;
@@ -37,6 +40,10 @@ SkStrikeCache* SkStrikeCache::GlobalStrikeCache() {
 }
 
 auto SkStrikeCache::findOrCreateStrike(const SkStrikeSpec& strikeSpec) -> sk_sp<SkStrike> {
+    if (sk_sp<SkStrike> strike = this->findStrikeShared(strikeSpec.descriptor())) {
+        return strike;
+    }
+
     SkAutoMutexExclusive ac(fLock);
     sk_sp<SkStrike> strike = this->internalFindStrikeOrNull(strikeSpec.descriptor());
     if (strike == nullptr) {
@@ -58,9 +65,9 @@ void SkStrikeCache::RemoveStrikeByUniqueId(uint32_t uniqueId) {
 void SkStrikeCache::removeStrikeByUniqueId(uint32_t uniqueId) {
     SkAutoMutexExclusive ac(fLock);
     std::vector<SkStrike*> strikes;
-    fStrikeLookup.foreach([&strikes, uniqueId](sk_sp<SkStrike>* item) {
-        if (item && (*item) &&(*item)->strikeSpec().typeface().uniqueID() == uniqueId) {
-            strikes.push_back(item->get());
+    this->lookupUnderLock().foreach([&strikes, uniqueId](const sk_sp<SkStrike>& item) {
+        if (item && item->strikeSpec().typeface().uniqueID() == uniqueId) {
+            strikes.push_back(item.get());
         }
     });
 
@@ -114,36 +121,85 @@ void SkStrikeCache::DumpMemoryStatistics(SkTraceMemoryDump* dump) {
 }
 
 sk_sp<SkStrike> SkStrikeCache::findStrike(const SkDescriptor& desc) {
+    if (sk_sp<SkStrike> strike = this->findStrikeShared(desc)) {
+        return strike;
+    }
+
     SkAutoMutexExclusive ac(fLock);
     sk_sp<SkStrike> result = this->internalFindStrikeOrNull(desc);
     this->internalPurge();
     return result;
 }
 
+auto SkStrikeCache::findStrikeShared(const SkDescriptor& desc) -> sk_sp<SkStrike> {
+    if (fPurgeNeeded.load(std::memory_order_relaxed)) {
+        return nullptr;
+    }
+
+    SkAutoSharedMutexShared lookup(fLookupLock);
+    sk_sp<SkStrike>* strikeHandle = fStrikeLookup.find(desc);
+    if (strikeHandle == nullptr) { return nullptr; }
+    SkStrike* strikePtr = strikeHandle->get();
+
+    // Avoid writing to the strike (and bouncing its cache line between threads) when it's
+    // already marked.
+    if (!strikePtr->fRecentlyUsed.load(std::memory_order_relaxed)) {
+        strikePtr->fRecentlyUsed.store(true, std::memory_order_relaxed);
+    }
+    return sk_ref_sp(strikePtr);
+}
+
 auto SkStrikeCache::internalFindStrikeOrNull(const SkDescriptor& desc) -> sk_sp<SkStrike> {
 
     // Check head because it is likely the strike we are looking for.
     if (fHead != nullptr && fHead->getDescriptor() == desc) { return sk_ref_sp(fHead); }
 
     // Do the heavy search looking for the strike.
-    sk_sp<SkStrike>* strikeHandle = fStrikeLookup.find(desc);
+    const sk_sp<SkStrike>* strikeHandle = this->lookupUnderLock().find(desc);
     if (strikeHandle == nullptr) { return nullptr; }
     SkStrike* strikePtr = strikeHandle->get();
     SkASSERT(strikePtr != nullptr);
-    if (fHead != strikePtr) {
-        // Make most recently used
-        strikePtr->fPrev->fNext = strikePtr->fNext;
-        if (strikePtr->fNext != nullptr) {
-            strikePtr->fNext->fPrev = strikePtr->fPrev;
-        } else {
-            fTail = strikePtr->fPrev;
+    this->internalMoveToHead(strikePtr);  // Make most recently used
+    return sk_ref_sp(strikePtr);
+}
+
+void SkStrikeCache::internalMoveToHead(SkStrike* strikePtr) {
+    if (fHead == strikePtr) {
+        return;
+    }
+    strikePtr->fPrev->fNext = strikePtr->fNext;
+    if (strikePtr->fNext != nullptr) {
+        strikePtr->fNext->fPrev = strikePtr->fPrev;
+    } else {
+        fTail = strikePtr->fPrev;
+    }
+    fHead->fPrev = strikePtr;
+    strikePtr->fNext = fHead;
+    strikePtr->fPrev = nullptr;
+    fHead = strikePtr;
+}
+
+void SkStrikeCache::internalApplyRecentUses() {
+    // Walk from the least recently used strike up to the current head, moving each strike that
+    // was found since the last purge to the head. Strikes found later are closer to the head, so
+    // they end up in front.
+    SkStrike* const oldHead = fHead;
+    SkStrike* strike = fTail;
+    while (strike != nullptr) {
+        SkStrike* prev = strike->fPrev;
+        if (strike->fRecentlyUsed.exchange(false, std::memory_order_relaxed)) {
+            this->internalMoveToHead(strike);
         }
-        fHead->fPrev = strikePtr;
-        strikePtr->fNext = fHead;
-        strikePtr->fPrev = nullptr;
-        fHead = strikePtr;
+        if (strike == oldHead) {
+            break;
+        }
+        strike = prev;
     }
-    return sk_ref_sp(strikePtr);
+}
+
+void SkStrikeCache::internalUpdatePurgeNeeded() {
+    fPurgeNeeded.store(fTotalMemoryUsed > fCacheSizeLimit || fCacheCount > fCacheCountLimit,
+                       std::memory_order_relaxed);
 }
 
 sk_sp<SkStrike> SkStrikeCache::createStrike(
@@ -261,9 +317,12 @@ size_t SkStrikeCache::internalPurge(size_t minBytesNeeded, bool checkPinners) {
 
     // early exit
     if (!countNeeded && !bytesNeeded) {
+        this->internalUpdatePurgeNeeded();
         return 0;
     }
 
+    this->internalApplyRecentUses();
+
     size_t  bytesFreed = 0;
     int     countFreed = 0;
 
@@ -283,6 +342,7 @@ size_t SkStrikeCache::internalPurge(size_t minBytesNeeded, bool checkPinners) {
     }
 
     this->validate();
+    this->internalUpdatePurgeNeeded();
 
 #ifdef SPEW_PURGE_STATUS
     if (countFreed) {
@@ -295,9 +355,12 @@ size_t SkStrikeCache::internalPurge(size_t minBytesNeeded, bool checkPinners) {
 }
 
 void SkStrikeCache::internalAttachToHead(sk_sp<SkStrike> strike) {
-    SkASSERT(fStrikeLookup.find(strike->getDescriptor()) == nullptr);
+    SkASSERT(this->lookupUnderLock().find(strike->getDescriptor()) == nullptr);
     SkStrike* strikePtr = strike.get();
-    fStrikeLookup.set(std::move(strike));
+    {
+        SkAutoSharedMutexExclusive lookup(fLookupLock);
+        fStrikeLookup.set(std::move(strike));
+    }
     SkASSERT(nullptr == strikePtr->fPrev && nullptr == strikePtr->fNext);
 
     fCacheCount += 1;
@@ -314,6 +377,9 @@ void SkStrikeCache::internalAttachToHead(sk_sp<SkStrike> strike) {
     }
 
     fHead = strikePtr; // Transfer ownership of strike to the cache list.
+    if (fTotalMemoryUsed > fCacheSizeLimit || fCacheCount > fCacheCountLimit) {
+        fPurgeNeeded.store(true, std::memory_order_relaxed);
+    }
 }
 
 void SkStrikeCache::internalRemoveStrike(SkStrike* strike) {
@@ -335,6 +401,8 @@ void SkStrikeCache::internalRemoveStrike(SkStrike* strike) {
 
     strike->fPrev = strike->fNext = nullptr;
     strike->fRemoved = true;
+
+    SkAutoSharedMutexExclusive lookup(fLookupLock);
     fStrikeLookup.remove(strike->getDescriptor());
 }
 
@@ -347,7 +415,7 @@ void SkStrikeCache::validate() const {
     while (strike != nullptr) {
         computedBytes += strike->fMemoryUsed;
         computedCount += 1;
-        SkASSERT(fStrikeLookup.findOrNull(strike->getDescriptor()) != nullptr);
+        SkASSERT(this->lookupUnderLock().findOrNull(strike->getDescriptor()) != nullptr);
         strike = strike->fNext;
     }
 
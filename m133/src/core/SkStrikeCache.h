@@ -12,10 +12,12 @@
 #include "include/private/base/SkLoadUserConfig.h" // IWYU pragma: keep
 #include "include/private/base/SkMutex.h"
 #include "include/private/base/SkThreadAnnotations.h"
+#include "src/base/SkSharedMutex.h"
 #include "src/core/SkStrike.h"
 #include "src/core/SkTHash.h"
 #include "src/text/StrikeForGPU.h"
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
@@ -86,6 +88,9 @@ public:
 private:
     friend class SkStrike;  // for SkStrike::updateDelta
     static constexpr char kGlyphCacheDumpName[] = "skia/sk_glyph_cache";
+    // Looks up the strike under the shared lookup lock only. Returns nullptr if the strike isn't
+    // cached, or if the cache needs purging, so that the caller takes fLock and purges.
+    sk_sp<SkStrike> findStrikeShared(const SkDescriptor& desc) SK_EXCLUDES(fLock);
     sk_sp<SkStrike> internalFindStrikeOrNull(const SkDescriptor& desc) SK_REQUIRES(fLock);
     sk_sp<SkStrike> internalCreateStrike(
             const SkStrikeSpec& strikeSpec,
@@ -95,6 +100,12 @@ private:
     // The following methods can only be called when mutex is already held.
     void internalRemoveStrike(SkStrike* strike) SK_REQUIRES(fLock);
     void internalAttachToHead(sk_sp<SkStrike> strike) SK_REQUIRES(fLock);
+    void internalMoveToHead(SkStrike* strike) SK_REQUIRES(fLock);
+
+    // Strikes found by findStrikeShared() are only marked as used; this moves them to the head
+    // of the LRU list before purging.
+    void internalApplyRecentUses() SK_REQUIRES(fLock);
+    void internalUpdatePurgeNeeded() SK_REQUIRES(fLock);
 
     // Checkout budgets, modulated by the specified min-bytes-needed-to-purge,
     // and attempt to purge caches to match.
@@ -113,8 +124,17 @@ private:
         static const SkDescriptor& GetKey(const sk_sp<SkStrike>& strike);
         static uint32_t Hash(const SkDescriptor& descriptor);
     };
-    skia_private::THashTable<sk_sp<SkStrike>, SkDescriptor, StrikeTraits> fStrikeLookup
-            SK_GUARDED_BY(fLock);
+    using StrikeLookup = skia_private::THashTable<sk_sp<SkStrike>, SkDescriptor, StrikeTraits>;
+    // fStrikeLookup is only changed while holding both fLock and fLookupLock exclusively, so it
+    // can be read while holding either one. Cache hits only take fLookupLock shared, which lets
+    // threads find strikes concurrently.
+    const StrikeLookup& lookupUnderLock() const SK_REQUIRES(fLock) SK_NO_THREAD_SAFETY_ANALYSIS {
+        return fStrikeLookup;
+    }
+    mutable SkSharedMutex fLookupLock SK_ACQUIRED_AFTER(fLock);
+    StrikeLookup fStrikeLookup SK_GUARDED_BY(fLookupLock);
+    // Set when the cache is over budget, which sends lookups through fLock to purge.
+    std::atomic<bool> fPurgeNeeded{false};
 
     size_t  fCacheSizeLimit{SK_DEFAULT_FONT_CACHE_LIMIT};
     size_t  fTotalMemoryUsed SK_GUARDED_BY(fLock) {0};
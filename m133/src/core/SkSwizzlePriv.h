@@ -29,7 +29,21 @@ namespace SkOpts {
                            RGB_to_BGR1,     // i.e. swap RB and insert an opaque alpha
                            gray_to_RGB1,    // i.e. expand to color channels + an opaque alpha
                            grayA_to_RGBA,   // i.e. expand to color channels
-                           grayA_to_rgbA;   // i.e. expand to color channels and premultiply
+                           grayA_to_rgbA,   // i.e. expand to color channels and premultiply
+                           RGB16_to_RGB1,   // i.e. narrow big-endian 16-bit components to 8-bit
+                           RGB16_to_BGR1,   //      and insert an opaque alpha
+                           RGBA16_to_RGBA,  // i.e. narrow big-endian 16-bit components to 8-bit
+                           RGBA16_to_BGRA,  //      and swap RB and/or premultiply if needed
+                           RGBA16_to_rgbA,
+                           RGBA16_to_bgrA;
+
+    using Swizzle_565_u8 = void (*)(uint16_t*, const uint8_t*, int);
+    extern Swizzle_565_u8 RGB_to_565,       // i.e. drop the low bits of each component
+                          gray_to_565;      // i.e. expand to color channels and drop the low bits
+
+    // Look up each 8-bit index in a 256-entry table of 8888 colors.
+    using Swizzle_8888_index8 = void (*)(uint32_t*, const uint8_t*, int, const uint32_t*);
+    extern Swizzle_8888_index8 index8_to_8888;
 
     void Init_Swizzler();
 }  // namespace SkOpts
@@ -34,6 +34,9 @@ namespace SkOpts {
         gray_to_RGB1          = hsw::gray_to_RGB1;
         grayA_to_RGBA         = hsw::grayA_to_RGBA;
         grayA_to_rgbA         = hsw::grayA_to_rgbA;
+        RGBA16_to_rgbA        = hsw::RGBA16_to_rgbA;
+        RGBA16_to_bgrA        = hsw::RGBA16_to_bgrA;
+        index8_to_8888        = hsw::index8_to_8888;
         inverted_CMYK_to_RGB1 = hsw::inverted_CMYK_to_RGB1;
         inverted_CMYK_to_BGR1 = hsw::inverted_CMYK_to_BGR1;
     }
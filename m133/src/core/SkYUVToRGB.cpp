@@ -0,0 +1,114 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkYUVToRGB.h"
+
+#include "include/core/SkAlphaType.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkColorType.h"
+#include "include/core/SkPixmap.h"
+#include "include/core/SkSize.h"
+#include "include/core/SkYUVAInfo.h"
+#include "include/core/SkYUVAPixmaps.h"
+#include "src/core/SkYUVAInfoLocation.h"
+#include "src/core/SkYUVMath.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+namespace {
+
+struct Channel {
+    const SkPixmap* fPlane = nullptr;
+    size_t fOffset = 0;  // Of the channel's byte within a pixel.
+    int fStride = 0;     // Bytes per pixel of the plane.
+};
+
+Channel find_channel(const SkYUVAPixmaps& src, const SkYUVAInfo::YUVALocation& location) {
+    if (location.fPlane < 0) {
+        return {};
+    }
+    const SkPixmap& plane = src.plane(location.fPlane);
+    switch (plane.colorType()) {
+        case kAlpha_8_SkColorType:
+        case kGray_8_SkColorType:
+        case kR8_unorm_SkColorType:
+            return {&plane, 0, 1};
+        case kR8G8_unorm_SkColorType:
+            return {&plane, location.fChannel == SkColorChannel::kG ? 1u : 0u, 2};
+        default:
+            return {};
+    }
+}
+
+const uint8_t* row(const Channel& channel, int y) {
+    return static_cast<const uint8_t*>(channel.fPlane->addr(0, y)) + channel.fOffset;
+}
+
+}  // anonymous namespace
+
+bool SkConvertYUVAPixmapsToRGBA(const SkYUVAPixmaps& src, const SkPixmap& dst) {
+    if (!src.isValid() || src.dataType() != SkYUVAPixmaps::DataType::kUnorm8) {
+        return false;
+    }
+    if (dst.colorType() != kRGBA_8888_SkColorType && dst.colorType() != kBGRA_8888_SkColorType) {
+        return false;
+    }
+    const SkYUVAInfo& yuvaInfo = src.yuvaInfo();
+    auto [ssX, ssY] = SkYUVAInfo::SubsamplingFactors(yuvaInfo.subsampling());
+    if (ssX < 1 || ssX > 2 || ssY < 1 || ssY > 2) {
+        return false;
+    }
+
+    const SkYUVAInfo::YUVALocations locations = src.toYUVALocations();
+    const Channel y = find_channel(src, locations[SkYUVAInfo::kY]),
+                  a = find_channel(src, locations[SkYUVAInfo::kA]);
+          Channel u = find_channel(src, locations[SkYUVAInfo::kU]),
+                  v = find_channel(src, locations[SkYUVAInfo::kV]);
+    if (y.fStride != 1 || !u.fPlane || !v.fPlane || u.fStride != v.fStride ||
+        (yuvaInfo.hasAlpha() && a.fStride != 1)) {
+        return false;
+    }
+    if (u.fStride == 2 && u.fPlane != v.fPlane) {
+        return false;
+    }
+    if (y.fPlane->dimensions() != dst.dimensions()) {
+        return false;
+    }
+
+    // Fold the YUV -> RGB matrix into one that works on 8-bit values, with rows in dst's order.
+    float yuvToRGB[20];
+    SkColorMatrix_YUV2RGB(yuvaInfo.yuvColorSpace(), yuvToRGB);
+    float m[12];
+    for (int i = 0; i < 3; ++i) {
+        m[4*i + 0] = yuvToRGB[5*i + 0];
+        m[4*i + 1] = yuvToRGB[5*i + 1];
+        m[4*i + 2] = yuvToRGB[5*i + 2];
+        m[4*i + 3] = yuvToRGB[5*i + 4] * 255;
+    }
+    if (dst.colorType() == kBGRA_8888_SkColorType) {
+        std::swap_ranges(m + 0, m + 4, m + 8);
+    }
+    // Interleaved chroma is read starting from whichever of U and V comes first.
+    if (u.fStride == 2 && v.fOffset < u.fOffset) {
+        std::swap(u, v);
+        for (int i = 0; i < 3; ++i) {
+            std::swap(m[4*i + 1], m[4*i + 2]);
+        }
+    }
+
+    const bool premul = yuvaInfo.hasAlpha() && dst.alphaType() == kPremul_SkAlphaType;
+    for (int j = 0; j < dst.height(); ++j) {
+        const int chromaY = j / ssY;
+        SkOpts::yuva_to_rgba(dst.writable_addr32(0, j),
+                             row(y, j), row(u, chromaY), row(v, chromaY),
+                             yuvaInfo.hasAlpha() ? row(a, j) : nullptr,
+                             dst.width(), m, ssX - 1, u.fStride, premul);
+    }
+    return true;
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkYUVToRGB_DEFINED
+#define SkYUVToRGB_DEFINED
+
+#include <cstdint>
+
+class SkPixmap;
+class SkYUVAPixmaps;
+
+namespace SkOpts {
+    // Converts a row of 8-bit Y, U, V and (optional) A samples to 8888 pixels, R in the low byte.
+    //
+    // Each output channel c is round(m[4c+0]*Y + m[4c+1]*U + m[4c+2]*V + m[4c+3]), clamped to
+    // [0, 255], and then premultiplied by A/255 if premul is set. If a is nullptr, A is 255.
+    //
+    // Each U and V sample covers (1 << chromaShift) pixels horizontally; chromaShift is 0 or 1.
+    // chromaStride is the distance in bytes between U samples, 1 or 2. When it is 2, U and V are
+    // interleaved and v must be u + 1.
+    extern void (*yuva_to_rgba)(uint32_t dst[],
+                                const uint8_t y[], const uint8_t u[], const uint8_t v[],
+                                const uint8_t a[], int count,
+                                const float m[12], int chromaShift, int chromaStride,
+                                bool premul);
+
+    void Init_YUVToRGB();
+}  // namespace SkOpts
+
+// Converts src to the 8888 pixels of dst, which must have the dimensions of src's planes before
+// any orientation is applied. Chroma is upsampled by replication. dst is premultiplied unless
+// its alpha type is unpremul; it is opaque if src has no alpha plane.
+//
+// Handles 8-bit planes with 4:4:4, 4:2:2, 4:4:0 or 4:2:0 subsampling where Y and A are each in
+// a single channel plane, and U and V are each in a single channel plane or interleaved in a
+// two channel plane. Returns false, leaving dst untouched, for any other layout.
+bool SkConvertYUVAPixmapsToRGBA(const SkYUVAPixmaps& src, const SkPixmap& dst);
+
+#endif // SkYUVToRGB_DEFINED
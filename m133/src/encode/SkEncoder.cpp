@@ -7,14 +7,28 @@
 
 #include "include/encode/SkEncoder.h"
 
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkColorSpace.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkRect.h"
 #include "include/private/base/SkAssert.h"
 
+#include <algorithm>
+
 bool SkEncoder::encodeRows(int numRows) {
     SkASSERT(numRows > 0 && fCurrRow < fSrc.height());
     if (numRows <= 0 || fCurrRow >= fSrc.height()) {
         return false;
     }
 
+    // Encoders made without pixels can only encode the rows they are given.
+    SkASSERT(fSrc.addr() || fRows.addr());
+    if (!fSrc.addr() && !fRows.addr()) {
+        return false;
+    }
+
     if (fCurrRow + numRows > fSrc.height()) {
         numRows = fSrc.height() - fCurrRow;
     }
@@ -27,3 +41,57 @@ bool SkEncoder::encodeRows(int numRows) {
 
     return true;
 }
+
+bool SkEncoder::encodeRows(const SkPixmap& rows) {
+    if (!rows.addr() || rows.height() <= 0 || rows.rowBytes() < rows.info().minRowBytes() ||
+        rows.width() != fSrc.width() ||
+        rows.colorType() != fSrc.colorType() ||
+        rows.alphaType() != fSrc.alphaType() ||
+        !SkColorSpace::Equals(rows.colorSpace(), fSrc.colorSpace())) {
+        return false;
+    }
+
+    fRows = rows;
+    fRowsTop = fCurrRow;
+    const bool success = this->encodeRows(rows.height());
+    fRows.reset();
+    return success;
+}
+
+bool SkEncoder::encodeBands(int bandHeight, const std::function<void(SkCanvas*)>& draw) {
+    if (bandHeight <= 0 || fCurrRow >= fSrc.height()) {
+        return false;
+    }
+
+    SkBitmap band;
+    bandHeight = std::min(bandHeight, fSrc.height() - fCurrRow);
+    if (!band.tryAllocPixels(fSrc.info().makeDimensions({fSrc.width(), bandHeight}))) {
+        return false;
+    }
+
+    while (fCurrRow < fSrc.height()) {
+        const int top = fCurrRow;
+        const int rows = std::min(bandHeight, fSrc.height() - top);
+
+        band.eraseColor(SK_ColorTRANSPARENT);
+        SkCanvas canvas(band);
+        canvas.clipRect(SkRect::MakeIWH(fSrc.width(), rows));
+        canvas.translate(0, -top);
+        draw(&canvas);
+
+        SkPixmap pixmap;
+        if (!band.pixmap().extractSubset(&pixmap, SkIRect::MakeWH(fSrc.width(), rows)) ||
+            !this->encodeRows(pixmap)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const void* SkEncoder::srcRow(int y) const {
+    if (fRows.addr()) {
+        SkASSERT(y >= fRowsTop && y < fRowsTop + fRows.height());
+        return fRows.addr(0, y - fRowsTop);
+    }
+    return fSrc.addr(0, y);
+}
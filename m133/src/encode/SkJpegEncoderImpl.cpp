@@ -307,7 +307,9 @@ std::unique_ptr<SkEncoder> SkJpegEncoderImpl::MakeRGB(
         const SkPixmap& src,
         const SkJpegEncoder::Options& options,
         const SkJpegMetadataEncoder::SegmentList& metadataSegments) {
-    if (!SkPixmapIsValid(src)) {
+    // |src| has no pixels if they will be passed to encodeRows(const SkPixmap&) instead.
+    if (!SkImageInfoIsValid(src.info()) ||
+        (src.addr() && src.rowBytes() < src.info().minRowBytes())) {
         return nullptr;
     }
     std::unique_ptr<SkJpegEncoderMgr> encoderMgr = SkJpegEncoderMgr::Make(dst);
@@ -343,6 +345,10 @@ bool SkJpegEncoderImpl::onEncodeRows(int numRows) {
     }
 
     if (fSrcYUVA) {
+        // YUVA planes cannot be passed to encodeRows(const SkPixmap&).
+        if (fRows.addr()) {
+            return false;
+        }
         // TODO(ccameron): Consider using jpeg_write_raw_data, to avoid having to re-pack the data.
         for (int i = 0; i < numRows; i++) {
             yuva_copy_row(*fSrcYUVA, fCurrRow + i, fStorage.get());
@@ -352,8 +358,8 @@ bool SkJpegEncoderImpl::onEncodeRows(int numRows) {
     } else {
         const size_t srcBytes = SkColorTypeBytesPerPixel(fSrc.colorType()) * fSrc.width();
         const size_t jpegSrcBytes = fEncoderMgr->cinfo()->input_components * fSrc.width();
-        const void* srcRow = fSrc.addr(0, fCurrRow);
         for (int i = 0; i < numRows; i++) {
+            const void* srcRow = this->srcRow(fCurrRow + i);
             JSAMPLE* jpegSrcRow = (JSAMPLE*)(const_cast<void*>(srcRow));
             if (fEncoderMgr->proc()) {
                 sk_msan_assert_initialized(srcRow, SkTAddOffset<const void>(srcRow, srcBytes));
@@ -372,7 +378,6 @@ bool SkJpegEncoderImpl::onEncodeRows(int numRows) {
             }
 
             jpeg_write_scanlines(fEncoderMgr->cinfo(), &jpegSrcRow, 1);
-            srcRow = SkTAddOffset<const void>(srcRow, fSrc.rowBytes());
         }
     }
 
@@ -414,7 +419,9 @@ sk_sp<SkData> Encode(GrDirectContext* ctx, const SkImage* img, const Options& op
     return nullptr;
 }
 
-std::unique_ptr<SkEncoder> Make(SkWStream* dst, const SkPixmap& src, const Options& options) {
+static std::unique_ptr<SkEncoder> make_rgb(SkWStream* dst,
+                                           const SkPixmap& src,
+                                           const Options& options) {
     SkJpegMetadataEncoder::SegmentList metadataSegments;
     SkJpegMetadataEncoder::AppendXMPStandard(metadataSegments, options.xmpMetadata);
     SkJpegMetadataEncoder::AppendICC(metadataSegments, options, src.colorSpace());
@@ -424,6 +431,17 @@ std::unique_ptr<SkEncoder> Make(SkWStream* dst, const SkPixmap& src, const Optio
     return SkJpegEncoderImpl::MakeRGB(dst, src, options, metadataSegments);
 }
 
+std::unique_ptr<SkEncoder> Make(SkWStream* dst, const SkPixmap& src, const Options& options) {
+    if (!SkPixmapIsValid(src)) {
+        return nullptr;
+    }
+    return make_rgb(dst, src, options);
+}
+
+std::unique_ptr<SkEncoder> Make(SkWStream* dst, const SkImageInfo& info, const Options& options) {
+    return make_rgb(dst, SkPixmap(info, nullptr, info.minRowBytes()), options);
+}
+
 std::unique_ptr<SkEncoder> Make(SkWStream* dst,
                                 const SkYUVAPixmaps& src,
                                 const SkColorSpace* srcColorSpace,
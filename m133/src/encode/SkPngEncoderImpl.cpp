@@ -27,8 +27,11 @@
 #include "include/private/base/SkAssert.h"
 #include "include/private/base/SkDebug.h"
 #include "include/private/base/SkNoncopyable.h"
+#include "include/private/base/SkTemplates.h"
+#include "include/private/base/SkTo.h"
 #include "modules/skcms/skcms.h"
 #include "src/codec/SkPngPriv.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/encode/SkImageEncoderFns.h"
 #include "src/encode/SkImageEncoderPriv.h"
 #include "src/encode/SkPngEncoderBase.h"
@@ -45,6 +48,7 @@
 
 #include <png.h>
 #include <pngconf.h>
+#include "zlib.h"  // NO_G3_REWRITE
 
 class GrDirectContext;
 class SkImage;
@@ -401,43 +405,304 @@ bool SkPngEncoderImpl::onFinishEncoding() {
     return true;
 }
 
-namespace SkPngEncoder {
-std::unique_ptr<SkEncoder> Make(SkWStream* dst, const SkPixmap& src, const Options& options) {
-    if (!SkPixmapIsValid(src)) {
+// Writes everything that comes before the image data.
+static std::unique_ptr<SkPngEncoderMgr> write_header(SkWStream* dst,
+                                                     const SkPixmap& src,
+                                                     const SkEncodedInfo& dstInfo,
+                                                     const SkPngEncoder::Options& options) {
+    std::unique_ptr<SkPngEncoderMgr> encoderMgr = SkPngEncoderMgr::Make(dst);
+    if (!encoderMgr) {
         return nullptr;
     }
 
-    std::unique_ptr<SkPngEncoderMgr> encoderMgr = SkPngEncoderMgr::Make(dst);
-    if (!encoderMgr) {
+    if (!encoderMgr->setHeader(dstInfo, src.info(), options)) {
         return nullptr;
     }
 
-    std::optional<SkPngEncoderBase::TargetInfo> targetInfo =
-            SkPngEncoderBase::getTargetInfo(src.info());
-    if (!targetInfo.has_value()) {
+    if (!encoderMgr->setColorSpace(src.info(), options)) {
         return nullptr;
     }
 
-    if (!encoderMgr->setHeader(targetInfo->fDstInfo, src.info(), options)) {
+    if (options.fGainmapInfo && !encoderMgr->setV0Gainmap(options)) {
         return nullptr;
     }
 
-    if (!encoderMgr->setColorSpace(src.info(), options)) {
+    if (!encoderMgr->writeInfo(src.info())) {
         return nullptr;
     }
+    return encoderMgr;
+}
 
-    if (options.fGainmapInfo && !encoderMgr->setV0Gainmap(options)) {
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// When SkPngEncoder::Options::fExecutor is set, Encode() writes the header with libpng, and then
+// filters and deflates stripes of rows in parallel itself. Each stripe is deflated independently
+// and, except for the last one, ends with a sync flush, which pads it to a byte boundary without
+// ending the deflate stream. So the stripes concatenate into one valid zlib stream, like pigz does.
+
+// Stripes this large compress nearly as well as one big stream does.
+static constexpr size_t kMinStripeBytes = 256 * 1024;
+
+static int rows_per_stripe(const SkPngEncoderBase::TargetInfo& targetInfo) {
+    return std::max(1, SkToInt(kMinStripeBytes / (targetInfo.fDstRowSize + 1)));
+}
+
+static uint8_t paeth_predictor(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = std::abs(p - a),
+        pb = std::abs(p - b),
+        pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) {
+        return a;
+    }
+    return pb <= pc ? b : c;
+}
+
+// Applies PNG filter type `filter` to `row`, given the unfiltered row above it, `prev`.
+static void apply_filter(int filter, const uint8_t* row, const uint8_t* prev, size_t size,
+                         size_t bpp, uint8_t* dst) {
+    // The first pixel has nothing to its left.
+    const size_t first = std::min(bpp, size);
+    switch (filter) {
+        case PNG_FILTER_VALUE_NONE:
+            memcpy(dst, row, size);
+            break;
+        case PNG_FILTER_VALUE_SUB:
+            memcpy(dst, row, first);
+            for (size_t i = first; i < size; i++) {
+                dst[i] = row[i] - row[i - bpp];
+            }
+            break;
+        case PNG_FILTER_VALUE_UP:
+            for (size_t i = 0; i < size; i++) {
+                dst[i] = row[i] - prev[i];
+            }
+            break;
+        case PNG_FILTER_VALUE_AVG:
+            for (size_t i = 0; i < first; i++) {
+                dst[i] = row[i] - (prev[i] >> 1);
+            }
+            for (size_t i = first; i < size; i++) {
+                dst[i] = row[i] - ((row[i - bpp] + prev[i]) >> 1);
+            }
+            break;
+        case PNG_FILTER_VALUE_PAETH:
+            for (size_t i = 0; i < first; i++) {
+                dst[i] = row[i] - prev[i];
+            }
+            for (size_t i = first; i < size; i++) {
+                dst[i] = row[i] - paeth_predictor(row[i - bpp], prev[i], prev[i - bpp]);
+            }
+            break;
+    }
+}
+
+// Like libpng, when more than one filter is allowed this picks the one whose output, read as
+// signed bytes, has the smallest sum of absolute values.
+static void filter_row(int filterFlags, const uint8_t* row, const uint8_t* prev, size_t size,
+                       size_t bpp, uint8_t* dst, uint8_t* scratch) {
+    uint64_t bestSum = UINT64_MAX;
+    for (int filter = PNG_FILTER_VALUE_NONE; filter <= PNG_FILTER_VALUE_PAETH; filter++) {
+        if (!(filterFlags & (PNG_FILTER_NONE << filter))) {
+            continue;
+        }
+        if (bestSum == UINT64_MAX && !(filterFlags & ~(PNG_FILTER_NONE << filter))) {
+            // This is the only allowed filter.
+            dst[0] = filter;
+            apply_filter(filter, row, prev, size, bpp, dst + 1);
+            return;
+        }
+        apply_filter(filter, row, prev, size, bpp, scratch);
+        uint64_t sum = 0;
+        for (size_t i = 0; i < size; i++) {
+            sum += scratch[i] < 128 ? scratch[i] : 256 - scratch[i];
+        }
+        if (sum < bestSum) {
+            bestSum = sum;
+            dst[0] = filter;
+            memcpy(dst + 1, scratch, size);
+        }
+    }
+}
+
+namespace {
+struct DeflatedStripe {
+    std::vector<uint8_t> fData;
+    uLong fAdler = 0;
+    size_t fFilteredSize = 0;
+    bool fSucceeded = false;
+};
+}  // namespace
+
+static void deflate_stripe(const SkPixmap& src,
+                           const SkPngEncoderBase::TargetInfo& targetInfo,
+                           int filterFlags,
+                           int zlibLevel,
+                           int firstRow,
+                           int endRow,
+                           bool isLast,
+                           DeflatedStripe* stripe) {
+    const size_t rowSize = targetInfo.fDstRowSize;
+    const size_t bpp = std::max(1, targetInfo.fDstInfo.bitsPerPixel() / 8);
+    auto transformRow = [&](int y, uint8_t* dst) {
+        targetInfo.fTransformProc((char*)dst,
+                                  (const char*)src.addr(0, y),
+                                  src.width(),
+                                  SkColorTypeBytesPerPixel(src.colorType()));
+    };
+
+    // Filtering a stripe's first row needs the last row of the stripe above.
+    skia_private::AutoTMalloc<uint8_t> rows(2 * rowSize), scratch(rowSize);
+    uint8_t* prev = rows.get();
+    uint8_t* curr = rows.get() + rowSize;
+    if (firstRow > 0) {
+        transformRow(firstRow - 1, prev);
+    } else {
+        memset(prev, 0, rowSize);
+    }
+
+    stripe->fFilteredSize = (rowSize + 1) * (endRow - firstRow);
+    skia_private::AutoTMalloc<uint8_t> filtered(stripe->fFilteredSize);
+    for (int y = firstRow; y < endRow; y++) {
+        transformRow(y, curr);
+        filter_row(filterFlags, curr, prev, rowSize, bpp,
+                   filtered.get() + (rowSize + 1) * (y - firstRow), scratch.get());
+        std::swap(prev, curr);
+    }
+
+    z_stream zstream = {};
+    // Match libpng's choice of strategy.
+    const int strategy = filterFlags == PNG_FILTER_NONE ? Z_DEFAULT_STRATEGY : Z_FILTERED;
+    if (deflateInit2(&zstream, zlibLevel, Z_DEFLATED, -MAX_WBITS, 8, strategy) != Z_OK) {
+        return;
+    }
+    // The sync flush that ends all but the last stripe adds a few bytes to what deflateBound()
+    // allows for.
+    const size_t headerSize = stripe->fData.size();
+    stripe->fData.resize(headerSize + deflateBound(&zstream, stripe->fFilteredSize) + 16);
+    zstream.next_in = filtered.get();
+    zstream.avail_in = SkToUInt(stripe->fFilteredSize);
+    zstream.next_out = stripe->fData.data() + headerSize;
+    zstream.avail_out = SkToUInt(stripe->fData.size() - headerSize);
+    int result = deflate(&zstream, isLast ? Z_FINISH : Z_SYNC_FLUSH);
+    stripe->fSucceeded = isLast ? result == Z_STREAM_END
+                                : result == Z_OK && zstream.avail_in == 0 && zstream.avail_out > 0;
+    stripe->fData.resize(headerSize + zstream.total_out);
+    deflateEnd(&zstream);
+
+    stripe->fAdler = adler32(adler32(0, nullptr, 0), filtered.get(),
+                             SkToUInt(stripe->fFilteredSize));
+}
+
+static bool write_chunk(SkWStream* dst, const char type[4], const uint8_t* data, size_t size) {
+    auto writeBE32 = [dst](uint32_t v) {
+        const uint8_t bytes[] = {(uint8_t)(v >> 24), (uint8_t)(v >> 16),
+                                 (uint8_t)(v >>  8), (uint8_t)(v >>  0)};
+        return dst->write(bytes, sizeof(bytes));
+    };
+    uLong crc = crc32(0, reinterpret_cast<const Bytef*>(type), 4);
+    if (size > 0) {
+        crc = crc32(crc, data, SkToUInt(size));
+    }
+    return writeBE32(SkToU32(size)) && dst->write(type, 4) && dst->write(data, size) &&
+           writeBE32(SkToU32(crc));
+}
+
+static bool encode_stripes(SkWStream* dst,
+                           const SkPixmap& src,
+                           const SkPngEncoderBase::TargetInfo& targetInfo,
+                           const SkPngEncoder::Options& options) {
+    std::unique_ptr<SkPngEncoderMgr> encoderMgr =
+            write_header(dst, src, targetInfo.fDstInfo, options);
+    if (!encoderMgr) {
+        return false;
+    }
+
+    // Like libpng, treat no filters as the default, all of them.
+    int filterFlags = (int)options.fFilterFlags & (int)SkPngEncoder::FilterFlag::kAll;
+    if (filterFlags == 0) {
+        filterFlags = PNG_ALL_FILTERS;
+    }
+    const int zlibLevel = std::min(std::max(0, options.fZLibLevel), 9);
+    const int rowsPerStripe = rows_per_stripe(targetInfo);
+    const int stripeCount = (src.height() + rowsPerStripe - 1) / rowsPerStripe;
+
+    std::vector<DeflatedStripe> stripes(stripeCount);
+    // The zlib header, as deflate() would write it for this level and strategy.
+    const int levelFlags = zlibLevel < 2 ? 0 : zlibLevel < 6 ? 1 : zlibLevel == 6 ? 2 : 3;
+    uint32_t zlibHeader = (Z_DEFLATED + ((MAX_WBITS - 8) << 4)) << 8 | levelFlags << 6;
+    zlibHeader += 31 - zlibHeader % 31;
+    stripes[0].fData = {(uint8_t)(zlibHeader >> 8), (uint8_t)zlibHeader};
+
+    SkTaskGroup(*options.fExecutor).batch(stripeCount, [&](int i) {
+        const int firstRow = i * rowsPerStripe;
+        const int endRow = std::min(src.height(), firstRow + rowsPerStripe);
+        deflate_stripe(src, targetInfo, filterFlags, zlibLevel, firstRow, endRow,
+                       i == stripeCount - 1, &stripes[i]);
+    });
+
+    // The zlib stream ends with the Adler-32 checksum of everything it compressed.
+    uLong adler = adler32(0, nullptr, 0);
+    for (const DeflatedStripe& stripe : stripes) {
+        if (!stripe.fSucceeded) {
+            return false;
+        }
+        adler = adler32_combine(adler, stripe.fAdler, (z_off_t)stripe.fFilteredSize);
+    }
+    stripes.back().fData.insert(stripes.back().fData.end(),
+                                {(uint8_t)(adler >> 24), (uint8_t)(adler >> 16),
+                                 (uint8_t)(adler >>  8), (uint8_t)(adler >>  0)});
+
+    for (const DeflatedStripe& stripe : stripes) {
+        if (!write_chunk(dst, "IDAT", stripe.fData.data(), stripe.fData.size())) {
+            return false;
+        }
+    }
+    return write_chunk(dst, "IEND", nullptr, 0);
+}
+
+// |src| has no pixels if they will be passed to encodeRows(const SkPixmap&) instead.
+static std::unique_ptr<SkEncoder> make(SkWStream* dst,
+                                       const SkPixmap& src,
+                                       const SkPngEncoder::Options& options) {
+    std::optional<SkPngEncoderBase::TargetInfo> targetInfo =
+            SkPngEncoderBase::getTargetInfo(src.info());
+    if (!targetInfo.has_value()) {
         return nullptr;
     }
 
-    if (!encoderMgr->writeInfo(src.info())) {
+    std::unique_ptr<SkPngEncoderMgr> encoderMgr =
+            write_header(dst, src, targetInfo->fDstInfo, options);
+    if (!encoderMgr) {
         return nullptr;
     }
 
     return std::make_unique<SkPngEncoderImpl>(std::move(*targetInfo), std::move(encoderMgr), src);
 }
 
+namespace SkPngEncoder {
+std::unique_ptr<SkEncoder> Make(SkWStream* dst, const SkPixmap& src, const Options& options) {
+    if (!SkPixmapIsValid(src)) {
+        return nullptr;
+    }
+    return make(dst, src, options);
+}
+
+std::unique_ptr<SkEncoder> Make(SkWStream* dst, const SkImageInfo& info, const Options& options) {
+    if (!SkImageInfoIsValid(info)) {
+        return nullptr;
+    }
+    return make(dst, SkPixmap(info, nullptr, info.minRowBytes()), options);
+}
+
 bool Encode(SkWStream* dst, const SkPixmap& src, const Options& options) {
+    if (options.fExecutor && SkPixmapIsValid(src) && src.width() > 0) {
+        std::optional<SkPngEncoderBase::TargetInfo> targetInfo =
+                SkPngEncoderBase::getTargetInfo(src.info());
+        if (targetInfo && src.height() > rows_per_stripe(*targetInfo)) {
+            return encode_stripes(dst, src, *targetInfo, options);
+        }
+    }
     auto encoder = Make(dst, src, options);
     return encoder.get() && encoder->encodeRows(src.height());
 }
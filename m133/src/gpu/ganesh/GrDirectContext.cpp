@@ -57,6 +57,8 @@
 #include "src/gpu/ganesh/text/GrAtlasManager.h"
 #include "src/image/SkImage_Base.h"
 #include "src/image/SkSurface_Base.h"
+#include "src/sksl/SkSLModuleLoader.h"
+#include "src/sksl/SkSLProgramKind.h"
 #include "src/text/gpu/StrikeCache.h"
 #include "src/text/gpu/TextBlobRedrawCoordinator.h"
 
@@ -293,6 +295,15 @@ bool GrDirectContext::init() {
     // get passed on to/shared between all the DDLRecorders created with this context.
     if (this->options().fExecutor) {
         fTaskGroup = std::make_unique<SkTaskGroup>(*this->options().fExecutor);
+
+        // Compile the SkSL modules our first shaders will need while the rest of the context is
+        // set up, rather than on the thread that creates the first program.
+        static constexpr SkSL::ProgramKind kPreloadedKinds[] = {
+                SkSL::ProgramKind::kVertex,
+                SkSL::ProgramKind::kFragment,
+                SkSL::ProgramKind::kPrivateRuntimeShader,
+        };
+        SkSL::ModuleLoader::PreloadModules(kPreloadedKinds, *this->options().fExecutor);
     }
 
     fPersistentCache = this->options().fPersistentCache;
@@ -15,6 +15,7 @@
 #include "include/core/SkSize.h"
 #include "include/core/SkSurface.h"
 #include "include/core/SkYUVAInfo.h"
+#include "src/base/SkTime.h"
 #include "src/core/SkBitmapCache.h"
 #include "src/core/SkCachedData.h"
 #include "src/core/SkNextID.h"
@@ -128,13 +129,15 @@ bool SkImage_Lazy::getROPixels(GrDirectContext* ctx, SkBitmap* bitmap,
             return false;
         }
         bool success = false;
+        // Timed so the cache knows how expensive this is to decode again.
+        const double start = SkTime::GetNSecs();
         {   // make sure ScopedGenerator goes out of scope before we try readPixelsProxy
             success = ScopedGenerator(fSharedGenerator)->getPixels(pmap);
         }
         if (!success && !this->readPixelsProxy(ctx, pmap)) {
             return false;
         }
-        SkBitmapCache::Add(std::move(cacheRec), bitmap);
+        SkBitmapCache::Add(std::move(cacheRec), bitmap, SkTime::GetNSecs() - start);
         this->notifyAddedToRasterCache();
     } else {
         if (!bitmap->tryAllocPixels(this->imageInfo())) {
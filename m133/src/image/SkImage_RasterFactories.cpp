@@ -5,19 +5,29 @@
  * found in the LICENSE file.
  */
 
+#include "include/codec/SkEncodedOrigin.h"
 #include "include/core/SkAlphaType.h"
 #include "include/core/SkBitmap.h"
+#include "include/core/SkBlendMode.h"
+#include "include/core/SkCanvas.h"
 #include "include/core/SkColorType.h"
+#include "include/core/SkColorSpace.h"
 #include "include/core/SkData.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkImageInfo.h"
+#include "include/core/SkPaint.h"
 #include "include/core/SkPixmap.h"
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkSamplingOptions.h"
+#include "include/core/SkSize.h"
+#include "include/core/SkYUVAInfo.h"
+#include "include/core/SkYUVAPixmaps.h"
 #include "include/private/base/SkMath.h"
 #include "src/core/SkCompressedDataUtils.h"
 #include "src/core/SkImageFilterTypes.h"
 #include "src/core/SkImageFilter_Base.h"
 #include "src/core/SkImagePriv.h"
+#include "src/core/SkYUVToRGB.h"
 #include "src/image/SkImage_Base.h"
 #include "src/image/SkImage_Raster.h"
 
@@ -160,6 +170,44 @@ sk_sp<SkImage> RasterFromPixmap(const SkPixmap& pmap, RasterReleaseProc proc, Re
     return sk_make_sp<SkImage_Raster>(pmap.info(), std::move(data), pmap.rowBytes());
 }
 
+sk_sp<SkImage> RasterFromYUVAPixmaps(const SkYUVAPixmaps& pixmaps,
+                                     sk_sp<SkColorSpace> imageColorSpace) {
+    if (!pixmaps.isValid()) {
+        return nullptr;
+    }
+    const SkYUVAInfo& yuvaInfo = pixmaps.yuvaInfo();
+    const SkAlphaType at = yuvaInfo.hasAlpha() ? kPremul_SkAlphaType : kOpaque_SkAlphaType;
+
+    // Convert the planes as they are stored, then orient the result if needed.
+    SkISize planeDimensions[SkYUVAInfo::kMaxPlanes];
+    yuvaInfo.planeDimensions(planeDimensions);
+    SkImageInfo ii = SkImageInfo::MakeN32(planeDimensions[0].width(),
+                                          planeDimensions[0].height(),
+                                          at,
+                                          imageColorSpace);
+    SkBitmap bitmap;
+    if (!valid_args(ii, ii.minRowBytes(), nullptr) || !bitmap.tryAllocPixels(ii) ||
+        !SkConvertYUVAPixmapsToRGBA(pixmaps, bitmap.pixmap())) {
+        return nullptr;
+    }
+
+    if (yuvaInfo.origin() != kTopLeft_SkEncodedOrigin) {
+        SkBitmap oriented;
+        if (!oriented.tryAllocPixels(ii.makeDimensions(yuvaInfo.dimensions()))) {
+            return nullptr;
+        }
+        SkCanvas canvas(oriented);
+        canvas.concat(yuvaInfo.originMatrix());
+        SkPaint paint;
+        paint.setBlendMode(SkBlendMode::kSrc);
+        canvas.drawImage(bitmap.asImage(), 0, 0, SkSamplingOptions(), &paint);
+        bitmap = std::move(oriented);
+    }
+
+    bitmap.setImmutable();
+    return RasterFromBitmap(bitmap);
+}
+
 }  // namespace SkImages
 
 sk_sp<SkImage> MakeRasterCopyPriv(const SkPixmap& pmap, uint32_t id) {
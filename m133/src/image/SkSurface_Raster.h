@@ -49,7 +49,7 @@ public:
     void onRestoreBackingMutability() override;
     sk_sp<const SkCapabilities> onCapabilities() override;
 
-private:
+protected:
     SkBitmap    fBitmap;
     bool        fWeOwnThePixels;
 
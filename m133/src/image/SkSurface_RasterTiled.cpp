@@ -0,0 +1,580 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/image/SkSurface_RasterTiled.h"
+
+#include "include/core/SkBBHFactory.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkCanvasVirtualEnforcer.h"
+#include "include/core/SkDrawable.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkM44.h"
+#include "include/core/SkMallocPixelRef.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkPixelRef.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkSurface.h"
+#include "include/core/SkSurfaceProps.h"
+#include "include/private/base/SkAssert.h"
+#include "include/private/base/SkTArray.h"
+#include "include/private/base/SkTemplates.h"
+#include "include/private/chromium/Slug.h"
+#include "src/core/SkBitmapDevice.h"
+#include "src/core/SkCanvasPriv.h"
+#include "src/core/SkRTree.h"
+#include "src/core/SkRecord.h"
+#include "src/core/SkRecordDraw.h"
+#include "src/core/SkRecorder.h"
+#include "src/core/SkRecords.h"
+#include "src/core/SkSurfacePriv.h"
+#include "src/text/GlyphRun.h"
+
+#include <memory>
+#include <new>
+#include <utility>
+
+using namespace skia_private;
+
+namespace {
+
+// How an op participates in the canvas state once everything before it has been rasterized.
+enum class OpRole {
+    kSave,       // opens a block closed by a Restore
+    kRestore,
+    kMatrix,     // matrix change that later ops still depend on
+    kClip,       // clip change that later ops still depend on
+    kResetClip,  // undoes the clip changes before it
+    kDrawn,      // contributes pixels only; can be discarded after a flush
+};
+
+struct ClassifyOp {
+    OpRole operator()(const SkRecords::Save&)       { return OpRole::kSave; }
+    OpRole operator()(const SkRecords::SaveLayer&)  { return OpRole::kSave; }
+    OpRole operator()(const SkRecords::SaveBehind&) { return OpRole::kSave; }
+    OpRole operator()(const SkRecords::Restore&)    { return OpRole::kRestore; }
+    OpRole operator()(const SkRecords::SetMatrix&)  { return OpRole::kMatrix; }
+    OpRole operator()(const SkRecords::SetM44&)     { return OpRole::kMatrix; }
+    OpRole operator()(const SkRecords::Translate&)  { return OpRole::kMatrix; }
+    OpRole operator()(const SkRecords::Scale&)      { return OpRole::kMatrix; }
+    OpRole operator()(const SkRecords::Concat&)     { return OpRole::kMatrix; }
+    OpRole operator()(const SkRecords::Concat44&)   { return OpRole::kMatrix; }
+    OpRole operator()(const SkRecords::ClipPath&)   { return OpRole::kClip; }
+    OpRole operator()(const SkRecords::ClipRRect&)  { return OpRole::kClip; }
+    OpRole operator()(const SkRecords::ClipRect&)   { return OpRole::kClip; }
+    OpRole operator()(const SkRecords::ClipRegion&) { return OpRole::kClip; }
+    OpRole operator()(const SkRecords::ClipShader&) { return OpRole::kClip; }
+    OpRole operator()(const SkRecords::ResetClip&)  { return OpRole::kResetClip; }
+    template <typename T>
+    OpRole operator()(const T&) { return OpRole::kDrawn; }
+};
+
+// Applies a kMatrix op to the matrix the ops before it leave behind.
+struct ApplyMatrix {
+    void operator()(const SkRecords::SetMatrix& op) { fMatrix = SkM44(op.matrix); }
+    void operator()(const SkRecords::SetM44& op)    { fMatrix = op.matrix; }
+    void operator()(const SkRecords::Translate& op) { fMatrix.preTranslate(op.dx, op.dy); }
+    void operator()(const SkRecords::Scale& op)     { fMatrix.preScale(op.sx, op.sy); }
+    void operator()(const SkRecords::Concat& op)    { fMatrix.preConcat(op.matrix); }
+    void operator()(const SkRecords::Concat44& op)  { fMatrix.preConcat(op.matrix); }
+    template <typename T>
+    void operator()(const T&) { SkUNREACHABLE; }
+
+    SkM44 fMatrix;
+};
+
+}  // namespace
+
+// The root device of an SkTiledRasterCanvas. Any access to its pixels first flushes the draws
+// that the owning canvas has recorded.
+class SkTiledRasterDevice final : public SkBitmapDevice {
+public:
+    SkTiledRasterDevice(const SkBitmap& bitmap, const SkSurfaceProps& props)
+            : SkBitmapDevice(bitmap, props) {}
+
+    void setOwner(SkTiledRasterCanvas* owner) { fOwner = owner; }
+
+private:
+    bool onReadPixels(const SkPixmap&, int x, int y) override;
+    bool onWritePixels(const SkPixmap&, int x, int y) override;
+    bool onPeekPixels(SkPixmap*) override;
+    bool onAccessPixels(SkPixmap*) override;
+
+    SkTiledRasterCanvas* fOwner = nullptr;
+};
+
+// Mirrors every state change into an SkRecorder (and into its own root device, so that clip and
+// matrix queries keep working), and records every draw instead of rasterizing it.
+class SkTiledRasterCanvas final : public SkCanvasVirtualEnforcer<SkCanvas> {
+public:
+    SkTiledRasterCanvas(sk_sp<SkTiledRasterDevice> device,
+                        const SkBitmap* dst,
+                        SkExecutor* executor,
+                        SkISize tileSize)
+            : SkCanvasVirtualEnforcer<SkCanvas>(device)
+            , fDst(dst)
+            , fExecutor(executor)
+            , fTileSize(tileSize)
+            , fRecorder(&fRecord, SkRect::Make(dst->dimensions())) {
+        device->setOwner(this);
+    }
+
+    // Rasterizes every recorded draw that is not inside a still-open layer.
+    void flush();
+
+protected:
+    void willSave() override {
+        fRecorder.save();
+        fSaveStack.push_back(-1);
+    }
+    SaveLayerStrategy getSaveLayerStrategy(const SaveLayerRec& rec) override {
+        fSaveStack.push_back(fRecord.count());
+        fRecorder.saveLayer(rec);
+        return kNoLayer_SaveLayerStrategy;
+    }
+    bool onDoSaveBehind(const SkRect* bounds) override {
+        fSaveStack.push_back(fRecord.count());
+        SkCanvasPriv::SaveBehind(&fRecorder, bounds);
+        return false;
+    }
+    void willRestore() override {
+        fRecorder.restore();
+        fSaveStack.pop_back();
+    }
+
+    void didConcat44(const SkM44& m) override { fRecorder.concat(m); }
+    void didSetM44(const SkM44& m) override { fRecorder.setMatrix(m); }
+    void didTranslate(SkScalar x, SkScalar y) override { fRecorder.translate(x, y); }
+    void didScale(SkScalar x, SkScalar y) override { fRecorder.scale(x, y); }
+
+    void onClipRect(const SkRect& rect, SkClipOp op, ClipEdgeStyle edgeStyle) override {
+        fRecorder.clipRect(rect, op, kSoft_ClipEdgeStyle == edgeStyle);
+        this->INHERITED::onClipRect(rect, op, edgeStyle);
+    }
+    void onClipRRect(const SkRRect& rrect, SkClipOp op, ClipEdgeStyle edgeStyle) override {
+        fRecorder.clipRRect(rrect, op, kSoft_ClipEdgeStyle == edgeStyle);
+        this->INHERITED::onClipRRect(rrect, op, edgeStyle);
+    }
+    void onClipPath(const SkPath& path, SkClipOp op, ClipEdgeStyle edgeStyle) override {
+        fRecorder.clipPath(path, op, kSoft_ClipEdgeStyle == edgeStyle);
+        this->INHERITED::onClipPath(path, op, edgeStyle);
+    }
+    void onClipShader(sk_sp<SkShader> sh, SkClipOp op) override {
+        fRecorder.clipShader(sh, op);
+        this->INHERITED::onClipShader(std::move(sh), op);
+    }
+    void onClipRegion(const SkRegion& deviceRgn, SkClipOp op) override {
+        fRecorder.clipRegion(deviceRgn, op);
+        this->INHERITED::onClipRegion(deviceRgn, op);
+    }
+    void onResetClip() override {
+        SkCanvasPriv::ResetClip(&fRecorder);
+        this->INHERITED::onResetClip();
+    }
+
+    void onDrawPaint(const SkPaint& paint) override {
+        if (this->willDraw()) {
+            fRecorder.drawPaint(paint);
+        }
+    }
+    void onDrawBehind(const SkPaint& paint) override {
+        if (this->willDraw()) {
+            SkCanvasPriv::DrawBehind(&fRecorder, paint);
+        }
+    }
+    void onDrawPoints(PointMode mode, size_t count, const SkPoint pts[],
+                      const SkPaint& paint) override {
+        if (this->willDraw()) {
+            fRecorder.drawPoints(mode, count, pts, paint);
+        }
+    }
+    void onDrawRect(const SkRect& rect, const SkPaint& paint) override {
+        if (this->willDraw()) {
+            fRecorder.drawRect(rect, paint);
+        }
+    }
+    void onDrawRegion(const SkRegion& region, const SkPaint& paint) override {
+        if (this->willDraw()) {
+            fRecorder.drawRegion(region, paint);
+        }
+    }
+    void onDrawOval(const SkRect& rect, const SkPaint& paint) override {
+        if (this->willDraw()) {
+            fRecorder.drawOval(rect, paint);
+        }
+    }
+    void onDrawArc(const SkRect& rect, SkScalar startAngle, SkScalar sweepAngle, bool useCenter,
+                   const SkPaint& paint) override {
+        if (this->willDraw()) {
+            fRecorder.drawArc(rect, startAngle, sweepAngle, useCenter, paint);
+        }
+    }
+    void onDrawRRect(const SkRRect& rrect, const SkPaint& paint) override {
+        if (this->willDraw()) {
+            fRecorder.drawRRect(rrect, paint);
+        }
+    }
+    void onDrawDRRect(const SkRRect& outer, const SkRRect& inner, const SkPaint& paint) override {
+        if (this->willDraw()) {
+            fRecorder.drawDRRect(outer, inner, paint);
+        }
+    }
+    void onDrawPath(const SkPath& path, const SkPaint& paint) override {
+        if (this->willDraw()) {
+            fRecorder.drawPath(path, paint);
+        }
+    }
+    void onDrawImage2(const SkImage* image, SkScalar left, SkScalar top,
+                      const SkSamplingOptions& sampling, const SkPaint* paint) override {
+        if (this->willDraw()) {
+            fRecorder.drawImage(image, left, top, sampling, paint);
+        }
+    }
+    void onDrawImageRect2(const SkImage* image, const SkRect& src, const SkRect& dst,
+                          const SkSamplingOptions& sampling, const SkPaint* paint,
+                          SrcRectConstraint constraint) override {
+        if (this->willDraw()) {
+            fRecorder.drawImageRect(image, src, dst, sampling, paint, constraint);
+        }
+    }
+    void onDrawImageLattice2(const SkImage* image, const Lattice& lattice, const SkRect& dst,
+                             SkFilterMode filter, const SkPaint* paint) override {
+        if (this->willDraw()) {
+            fRecorder.drawImageLattice(image, lattice, dst, filter, paint);
+        }
+    }
+    void onDrawAtlas2(const SkImage* image, const SkRSXform xform[], const SkRect tex[],
+                      const SkColor colors[], int count, SkBlendMode bmode,
+                      const SkSamplingOptions& sampling, const SkRect* cull,
+                      const SkPaint* paint) override {
+        if (this->willDraw()) {
+            fRecorder.drawAtlas(image, xform, tex, colors, count, bmode, sampling, cull, paint);
+        }
+    }
+    void onDrawGlyphRunList(const sktext::GlyphRunList& list, const SkPaint& paint) override {
+        if (this->willDraw()) {
+            static_cast<SkCanvas*>(&fRecorder)->onDrawGlyphRunList(list, paint);
+        }
+    }
+    void onDrawTextBlob(const SkTextBlob* blob, SkScalar x, SkScalar y,
+                        const SkPaint& paint) override {
+        if (this->willDraw()) {
+            fRecorder.drawTextBlob(blob, x, y, paint);
+        }
+    }
+    void onDrawSlug(const sktext::gpu::Slug* slug, const SkPaint& paint) override {
+        if (this->willDraw()) {
+            static_cast<SkCanvas*>(&fRecorder)->drawSlug(slug, paint);
+        }
+    }
+    void onDrawPicture(const SkPicture* picture, const SkMatrix* matrix,
+                       const SkPaint* paint) override {
+        if (this->willDraw()) {
+            fRecorder.drawPicture(picture, matrix, paint);
+        }
+    }
+    void onDrawDrawable(SkDrawable* drawable, const SkMatrix* matrix) override {
+        // Drawables may not be safe to draw from several threads, so expand them now like a
+        // raster canvas would; their contents are recorded through this canvas.
+        drawable->draw(this, matrix);
+    }
+    void onDrawVerticesObject(const SkVertices* vertices, SkBlendMode bmode,
+                              const SkPaint& paint) override {
+        if (this->willDraw()) {
+            fRecorder.drawVertices(vertices, bmode, paint);
+        }
+    }
+    void onDrawPatch(const SkPoint cubics[12], const SkColor colors[4],
+                     const SkPoint texCoords[4], SkBlendMode bmode,
+                     const SkPaint& paint) override {
+        if (this->willDraw()) {
+            fRecorder.drawPatch(cubics, colors, texCoords, bmode, paint);
+        }
+    }
+    void onDrawMesh(const SkMesh& mesh, sk_sp<SkBlender> blender, const SkPaint& paint) override {
+        if (this->willDraw()) {
+            fRecorder.drawMesh(mesh, std::move(blender), paint);
+        }
+    }
+    void onDrawShadowRec(const SkPath& path, const SkDrawShadowRec& rec) override {
+        if (this->willDraw()) {
+            fRecorder.private_draw_shadow_rec(path, rec);
+        }
+    }
+    void onDrawAnnotation(const SkRect& rect, const char key[], SkData* data) override {
+        fRecorder.drawAnnotation(rect, key, data);
+    }
+    void onDrawEdgeAAQuad(const SkRect& rect, const SkPoint clip[4], QuadAAFlags aa,
+                          const SkColor4f& color, SkBlendMode mode) override {
+        if (this->willDraw()) {
+            fRecorder.experimental_DrawEdgeAAQuad(rect, clip, aa, color, mode);
+        }
+    }
+    void onDrawEdgeAAImageSet2(const ImageSetEntry set[], int count, const SkPoint dstClips[],
+                               const SkMatrix preViewMatrices[],
+                               const SkSamplingOptions& sampling, const SkPaint* paint,
+                               SrcRectConstraint constraint) override {
+        if (this->willDraw()) {
+            fRecorder.experimental_DrawEdgeAAImageSet(set, count, dstClips, preViewMatrices,
+                                                      sampling, paint, constraint);
+        }
+    }
+
+private:
+    // Notifies the surface (copy-on-write, generation ID) exactly as an immediate draw would.
+    bool willDraw() {
+        if (!this->predrawNotify()) {
+            return false;
+        }
+        fHasPendingDraws = true;
+        return true;
+    }
+
+    void rasterize(int count);
+    void discardRasterized(int count);
+
+    const SkBitmap*   fDst;  // owned by the surface, which also owns this canvas
+    SkExecutor*       fExecutor;
+    const SkISize     fTileSize;
+
+    SkRecord          fRecord;
+    SkRecorder        fRecorder;
+    bool              fHasPendingDraws = false;
+
+    // One entry per open save: -1 for a plain save, otherwise the index of the first op of a
+    // layer (or save-behind) whose contents can't be composited until its restore.
+    TArray<int>       fSaveStack;
+
+    using INHERITED = SkCanvasVirtualEnforcer<SkCanvas>;
+};
+
+void SkTiledRasterCanvas::flush() {
+    if (!fHasPendingDraws) {
+        return;
+    }
+
+    int count = fRecord.count();
+    for (int index : fSaveStack) {
+        if (index >= 0) {
+            count = index;
+            break;
+        }
+    }
+
+    this->rasterize(count);
+    this->discardRasterized(count);
+    fHasPendingDraws = count < fRecord.count();
+}
+
+void SkTiledRasterCanvas::rasterize(int count) {
+    if (count == 0) {
+        return;
+    }
+
+    const SkIRect surfaceBounds = fDst->bounds();
+    AutoTArray<SkRect> bounds(fRecord.count());
+    AutoTMalloc<SkBBoxHierarchy::Metadata> meta(fRecord.count());
+    SkRecordFillBounds(SkRect::Make(surfaceBounds), fRecord, bounds.data(), meta);
+
+    // Only ops before count are inserted, so the RTree search never returns the contents of
+    // a layer that is still open.
+    sk_sp<SkBBoxHierarchy> rtree = sk_make_sp<SkRTree>();
+    rtree->insert(bounds.data(), meta, count);
+
+    SkRecordDrawTiled(fRecord, count, nullptr, 0, rtree.get(), fDst->pixmap(), SkMatrix::I(),
+                      this->getBaseProps(), *fExecutor, fTileSize);
+}
+
+void SkTiledRasterCanvas::discardRasterized(int count) {
+    // Everything before count has been rasterized. Closed save blocks and draws become NoOps.
+    // What remains relevant are the saves that are still open and the state changes made before
+    // and inside them, which the loop below collapses: for each open save level, just the clips
+    // since its last ResetClip, each after a SetM44 of the matrix it was made with, and a final
+    // SetM44 of the matrix that later ops start from. So the record only grows with the clips
+    // that still apply, however many flushes a long-lived canvas goes through.
+    TArray<int> openSaves;
+    for (int i = 0; i < count; ++i) {
+        switch (fRecord.visit(i, ClassifyOp())) {
+            case OpRole::kSave:
+                openSaves.push_back(i);
+                break;
+            case OpRole::kRestore: {
+                SkASSERT(!openSaves.empty());
+                const int save = openSaves.back();
+                openSaves.pop_back();
+                for (int j = save; j <= i; ++j) {
+                    fRecord.replace<SkRecords::NoOp>(j);
+                }
+                break;
+            }
+            case OpRole::kMatrix:
+            case OpRole::kClip:
+            case OpRole::kResetClip:
+                break;
+            case OpRole::kDrawn:
+                fRecord.replace<SkRecords::NoOp>(i);
+                break;
+        }
+    }
+
+    ApplyMatrix matrix;   // the matrix after the ops visited so far
+    int lastMatrix = -1;  // the last matrix op at this save level
+    bool lastMatrixKept = false;
+    TArray<int> kept;     // the clip ops at this save level, and the matrix ops they use
+    auto setLastMatrix = [&] {
+        if (lastMatrix >= 0) {
+            new (fRecord.replace<SkRecords::SetM44>(lastMatrix)) SkRecords::SetM44{matrix.fMatrix};
+        }
+    };
+    for (int i = 0; i < count; ++i) {
+        switch (fRecord.visit(i, ClassifyOp())) {
+            case OpRole::kSave:
+                if (!lastMatrixKept) {
+                    setLastMatrix();
+                }
+                lastMatrix = -1;
+                lastMatrixKept = false;
+                kept.clear();
+                break;
+            case OpRole::kMatrix:
+                fRecord.visit(i, matrix);
+                if (lastMatrix >= 0 && !lastMatrixKept) {
+                    fRecord.replace<SkRecords::NoOp>(lastMatrix);
+                }
+                lastMatrix = i;
+                lastMatrixKept = false;
+                break;
+            case OpRole::kClip:
+                if (lastMatrix >= 0 && !lastMatrixKept) {
+                    setLastMatrix();
+                    kept.push_back(lastMatrix);
+                    lastMatrixKept = true;
+                }
+                kept.push_back(i);
+                break;
+            case OpRole::kResetClip:
+                // The last matrix op still sets the matrix for the ops after this one.
+                for (int j : kept) {
+                    if (j != lastMatrix) {
+                        fRecord.replace<SkRecords::NoOp>(j);
+                    }
+                }
+                kept.clear();
+                lastMatrixKept = false;
+                kept.push_back(i);
+                break;
+            case OpRole::kDrawn:
+                // Only the NoOps made above are left.
+                break;
+            case OpRole::kRestore:
+                SkUNREACHABLE;
+        }
+    }
+    if (!lastMatrixKept) {
+        setLastMatrix();
+    }
+
+    const int before = fRecord.count();
+    fRecord.defrag();
+    const int removed = before - fRecord.count();
+    for (int& index : fSaveStack) {
+        if (index >= 0) {
+            SkASSERT(index >= count);
+            index -= removed;
+        }
+    }
+}
+
+bool SkTiledRasterDevice::onReadPixels(const SkPixmap& pm, int x, int y) {
+    fOwner->flush();
+    return this->SkBitmapDevice::onReadPixels(pm, x, y);
+}
+
+bool SkTiledRasterDevice::onWritePixels(const SkPixmap& pm, int x, int y) {
+    fOwner->flush();
+    return this->SkBitmapDevice::onWritePixels(pm, x, y);
+}
+
+bool SkTiledRasterDevice::onPeekPixels(SkPixmap* pm) {
+    fOwner->flush();
+    return this->SkBitmapDevice::onPeekPixels(pm);
+}
+
+bool SkTiledRasterDevice::onAccessPixels(SkPixmap* pm) {
+    fOwner->flush();
+    return this->SkBitmapDevice::onAccessPixels(pm);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkSurface_RasterTiled::SkSurface_RasterTiled(const SkImageInfo& info,
+                                             sk_sp<SkPixelRef> pr,
+                                             SkExecutor* executor,
+                                             SkISize tileSize,
+                                             const SkSurfaceProps* props)
+        : INHERITED(info, std::move(pr), props)
+        , fExecutor(executor)
+        , fTileSize(tileSize) {}
+
+SkCanvas* SkSurface_RasterTiled::onNewCanvas() {
+    auto device = sk_make_sp<SkTiledRasterDevice>(fBitmap, this->props());
+    fTiledCanvas = new SkTiledRasterCanvas(std::move(device), &fBitmap, fExecutor, fTileSize);
+    return fTiledCanvas;
+}
+
+sk_sp<SkSurface> SkSurface_RasterTiled::onNewSurface(const SkImageInfo& info) {
+    return SkSurfaces::RasterTiled(info, fExecutor, fTileSize, &this->props());
+}
+
+sk_sp<SkImage> SkSurface_RasterTiled::onNewImageSnapshot(const SkIRect* subset) {
+    this->flush();
+    return this->INHERITED::onNewImageSnapshot(subset);
+}
+
+void SkSurface_RasterTiled::onWritePixels(const SkPixmap& src, int x, int y) {
+    this->flush();
+    this->INHERITED::onWritePixels(src, x, y);
+}
+
+void SkSurface_RasterTiled::onDraw(SkCanvas* canvas, SkScalar x, SkScalar y,
+                                   const SkSamplingOptions& sampling, const SkPaint* paint) {
+    this->flush();
+    this->INHERITED::onDraw(canvas, x, y, sampling, paint);
+}
+
+void SkSurface_RasterTiled::flush() {
+    if (fTiledCanvas) {
+        fTiledCanvas->flush();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+namespace SkSurfaces {
+sk_sp<SkSurface> RasterTiled(const SkImageInfo& info,
+                             SkExecutor* executor,
+                             SkISize tileSize,
+                             const SkSurfaceProps* props) {
+    if (!SkSurfaceValidateRasterInfo(info)) {
+        return nullptr;
+    }
+    if (tileSize.width() <= 0 || tileSize.height() <= 0) {
+        return nullptr;
+    }
+    if (!executor) {
+        executor = &SkExecutor::GetDefault();
+    }
+
+    sk_sp<SkPixelRef> pr = SkMallocPixelRef::MakeAllocate(info, 0);
+    if (!pr) {
+        return nullptr;
+    }
+    return sk_make_sp<SkSurface_RasterTiled>(info, std::move(pr), executor, tileSize, props);
+}
+
+}  // namespace SkSurfaces
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkSurface_RasterTiled_DEFINED
+#define SkSurface_RasterTiled_DEFINED
+
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkSamplingOptions.h"
+#include "include/core/SkScalar.h"
+#include "include/core/SkSize.h"
+#include "src/image/SkSurface_Raster.h"
+
+class SkCanvas;
+class SkExecutor;
+class SkImage;
+class SkPaint;
+class SkPixelRef;
+class SkPixmap;
+class SkSurface;
+class SkSurfaceProps;
+class SkTiledRasterCanvas;
+struct SkIRect;
+
+/**
+ *  A raster surface whose canvas records draws instead of rasterizing them immediately. Pending
+ *  draws are flushed whenever the pixels are observed: the record is binned into tiles through an
+ *  SkRTree and each tile is replayed, clipped to its bounds, on an SkExecutor.
+ */
+class SkSurface_RasterTiled final : public SkSurface_Raster {
+public:
+    SkSurface_RasterTiled(const SkImageInfo&, sk_sp<SkPixelRef>, SkExecutor*, SkISize tileSize,
+                          const SkSurfaceProps*);
+
+    SkCanvas* onNewCanvas() override;
+    sk_sp<SkSurface> onNewSurface(const SkImageInfo&) override;
+    sk_sp<SkImage> onNewImageSnapshot(const SkIRect* subset) override;
+    void onWritePixels(const SkPixmap&, int x, int y) override;
+    void onDraw(SkCanvas*, SkScalar, SkScalar, const SkSamplingOptions&, const SkPaint*) override;
+
+private:
+    // Rasterizes any draws still pending in the cached canvas.
+    void flush();
+
+    SkExecutor*          fExecutor;
+    SkISize              fTileSize;
+    SkTiledRasterCanvas* fTiledCanvas = nullptr;  // owned by SkSurface_Base
+
+    using INHERITED = SkSurface_Raster;
+};
+
+#endif
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkAnalyticCoverage_opts_DEFINED
+#define SkAnalyticCoverage_opts_DEFINED
+
+#include "src/base/SkVx.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace SK_OPTS_NS {
+
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX2 || SK_CPU_LSX_LEVEL >= SK_CPU_LSX_LEVEL_LASX
+    static constexpr int kAlphaLanes = 32;
+#else
+    static constexpr int kAlphaLanes = 16;
+#endif
+    using AlphaVec = skvx::Vec<kAlphaLanes, uint8_t>;
+
+    /*not static*/ inline void accumulate_alphas(uint8_t dst[], const uint8_t src[], int count) {
+        for (; count >= kAlphaLanes; count -= kAlphaLanes) {
+            skvx::saturated_add(AlphaVec::Load(dst), AlphaVec::Load(src)).store(dst);
+            dst += kAlphaLanes;
+            src += kAlphaLanes;
+        }
+        while (count-- > 0) {
+            *dst = std::min(0xFF, *dst + *src++);
+            dst++;
+        }
+    }
+
+    /*not static*/ inline void accumulate_alpha(uint8_t dst[], uint8_t alpha, int count) {
+        const AlphaVec wideAlpha(alpha);
+        for (; count >= kAlphaLanes; count -= kAlphaLanes) {
+            skvx::saturated_add(AlphaVec::Load(dst), wideAlpha).store(dst);
+            dst += kAlphaLanes;
+        }
+        while (count-- > 0) {
+            *dst = std::min(0xFF, *dst + alpha);
+            dst++;
+        }
+    }
+
+    /*not static*/ inline void subtract_alphas(uint8_t dst[], const uint8_t src[], int count) {
+        for (; count >= kAlphaLanes; count -= kAlphaLanes) {
+            AlphaVec d = AlphaVec::Load(dst),
+                     s = AlphaVec::Load(src);
+            (skvx::max(d, s) - s).store(dst);
+            dst += kAlphaLanes;
+            src += kAlphaLanes;
+        }
+        while (count-- > 0) {
+            *dst = *dst > *src ? *dst - *src : 0;
+            dst++;
+            src++;
+        }
+    }
+
+    /*not static*/ inline void alpha_ramp(uint8_t dst[], int count, int32_t start, int32_t step) {
+        // The math is done unsigned so that stepping past the last lane can't overflow. Every
+        // value we store is non-negative, so the logical shift matches the signed one.
+        using U32 = skvx::Vec<8, uint32_t>;
+        U32 v = (uint32_t)start + U32{0,1,2,3,4,5,6,7} * (uint32_t)step;
+        const uint32_t stride = 8 * (uint32_t)step;
+        for (; count >= 8; count -= 8) {
+            skvx::cast<uint8_t>(v >> 8).store(dst);
+            v += stride;
+            dst += 8;
+        }
+        uint32_t tail = v[0];
+        while (count-- > 0) {
+            *dst++ = (uint8_t)(tail >> 8);
+            tail += (uint32_t)step;
+        }
+    }
+
+}  // namespace SK_OPTS_NS
+
+#endif // SkAnalyticCoverage_opts_DEFINED
@@ -3396,7 +3396,18 @@ STAGE(matrix_perspective, const float* m) {
 SI void gradient_lookup(const SkRasterPipeline_GradientCtx* c, U32 idx, F t,
                         F* r, F* g, F* b, F* a) {
     F fr, br, fg, bg, fb, bb, fa, ba;
-#if defined(SKRP_CPU_HSW)
+#if defined(SKRP_CPU_SKX)
+    if (c->stopCount <= 16) {
+        fr = _mm512_permutexvar_ps((__m512i)idx, _mm512_loadu_ps(c->fs[0]));
+        br = _mm512_permutexvar_ps((__m512i)idx, _mm512_loadu_ps(c->bs[0]));
+        fg = _mm512_permutexvar_ps((__m512i)idx, _mm512_loadu_ps(c->fs[1]));
+        bg = _mm512_permutexvar_ps((__m512i)idx, _mm512_loadu_ps(c->bs[1]));
+        fb = _mm512_permutexvar_ps((__m512i)idx, _mm512_loadu_ps(c->fs[2]));
+        bb = _mm512_permutexvar_ps((__m512i)idx, _mm512_loadu_ps(c->bs[2]));
+        fa = _mm512_permutexvar_ps((__m512i)idx, _mm512_loadu_ps(c->fs[3]));
+        ba = _mm512_permutexvar_ps((__m512i)idx, _mm512_loadu_ps(c->bs[3]));
+    } else
+#elif defined(SKRP_CPU_HSW)
     if (c->stopCount <=8) {
         fr = _mm256_permutevar8x32_ps(_mm256_loadu_ps(c->fs[0]), (__m256i)idx);
         br = _mm256_permutevar8x32_ps(_mm256_loadu_ps(c->bs[0]), (__m256i)idx);
@@ -4925,6 +4936,15 @@ SI void smoothstep_fn(F* edge0, F* edge1, F* x) {
     *edge0 = t * t * (3.0 - 2.0 * t);
 }
 
+// The Builder fuses `a * b + c` and `min(max(x, lo), hi)` into these, to save a stage each time.
+SI void mad_fn(F* a, F* b, F* c) {
+    *a = mad(*a, *b, *c);
+}
+
+SI void clamp_fn(F* x, F* lo, F* hi) {
+    *x = min(max(*x, *lo), *hi);
+}
+
 #define DECLARE_N_WAY_TERNARY_FLOAT(name)                                \
     STAGE_TAIL(name##_n_floats, SkRasterPipeline_TernaryOpCtx* packed) { \
         apply_adjacent_ternary_packed<F, &name##_fn>(packed, base);      \
@@ -4949,6 +4969,8 @@ SI void smoothstep_fn(F* edge0, F* edge1, F* x) {
 DECLARE_N_WAY_TERNARY_FLOAT(smoothstep)
 DECLARE_TERNARY_FLOAT(mix)
 DECLARE_TERNARY_INT(mix)
+DECLARE_TERNARY_FLOAT(mad)
+DECLARE_TERNARY_FLOAT(clamp)
 
 #undef DECLARE_N_WAY_TERNARY_FLOAT
 #undef DECLARE_TERNARY_FLOAT
@@ -6412,7 +6434,19 @@ SI void gradient_lookup(const SkRasterPipeline_GradientCtx* c, U32 idx, F t,
                         U16* r, U16* g, U16* b, U16* a) {
 
     F fr, fg, fb, fa, br, bg, bb, ba;
-#if defined(SKRP_CPU_HSW)
+#if defined(SKRP_CPU_SKX)
+    // lowp keeps 16 floats per F on SKX, so this is the same single-register lookup as highp.
+    if (c->stopCount <= 16) {
+        fr = _mm512_permutexvar_ps((__m512i)idx, _mm512_loadu_ps(c->fs[0]));
+        br = _mm512_permutexvar_ps((__m512i)idx, _mm512_loadu_ps(c->bs[0]));
+        fg = _mm512_permutexvar_ps((__m512i)idx, _mm512_loadu_ps(c->fs[1]));
+        bg = _mm512_permutexvar_ps((__m512i)idx, _mm512_loadu_ps(c->bs[1]));
+        fb = _mm512_permutexvar_ps((__m512i)idx, _mm512_loadu_ps(c->fs[2]));
+        bb = _mm512_permutexvar_ps((__m512i)idx, _mm512_loadu_ps(c->bs[2]));
+        fa = _mm512_permutexvar_ps((__m512i)idx, _mm512_loadu_ps(c->fs[3]));
+        ba = _mm512_permutexvar_ps((__m512i)idx, _mm512_loadu_ps(c->bs[3]));
+    } else
+#elif defined(SKRP_CPU_HSW)
     if (c->stopCount <=8) {
         __m256i lo, hi;
         split(idx, &lo, &hi);
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkYUVToRGB_opts_DEFINED
+#define SkYUVToRGB_opts_DEFINED
+
+#include "include/private/base/SkAssert.h"
+#include "src/base/SkVx.h"
+
+#include <cstdint>
+
+namespace SK_OPTS_NS {
+
+    static constexpr int kYUVLanes = 8;
+
+    // The matrix coefficients, splatted once per row.
+    template <int N>
+    struct YUVToRGBMatrix {
+        explicit YUVToRGBMatrix(const float m[12]) {
+            for (int i = 0; i < 12; ++i) {
+                fM[i] = m[i];
+            }
+        }
+        skvx::Vec<N,float> fM[12];
+    };
+
+    // The same math converts full vectors and, with N == 1, the pixels left over at the end of
+    // a row, so that every pixel in a row is converted identically.
+    template <int N>
+    static inline skvx::Vec<N,uint32_t> yuva_to_8888(const skvx::Vec<N,uint8_t>& y8,
+                                                     const skvx::Vec<N,uint8_t>& u8,
+                                                     const skvx::Vec<N,uint8_t>& v8,
+                                                     const skvx::Vec<N,uint8_t>& a8,
+                                                     const YUVToRGBMatrix<N>& matrix,
+                                                     bool premul) {
+        using F = skvx::Vec<N,float>;
+        const F* m = matrix.fM;
+        const F Y = skvx::cast<float>(y8),
+                U = skvx::cast<float>(u8),
+                V = skvx::cast<float>(v8);
+
+        F r = m[0]*Y + m[1]*U + m[ 2]*V + m[ 3],
+          g = m[4]*Y + m[5]*U + m[ 6]*V + m[ 7],
+          b = m[8]*Y + m[9]*U + m[10]*V + m[11];
+        r = skvx::pin(r, F(0), F(255));
+        g = skvx::pin(g, F(0), F(255));
+        b = skvx::pin(b, F(0), F(255));
+        if (premul) {
+            const F scale = skvx::cast<float>(a8) * (1/255.f);
+            r *= scale;
+            g *= scale;
+            b *= scale;
+        }
+
+        // Every channel is in [0, 255] by now, so reinterpreting its int bits is a cast.
+        auto to_u32 = [](const F& c) {
+            return sk_bit_cast<skvx::Vec<N,uint32_t>>(skvx::lrint(c));
+        };
+        return to_u32(r)       |
+               to_u32(g) <<  8 |
+               to_u32(b) << 16 |
+               skvx::cast<uint32_t>(a8) << 24;
+    }
+
+    // Loads the U and V samples covering the kYUVLanes pixels starting at x.
+    template <int kChromaShift, int kChromaStride>
+    static inline void load_uv(const uint8_t u[], const uint8_t v[], int x,
+                               skvx::Vec<kYUVLanes,uint8_t>* U, skvx::Vec<kYUVLanes,uint8_t>* V) {
+        static_assert(kYUVLanes == 8, "the shuffles below assume 8 lanes");
+        if constexpr (kChromaStride == 1 && kChromaShift == 0) {
+            *U = skvx::Vec<8,uint8_t>::Load(u + x);
+            *V = skvx::Vec<8,uint8_t>::Load(v + x);
+        } else if constexpr (kChromaStride == 1) {
+            *U = skvx::shuffle<0,0,1,1,2,2,3,3>(skvx::Vec<4,uint8_t>::Load(u + x/2));
+            *V = skvx::shuffle<0,0,1,1,2,2,3,3>(skvx::Vec<4,uint8_t>::Load(v + x/2));
+        } else if constexpr (kChromaShift == 0) {
+            const auto uv = skvx::Vec<16,uint8_t>::Load(u + 2*x);
+            *U = skvx::shuffle<0,2,4,6,8,10,12,14>(uv);
+            *V = skvx::shuffle<1,3,5,7,9,11,13,15>(uv);
+        } else {
+            // x is always a multiple of kYUVLanes, so x/2 pairs of samples start at u + x.
+            const auto uv = skvx::Vec<8,uint8_t>::Load(u + x);
+            *U = skvx::shuffle<0,0,2,2,4,4,6,6>(uv);
+            *V = skvx::shuffle<1,1,3,3,5,5,7,7>(uv);
+        }
+    }
+
+    template <int kChromaShift, int kChromaStride>
+    static void yuva_to_rgba_row(uint32_t dst[],
+                                 const uint8_t y[], const uint8_t u[], const uint8_t v[],
+                                 const uint8_t a[], int count, const float m[12], bool premul) {
+        using Bytes = skvx::Vec<kYUVLanes,uint8_t>;
+        const YUVToRGBMatrix<kYUVLanes> wide(m);
+        const YUVToRGBMatrix<1> narrow(m);
+        premul = premul && a;
+
+        int x = 0;
+        for (; x + kYUVLanes <= count; x += kYUVLanes) {
+            Bytes U, V;
+            load_uv<kChromaShift, kChromaStride>(u, v, x, &U, &V);
+            const Bytes A = a ? Bytes::Load(a + x) : Bytes(0xFF);
+            yuva_to_8888(Bytes::Load(y + x), U, V, A, wide, premul).store(dst + x);
+        }
+        for (; x < count; ++x) {
+            const int c = (x >> kChromaShift) * kChromaStride;
+            dst[x] = yuva_to_8888<1>(y[x], u[c], v[c], a ? a[x] : 0xFF, narrow, premul)[0];
+        }
+    }
+
+    /*not static*/ inline void yuva_to_rgba(uint32_t dst[],
+                                            const uint8_t y[], const uint8_t u[],
+                                            const uint8_t v[], const uint8_t a[], int count,
+                                            const float m[12], int chromaShift, int chromaStride,
+                                            bool premul) {
+        SkASSERT(chromaShift == 0 || chromaShift == 1);
+        SkASSERT(chromaStride == 1 || (chromaStride == 2 && v == u + 1));
+        switch (chromaShift << 1 | (chromaStride - 1)) {
+            case 0: return yuva_to_rgba_row<0,1>(dst, y, u, v, a, count, m, premul);
+            case 1: return yuva_to_rgba_row<0,2>(dst, y, u, v, a, count, m, premul);
+            case 2: return yuva_to_rgba_row<1,1>(dst, y, u, v, a, count, m, premul);
+            case 3: return yuva_to_rgba_row<1,2>(dst, y, u, v, a, count, m, premul);
+        }
+    }
+
+}  // namespace SK_OPTS_NS
+
+#endif // SkYUVToRGB_opts_DEFINED
@@ -12,11 +12,13 @@
 #include "include/private/base/SkMalloc.h"
 #include "include/private/base/SkTFitsIn.h"
 #include "include/private/base/SkTo.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/core/SkTraceEvent.h"
 
 #include <algorithm>
 #include <cstdint>
 #include <cstring>
+#include <vector>
 
 #include "zlib.h"  // NO_G3_REWRITE
 
@@ -67,17 +69,147 @@ static void do_deflate(int flush,
                  : returnValue == Z_OK);
 }
 
+// In parallel mode, the input is split into chunks which are compressed independently, like
+// pigz does. Each chunk is primed with the window of input before it as a preset dictionary, so
+// compression barely suffers. Chunks are compressed a batch at a time, which bounds how much
+// input and output is held in memory.
+static constexpr size_t kParallelChunkSize = 128 * 1024;
+static constexpr size_t kParallelWindowSize = 32 * 1024;
+static constexpr int    kParallelChunksPerBatch = 16;
+
 // Hide all zlib impl details.
 struct SkDeflateWStream::Impl {
     SkWStream* fOut;
     unsigned char fInBuffer[SKDEFLATEWSTREAM_INPUT_BUFFER_SIZE];
     size_t fInBufferIndex;
     z_stream fZStream;
+    int fCompressionLevel;
+    bool fGzip;
+
+    // Only used in parallel mode.
+    SkExecutor* fExecutor;
+    std::vector<uint8_t> fPending;     // Input that has not been compressed yet.
+    std::vector<uint8_t> fDictionary;  // The end of the input that has been.
+    uLong fAdler;
+    size_t fTotalIn;
+    bool fStarted;                     // Whether any batch has been written.
+
+    void deflateBatch(bool last);
 };
 
+static void init_zstream(z_stream* zStream, int compressionLevel, int windowBits) {
+    zStream->next_in = nullptr;
+    zStream->zalloc = &skia_alloc_func;
+    zStream->zfree = &skia_free_func;
+    zStream->opaque = nullptr;
+    SkASSERT(compressionLevel <= 9 && compressionLevel >= -1);
+    SkDEBUGCODE(int r =) deflateInit2(zStream, compressionLevel,
+                                      Z_DEFLATED, windowBits,
+                                      8, Z_DEFAULT_STRATEGY);
+    SkASSERT(Z_OK == r);
+}
+
+// Compresses one chunk as raw deflate data. Chunks other than the last end with a sync flush,
+// which leaves the output byte aligned, so the chunks can simply be concatenated.
+static void deflate_chunk(int compressionLevel,
+                          const uint8_t* dictionary, size_t dictionaryLength,
+                          const uint8_t* input, size_t inputLength,
+                          bool last,
+                          std::vector<uint8_t>* output) {
+    z_stream zStream;
+    init_zstream(&zStream, compressionLevel, -MAX_WBITS);
+    if (dictionaryLength) {
+        deflateSetDictionary(&zStream, dictionary, SkToUInt(dictionaryLength));
+    }
+
+    zStream.next_in = const_cast<uint8_t*>(input);
+    zStream.avail_in = SkToUInt(inputLength);
+    // deflateBound() is enough for Z_FINISH; a sync flush may need a few more bytes.
+    output->resize(deflateBound(&zStream, (uLong)inputLength) + 16);
+    size_t used = 0;
+    const int flush = last ? Z_FINISH : Z_SYNC_FLUSH;
+    while (true) {
+        zStream.next_out = output->data() + used;
+        zStream.avail_out = SkToUInt(output->size() - used);
+        SkDEBUGCODE(int returnValue =) deflate(&zStream, flush);
+        SkASSERT(returnValue == Z_OK || returnValue == Z_STREAM_END);
+        used = output->size() - zStream.avail_out;
+        if (zStream.avail_out) {
+            break;
+        }
+        output->resize(output->size() * 2);
+    }
+    output->resize(used);
+    (void)deflateEnd(&zStream);
+}
+
+// Compresses all of the pending input if this is the last batch, and otherwise as many whole
+// chunks of it as there are.
+void SkDeflateWStream::Impl::deflateBatch(bool last) {
+    const size_t length = last ? fPending.size()
+                               : fPending.size() / kParallelChunkSize * kParallelChunkSize;
+    // Even with no input left, the last batch has to end the stream.
+    const int chunkCount =
+            std::max(1, SkToInt((length + kParallelChunkSize - 1) / kParallelChunkSize));
+
+    struct Chunk {
+        std::vector<uint8_t> fData;
+        uLong fAdler;
+    };
+    std::vector<Chunk> chunks(chunkCount);
+    SkTaskGroup(*fExecutor).batch(chunkCount, [&](int i) {
+        const size_t start = i * kParallelChunkSize;
+        const size_t end = std::min(length, start + kParallelChunkSize);
+        const uint8_t* dictionary;
+        size_t dictionaryLength;
+        if (i == 0) {
+            dictionary = fDictionary.data();
+            dictionaryLength = fDictionary.size();
+        } else {
+            dictionaryLength = std::min(start, kParallelWindowSize);
+            dictionary = fPending.data() + start - dictionaryLength;
+        }
+        deflate_chunk(fCompressionLevel, dictionary, dictionaryLength,
+                      fPending.data() + start, end - start, last && i == chunkCount - 1,
+                      &chunks[i].fData);
+        chunks[i].fAdler = adler32(adler32(0, nullptr, 0), fPending.data() + start,
+                                   SkToUInt(end - start));
+    });
+    if (!fStarted) {
+        // The zlib header, as deflate() would write it for this level.
+        const int level = fCompressionLevel == Z_DEFAULT_COMPRESSION ? 6 : fCompressionLevel;
+        const int levelFlags = level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3;
+        uint32_t header = (Z_DEFLATED + ((MAX_WBITS - 8) << 4)) << 8 | levelFlags << 6;
+        header += 31 - header % 31;
+        const uint8_t headerBytes[] = {(uint8_t)(header >> 8), (uint8_t)header};
+        fOut->write(headerBytes, sizeof(headerBytes));
+        fStarted = true;
+    }
+    for (int i = 0; i < chunkCount; ++i) {
+        const size_t chunkLength = std::min(length - i * kParallelChunkSize, kParallelChunkSize);
+        fOut->write(chunks[i].fData.data(), chunks[i].fData.size());
+        fAdler = adler32_combine(fAdler, chunks[i].fAdler, (z_off_t)chunkLength);
+    }
+    if (last) {
+        const uLong adler = fAdler;
+        const uint8_t adlerBytes[] = {(uint8_t)(adler >> 24), (uint8_t)(adler >> 16),
+                                      (uint8_t)(adler >>  8), (uint8_t)(adler >>  0)};
+        fOut->write(adlerBytes, sizeof(adlerBytes));
+    }
+
+    // The next batch is primed with the end of this one.
+    const size_t window = std::min(length, kParallelWindowSize);
+    if (window) {
+        fDictionary.assign(fPending.begin() + length - window, fPending.begin() + length);
+    }
+    fPending.erase(fPending.begin(), fPending.begin() + length);
+    fTotalIn += length;
+}
+
 SkDeflateWStream::SkDeflateWStream(SkWStream* out,
                                    int compressionLevel,
-                                   bool gzip)
+                                   bool gzip,
+                                   SkExecutor* executor)
     : fImpl(std::make_unique<SkDeflateWStream::Impl>()) {
 
     // There has existed at some point at least one zlib implementation which thought it was being
@@ -88,18 +220,17 @@ SkDeflateWStream::SkDeflateWStream(SkWStream* out,
 
     fImpl->fOut = out;
     fImpl->fInBufferIndex = 0;
-    if (!fImpl->fOut) {
+    fImpl->fCompressionLevel = compressionLevel;
+    fImpl->fGzip = gzip;
+    fImpl->fExecutor = gzip ? nullptr : executor;
+    fImpl->fAdler = adler32(0, nullptr, 0);
+    fImpl->fTotalIn = 0;
+    fImpl->fStarted = false;
+    if (!fImpl->fOut || fImpl->fExecutor) {
+        // In parallel mode, a single zlib stream is only used if the input turns out to be small.
         return;
     }
-    fImpl->fZStream.next_in = nullptr;
-    fImpl->fZStream.zalloc = &skia_alloc_func;
-    fImpl->fZStream.zfree = &skia_free_func;
-    fImpl->fZStream.opaque = nullptr;
-    SkASSERT(compressionLevel <= 9 && compressionLevel >= -1);
-    SkDEBUGCODE(int r =) deflateInit2(&fImpl->fZStream, compressionLevel,
-                                      Z_DEFLATED, gzip ? 0x1F : 0x0F,
-                                      8, Z_DEFAULT_STRATEGY);
-    SkASSERT(Z_OK == r);
+    init_zstream(&fImpl->fZStream, compressionLevel, gzip ? 0x1F : 0x0F);
 }
 
 SkDeflateWStream::~SkDeflateWStream() { this->finalize(); }
@@ -109,8 +240,22 @@ void SkDeflateWStream::finalize() {
     if (!fImpl->fOut) {
         return;
     }
-    do_deflate(Z_FINISH, &fImpl->fZStream, fImpl->fOut, fImpl->fInBuffer,
-               fImpl->fInBufferIndex);
+    if (fImpl->fExecutor) {
+        if (fImpl->fStarted || SplitsInput(fImpl->fPending.size())) {
+            fImpl->deflateBatch(true);
+            fImpl->fOut = nullptr;
+            return;
+        }
+        // Too small to be worth splitting up, so compress it all in one stream.
+        init_zstream(&fImpl->fZStream, fImpl->fCompressionLevel, 0x0F);
+        do_deflate(Z_FINISH, &fImpl->fZStream, fImpl->fOut, fImpl->fPending.data(),
+                   fImpl->fPending.size());
+        fImpl->fTotalIn = fImpl->fPending.size();
+        fImpl->fPending = {};
+    } else {
+        do_deflate(Z_FINISH, &fImpl->fZStream, fImpl->fOut, fImpl->fInBuffer,
+                   fImpl->fInBufferIndex);
+    }
     (void)deflateEnd(&fImpl->fZStream);
     fImpl->fOut = nullptr;
 }
@@ -120,6 +265,14 @@ bool SkDeflateWStream::write(const void* void_buffer, size_t len) {
     if (!fImpl->fOut) {
         return false;
     }
+    if (fImpl->fExecutor) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(void_buffer);
+        fImpl->fPending.insert(fImpl->fPending.end(), bytes, bytes + len);
+        if (fImpl->fPending.size() >= kParallelChunksPerBatch * kParallelChunkSize) {
+            fImpl->deflateBatch(false);
+        }
+        return true;
+    }
     const char* buffer = (const char*)void_buffer;
     while (len > 0) {
         size_t tocopy =
@@ -140,6 +293,13 @@ bool SkDeflateWStream::write(const void* void_buffer, size_t len) {
     return true;
 }
 
+bool SkDeflateWStream::SplitsInput(size_t inputLength) {
+    return inputLength >= 2 * kParallelChunkSize;
+}
+
 size_t SkDeflateWStream::bytesWritten() const {
+    if (fImpl->fExecutor) {
+        return fImpl->fTotalIn + fImpl->fPending.size();
+    }
     return fImpl->fZStream.total_in + fImpl->fInBufferIndex;
 }
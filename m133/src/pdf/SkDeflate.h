@@ -14,6 +14,8 @@
 
 #include <memory>
 
+class SkExecutor;
+
 /**
   * Wrap a stream in this class to compress the information written to
   * this stream using the Deflate algorithm.
@@ -32,10 +34,16 @@ public:
         a wrapper, documented in RFC 1952, around a deflate stream."
         gzip adds a header with a magic number to the beginning of the
         stream, allowing a client to identify a gzip file.
+
+        @param executor iff not null, large inputs are split into chunks which are compressed in
+        parallel on it. The output is still a single zlib stream, though not byte-for-byte the
+        same as without an executor. Ignored for gzip output. Writing waits for the chunks to
+        be compressed, so this must not be used from work running on the same executor.
      */
     SkDeflateWStream(SkWStream*,
                      int compressionLevel,
-                     bool gzip = false);
+                     bool gzip = false,
+                     SkExecutor* executor = nullptr);
 
     /** The destructor calls finalize(). */
     ~SkDeflateWStream() override;
@@ -48,6 +56,9 @@ public:
     bool write(const void*, size_t) override;
     size_t bytesWritten() const override;
 
+    /** Returns true if an input of this length is split up when there is an executor. */
+    static bool SplitsInput(size_t inputLength);
+
 private:
     struct Impl;
     std::unique_ptr<Impl> fImpl;
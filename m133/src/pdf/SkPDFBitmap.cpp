@@ -123,7 +123,10 @@ void emit_image_stream(SkPDFDocument* doc,
     doc->emitStream(pdfDict, std::move(writeStream), ref);
 }
 
-void do_deflated_alpha(const SkPixmap& pm, SkPDFDocument* doc, SkPDFIndirectReference ref) {
+void do_deflated_alpha(const SkPixmap& pm,
+                       SkPDFDocument* doc,
+                       SkExecutor* deflateExecutor,
+                       SkPDFIndirectReference ref) {
     SkPDF::Metadata::CompressionLevel compressionLevel = doc->metadata().fCompressionLevel;
     SkPDFStreamFormat format = compressionLevel == SkPDF::Metadata::CompressionLevel::None
                              ? SkPDFStreamFormat::Uncompressed
@@ -132,7 +135,8 @@ void do_deflated_alpha(const SkPixmap& pm, SkPDFDocument* doc, SkPDFIndirectRefe
     SkWStream* stream = &buffer;
     std::optional<SkDeflateWStream> deflateWStream;
     if (format == SkPDFStreamFormat::Flate) {
-        deflateWStream.emplace(&buffer, SkToInt(compressionLevel));
+        deflateWStream.emplace(&buffer, SkToInt(compressionLevel), /*gzip=*/false,
+                               deflateExecutor);
         stream = &*deflateWStream;
     }
     if (kAlpha_8_SkColorType == pm.colorType()) {
@@ -200,6 +204,7 @@ bool icc_channel_mismatch(const skcms_ICCProfile* iccProfile, int expectedChanne
 
 void do_deflated_image(const SkPixmap& pm,
                        SkPDFDocument* doc,
+                       SkExecutor* deflateExecutor,
                        bool isOpaque,
                        SkPDFIndirectReference ref) {
     SkPDFIndirectReference sMask;
@@ -214,7 +219,8 @@ void do_deflated_image(const SkPixmap& pm,
     SkWStream* stream = &buffer;
     std::optional<SkDeflateWStream> deflateWStream;
     if (format == SkPDFStreamFormat::Flate) {
-        deflateWStream.emplace(&buffer, SkToInt(compressionLevel));
+        deflateWStream.emplace(&buffer, SkToInt(compressionLevel), /*gzip=*/false,
+                               deflateExecutor);
         stream = &*deflateWStream;
     }
     SkPDFUnion colorSpace = SkPDFUnion::Name("DeviceGray");
@@ -275,7 +281,7 @@ void do_deflated_image(const SkPixmap& pm,
     emit_image_stream(doc, ref, [&buffer](SkWStream* stream) { buffer.writeToAndReset(stream); },
                       pm.info().dimensions(), std::move(colorSpace), sMask, length, format);
     if (!isOpaque) {
-        do_deflated_alpha(pm, doc, sMask);
+        do_deflated_alpha(pm, doc, deflateExecutor, sMask);
     }
 }
 
@@ -352,9 +358,11 @@ SkBitmap to_pixels(const SkImage* image) {
     return bm;
 }
 
+// If deflateExecutor is set, large deflated streams are compressed in parallel on it.
 void serialize_image(const SkImage* img,
                      int encodingQuality,
                      SkPDFDocument* doc,
+                     SkExecutor* deflateExecutor,
                      SkPDFIndirectReference ref) {
     SkASSERT(img);
     SkASSERT(doc);
@@ -379,7 +387,7 @@ void serialize_image(const SkImage* img,
             }
         }
     }
-    do_deflated_image(pm, doc, isOpaque, ref);
+    do_deflated_image(pm, doc, deflateExecutor, isOpaque, ref);
 }
 
 } // namespace
@@ -390,16 +398,22 @@ SkPDFIndirectReference SkPDFSerializeImage(const SkImage* img,
     SkASSERT(img);
     SkASSERT(doc);
     SkPDFIndirectReference ref = doc->reserveRef();
-    if (SkExecutor* executor = doc->executor()) {
+    SkExecutor* executor = doc->executor();
+    // An image that will be deflated in pieces is serialized here, so that waiting for the
+    // pieces doesn't tie up one of the executor's threads. Other images are serialized as jobs,
+    // which don't split their own deflates for the same reason.
+    const size_t deflatedSize = (size_t)img->width() * img->height() * 3;
+    if (executor &&
+        !(encodingQuality > 100 && SkDeflateWStream::SplitsInput(deflatedSize))) {
         SkRef(img);
         doc->incrementJobCount();
         executor->add([img, encodingQuality, doc, ref]() {
-            serialize_image(img, encodingQuality, doc, ref);
+            serialize_image(img, encodingQuality, doc, /*deflateExecutor=*/nullptr, ref);
             SkSafeUnref(img);
             doc->signalJobComplete();
         });
         return ref;
     }
-    serialize_image(img, encodingQuality, doc, ref);
+    serialize_image(img, encodingQuality, doc, executor, ref);
     return ref;
 }
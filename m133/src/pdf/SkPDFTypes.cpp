@@ -549,10 +549,12 @@ void SkPDFDict::insertUnion(const char key[], SkPDFUnion&& value) {
 
 
 
+// If deflateExecutor is set, a large stream is compressed in parallel on it.
 static void serialize_stream(SkPDFDict* origDict,
                              SkStreamAsset* stream,
                              SkPDFSteamCompressionEnabled compress,
                              SkPDFDocument* doc,
+                             SkExecutor* deflateExecutor,
                              SkPDFIndirectReference ref) {
     // Code assumes that the stream starts at the beginning.
     SkASSERT(stream && stream->hasLength());
@@ -566,7 +568,10 @@ static void serialize_stream(SkPDFDict* origDict,
         stream->getLength() > kMinimumSavings)
     {
         SkDynamicMemoryWStream compressedData;
-        SkDeflateWStream deflateWStream(&compressedData,SkToInt(doc->metadata().fCompressionLevel));
+        SkDeflateWStream deflateWStream(&compressedData,
+                                        SkToInt(doc->metadata().fCompressionLevel),
+                                        /*gzip=*/false,
+                                        deflateExecutor);
         SkStreamCopy(&deflateWStream, stream);
         deflateWStream.finalize();
         if (stream->getLength() > compressedData.bytesWritten() + kMinimumSavings) {
@@ -589,20 +594,24 @@ SkPDFIndirectReference SkPDFStreamOut(std::unique_ptr<SkPDFDict> dict,
                                       SkPDFDocument* doc,
                                       SkPDFSteamCompressionEnabled compress) {
     SkPDFIndirectReference ref = doc->reserveRef();
-    if (SkExecutor* executor = doc->executor()) {
+    SkExecutor* executor = doc->executor();
+    // A stream that will be deflated in pieces is serialized here, so that waiting for the
+    // pieces doesn't tie up one of the executor's threads.
+    if (executor && !(compress == SkPDFSteamCompressionEnabled::Yes &&
+                      SkDeflateWStream::SplitsInput(content->getLength()))) {
         SkPDFDict* dictPtr = dict.release();
         SkStreamAsset* contentPtr = content.release();
         // Pass ownership of both pointers into a std::function, which should
         // only be executed once.
         doc->incrementJobCount();
         executor->add([dictPtr, contentPtr, compress, doc, ref]() {
-            serialize_stream(dictPtr, contentPtr, compress, doc, ref);
+            serialize_stream(dictPtr, contentPtr, compress, doc, /*deflateExecutor=*/nullptr, ref);
             delete dictPtr;
             delete contentPtr;
             doc->signalJobComplete();
         });
         return ref;
     }
-    serialize_stream(dict.get(), content.get(), compress, doc, ref);
+    serialize_stream(dict.get(), content.get(), compress, doc, executor, ref);
     return ref;
 }
@@ -390,9 +390,10 @@ void SkGradientBaseShader::AppendGradientFillStages(SkRasterPipeline* p,
         // Note: In order to handle clamps in search, the search assumes a stop conceptully placed
         // at -inf. Therefore, the max number of stops is fColorCount+1.
         for (int i = 0; i < 4; i++) {
-            // Allocate at least at for the AVX2 gather from a YMM register.
-            ctx->fs[i] = alloc->makeArray<float>(std::max(count + 1, 8));
-            ctx->bs[i] = alloc->makeArray<float>(std::max(count + 1, 8));
+            // Allocate at least enough for the AVX-512 lookup from a ZMM register (which also
+            // covers the AVX2 lookup from a YMM register).
+            ctx->fs[i] = alloc->makeArray<float>(std::max(count + 1, 16));
+            ctx->bs[i] = alloc->makeArray<float>(std::max(count + 1, 16));
         }
 
         if (positions == nullptr) {
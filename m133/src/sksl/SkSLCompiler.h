@@ -60,6 +60,10 @@ class SymbolTable;
  * while performing basic optimizations such as constant-folding and dead-code elimination. Then the
  * Program is passed into a CodeGenerator to produce compiled output.
  *
+ * A Compiler must only be used by one thread at a time, but separate Compilers may compile programs
+ * concurrently. They share the built-in modules, which are loaded on first use (or ahead of time by
+ * ModuleLoader::PreloadModules) and are immutable afterwards.
+ *
  * See the README for information about SkSL.
  */
 class SK_API Compiler {
@@ -9,6 +9,7 @@
 
 #include "include/core/SkTypes.h"
 #include "include/private/base/SkMutex.h"
+#include "include/private/base/SkTo.h"
 #include "src/base/SkNoDestructor.h"
 #include "src/sksl/SkSLBuiltinTypes.h"
 #include "src/sksl/SkSLCompiler.h"
@@ -23,7 +24,13 @@
 #include "src/sksl/ir/SkSLType.h"
 #include "src/sksl/ir/SkSLVariable.h"
 
+#if !defined(SKSL_STANDALONE)
+#include "include/core/SkExecutor.h"
+#endif
+
 #include <algorithm>
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <string>
 #include <utility>
@@ -93,52 +100,76 @@ struct ModuleLoader::Impl {
 
     void makeRootSymbolTable();
 
-    // This mutex is taken when ModuleLoader::Get is called, and released when the returned
-    // ModuleLoader object falls out of scope.
-    SkMutex fMutex;
+    // Each module is compiled the first time it's needed, while holding its own mutex. A thread
+    // loading a module locks its parent (if the parent is not yet loaded) while holding the
+    // child's mutex, never the reverse, so independent modules can be compiled concurrently
+    // without any risk of deadlock. Once compiled, a module is published through fLoaded and can
+    // be returned without locking.
+    struct ModuleSlot {
+        SkMutex fMutex;
+        std::unique_ptr<const Module> fModule;
+        std::atomic<const Module*> fLoaded{nullptr};
+    };
+
+    template <typename CompileFn>
+    static const Module* Load(ModuleSlot& slot, CompileFn&& compile);
+
     const BuiltinTypes fBuiltinTypes;
 
     std::unique_ptr<const Module> fRootModule;
 
-    std::unique_ptr<const Module> fSharedModule;            // [Root] + Public intrinsics
-    std::unique_ptr<const Module> fGPUModule;               // [Shared] + Non-public intrinsics/
-                                                            //     helper functions
-    std::unique_ptr<const Module> fVertexModule;            // [GPU] + Vertex stage decls
-    std::unique_ptr<const Module> fFragmentModule;          // [GPU] + Fragment stage decls
-    std::unique_ptr<const Module> fComputeModule;           // [GPU] + Compute stage decls
-    std::unique_ptr<const Module> fGraphiteVertexModule;    // [Vert] + Graphite vertex helpers
-    std::unique_ptr<const Module> fGraphiteFragmentModule;  // [Frag] + Graphite fragment helpers
-    std::unique_ptr<const Module> fGraphiteVertexES2Module; // [Vert] + Graphite vertex ES2 helpers
-    std::unique_ptr<const Module> fGraphiteFragmentES2Module;//[Frag] + Graphite fragment ES2 "  "
-
-    std::unique_ptr<const Module> fPublicModule;            // [Shared] minus Private types +
-                                                            //     Runtime effect intrinsics
-    std::unique_ptr<const Module> fRuntimeShaderModule;     // [Public] + Runtime shader decls
+    ModuleSlot fSharedModule;            // [Root] + Public intrinsics
+    ModuleSlot fGPUModule;               // [Shared] + Non-public intrinsics/helper functions
+    ModuleSlot fVertexModule;            // [GPU] + Vertex stage decls
+    ModuleSlot fFragmentModule;          // [GPU] + Fragment stage decls
+    ModuleSlot fComputeModule;           // [GPU] + Compute stage decls
+    ModuleSlot fGraphiteVertexModule;    // [Vert] + Graphite vertex helpers
+    ModuleSlot fGraphiteFragmentModule;  // [Frag] + Graphite fragment helpers
+    ModuleSlot fGraphiteVertexES2Module; // [Vert] + Graphite vertex ES2 helpers
+    ModuleSlot fGraphiteFragmentES2Module;//[Frag] + Graphite fragment ES2 helpers
+
+    ModuleSlot fPublicModule;            // [Shared] minus Private types +
+                                         //     Runtime effect intrinsics
+    ModuleSlot fRuntimeShaderModule;     // [Public] + Runtime shader decls
 };
 
+template <typename CompileFn>
+const Module* ModuleLoader::Impl::Load(ModuleSlot& slot, CompileFn&& compile) {
+    if (const Module* module = slot.fLoaded.load(std::memory_order_acquire)) {
+        return module;
+    }
+    SkAutoMutexExclusive lock(slot.fMutex);
+    if (!slot.fModule) {
+        slot.fModule = compile();
+        slot.fLoaded.store(slot.fModule.get(), std::memory_order_release);
+    }
+    return slot.fModule.get();
+}
+
 ModuleLoader ModuleLoader::Get() {
     static SkNoDestructor<ModuleLoader::Impl> sModuleLoaderImpl;
     return ModuleLoader(*sModuleLoaderImpl);
 }
 
-ModuleLoader::ModuleLoader(ModuleLoader::Impl& m) : fModuleLoader(m) {
-    fModuleLoader.fMutex.acquire();
-}
+ModuleLoader::ModuleLoader(ModuleLoader::Impl& m) : fModuleLoader(m) {}
 
-ModuleLoader::~ModuleLoader() {
-    fModuleLoader.fMutex.release();
-}
+ModuleLoader::~ModuleLoader() = default;
 
 void ModuleLoader::unloadModules() {
-    fModuleLoader.fSharedModule           = nullptr;
-    fModuleLoader.fGPUModule              = nullptr;
-    fModuleLoader.fVertexModule           = nullptr;
-    fModuleLoader.fFragmentModule         = nullptr;
-    fModuleLoader.fComputeModule          = nullptr;
-    fModuleLoader.fGraphiteVertexModule   = nullptr;
-    fModuleLoader.fGraphiteFragmentModule = nullptr;
-    fModuleLoader.fPublicModule           = nullptr;
-    fModuleLoader.fRuntimeShaderModule    = nullptr;
+    for (Impl::ModuleSlot* slot : {&fModuleLoader.fSharedModule,
+                                   &fModuleLoader.fGPUModule,
+                                   &fModuleLoader.fVertexModule,
+                                   &fModuleLoader.fFragmentModule,
+                                   &fModuleLoader.fComputeModule,
+                                   &fModuleLoader.fGraphiteVertexModule,
+                                   &fModuleLoader.fGraphiteFragmentModule,
+                                   &fModuleLoader.fGraphiteVertexES2Module,
+                                   &fModuleLoader.fGraphiteFragmentES2Module,
+                                   &fModuleLoader.fPublicModule,
+                                   &fModuleLoader.fRuntimeShaderModule}) {
+        slot->fLoaded.store(nullptr, std::memory_order_relaxed);
+        slot->fModule = nullptr;
+    }
 }
 
 ModuleLoader::Impl::Impl() {
@@ -242,131 +273,206 @@ void ModuleLoader::addPublicTypeAliases(const SkSL::Module* module) {
 }
 
 const Module* ModuleLoader::loadPublicModule(SkSL::Compiler* compiler) {
-    if (!fModuleLoader.fPublicModule) {
+    return Impl::Load(fModuleLoader.fPublicModule, [&] {
         const Module* sharedModule = this->loadSharedModule(compiler);
-        fModuleLoader.fPublicModule = compile_and_shrink(compiler,
-                                                         ProgramKind::kFragment,
-                                                         MODULE_DATA(sksl_public),
-                                                         sharedModule);
-        this->addPublicTypeAliases(fModuleLoader.fPublicModule.get());
-    }
-    return fModuleLoader.fPublicModule.get();
+        std::unique_ptr<Module> module = compile_and_shrink(compiler,
+                                                            ProgramKind::kFragment,
+                                                            MODULE_DATA(sksl_public),
+                                                            sharedModule);
+        this->addPublicTypeAliases(module.get());
+        return module;
+    });
 }
 
 const Module* ModuleLoader::loadPrivateRTShaderModule(SkSL::Compiler* compiler) {
-    if (!fModuleLoader.fRuntimeShaderModule) {
+    return Impl::Load(fModuleLoader.fRuntimeShaderModule, [&] {
         const Module* publicModule = this->loadPublicModule(compiler);
-        fModuleLoader.fRuntimeShaderModule = compile_and_shrink(compiler,
-                                                                ProgramKind::kFragment,
-                                                                MODULE_DATA(sksl_rt_shader),
-                                                                publicModule);
-    }
-    return fModuleLoader.fRuntimeShaderModule.get();
+        return compile_and_shrink(compiler,
+                                  ProgramKind::kFragment,
+                                  MODULE_DATA(sksl_rt_shader),
+                                  publicModule);
+    });
 }
 
 const Module* ModuleLoader::loadSharedModule(SkSL::Compiler* compiler) {
-    if (!fModuleLoader.fSharedModule) {
+    return Impl::Load(fModuleLoader.fSharedModule, [&] {
         const Module* rootModule = this->rootModule();
-        fModuleLoader.fSharedModule = compile_and_shrink(compiler,
-                                                         ProgramKind::kFragment,
-                                                         MODULE_DATA(sksl_shared),
-                                                         rootModule);
-    }
-    return fModuleLoader.fSharedModule.get();
+        return compile_and_shrink(compiler,
+                                  ProgramKind::kFragment,
+                                  MODULE_DATA(sksl_shared),
+                                  rootModule);
+    });
 }
 
 const Module* ModuleLoader::loadGPUModule(SkSL::Compiler* compiler) {
-    if (!fModuleLoader.fGPUModule) {
+    return Impl::Load(fModuleLoader.fGPUModule, [&] {
         const Module* sharedModule = this->loadSharedModule(compiler);
-        fModuleLoader.fGPUModule = compile_and_shrink(compiler,
-                                                      ProgramKind::kFragment,
-                                                      MODULE_DATA(sksl_gpu),
-                                                      sharedModule);
+        std::unique_ptr<Module> module = compile_and_shrink(compiler,
+                                                            ProgramKind::kFragment,
+                                                            MODULE_DATA(sksl_gpu),
+                                                            sharedModule);
 #ifdef SKSL_EXT
-        this->addPublicTypeAliases(fModuleLoader.fGPUModule.get());
+        this->addPublicTypeAliases(module.get());
 #endif
-    }
-    return fModuleLoader.fGPUModule.get();
+        return module;
+    });
 }
 
 const Module* ModuleLoader::loadFragmentModule(SkSL::Compiler* compiler) {
-    if (!fModuleLoader.fFragmentModule) {
+    return Impl::Load(fModuleLoader.fFragmentModule, [&] {
         const Module* gpuModule = this->loadGPUModule(compiler);
-        fModuleLoader.fFragmentModule = compile_and_shrink(compiler,
-                                                           ProgramKind::kFragment,
-                                                           MODULE_DATA(sksl_frag),
-                                                           gpuModule);
-    }
-    return fModuleLoader.fFragmentModule.get();
+        return compile_and_shrink(compiler,
+                                  ProgramKind::kFragment,
+                                  MODULE_DATA(sksl_frag),
+                                  gpuModule);
+    });
 }
 
 const Module* ModuleLoader::loadVertexModule(SkSL::Compiler* compiler) {
-    if (!fModuleLoader.fVertexModule) {
+    return Impl::Load(fModuleLoader.fVertexModule, [&] {
         const Module* gpuModule = this->loadGPUModule(compiler);
-        fModuleLoader.fVertexModule = compile_and_shrink(compiler,
-                                                         ProgramKind::kVertex,
-                                                         MODULE_DATA(sksl_vert),
-                                                         gpuModule);
-    }
-    return fModuleLoader.fVertexModule.get();
+        return compile_and_shrink(compiler,
+                                  ProgramKind::kVertex,
+                                  MODULE_DATA(sksl_vert),
+                                  gpuModule);
+    });
 }
 
 const Module* ModuleLoader::loadComputeModule(SkSL::Compiler* compiler) {
-    if (!fModuleLoader.fComputeModule) {
+    return Impl::Load(fModuleLoader.fComputeModule, [&] {
         const Module* gpuModule = this->loadGPUModule(compiler);
-        fModuleLoader.fComputeModule = compile_and_shrink(compiler,
-                                                          ProgramKind::kCompute,
-                                                          MODULE_DATA(sksl_compute),
-                                                          gpuModule);
-    }
-    return fModuleLoader.fComputeModule.get();
+        return compile_and_shrink(compiler,
+                                  ProgramKind::kCompute,
+                                  MODULE_DATA(sksl_compute),
+                                  gpuModule);
+    });
 }
 
 const Module* ModuleLoader::loadGraphiteFragmentModule(SkSL::Compiler* compiler) {
-    if (!fModuleLoader.fGraphiteFragmentModule) {
+    return Impl::Load(fModuleLoader.fGraphiteFragmentModule, [&] {
         const Module* fragmentModule = this->loadFragmentModule(compiler);
-        fModuleLoader.fGraphiteFragmentModule = compile_and_shrink(compiler,
-                                                                   ProgramKind::kGraphiteFragment,
-                                                                   MODULE_DATA(sksl_graphite_frag),
-                                                                   fragmentModule);
-    }
-    return fModuleLoader.fGraphiteFragmentModule.get();
+        return compile_and_shrink(compiler,
+                                  ProgramKind::kGraphiteFragment,
+                                  MODULE_DATA(sksl_graphite_frag),
+                                  fragmentModule);
+    });
 }
 
 const Module* ModuleLoader::loadGraphiteFragmentES2Module(SkSL::Compiler* compiler) {
-    if (!fModuleLoader.fGraphiteFragmentES2Module) {
+    return Impl::Load(fModuleLoader.fGraphiteFragmentES2Module, [&] {
         const Module* fragmentModule = this->loadFragmentModule(compiler);
-        fModuleLoader.fGraphiteFragmentES2Module =
-                compile_and_shrink(compiler,
-                                   ProgramKind::kGraphiteFragmentES2,
-                                   MODULE_DATA(sksl_graphite_frag_es2),
-                                   fragmentModule);
-    }
-    return fModuleLoader.fGraphiteFragmentES2Module.get();
+        return compile_and_shrink(compiler,
+                                  ProgramKind::kGraphiteFragmentES2,
+                                  MODULE_DATA(sksl_graphite_frag_es2),
+                                  fragmentModule);
+    });
 }
 
 const Module* ModuleLoader::loadGraphiteVertexModule(SkSL::Compiler* compiler) {
-    if (!fModuleLoader.fGraphiteVertexModule) {
+    return Impl::Load(fModuleLoader.fGraphiteVertexModule, [&] {
         const Module* vertexModule = this->loadVertexModule(compiler);
-        fModuleLoader.fGraphiteVertexModule = compile_and_shrink(compiler,
-                                                                 ProgramKind::kGraphiteVertex,
-                                                                 MODULE_DATA(sksl_graphite_vert),
-                                                                 vertexModule);
-    }
-    return fModuleLoader.fGraphiteVertexModule.get();
+        return compile_and_shrink(compiler,
+                                  ProgramKind::kGraphiteVertex,
+                                  MODULE_DATA(sksl_graphite_vert),
+                                  vertexModule);
+    });
 }
 
 const Module* ModuleLoader::loadGraphiteVertexES2Module(SkSL::Compiler* compiler) {
-    if (!fModuleLoader.fGraphiteVertexES2Module) {
+    return Impl::Load(fModuleLoader.fGraphiteVertexES2Module, [&] {
         const Module* vertexModule = this->loadVertexModule(compiler);
-        fModuleLoader.fGraphiteVertexES2Module =
-                compile_and_shrink(compiler,
-                                   ProgramKind::kGraphiteVertexES2,
-                                   MODULE_DATA(sksl_graphite_vert_es2),
-                                   vertexModule);
+        return compile_and_shrink(compiler,
+                                  ProgramKind::kGraphiteVertexES2,
+                                  MODULE_DATA(sksl_graphite_vert_es2),
+                                  vertexModule);
+    });
+}
+
+#if !defined(SKSL_STANDALONE)
+namespace {
+
+using LoadFn = const Module* (ModuleLoader::*)(SkSL::Compiler*);
+
+// A module to preload, and the indices of the modules built directly on top of it.
+struct PreloadNode {
+    LoadFn fLoad;
+    std::vector<int> fChildren;
+};
+using PreloadTree = std::vector<PreloadNode>;
+
+// Returns the loaders of the modules that programs of `kind` are built on, from the root down.
+std::vector<LoadFn> module_chain(ProgramKind kind) {
+    using M = ModuleLoader;
+    switch (kind) {
+        case ProgramKind::kFragment:
+            return {&M::loadSharedModule, &M::loadGPUModule, &M::loadFragmentModule};
+        case ProgramKind::kVertex:
+            return {&M::loadSharedModule, &M::loadGPUModule, &M::loadVertexModule};
+        case ProgramKind::kCompute:
+            return {&M::loadSharedModule, &M::loadGPUModule, &M::loadComputeModule};
+        case ProgramKind::kGraphiteFragment:
+            return {&M::loadSharedModule, &M::loadGPUModule, &M::loadFragmentModule,
+                    &M::loadGraphiteFragmentModule};
+        case ProgramKind::kGraphiteVertex:
+            return {&M::loadSharedModule, &M::loadGPUModule, &M::loadVertexModule,
+                    &M::loadGraphiteVertexModule};
+        case ProgramKind::kGraphiteFragmentES2:
+            return {&M::loadSharedModule, &M::loadGPUModule, &M::loadFragmentModule,
+                    &M::loadGraphiteFragmentES2Module};
+        case ProgramKind::kGraphiteVertexES2:
+            return {&M::loadSharedModule, &M::loadGPUModule, &M::loadVertexModule,
+                    &M::loadGraphiteVertexES2Module};
+        case ProgramKind::kPrivateRuntimeBlender:
+        case ProgramKind::kPrivateRuntimeColorFilter:
+        case ProgramKind::kPrivateRuntimeShader:
+            return {&M::loadSharedModule, &M::loadPublicModule, &M::loadPrivateRTShaderModule};
+        case ProgramKind::kRuntimeColorFilter:
+        case ProgramKind::kRuntimeShader:
+        case ProgramKind::kRuntimeBlender:
+        case ProgramKind::kMeshVertex:
+        case ProgramKind::kMeshFragment:
+            return {&M::loadSharedModule, &M::loadPublicModule};
+    }
+    SkUNREACHABLE;
+}
+
+void preload(std::shared_ptr<const PreloadTree> tree, int index, SkExecutor* executor) {
+    // Every task uses its own Compiler, so the children of a module are compiled in parallel.
+    {
+        SkSL::Compiler compiler;
+        (ModuleLoader::Get().*(*tree)[index].fLoad)(&compiler);
+    }
+    for (int child : (*tree)[index].fChildren) {
+        executor->add([tree, child, executor] { preload(tree, child, executor); });
+    }
+}
+
+}  // namespace
+
+void ModuleLoader::PreloadModules(SkSpan<const ProgramKind> kinds, SkExecutor& executor) {
+    // Every module chain starts at the shared module, so the modules form a single tree.
+    auto tree = std::make_shared<PreloadTree>();
+    for (ProgramKind kind : kinds) {
+        int parent = -1;
+        for (LoadFn load : module_chain(kind)) {
+            auto iter = std::find_if(tree->begin(), tree->end(), [&](const PreloadNode& node) {
+                return node.fLoad == load;
+            });
+            int index = SkToInt(iter - tree->begin());
+            if (iter == tree->end()) {
+                tree->push_back({load, {}});
+                if (parent >= 0) {
+                    (*tree)[parent].fChildren.push_back(index);
+                }
+            }
+            parent = index;
+        }
+    }
+    if (!tree->empty()) {
+        executor.add([tree, e = &executor] { preload(tree, /*index=*/0, e); });
     }
-    return fModuleLoader.fGraphiteVertexES2Module.get();
 }
+#endif  // !defined(SKSL_STANDALONE)
 
 void ModuleLoader::Impl::makeRootSymbolTable() {
     auto rootModule = std::make_unique<Module>();
@@ -8,14 +8,20 @@
 #ifndef SKSL_MODULELOADER
 #define SKSL_MODULELOADER
 
+#include "include/core/SkSpan.h"
 #include "src/sksl/SkSLBuiltinTypes.h"
+
+#include <cstdint>
 #include <memory>
 
+class SkExecutor;
+
 namespace SkSL {
 
 class Compiler;
 struct Module;
 class Type;
+enum class ProgramKind : int8_t;
 
 using BuiltinTypePtr = const std::unique_ptr<Type> BuiltinTypes::*;
 
@@ -32,10 +38,19 @@ public:
     ModuleLoader(ModuleLoader::Impl&);
     ~ModuleLoader();
 
-    // Acquires a mutex-locked reference to the singleton ModuleLoader. When the ModuleLoader is
-    // allowed to fall out of scope, the mutex will be released.
+    // Returns a reference to the singleton ModuleLoader. Every module has its own mutex, so any
+    // number of threads may load modules at once; modules which don't depend on each other are
+    // compiled concurrently.
     static ModuleLoader Get();
 
+#if !defined(SKSL_STANDALONE)
+    // Starts compiling, on `executor`, every module needed by programs of the given kinds, and
+    // returns immediately. Sibling modules (e.g. the vertex and fragment modules) are compiled in
+    // parallel, each by its own Compiler. A subsequent load of any of these modules waits for the
+    // task compiling it, or compiles it itself if that task hasn't started yet.
+    static void PreloadModules(SkSpan<const ProgramKind> kinds, SkExecutor& executor);
+#endif
+
     // The built-in types and root module are universal, immutable, and shared by every Compiler.
     // They are created when the ModuleLoader is instantiated and never change.
     const BuiltinTypes& builtinTypes();
@@ -60,7 +75,8 @@ public:
     // `vec4` are added; SkSL private types like `sampler2D` are replaced with an invalid type.
     void addPublicTypeAliases(const SkSL::Module* module);
 
-    // This unloads every module. It's useful primarily for benchmarking purposes.
+    // This unloads every module. It's useful primarily for benchmarking purposes. Unlike the rest
+    // of the ModuleLoader, it is not thread-safe: no other thread may be using any module.
     void unloadModules();
 };
 
@@ -9,12 +9,15 @@
 #include <cstdint>
 #include <optional>
 
+#include "include/core/SkData.h"
 #include "include/core/SkStream.h"
 #include "include/private/base/SkMalloc.h"
 #include "include/private/base/SkTFitsIn.h"
+#include "include/private/base/SkTemplates.h"
 #include "include/private/base/SkTo.h"
 #include "src/base/SkArenaAlloc.h"
 #include "src/base/SkSafeMath.h"
+#include "src/core/SkChecksum.h"
 #include "src/core/SkOpts.h"
 #include "src/core/SkRasterPipelineContextUtils.h"
 #include "src/core/SkRasterPipelineOpContexts.h"
@@ -130,7 +133,9 @@ namespace SkSL::RP {
 
 #define ALL_MULTI_SLOT_TERNARY_OP_CASES \
          BuilderOp::mix_n_floats:       \
-    case BuilderOp::mix_n_ints
+    case BuilderOp::mix_n_ints:         \
+    case BuilderOp::mad_n_floats:       \
+    case BuilderOp::clamp_n_floats
 
 static bool is_immediate_op(BuilderOp op) {
     switch (op) {
@@ -239,6 +244,10 @@ void Builder::binary_op(BuilderOp op, int32_t slots) {
         }
     }
 
+    if (this->simplifyBinaryOpPair(op, slots)) {
+        return;
+    }
+
     switch (op) {
         case ALL_N_WAY_BINARY_OP_CASES:
         case ALL_MULTI_SLOT_BINARY_OP_CASES:
@@ -340,6 +349,57 @@ bool Builder::simplifyImmediateUnmaskedOp() {
     return false;
 }
 
+bool Builder::simplifyBinaryOpPair(BuilderOp op, int32_t slots) {
+    // `a * b + c` and `clamp(x, lo, hi)` are emitted as a binary op, a push of the next operand,
+    // and a second binary op. If the push doesn't depend on the stack, we can move it ahead of the
+    // first op and perform both ops with a single ternary op:
+    //   `mul_n_floats, push c, add_n_floats` becomes `push c, mad_n_floats`
+    //   `max_n_floats, push hi, min_n_floats` becomes `push hi, clamp_n_floats`
+    BuilderOp firstOp, fusedOp;
+    switch (op) {
+        case BuilderOp::add_n_floats:
+            firstOp = BuilderOp::mul_n_floats;
+            fusedOp = BuilderOp::mad_n_floats;
+            break;
+
+        case BuilderOp::min_n_floats:
+            firstOp = BuilderOp::max_n_floats;
+            fusedOp = BuilderOp::clamp_n_floats;
+            break;
+
+        default:
+            return false;
+    }
+
+    Instruction* pushInstruction  = this->lastInstruction(/*fromBack=*/0);
+    Instruction* firstInstruction = this->lastInstruction(/*fromBack=*/1);
+    if (!pushInstruction || !firstInstruction) {
+        return false;
+    }
+    // If the instruction before the push was the matching first op, over the same slots...
+    if (firstInstruction->fOp != firstOp || firstInstruction->fImmA != slots) {
+        return false;
+    }
+    // ... and the push put exactly one operand onto the stack, without reading from it...
+    switch (pushInstruction->fOp) {
+        case BuilderOp::push_constant:
+        case BuilderOp::push_immutable:
+        case BuilderOp::push_slots:
+        case BuilderOp::push_uniform:
+            break;
+
+        default:
+            return false;
+    }
+    if (pushInstruction->fImmA != slots) {
+        return false;
+    }
+    // ... we can swap the two, and replace the first op with the fused op.
+    std::swap(*pushInstruction, *firstInstruction);
+    pushInstruction->fOp = fusedOp;
+    return true;
+}
+
 void Builder::discard_stack(int32_t count, int stackID) {
     // If we pushed something onto the stack and then immediately discarded part of it, we can
     // shrink or eliminate the push.
@@ -1412,6 +1472,10 @@ Program::Program(TArray<Instruction> instrs,
 
 Program::~Program() = default;
 
+size_t Program::approximateSizeInBytes() const {
+    return sizeof(Program) + fInstructions.size_bytes() + fTempStackMaxDepths.size_bytes();
+}
+
 static bool immutable_data_is_splattable(int32_t* immutablePtr, int numSlots) {
     // If every value between `immutablePtr[0]` and `immutablePtr[numSlots]` is bit-identical, we
     // can use a splat.
@@ -3220,6 +3284,7 @@ void Program::Dumper::dump(SkWStream* out, bool writeInstructionCount) {
                 break;
 
             case POp::mix_float:   case POp::mix_int:
+            case POp::mad_float:   case POp::clamp_float:
                 std::tie(opArg1, opArg2, opArg3) = this->adjacent3PtrCtx(stage.ctx, 1);
                 break;
 
@@ -3241,6 +3306,7 @@ void Program::Dumper::dump(SkWStream* out, bool writeInstructionCount) {
                 break;
 
             case POp::mix_2_floats:   case POp::mix_2_ints:
+            case POp::mad_2_floats:   case POp::clamp_2_floats:
                 std::tie(opArg1, opArg2, opArg3) = this->adjacent3PtrCtx(stage.ctx, 2);
                 break;
 
@@ -3262,6 +3328,7 @@ void Program::Dumper::dump(SkWStream* out, bool writeInstructionCount) {
                 break;
 
             case POp::mix_3_floats:   case POp::mix_3_ints:
+            case POp::mad_3_floats:   case POp::clamp_3_floats:
                 std::tie(opArg1, opArg2, opArg3) = this->adjacent3PtrCtx(stage.ctx, 3);
                 break;
 
@@ -3283,6 +3350,7 @@ void Program::Dumper::dump(SkWStream* out, bool writeInstructionCount) {
                 break;
 
             case POp::mix_4_floats:   case POp::mix_4_ints:
+            case POp::mad_4_floats:   case POp::clamp_4_floats:
                 std::tie(opArg1, opArg2, opArg3) = this->adjacent3PtrCtx(stage.ctx, 4);
                 break;
 
@@ -3306,6 +3374,7 @@ void Program::Dumper::dump(SkWStream* out, bool writeInstructionCount) {
                 break;
 
             case POp::mix_n_floats:        case POp::mix_n_ints:
+            case POp::mad_n_floats:        case POp::clamp_n_floats:
             case POp::smoothstep_n_floats:
                 std::tie(opArg1, opArg2, opArg3) = this->adjacentTernaryOpCtx(stage.ctx);
                 break;
@@ -3769,6 +3838,16 @@ void Program::Dumper::dump(SkWStream* out, bool writeInstructionCount) {
                 opText = opArg1 + " = mix(" + opArg2 + ", " + opArg3 + ", " + opArg1 + ")";
                 break;
 
+            case POp::mad_float:      case POp::mad_2_floats:   case POp::mad_3_floats:
+            case POp::mad_4_floats:   case POp::mad_n_floats:
+                opText = opArg1 + " = " + opArg1 + " * " + opArg2 + " + " + opArg3;
+                break;
+
+            case POp::clamp_float:    case POp::clamp_2_floats: case POp::clamp_3_floats:
+            case POp::clamp_4_floats: case POp::clamp_n_floats:
+                opText = opArg1 + " = clamp(" + opArg1 + ", " + opArg2 + ", " + opArg3 + ")";
+                break;
+
             case POp::smoothstep_n_floats:
                 opText = opArg1 + " = smoothstep(" + opArg1 + ", " + opArg2 + ", " + opArg3 + ")";
                 break;
@@ -3829,4 +3908,108 @@ void Program::dump(SkWStream* out, bool writeInstructionCount) const {
     Dumper(*this).dump(out, writeInstructionCount);
 }
 
+// Identifies the serialization format and the op lists it was written with, so that programs
+// from a build with different ops are rejected rather than misread.
+static uint32_t serialization_fingerprint() {
+    static const uint32_t fingerprint = [] {
+        static constexpr const char* kOpNames[] = {
+            #define M(stage) #stage,
+                SK_RASTER_PIPELINE_OPS_ALL(M)
+                SKRP_EXTENDED_OPS(M)
+            #undef M
+        };
+        static constexpr uint32_t kFormatVersion = 2;
+        uint32_t hash = SkChecksum::Hash32(&kFormatVersion, sizeof(kFormatVersion));
+        for (const char* name : kOpNames) {
+            hash = SkChecksum::Hash32(name, strlen(name), hash);
+        }
+        const int numBuilderOps = (int)BuilderOp::unsupported + 1;
+        const size_t instructionSize = sizeof(Instruction);
+        hash = SkChecksum::Hash32(&numBuilderOps, sizeof(numBuilderOps), hash);
+        return SkChecksum::Hash32(&instructionSize, sizeof(instructionSize), hash);
+    }();
+    return fingerprint;
+}
+
+bool Program::serialize(SkWStream* out) const {
+    if (fDebugTrace) {
+        return false;
+    }
+    SkDynamicMemoryWStream payload;
+    bool ok = payload.write32(serialization_fingerprint()) &&
+              payload.write32(fNumValueSlots) &&
+              payload.write32(fNumUniformSlots) &&
+              payload.write32(fNumImmutableSlots) &&
+              payload.write32(fNumLabels) &&
+              payload.write32(fInstructions.size());
+    for (const Instruction& inst : fInstructions) {
+        ok = ok && payload.write32((int32_t)inst.fOp) &&
+                   payload.write32(inst.fSlotA) &&
+                   payload.write32(inst.fSlotB) &&
+                   payload.write32(inst.fImmA) &&
+                   payload.write32(inst.fImmB) &&
+                   payload.write32(inst.fImmC) &&
+                   payload.write32(inst.fImmD) &&
+                   payload.write32(inst.fStackID);
+    }
+    if (!ok) {
+        return false;
+    }
+    // The instructions' slots and immediates are used as indices without being range checked,
+    // so the payload is followed by its checksum, which Deserialize() verifies before reading.
+    sk_sp<SkData> data = payload.detachAsData();
+    return out->write(data->data(), data->size()) &&
+           out->write32(SkChecksum::Hash32(data->data(), data->size()));
+}
+
+std::unique_ptr<Program> Program::Deserialize(const void* data, size_t length) {
+    uint32_t checksum;
+    if (length < sizeof(checksum)) {
+        return nullptr;
+    }
+    length -= sizeof(checksum);
+    memcpy(&checksum, SkTAddOffset<const void>(data, length), sizeof(checksum));
+    if (checksum != SkChecksum::Hash32(data, length)) {
+        return nullptr;
+    }
+
+    SkMemoryStream stream(data, length, /*copyData=*/false);
+    uint32_t fingerprint;
+    int32_t numValueSlots, numUniformSlots, numImmutableSlots, numLabels, numInstructions;
+    if (!stream.readU32(&fingerprint) || fingerprint != serialization_fingerprint() ||
+        !stream.readS32(&numValueSlots) || numValueSlots < 0 ||
+        !stream.readS32(&numUniformSlots) || numUniformSlots < 0 ||
+        !stream.readS32(&numImmutableSlots) || numImmutableSlots < 0 ||
+        !stream.readS32(&numLabels) || numLabels < 0 ||
+        !stream.readS32(&numInstructions) || numInstructions < 0 ||
+        (size_t)numInstructions > stream.getLength() / (8 * sizeof(int32_t))) {
+        return nullptr;
+    }
+
+    TArray<Instruction> instructions;
+    instructions.reserve_exact(numInstructions);
+    for (int index = 0; index < numInstructions; ++index) {
+        int32_t op;
+        Instruction inst;
+        if (!stream.readS32(&op) || op < 0 || op >= (int32_t)BuilderOp::unsupported ||
+            !stream.readS32(&inst.fSlotA) ||
+            !stream.readS32(&inst.fSlotB) ||
+            !stream.readS32(&inst.fImmA) ||
+            !stream.readS32(&inst.fImmB) ||
+            !stream.readS32(&inst.fImmC) ||
+            !stream.readS32(&inst.fImmD) ||
+            !stream.readS32(&inst.fStackID) ||
+            inst.fStackID < 0 || inst.fStackID >= numInstructions) {
+            return nullptr;
+        }
+        inst.fOp = (BuilderOp)op;
+        instructions.push_back(inst);
+    }
+    if (!stream.isAtEnd()) {
+        return nullptr;
+    }
+    return std::make_unique<Program>(std::move(instructions), numValueSlots, numUniformSlots,
+                                     numImmutableSlots, numLabels, /*debugTrace=*/nullptr);
+}
+
 }  // namespace SkSL::RP
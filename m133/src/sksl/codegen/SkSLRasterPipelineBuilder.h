@@ -167,8 +167,27 @@ public:
 
     void dump(SkWStream* out, bool writeInstructionCount = false) const;
 
+    /**
+     * Writes the program in a binary form which Deserialize() can turn back into an identical
+     * program. The format is tied to this build's op lists; Deserialize() rejects data written
+     * with different ones. Programs with a debug trace can't be serialized and return false.
+     */
+    bool serialize(SkWStream* out) const;
+
+    /**
+     * Reads a program written by serialize(), or returns null if the data is malformed, doesn't
+     * match the checksum serialize() wrote with it, or was written by an incompatible build. The
+     * checksum catches data that was truncated or corrupted, but the instructions themselves are
+     * not range checked, so the data must still come from a trusted source, such as a cache this
+     * process wrote.
+     */
+    static std::unique_ptr<Program> Deserialize(const void* data, size_t length);
+
     int numUniforms() const { return fNumUniformSlots; }
 
+    /** Approximates the memory held by the program, for caches which budget by size. */
+    size_t approximateSizeInBytes() const;
+
 private:
     using StackDepths = skia_private::TArray<int>; // [stack index] = depth of stack
 
@@ -723,6 +742,7 @@ private:
     Instruction* lastInstructionOnAnyStack(int fromBack = 0);
     void simplifyPopSlotsUnmasked(SlotRange* dst);
     bool simplifyImmediateUnmaskedOp();
+    bool simplifyBinaryOpPair(BuilderOp op, int32_t slots);
 
     skia_private::TArray<Instruction> fInstructions;
     int fNumLabels = 0;
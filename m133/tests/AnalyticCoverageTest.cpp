@@ -0,0 +1,85 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/private/base/SkSafe32.h"
+#include "src/base/SkRandom.h"
+#include "src/core/SkAnalyticCoverage.h"
+#include "tests/Test.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+static constexpr int kMaxCount = 100;
+
+// Exercise every count up to kMaxCount at a few offsets, so both the vector loops and the
+// scalar tails are covered, and check that nothing past count is touched.
+DEF_TEST(AnalyticCoverage_Accumulate, r) {
+    SkRandom random;
+    uint8_t src[kMaxCount + 8], dst[kMaxCount + 8], expected[kMaxCount + 8];
+
+    for (int offset = 0; offset < 4; ++offset) {
+        for (int count = 0; count <= kMaxCount; ++count) {
+            for (auto& a : src) { a = random.nextU() & 0xFF; }
+            for (auto& a : dst) { a = random.nextU() & 0xFF; }
+            const uint8_t alpha = random.nextU() & 0xFF;
+
+            memcpy(expected, dst, sizeof(dst));
+            for (int i = 0; i < count; ++i) {
+                expected[offset + i] = std::min(0xFF, expected[offset + i] + src[offset + i]);
+            }
+            SkOpts::accumulate_alphas(dst + offset, src + offset, count);
+            REPORTER_ASSERT(r, !memcmp(dst, expected, sizeof(dst)), "count %d", count);
+
+            for (int i = 0; i < count; ++i) {
+                expected[offset + i] = std::min(0xFF, expected[offset + i] + alpha);
+            }
+            SkOpts::accumulate_alpha(dst + offset, alpha, count);
+            REPORTER_ASSERT(r, !memcmp(dst, expected, sizeof(dst)), "count %d", count);
+
+            for (int i = 0; i < count; ++i) {
+                uint8_t& e = expected[offset + i];
+                e = e > src[offset + i] ? e - src[offset + i] : 0;
+            }
+            SkOpts::subtract_alphas(dst + offset, src + offset, count);
+            REPORTER_ASSERT(r, !memcmp(dst, expected, sizeof(dst)), "count %d", count);
+        }
+    }
+}
+
+DEF_TEST(AnalyticCoverage_AlphaRamp, r) {
+    const int32_t steps[] = {0, 1, 255, 256, 0x1234, 0x10000, 0x7654321, SK_MaxS32};
+
+    for (int32_t step : steps) {
+        for (int count = 0; count <= kMaxCount; ++count) {
+            // Stay within the documented range: every value in [0, SK_MaxS32].
+            const int64_t span = (int64_t)step * std::max(count - 1, 0);
+            if (span > SK_MaxS32) {
+                break;
+            }
+            for (int32_t start : {0, 0x80, (int32_t)(SK_MaxS32 - span)}) {
+                if (start + span > SK_MaxS32) {
+                    continue;
+                }
+                uint8_t ascending[kMaxCount + 1], descending[kMaxCount + 1];
+                memset(ascending, 0xAA, sizeof(ascending));
+                memset(descending, 0xAA, sizeof(descending));
+
+                SkOpts::alpha_ramp(ascending, count, start, step);
+                SkOpts::alpha_ramp(descending, count, (int32_t)(start + span), -step);
+
+                for (int i = 0; i < count; ++i) {
+                    const int64_t up   = start + (int64_t)i * step,
+                                  down = start + span - (int64_t)i * step;
+                    REPORTER_ASSERT(r, ascending[i] == (uint8_t)(up >> 8));
+                    REPORTER_ASSERT(r, descending[i] == (uint8_t)(down >> 8));
+                }
+                REPORTER_ASSERT(r, ascending[count] == 0xAA && descending[count] == 0xAA);
+            }
+        }
+    }
+}
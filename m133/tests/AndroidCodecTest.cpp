@@ -8,6 +8,8 @@
 #include "include/codec/SkAndroidCodec.h"
 #include "include/codec/SkCodec.h"
 #include "include/codec/SkEncodedImageFormat.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkColor.h"
 #include "include/core/SkColorSpace.h"
 #include "include/core/SkData.h"
 #include "include/core/SkImageInfo.h"
@@ -20,6 +22,8 @@
 #include "tests/Test.h"
 #include "tools/Resources.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <cstring>
 #include <initializer_list>
@@ -272,3 +276,96 @@ DEF_TEST(AndroidCodec_PQ, r) {
     static constexpr skcms_Matrix3x3 kExpected = SkNamedGamut::kRec2020;
     REPORTER_ASSERT(r, 0 == memcmp(&matrix, &kExpected, sizeof(skcms_Matrix3x3)));
 }
+
+// Averages each channel of the pixels of src that each pixel of dst covers, the slow way.
+static void reference_box_filter(const SkBitmap& src, SkBitmap* dst) {
+    const double sx = (double) src.width() / dst->width(),
+                 sy = (double) src.height() / dst->height();
+    for (int y = 0; y < dst->height(); y++) {
+        for (int x = 0; x < dst->width(); x++) {
+            double sum[4] = {0, 0, 0, 0};
+            for (int j = (int) (y * sy); j < (y + 1) * sy; j++) {
+                const double wy = std::min(j + 1.0, (y + 1) * sy) - std::max((double) j, y * sy);
+                for (int i = (int) (x * sx); i < (x + 1) * sx; i++) {
+                    const double w = wy * (std::min(i + 1.0, (x + 1) * sx) -
+                                           std::max((double) i, x * sx));
+                    const uint8_t* p = (const uint8_t*) src.getAddr32(i, j);
+                    for (int c = 0; c < 4; c++) {
+                        sum[c] += w * p[c];
+                    }
+                }
+            }
+            uint8_t* d = (uint8_t*) dst->getAddr32(x, y);
+            for (int c = 0; c < 4; c++) {
+                d[c] = (uint8_t) std::lround(sum[c] / (sx * sy));
+            }
+        }
+    }
+}
+
+// Returns the largest and the mean difference between the channels of a and b.
+static std::pair<int, double> diff(const SkBitmap& a, const SkBitmap& b) {
+    int maxDiff = 0;
+    int64_t total = 0;
+    for (int y = 0; y < a.height(); y++) {
+        const uint8_t* pa = (const uint8_t*) a.getAddr32(0, y);
+        const uint8_t* pb = (const uint8_t*) b.getAddr32(0, y);
+        for (int i = 0; i < 4 * a.width(); i++) {
+            const int d = std::abs(pa[i] - pb[i]);
+            maxDiff = std::max(maxDiff, d);
+            total += d;
+        }
+    }
+    return {maxDiff, (double) total / (4.0 * a.width() * a.height())};
+}
+
+DEF_TEST(AndroidCodec_getPixelsAtSize, r) {
+    for (const char* path : {"images/mandrill_512.png", "images/mandrill_512_q075.jpg"}) {
+        auto codec = SkAndroidCodec::MakeFromData(GetResourceAsData(path));
+        if (!codec) {
+            ERRORF(r, "Could not create codec for %s", path);
+            continue;
+        }
+        const bool isJpeg = codec->getEncodedFormat() == SkEncodedImageFormat::kJPEG;
+        const SkImageInfo fullInfo = codec->getInfo().makeColorType(kN32_SkColorType);
+        SkBitmap full;
+        full.allocPixels(fullInfo);
+        REPORTER_ASSERT(r, SkCodec::kSuccess ==
+                           codec->getPixels(fullInfo, full.getPixels(), full.rowBytes()));
+
+        // None of these are sample sizes, and a JPEG decodes the first two at a scale of 2/8
+        // and 5/8, then box filters the rest of the way.
+        for (SkISize size : {SkISize{100, 100}, SkISize{300, 217}, SkISize{37, 511}}) {
+            SkBitmap actual, expected;
+            actual.allocPixels(fullInfo.makeDimensions(size));
+            expected.allocPixels(fullInfo.makeDimensions(size));
+            REPORTER_ASSERT(r, SkCodec::kSuccess ==
+                               codec->getPixelsAtSize(actual.info(), actual.getPixels(),
+                                                      actual.rowBytes()));
+            reference_box_filter(full, &expected);
+
+            // Only rounding differs, unless a JPEG was decoded at a smaller scale. DCT scaling
+            // is close to, but not quite, a box filter.
+            auto [maxDiff, meanDiff] = diff(expected, actual);
+            if (isJpeg) {
+                REPORTER_ASSERT(r, meanDiff < 4, "%s %dx%d: mean difference %g",
+                                path, size.width(), size.height(), meanDiff);
+            } else {
+                REPORTER_ASSERT(r, maxDiff <= 1, "%s %dx%d: max difference %d",
+                                path, size.width(), size.height(), maxDiff);
+            }
+        }
+
+        // Other color types are scaled, if not box filtered.
+        SkBitmap bm;
+        bm.allocPixels(fullInfo.makeColorType(kRGB_565_SkColorType).makeWH(100, 100));
+        REPORTER_ASSERT(r, SkCodec::kSuccess ==
+                           codec->getPixelsAtSize(bm.info(), bm.getPixels(), bm.rowBytes()));
+
+        // Scaling up is not supported.
+        bm.allocPixels(fullInfo.makeWH(513, 100));
+        REPORTER_ASSERT(r, SkCodec::kInvalidParameters ==
+                           codec->getPixelsAtSize(bm.info(), bm.getPixels(), bm.rowBytes()));
+    }
+}
+
@@ -13,6 +13,7 @@
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
 #include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkPicture.h"
 #include "include/core/SkRect.h"
@@ -484,3 +485,65 @@ DEF_TEST(AnimatedImage, r) {
         }
     }
 }
+
+DEF_TEST(AnimatedImage_frameCacheAndLookAhead, r) {
+    if (GetResourcePath().isEmpty()) {
+        return;
+    }
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(1);
+    for (const char* file : { "images/alphabetAnim.gif",
+                              "images/colorTables.gif",
+                              "images/stoplight.webp",
+                              "images/required.webp",
+                              }) {
+        auto data = GetResourceAsData(file);
+        if (!data) {
+            ERRORF(r, "Could not get %s", file);
+            continue;
+        }
+
+        auto expectedImage = SkAnimatedImage::Make(SkAndroidCodec::MakeFromData(data));
+        auto actualImage = SkAnimatedImage::Make(SkAndroidCodec::MakeFromData(data));
+        if (!expectedImage || !actualImage) {
+            ERRORF(r, "Could not create animated image for %s", file);
+            continue;
+        }
+        expectedImage->setRepetitionCount(SkCodec::kRepetitionCountInfinite);
+        actualImage->setRepetitionCount(SkCodec::kRepetitionCountInfinite);
+
+        const int frameCount = actualImage->getFrameCount();
+        const SkImageInfo info = SkImageInfo::MakeN32Premul(actualImage->getBounds().width(),
+                                                            actualImage->getBounds().height());
+        // Enough to keep about half of the frames.
+        actualImage->setFrameCacheBudget(info.computeMinByteSize() * (frameCount / 2 + 1));
+        actualImage->setExecutor(executor.get());
+
+        auto draw = [&info](SkAnimatedImage* image) {
+            SkBitmap bm;
+            bm.allocPixels(info);
+            bm.eraseColor(SK_ColorTRANSPARENT);
+            SkCanvas canvas(bm);
+            image->draw(&canvas);
+            return bm;
+        };
+
+        // Play the animation three times, resetting partway through the second time, and
+        // dropping the cache during the third.
+        for (int i = 0; i < 3 * frameCount; i++) {
+            if (i == frameCount + frameCount / 2) {
+                expectedImage->reset();
+                actualImage->reset();
+            }
+            if (i == 2 * frameCount + 1) {
+                actualImage->setFrameCacheBudget(0);
+            }
+            const int expectedDuration = expectedImage->decodeNextFrame();
+            const int actualDuration = actualImage->decodeNextFrame();
+            REPORTER_ASSERT(r, expectedDuration == actualDuration);
+            if (!compare_bitmaps(r, file, i % frameCount,
+                                 draw(expectedImage.get()), draw(actualImage.get()))) {
+                break;
+            }
+        }
+    }
+}
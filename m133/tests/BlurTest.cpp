@@ -12,6 +12,7 @@
 #include "include/core/SkColor.h"
 #include "include/core/SkColorPriv.h"
 #include "include/core/SkColorType.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkMaskFilter.h"
 #include "include/core/SkPaint.h"
@@ -24,7 +25,9 @@
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkScalar.h"
 #include "include/core/SkSize.h"
+#include "include/core/SkTileMode.h"
 #include "include/core/SkSurface.h"
+#include "include/core/SkSurfaceProps.h"
 #include "include/core/SkTypes.h"
 #include "include/effects/SkPerlinNoiseShader.h"
 #include "include/gpu/GpuTypes.h"
@@ -33,9 +36,12 @@
 #include "include/private/base/SkTPin.h"
 #include "src/base/SkFloatBits.h"
 #include "src/base/SkMathPriv.h"
+#include "src/base/SkRandom.h"
+#include "src/core/SkBlurEngine.h"
 #include "src/core/SkBlurMask.h"
 #include "src/core/SkMask.h"
 #include "src/core/SkMaskFilterBase.h"
+#include "src/core/SkSpecialImage.h"
 #include "src/effects/SkEmbossMaskFilter.h"
 #include "src/gpu/ganesh/GrBlurUtils.h"
 #include "tests/CtsEnforcement.h"
@@ -48,6 +54,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <initializer_list>
+#include <memory>
 
 struct GrContextOptions;
 
@@ -587,3 +594,56 @@ DEF_TEST(zero_blur, reporter) {
     SkIPoint offset;
     bitmap.extractAlpha(&alpha, &paint, nullptr, &offset);
 }
+
+// Splitting the raster 8888 blur into bands of rows and columns must not change a single pixel.
+DEF_TEST(RasterBlurEngine_Bands, reporter) {
+    constexpr int kW = 517, kH = 389;  // Odd sizes, so the last bands are partial.
+    SkBitmap src;
+    src.allocN32Pixels(kW, kH);
+    SkRandom random;
+    for (int y = 0; y < kH; ++y) {
+        for (int x = 0; x < kW; ++x) {
+            *src.getAddr32(x, y) = SkPreMultiplyColor(random.nextU());
+        }
+    }
+    sk_sp<SkSpecialImage> input = SkSpecialImages::MakeFromRaster(SkIRect::MakeWH(kW, kH), src,
+                                                                  SkSurfaceProps{});
+
+    std::unique_ptr<SkExecutor> pool = SkExecutor::MakeFIFOThreadPool(4);
+    std::unique_ptr<SkBlurEngine> serial = SkBlurEngine::MakeRasterBlurEngine(nullptr);
+    std::unique_ptr<SkBlurEngine> banded = SkBlurEngine::MakeRasterBlurEngine(pool.get());
+
+    const SkIRect srcBounds = SkIRect::MakeLTRB(10, 7, kW - 3, kH - 12);
+    const SkIRect dstBounds = SkIRect::MakeLTRB(-20, 3, kW + 15, kH - 1);
+    for (SkSize sigma : {SkSize{5.f, 5.f}, SkSize{20.f, 0.f}, SkSize{0.f, 20.f},
+                         SkSize{40.f, 12.f}, SkSize{100.f, 100.f}}) {
+        const SkBlurEngine::Algorithm* serialBlur = serial->findAlgorithm(sigma, src.colorType());
+        const SkBlurEngine::Algorithm* bandedBlur = banded->findAlgorithm(sigma, src.colorType());
+        REPORTER_ASSERT(reporter, serialBlur && bandedBlur);
+        if (!serialBlur || !bandedBlur) {
+            continue;
+        }
+
+        SkBitmap expected, actual;
+        REPORTER_ASSERT(reporter, SkSpecialImages::AsBitmap(
+                serialBlur->blur(sigma, input, srcBounds, SkTileMode::kDecal, dstBounds).get(),
+                &expected));
+        REPORTER_ASSERT(reporter, SkSpecialImages::AsBitmap(
+                bandedBlur->blur(sigma, input, srcBounds, SkTileMode::kDecal, dstBounds).get(),
+                &actual));
+        REPORTER_ASSERT(reporter, expected.dimensions() == dstBounds.size());
+        REPORTER_ASSERT(reporter, actual.dimensions() == dstBounds.size());
+        if (expected.dimensions() != actual.dimensions()) {
+            continue;
+        }
+
+        int mismatches = 0;
+        for (int y = 0; y < expected.height(); ++y) {
+            for (int x = 0; x < expected.width(); ++x) {
+                mismatches += *expected.getAddr32(x, y) != *actual.getAddr32(x, y);
+            }
+        }
+        REPORTER_ASSERT(reporter, mismatches == 0, "sigma (%g, %g): %d pixels differ",
+                        sigma.width(), sigma.height(), mismatches);
+    }
+}
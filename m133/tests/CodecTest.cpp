@@ -11,6 +11,7 @@
 #include "include/codec/SkGifDecoder.h"
 #include "include/codec/SkJpegDecoder.h"
 #include "include/codec/SkPngChunkReader.h"
+#include "include/codec/SkPngDecoder.h"
 #include "include/core/SkAlphaType.h"
 #include "include/core/SkBitmap.h"
 #include "include/core/SkCanvas.h"
@@ -19,6 +20,7 @@
 #include "include/core/SkColorType.h"
 #include "include/core/SkData.h"
 #include "include/core/SkDataTable.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkImageGenerator.h"
 #include "include/core/SkImageInfo.h"
@@ -42,6 +44,7 @@
 #include "src/codec/SkCodecImageGenerator.h"
 #include "src/core/SkColorSpacePriv.h"
 #include "src/core/SkMD5.h"
+#include "src/core/SkOSFile.h"
 #include "src/core/SkStreamPriv.h"
 #include "tests/FakeStreams.h"
 #include "tests/Test.h"
@@ -58,6 +61,7 @@
 #include <setjmp.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 #include <initializer_list>
@@ -2250,3 +2254,178 @@ DEF_TEST(Codec_jpeg_decode_progressive_stream_incomplete, r) {
     SkCodec::Result result = codec->getPixels(info, bm.getPixels(), bm.rowBytes());
     REPORTER_ASSERT(r, result == SkCodec::kIncompleteInput);
 }
+
+namespace {
+// Forwards work to another executor, counting how much it was given.
+class CountingExecutor final : public SkExecutor {
+public:
+    explicit CountingExecutor(SkExecutor* executor) : fExecutor(executor) {}
+
+    void add(std::function<void(void)> work) override {
+        fTaskCount++;
+        fExecutor->add(std::move(work));
+    }
+    void borrow() override { fExecutor->borrow(); }
+
+    int taskCount() const { return fTaskCount.load(); }
+
+private:
+    SkExecutor* fExecutor;
+    std::atomic<int> fTaskCount{0};
+};
+}  // namespace
+
+DEF_TEST(Codec_jpeg_restart_intervals_in_parallel, r) {
+    // A 4:2:0 jpeg with a restart marker after every row of MCUs.
+    constexpr char path[] = "images/iphone_13_pro.jpeg";
+    sk_sp<SkData> data = GetResourceAsData(path);
+    if (!data) {
+        SkDebugf("Missing resource '%s'\n", path);
+        return;
+    }
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+
+    // A truncated image can't be decoded in parallel, but must still decode like it does
+    // serially.
+    for (sk_sp<SkData> encoded : {data, SkData::MakeSubset(data.get(), 0, data->size() / 2)}) {
+        for (SkColorType colorType : {kRGBA_8888_SkColorType, kRGB_565_SkColorType}) {
+            std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(encoded);
+            REPORTER_ASSERT(r, codec);
+            if (!codec) {
+                return;
+            }
+            SkImageInfo info = codec->getInfo().makeColorType(colorType);
+
+            SkBitmap serial, parallel;
+            serial.allocPixels(info);
+            parallel.allocPixels(info);
+            SkCodec::Result serialResult = codec->getPixels(serial.pixmap());
+
+            CountingExecutor counter(executor.get());
+            SkCodec::Options options;
+            options.fExecutor = &counter;
+            SkCodec::Result parallelResult =
+                    codec->getPixels(info, parallel.getPixels(), parallel.rowBytes(), &options);
+            REPORTER_ASSERT(r, serialResult == parallelResult);
+            // The whole image must be split into bands, while the truncated one must not even
+            // be tried.
+            if (encoded == data) {
+                REPORTER_ASSERT(r, counter.taskCount() >= 2, "%d", counter.taskCount());
+            } else {
+                REPORTER_ASSERT(r, counter.taskCount() == 0, "%d", counter.taskCount());
+            }
+            REPORTER_ASSERT(r, (serialResult == SkCodec::kSuccess) == (encoded == data));
+
+            for (int y = 0; y < info.height(); y++) {
+                if (0 != memcmp(serial.getAddr(0, y), parallel.getAddr(0, y),
+                                info.minRowBytes())) {
+                    ERRORF(r, "row %d differs for color type %d", y, colorType);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+// Maps the file at |path| and makes a codec from it. The file is closed before returning.
+static std::unique_ptr<SkCodec> make_from_fd(const char path[],
+                                             SkSpan<const SkCodecs::Decoder> decoders,
+                                             SkCodec::Result* result = nullptr) {
+    FILE* file = sk_fopen(path, kRead_SkFILE_Flag);
+    if (!file) {
+        return nullptr;
+    }
+    std::unique_ptr<SkCodec> codec = SkCodec::MakeFromFD(sk_fileno(file), decoders, result);
+    sk_fclose(file);
+    return codec;
+}
+
+// Decoding from a mapped file reads the mapping in place. It must match decoding the same file
+// through a stream that copies, including when scanline decoding stops partway through the data.
+DEF_TEST(Codec_MakeFromFD, r) {
+    const SkCodecs::Decoder decoders[] = {SkPngDecoder::Decoder(), SkJpegDecoder::Decoder()};
+    for (const char* path : {"images/mandrill_512.png",
+                             "images/plane_interlaced.png",
+                             "images/mandrill_512_q075.jpg",
+                             "images/color_wheel.jpg"}) {
+        const SkString fullPath = GetResourcePath(path);
+        SkCodec::Result result;
+        std::unique_ptr<SkCodec> mapped = make_from_fd(fullPath.c_str(), decoders, &result);
+        std::unique_ptr<SkCodec> copying =
+                SkCodec::MakeFromStream(SkFILEStream::Make(fullPath.c_str()), decoders);
+        if (!copying) {
+            SkDebugf("Missing resource '%s'\n", path);
+            continue;
+        }
+        REPORTER_ASSERT(r, mapped && result == SkCodec::kSuccess, "%s", path);
+        if (!mapped) {
+            continue;
+        }
+
+        const SkImageInfo info = copying->getInfo().makeColorType(kN32_SkColorType);
+        SkBitmap expected, actual;
+        expected.allocPixels(info);
+        actual.allocPixels(info);
+        REPORTER_ASSERT(r, copying->getPixels(expected.pixmap()) == SkCodec::kSuccess);
+        REPORTER_ASSERT(r, mapped->getPixels(actual.pixmap()) == SkCodec::kSuccess);
+        REPORTER_ASSERT(r, md5(expected) == md5(actual), "%s", path);
+
+        // Decode the top half, then the rest.
+        mapped = make_from_fd(fullPath.c_str(), decoders);
+        if (!mapped || mapped->startScanlineDecode(info) != SkCodec::kSuccess) {
+            continue;
+        }
+        const int half = info.height() / 2;
+        actual.eraseColor(SK_ColorTRANSPARENT);
+        REPORTER_ASSERT(r, mapped->getScanlines(actual.getPixels(), half,
+                                                actual.rowBytes()) == half);
+        REPORTER_ASSERT(r, mapped->getScanlines(actual.getAddr(0, half), info.height() - half,
+                                                actual.rowBytes()) == info.height() - half);
+        REPORTER_ASSERT(r, md5(expected) == md5(actual), "%s (scanlines)", path);
+    }
+}
+
+DEF_TEST(Codec_jpeg_progressive_preview, r) {
+    constexpr char path[] = "images/progressive_kitten_missing_eof.jpg";
+    sk_sp<SkData> data = GetResourceAsData(path);
+    if (!data) {
+        SkDebugf("Missing resource '%s'\n", path);
+        return;
+    }
+    std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(data);
+    REPORTER_ASSERT(r, codec);
+    if (!codec) {
+        return;
+    }
+    SkCodec::Options previewOptions;
+    previewOptions.fProgressivePreview = true;
+
+    // At full size, the preview is blocky, so it differs from the full decode.
+    SkBitmap full, preview;
+    full.allocPixels(codec->getInfo());
+    preview.allocPixels(codec->getInfo());
+    REPORTER_ASSERT(r, codec->getPixels(full.pixmap()) == SkCodec::kSuccess);
+    REPORTER_ASSERT(r, codec->getPixels(preview.pixmap(), &previewOptions) == SkCodec::kSuccess);
+    REPORTER_ASSERT(r, md5(full) != md5(preview));
+
+    // At 1/8 scale, only the DC coefficients matter. This image's first scan has all of them,
+    // less their lowest bit, so the preview is close to the full decode.
+    const SkImageInfo eighth = codec->getInfo().makeDimensions(codec->getScaledDimensions(0.125f));
+    full.allocPixels(eighth);
+    preview.allocPixels(eighth);
+    REPORTER_ASSERT(r, codec->getPixels(full.pixmap()) == SkCodec::kSuccess);
+    REPORTER_ASSERT(r, codec->getPixels(preview.pixmap(), &previewOptions) == SkCodec::kSuccess);
+    int totalDiff = 0;
+    for (int y = 0; y < eighth.height(); y++) {
+        for (int x = 0; x < eighth.width(); x++) {
+            const SkColor a = full.getColor(x, y),
+                          b = preview.getColor(x, y);
+            totalDiff += std::abs((int) SkColorGetR(a) - (int) SkColorGetR(b)) +
+                         std::abs((int) SkColorGetG(a) - (int) SkColorGetG(b)) +
+                         std::abs((int) SkColorGetB(a) - (int) SkColorGetB(b));
+        }
+    }
+    const double meanDiff = totalDiff / (3.0 * eighth.width() * eighth.height());
+    REPORTER_ASSERT(r, meanDiff < 8, "mean difference %g", meanDiff);
+}
+
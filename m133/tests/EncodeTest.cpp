@@ -15,17 +15,23 @@
 #include "include/core/SkColorType.h"
 #include "include/core/SkData.h"
 #include "include/core/SkDataTable.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkImageInfo.h"
+#include "include/core/SkPaint.h"
 #include "include/core/SkPixmap.h"
+#include "include/core/SkPoint.h"
+#include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkSurface.h"
+#include "include/core/SkTileMode.h"
 #include "include/core/SkTypes.h"
 #include "include/encode/SkEncoder.h"
 #include "include/encode/SkJpegEncoder.h"
 #include "include/encode/SkPngEncoder.h"
 #include "include/encode/SkWebpEncoder.h"
+#include "include/effects/SkGradientShader.h"
 #include "include/private/base/SkAssert.h"
 #include "include/private/base/SkMalloc.h"
 #include "include/private/base/SkTemplates.h"
@@ -533,6 +539,100 @@ DEF_TEST(Encode_PngOptions, r) {
     REPORTER_ASSERT(r, almost_equals(bm0, bm2, 0));
 }
 
+DEF_TEST(Encode_PngStripes, r) {
+    // Tall enough to be split into several stripes.
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(301, 1000);
+    for (int y = 0; y < bitmap.height(); ++y) {
+        for (int x = 0; x < bitmap.width(); ++x) {
+            U8CPU a = y % 3 ? 0xFF : x & 0xFF;
+            SkColor c = SkColorSetARGB(a, (x ^ y) & 0xFF, (x * y >> 4) & 0xFF, (x + y) / 5 & 0xFF);
+            *bitmap.getAddr32(x, y) = SkPreMultiplyColor(c);
+        }
+    }
+
+    SkPixmap src;
+    REPORTER_ASSERT(r, bitmap.peekPixels(&src));
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+
+    for (auto filters : {SkPngEncoder::FilterFlag::kNone,
+                         SkPngEncoder::FilterFlag::kPaeth,
+                         SkPngEncoder::FilterFlag::kAll}) {
+        SkPngEncoder::Options options;
+        options.fFilterFlags = filters;
+
+        SkDynamicMemoryWStream serialStream, stripedStream;
+        REPORTER_ASSERT(r, SkPngEncoder::Encode(&serialStream, src, options));
+        options.fExecutor = executor.get();
+        REPORTER_ASSERT(r, SkPngEncoder::Encode(&stripedStream, src, options));
+
+        SkBitmap bm0, bm1;
+        sk_sp<SkImage> serial = SkImages::DeferredFromEncodedData(serialStream.detachAsData());
+        sk_sp<SkImage> striped = SkImages::DeferredFromEncodedData(stripedStream.detachAsData());
+        REPORTER_ASSERT(r, serial && striped);
+        if (!serial || !striped) {
+            return;
+        }
+        REPORTER_ASSERT(r, serial->asLegacyBitmap(&bm0));
+        REPORTER_ASSERT(r, striped->asLegacyBitmap(&bm1));
+        REPORTER_ASSERT(r, almost_equals(bm0, bm1, 0));
+    }
+}
+
+// Encoding rows a band at a time, without the whole image in memory, must produce exactly what
+// encoding the whole pixmap does.
+DEF_TEST(Encode_Bands, r) {
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(97, 61);
+    // Edges of paths may rasterize differently when clipped to a band, so stick to rects.
+    auto draw = [](SkCanvas* canvas) {
+        canvas->drawColor(SK_ColorWHITE);
+        SkPaint paint;
+        const SkPoint pts[] = {{0, 0}, {97, 61}};
+        const SkColor colors[] = {SK_ColorBLUE, SK_ColorGREEN};
+        paint.setShader(SkGradientShader::MakeLinear(pts, colors, nullptr, 2, SkTileMode::kClamp));
+        canvas->drawRect(SkRect::MakeLTRB(10, 10, 70, 50), paint);
+        paint.setShader(nullptr);
+        paint.setColor(0x80FF0000);
+        canvas->drawRect(SkRect::MakeLTRB(30, 5, 90, 55), paint);
+    };
+
+    SkBitmap bitmap;
+    bitmap.allocPixels(info);
+    SkCanvas canvas(bitmap);
+    draw(&canvas);
+
+    auto makeEncoder = [](SkEncodedImageFormat format, SkWStream* dst, const auto& src) {
+        return format == SkEncodedImageFormat::kJPEG
+                       ? SkJpegEncoder::Make(dst, src, SkJpegEncoder::Options())
+                       : SkPngEncoder::Make(dst, src, SkPngEncoder::Options());
+    };
+
+    for (auto format : {SkEncodedImageFormat::kJPEG, SkEncodedImageFormat::kPNG}) {
+        SkDynamicMemoryWStream whole, drawn, passed;
+        REPORTER_ASSERT(r, encode(format, &whole, bitmap.pixmap()));
+
+        std::unique_ptr<SkEncoder> encoder = makeEncoder(format, &drawn, info);
+        REPORTER_ASSERT(r, encoder && encoder->encodeBands(16, draw));
+
+        // An encoder without pixels can't encode rows it wasn't given, or rows that don't match.
+        encoder = makeEncoder(format, &passed, info);
+        REPORTER_ASSERT(r, encoder);
+        SkBitmap wrongType;
+        wrongType.allocPixels(info.makeColorType(kRGB_565_SkColorType).makeWH(info.width(), 10));
+        REPORTER_ASSERT(r, !encoder->encodeRows(wrongType.pixmap()));
+        for (int y = 0; y < info.height(); y += 10) {
+            SkPixmap rows;
+            bitmap.pixmap().extractSubset(
+                    &rows, SkIRect::MakeLTRB(0, y, info.width(), std::min(y + 10, info.height())));
+            REPORTER_ASSERT(r, encoder->encodeRows(rows));
+        }
+
+        sk_sp<SkData> expected = whole.detachAsData();
+        REPORTER_ASSERT(r, expected->equals(drawn.detachAsData().get()));
+        REPORTER_ASSERT(r, expected->equals(passed.detachAsData().get()));
+    }
+}
+
 #ifndef SK_BUILD_FOR_GOOGLE3
 DEF_TEST(Encode_WebpQuality, r) {
     SkBitmap bm;
@@ -8,6 +8,7 @@
 #include "include/core/SkTypes.h"
 
 #ifdef SK_SUPPORT_PDF
+#include "include/core/SkExecutor.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkString.h"
 #include "include/private/base/SkDebug.h"
@@ -21,6 +22,7 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 
 #include "zlib.h"
@@ -177,4 +179,40 @@ DEF_TEST(SkPDF_DeflateWStream, r) {
     REPORTER_ASSERT(r, !emptyDeflateWStream.writeText("FOO"));
 }
 
+DEF_TEST(SkPDF_DeflateWStream_parallel, r) {
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    SkRandom random(654321);
+    // Small enough for one zlib stream, a few chunks, and several batches of chunks.
+    for (uint32_t size : {0u, 5000u, 300000u, 5000000u}) {
+        // Runs of repeated bytes, so that matches span chunks.
+        AutoTMalloc<uint8_t> buffer(size);
+        for (uint32_t j = 0; j < size;) {
+            uint32_t run = std::min(size - j, random.nextRangeU(1, 64));
+            memset(&buffer[j], random.nextU() & 0x0f, run);
+            j += run;
+        }
+
+        SkDynamicMemoryWStream dynamicMemoryWStream;
+        {
+            SkDeflateWStream deflateWStream(&dynamicMemoryWStream, -1, false, executor.get());
+            for (uint32_t j = 0; j < size;) {
+                uint32_t writeSize = std::min(size - j, random.nextRangeU(1, 100000));
+                REPORTER_ASSERT(r, deflateWStream.write(&buffer[j], writeSize));
+                j += writeSize;
+            }
+            REPORTER_ASSERT(r, deflateWStream.bytesWritten() == size);
+        }
+        std::unique_ptr<SkStreamAsset> compressed(dynamicMemoryWStream.detachAsStream());
+        std::unique_ptr<SkStreamAsset> decompressed(stream_inflate(r, compressed.get()));
+        if (!decompressed) {
+            ERRORF(r, "Decompression of %u bytes failed.", size);
+            continue;
+        }
+        AutoTMalloc<uint8_t> result(size);
+        REPORTER_ASSERT(r, decompressed->getLength() == size);
+        REPORTER_ASSERT(r, decompressed->read(result.get(), size) == size);
+        REPORTER_ASSERT(r, size == 0 || !memcmp(result.get(), buffer.get(), size));
+    }
+}
+
 #endif
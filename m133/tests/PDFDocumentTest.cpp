@@ -13,6 +13,7 @@
 #include "include/core/SkFont.h"
 #include "include/core/SkImage.h" // IWYU pragma: keep
 #include "include/core/SkPaint.h"
+#include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkString.h"
@@ -267,3 +268,29 @@ DEF_TEST(SkPDF_abort_jobs, rep) {
     doc->abort();
 }
 
+
+// Large streams are deflated in parallel on the document's executor. Make sure that doesn't
+// deadlock when no thread can help out a job that waits for other work on the executor.
+DEF_TEST(SkPDF_parallel_deflate_single_thread, rep) {
+    REQUIRE_PDF_DOCUMENT(SkPDF_parallel_deflate_single_thread, rep);
+    SkBitmap b;
+    b.allocN32Pixels(512, 512);
+    b.eraseColor(0xFF9643A0);
+    SkPDF::Metadata metadata;
+    std::unique_ptr<SkExecutor> executor =
+            SkExecutor::MakeFIFOThreadPool(1, /*allowBorrowing=*/false);
+    metadata.fExecutor = executor.get();
+    SkDynamicMemoryWStream dst;
+    auto doc = SkPDF::MakeDocument(&dst, metadata);
+    for (int i = 0; i < 3; ++i) {
+        SkCanvas* canvas = doc->beginPage(612, 792);
+        canvas->drawImage(b.asImage(), 0, 0);
+        // Enough drawing for the page's content stream to be deflated in pieces as well.
+        for (int j = 0; j < 20000; ++j) {
+            canvas->drawRect(SkRect::MakeXYWH(j % 600, j % 780, 4, 4), SkPaint());
+        }
+        doc->endPage();
+    }
+    doc->close();
+    REPORTER_ASSERT(rep, dst.bytesWritten() > 0);
+}
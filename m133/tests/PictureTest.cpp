@@ -11,9 +11,11 @@
 #include "include/core/SkClipOp.h"
 #include "include/core/SkColor.h"
 #include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFont.h"
 #include "include/core/SkFontStyle.h"
 #include "include/core/SkImage.h" // IWYU pragma: keep
+#include "include/core/SkImageFilter.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkMatrix.h"
 #include "include/core/SkPaint.h"
@@ -26,17 +28,22 @@
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkSamplingOptions.h"
 #include "include/core/SkScalar.h"
+#include "include/core/SkSize.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkTypeface.h"
 #include "include/core/SkTypes.h"
+#include "include/effects/SkImageFilters.h"
+#include "include/private/base/SkTemplates.h"
 #include "src/base/SkRandom.h"
 #include "src/core/SkBigPicture.h"
 #include "src/core/SkPicturePriv.h"
 #include "src/core/SkRectPriv.h"
 #include "tests/Test.h"
+#include "tools/ToolUtils.h"
 #include "tools/fonts/FontToolUtils.h"
 
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <vector>
 
@@ -868,9 +875,10 @@ DEF_TEST(Picture_emptyNestedPictureBug, r) {
 
 DEF_TEST(Picture_fillsBBH, r) {
     // Test empty (0 draws), mini (1 draw), and big (2+) pictures, making sure they fill the BBH.
+    // The rects overlap so that SkRecordOptimize() can't merge them into one draw.
     const SkRect rects[] = {
         { 0, 0, 20,20},
-        {20,20, 40,40},
+        {10,10, 40,40},
     };
 
     for (int n = 0; n <= 2; n++) {
@@ -924,3 +932,125 @@ DEF_TEST(Picture_nested_op_count, r) {
     check(make_pic(10, leaf1),  10,  10);
     check(make_pic(10, leaf10), 10, 100);
 }
+
+DEF_TEST(Picture_playbackTiled, r) {
+    constexpr int kW = 157, kH = 113;
+
+    // With 'edges' set, strokes along the edges of the shapes instead, so that playing the picture
+    // back covers the pixels within about a pixel of them. Tiles clip a path that crosses them
+    // before scan converting it, which moves its edges by a fraction of a pixel, so those are the
+    // only pixels that may differ from playback(), and by no more than kMaxEdgeDifference in any
+    // channel.
+    constexpr int kMaxEdgeDifference = 128;
+    auto record = [](SkBBHFactory* factory, bool edges, bool backdrop,
+                     const sk_sp<SkPicture>& nested) {
+        SkPictureRecorder recorder;
+        SkCanvas* c = recorder.beginRecording(SkRect::MakeWH(kW, kH), factory);
+        if (!edges) {
+            c->clear(SK_ColorWHITE);
+        }
+
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        if (edges) {
+            paint.setStyle(SkPaint::kStroke_Style);
+            paint.setStrokeWidth(3);
+        }
+        paint.setColor(0xC02060A0);
+        c->drawCircle(60, 50, 41, paint);
+        c->save();
+        c->rotate(9);
+        paint.setColor(0x8040C020);
+        c->drawRect({30, 20, 140, 70}, paint);
+        c->restore();
+
+        if (nested) {
+            c->save();
+            c->translate(70, 40);
+            c->drawPicture(nested);
+            c->restore();
+        }
+
+        if (backdrop && !edges) {
+            sk_sp<SkImageFilter> blur = SkImageFilters::Blur(4, 4, nullptr);
+            const SkRect bounds = {20, 30, 120, 100};
+            c->saveLayer(SkCanvas::SaveLayerRec(&bounds, nullptr, blur.get(), 0));
+            c->restore();
+        }
+
+        paint.setColor(SK_ColorBLACK);
+        paint.setStyle(SkPaint::kStroke_Style);
+        paint.setStrokeWidth(edges ? 6 : 3);
+        c->drawLine(0, kH, kW, 0, paint);
+        return recorder.finishRecordingAsPicture();
+    };
+
+    auto check = [&](const sk_sp<SkPicture>& pic, const sk_sp<SkPicture>& edgesPic,
+                     SkExecutor* executor, SkISize tileSize) {
+        const SkImageInfo info = SkImageInfo::MakeN32Premul(kW, kH);
+        const SkMatrix matrix = SkMatrix::Translate(3.5f, -2).preScale(0.9f, 1.1f);
+
+        SkBitmap expected, actual, edges;
+        expected.allocPixels(info);
+        actual.allocPixels(info);
+        edges.allocPixels(SkImageInfo::MakeA8(kW, kH));
+        expected.eraseColor(SK_ColorTRANSPARENT);
+        actual.eraseColor(SK_ColorTRANSPARENT);
+        edges.eraseColor(SK_ColorTRANSPARENT);
+
+        SkCanvas canvas(expected);
+        canvas.concat(matrix);
+        pic->playback(&canvas);
+
+        SkCanvas edgesCanvas(edges);
+        edgesCanvas.concat(matrix);
+        edgesPic->playback(&edgesCanvas);
+
+        REPORTER_ASSERT(r, pic->playbackTiled(actual.pixmap(), matrix, executor, tileSize));
+
+        // Every pixel is compared: those off of the paths' edges must match exactly, and those on
+        // them within the bound that SkPicture::playbackTiled() documents.
+        int differing = 0;
+        for (int y = 0; y < kH; ++y) {
+            for (int x = 0; x < kW; ++x) {
+                const int tolerance = *edges.getAddr8(x, y) ? kMaxEdgeDifference : 0;
+                const uint32_t e = *expected.getAddr32(x, y), a = *actual.getAddr32(x, y);
+                for (int shift = 0; shift < 32; shift += 8) {
+                    if (SkTAbs(int((e >> shift) & 0xFF) - int((a >> shift) & 0xFF)) > tolerance) {
+                        differing += 1;
+                        break;
+                    }
+                }
+            }
+        }
+        REPORTER_ASSERT(r, differing == 0, "%d pixels differ by more than tiling allows",
+                        differing);
+
+        // The matrix leaves this corner outside the picture's cull rect, but clear() reaches it.
+        REPORTER_ASSERT(r, expected.getColor(kW - 1, 0) == SK_ColorWHITE);
+        REPORTER_ASSERT(r, actual.getColor(kW - 1, 0) == SK_ColorWHITE);
+    };
+
+    std::unique_ptr<SkExecutor> pool = SkExecutor::MakeFIFOThreadPool(3);
+    SkRTreeFactory factory;
+    // The nested picture's clear() reaches outside of its cull rect.
+    sk_sp<SkPicture> inner = record(nullptr, false, false, nullptr);
+    sk_sp<SkPicture> innerEdges = record(nullptr, true, false, nullptr);
+
+    for (SkBBHFactory* bbh : {(SkBBHFactory*)nullptr, (SkBBHFactory*)&factory}) {
+        for (bool backdrop : {false, true}) {
+            for (bool nested : {false, true}) {
+                sk_sp<SkPicture> pic = record(bbh, false, backdrop, nested ? inner : nullptr);
+                sk_sp<SkPicture> edges = record(nullptr, true, backdrop,
+                                                nested ? innerEdges : nullptr);
+                check(pic, edges, pool.get(), {32, 32});
+                check(pic, edges, pool.get(), {kW, 7});
+                check(pic, edges, nullptr, {50, 200});
+            }
+        }
+    }
+
+    SkBitmap bm;
+    bm.allocPixels(SkImageInfo::MakeN32Premul(4, 4));
+    REPORTER_ASSERT(r, !inner->playbackTiled(bm.pixmap(), SkMatrix::I(), nullptr, {0, 4}));
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkBitmap.h"
+#include "include/core/SkBlendMode.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkMatrix.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkShader.h"
+#include "include/core/SkSurfaceProps.h"
+#include "src/base/SkArenaAlloc.h"
+#include "src/core/SkBlitter.h"
+#include "src/core/SkCoreBlitters.h"
+#include "src/core/SkOpts.h"
+#include "tests/Test.h"
+#include "tools/ToolUtils.h"
+
+#include <cstdint>
+#include <vector>
+
+// blitAntiH() coalesces neighbouring partial coverage runs into spans; the result must match
+// blitting every run on its own.
+DEF_TEST(SkRasterPipelineBlitter_AntiHSpans, r) {
+    struct Run { int16_t len; SkAlpha alpha; };
+    const std::vector<Run> rows[] = {
+        {{1, 0x40}, {1, 0x80}, {1, 0xC0}, {58, 0xff}, {1, 0xC0}, {1, 0x80}, {1, 0x40}},
+        {{3, 0x00}, {2, 0x11}, {4, 0x00}, {1, 0x22}, {9, 0x00}, {5, 0x33}, {40, 0x00}},
+        {{1, 0x7f}, {8, 0x00}, {1, 0x01}, {1, 0xfe}, {30, 0x00}, {23, 0x55}},
+        {{63, 0x99}, {1, 0x98}},
+        {{64, 0x00}},
+    };
+    constexpr int kW = 64;
+
+    // F16 isn't handled by the legacy blitters, so this will always use the raster pipeline.
+    const SkImageInfo info = SkImageInfo::Make(kW, 1, kRGBA_F16_SkColorType, kPremul_SkAlphaType);
+
+    for (SkColor color : {SK_ColorRED, SkColorSetARGB(0x80, 0x20, 0x40, 0x60)}) {
+        for (const std::vector<Run>& row : rows) {
+            SkPaint paint;
+            paint.setColor(color);
+
+            SkBitmap batched, single;
+            batched.allocPixels(info);
+            single.allocPixels(info);
+            batched.eraseColor(SK_ColorWHITE);
+            single.eraseColor(SK_ColorWHITE);
+
+            // Lay out the whole row the way the scan converters do.
+            SkAlpha aa[kW + 1] = {};
+            int16_t runs[kW + 1] = {};
+            int x = 0;
+            for (const Run& run : row) {
+                aa[x] = run.alpha;
+                runs[x] = run.len;
+                x += run.len;
+            }
+            REPORTER_ASSERT(r, x == kW);
+
+            SkSTArenaAlloc<2048> allocA, allocB;
+            SkBlitter* blitter = SkBlitter::Choose(batched.pixmap(), SkMatrix::I(), paint,
+                                                   &allocA, false, nullptr, SkSurfaceProps());
+            blitter->blitAntiH(0, 0, aa, runs);
+
+            blitter = SkBlitter::Choose(single.pixmap(), SkMatrix::I(), paint,
+                                        &allocB, false, nullptr, SkSurfaceProps());
+            x = 0;
+            for (const Run& run : row) {
+                SkAlpha oneAA[kW + 1] = {run.alpha};
+                int16_t oneRun[kW + 1] = {run.len};
+                blitter->blitAntiH(x, 0, oneAA, oneRun);
+                x += run.len;
+            }
+
+            REPORTER_ASSERT(r, ToolUtils::equal_pixels(batched, single));
+        }
+    }
+}
+
+// Solid color blitters come from a per-thread cache with the color patched in. Draw the same
+// shapes with a constant color shader, which never uses the cache, and compare.
+DEF_TEST(SkRasterPipelineBlitter_Cache, r) {
+    const SkColor colors[] = {SK_ColorRED, 0x8020C040, SK_ColorBLUE, 0x00000000, SK_ColorWHITE};
+    const SkBlendMode modes[] = {SkBlendMode::kSrcOver, SkBlendMode::kSrc,
+                                 SkBlendMode::kMultiply, SkBlendMode::kPlus};
+
+    SkRasterPipelineBlitterCacheStats before = SkGetRasterPipelineBlitterCacheStats();
+    int draws = 0;
+
+    // Vary the dst size so cached blitters get reused with both smaller and larger dsts.
+    for (int size : {23, 61, 17}) {
+        const SkImageInfo info =
+                SkImageInfo::Make(size, size, kRGBA_F16_SkColorType, kPremul_SkAlphaType);
+        SkBitmap cached, uncached;
+        cached.allocPixels(info);
+        uncached.allocPixels(info);
+        cached.eraseColor(0xFF808080);
+        uncached.eraseColor(0xFF808080);
+
+        SkCanvas cachedCanvas(cached), uncachedCanvas(uncached);
+        for (SkBlendMode mode : modes) {
+            for (SkColor color : colors) {
+                SkPaint paint;
+                paint.setAntiAlias(true);
+                paint.setBlendMode(mode);
+                paint.setColor(color);
+                cachedCanvas.drawRect(SkRect::MakeLTRB(1, 2, size - 3, size / 2 + 0.5f), paint);
+                cachedCanvas.drawCircle(size / 2.0f, size / 2.0f, size / 3.0f, paint);
+                // The canvas skips draws that can't change any pixels.
+                draws += paint.nothingToDraw() ? 0 : 2;
+
+                paint.setColor(SK_ColorBLACK);
+                paint.setShader(SkShaders::Color(color));
+                uncachedCanvas.drawRect(SkRect::MakeLTRB(1, 2, size - 3, size / 2 + 0.5f), paint);
+                uncachedCanvas.drawCircle(size / 2.0f, size / 2.0f, size / 3.0f, paint);
+            }
+        }
+        REPORTER_ASSERT(r, ToolUtils::equal_pixels(cached, uncached));
+    }
+
+    // Other threads may be drawing too, so we can only check for at least our own draws.
+    SkRasterPipelineBlitterCacheStats after = SkGetRasterPipelineBlitterCacheStats();
+    REPORTER_ASSERT(r, (after.fHits - before.fHits) + (after.fMisses - before.fMisses) >= draws);
+    REPORTER_ASSERT(r, after.fHits - before.fHits > 0);
+}
+
+// Cached blitters hold pipelines compiled for one SkOpts target, so switching targets has to
+// rebuild them. This switches the global stage tables, which is why it has to be a serial test.
+DEF_SERIAL_TEST(SkRasterPipelineBlitter_CacheTracksTarget, r) {
+    using Target = SkOpts::RasterPipelineTarget;
+
+    SkBitmap bitmap;
+    bitmap.allocPixels(SkImageInfo::Make(16, 16, kRGBA_F16_SkColorType, kPremul_SkAlphaType));
+    SkCanvas canvas(bitmap);
+    SkPaint paint;
+    paint.setColor(0x8020C040);
+
+    auto misses = [&](Target target) {
+        SkOpts::SetRasterPipelineTarget(target);
+        SkRasterPipelineBlitterCacheStats before = SkGetRasterPipelineBlitterCacheStats();
+        canvas.drawRect(SkRect::MakeWH(8, 8), paint);
+        canvas.drawRect(SkRect::MakeWH(8, 8), paint);
+        return SkGetRasterPipelineBlitterCacheStats().fMisses - before.fMisses;
+    };
+
+    misses(Target::kNative);
+    // Nothing else draws during a serial test, so the second draw of each pair always hits.
+    REPORTER_ASSERT(r, misses(Target::kDefault) == 1);
+    REPORTER_ASSERT(r, misses(Target::kNative) == 1);
+}
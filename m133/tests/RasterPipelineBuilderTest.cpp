@@ -5,6 +5,7 @@
  * found in the LICENSE file.
  */
 
+#include "include/core/SkData.h"
 #include "include/core/SkStream.h"
 #include "src/base/SkArenaAlloc.h"
 #include "src/base/SkStringView.h"
@@ -13,6 +14,9 @@
 #include "src/sksl/tracing/SkSLDebugTracePriv.h"
 #include "tests/Test.h"
 
+#include <cstdint>
+#include <vector>
+
 static sk_sp<SkData> get_program_dump(SkSL::RP::Program& program) {
     SkDynamicMemoryWStream stream;
     program.dump(&stream);
@@ -854,6 +858,53 @@ mix_3_floats                   $0..2 = mix($3..5, $6..8, $0..2)
 )");
 }
 
+DEF_TEST(RasterPipelineBuilderFusedTernaryFloatOps, r) {
+    using BuilderOp = SkSL::RP::BuilderOp;
+
+    SkSL::RP::Builder builder;
+    // `a * b + c` becomes a single mad.
+    builder.push_slots(three_slots_at(0));
+    builder.push_slots(three_slots_at(3));
+    builder.binary_op(BuilderOp::mul_n_floats, 3);
+    builder.push_uniform(three_slots_at(0));
+    builder.binary_op(BuilderOp::add_n_floats, 3);
+    builder.pop_slots(three_slots_at(6));
+    // `clamp(x, lo, hi)` becomes a single clamp.
+    builder.push_slots(four_slots_at(0));
+    builder.push_zeros(4);
+    builder.binary_op(BuilderOp::max_n_floats, 4);
+    builder.push_uniform(four_slots_at(4));
+    builder.binary_op(BuilderOp::min_n_floats, 4);
+    builder.pop_slots(four_slots_at(4));
+    // A push which reads the stack can't be moved ahead of the first op.
+    builder.push_slots(two_slots_at(0));
+    builder.push_slots(two_slots_at(2));
+    builder.binary_op(BuilderOp::mul_n_floats, 2);
+    builder.push_clone(2);
+    builder.binary_op(BuilderOp::add_n_floats, 2);
+    builder.pop_slots(two_slots_at(8));
+    std::unique_ptr<SkSL::RP::Program> program = builder.finish(/*numValueSlots=*/10,
+                                                                /*numUniformSlots=*/8,
+                                                                /*numImmutableSlots=*/0);
+    check(r, *program,
+R"(copy_4_slots_unmasked          $0..3 = v0..3
+copy_2_slots_unmasked          $4..5 = v4..5
+copy_3_uniforms                $6..8 = u0..2
+mad_3_floats                   $0..2 = $0..2 * $3..5 + $6..8
+copy_3_slots_unmasked          v6..8 = $0..2
+copy_4_slots_unmasked          $0..3 = v0..3
+splat_4_constants              $4..7 = 0
+copy_4_uniforms                $8..11 = u4..7
+clamp_4_floats                 $0..3 = clamp($0..3, $4..7, $8..11)
+copy_4_slots_unmasked          v4..7 = $0..3
+copy_4_slots_unmasked          $0..3 = v0..3
+mul_2_floats                   $0..1 *= $2..3
+copy_2_slots_unmasked          $2..3 = $0..1
+add_2_floats                   $0..1 += $2..3
+copy_2_slots_unmasked          v8..9 = $0..1
+)");
+}
+
 DEF_TEST(RasterPipelineBuilderAutomaticStackRewinding, r) {
     using BuilderOp = SkSL::RP::BuilderOp;
 
@@ -940,3 +991,52 @@ trace_exit                     TraceExit(FunctionC) when $0 is true
         }
     }
 }
+
+DEF_TEST(RasterPipelineBuilderSerialize, r) {
+    // Create a very simple nonsense program which uses several stacks, labels and uniforms.
+    SkSL::RP::Builder builder;
+    builder.push_constant_f(13.5f);
+    builder.push_uniform(two_slots_at(0));
+    builder.set_current_stack(1);
+    builder.push_slots(three_slots_at(4));
+    builder.set_current_stack(0);
+    builder.binary_op(SkSL::RP::BuilderOp::add_n_floats, 1);
+    builder.pop_slots(two_slots_at(2));
+    int label = builder.nextLabelID();
+    builder.branch_if_all_lanes_active(label);
+    builder.set_current_stack(1);
+    builder.discard_stack(3);
+    builder.set_current_stack(0);
+    builder.label(label);
+    std::unique_ptr<SkSL::RP::Program> program = builder.finish(/*numValueSlots=*/10,
+                                                                /*numUniformSlots=*/2,
+                                                                /*numImmutableSlots=*/0);
+    SkDynamicMemoryWStream stream;
+    REPORTER_ASSERT(r, program->serialize(&stream));
+    sk_sp<SkData> data = stream.detachAsData();
+
+    // The deserialized program must be identical.
+    std::unique_ptr<SkSL::RP::Program> copy =
+            SkSL::RP::Program::Deserialize(data->data(), data->size());
+    REPORTER_ASSERT(r, copy);
+    if (copy) {
+        REPORTER_ASSERT(r, copy->numUniforms() == 2);
+        sk_sp<SkData> expected = get_program_dump(*program);
+        check(r, *copy, as_string_view(expected));
+    }
+
+    // Truncated, extended or corrupted data, and data written with different ops, are rejected.
+    REPORTER_ASSERT(r, !SkSL::RP::Program::Deserialize(data->data(), data->size() - 1));
+    REPORTER_ASSERT(r, !SkSL::RP::Program::Deserialize(data->data(), 4));
+    REPORTER_ASSERT(r, !SkSL::RP::Program::Deserialize(data->data(), 0));
+    std::vector<uint8_t> bytes(data->bytes(), data->bytes() + data->size());
+    bytes.push_back(0);
+    REPORTER_ASSERT(r, !SkSL::RP::Program::Deserialize(bytes.data(), bytes.size()));
+    bytes.pop_back();
+    bytes[0] ^= 1;
+    REPORTER_ASSERT(r, !SkSL::RP::Program::Deserialize(bytes.data(), bytes.size()));
+    bytes[0] ^= 1;
+    // The first instruction's fSlotA, which would otherwise be used as an index unchecked.
+    bytes[6 * sizeof(int32_t) + 1 * sizeof(int32_t)] ^= 0x40;
+    REPORTER_ASSERT(r, !SkSL::RP::Program::Deserialize(bytes.data(), bytes.size()));
+}
@@ -0,0 +1,300 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkBitmap.h"
+#include "include/core/SkBlendMode.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkImageFilter.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkMatrix.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkPath.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkPictureRecorder.h"
+#include "include/core/SkPoint.h"
+#include "include/core/SkRRect.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkShader.h"
+#include "include/core/SkSize.h"
+#include "include/core/SkSurface.h"
+#include "include/core/SkTileMode.h"
+#include "include/effects/SkGradientShader.h"
+#include "include/effects/SkImageFilters.h"
+#include "include/private/base/SkTemplates.h"
+#include "src/core/SkCanvasPriv.h"
+#include "tests/Test.h"
+#include "tools/ToolUtils.h"
+
+#include <cstdint>
+#include <memory>
+
+static constexpr int kW = 301, kH = 211;
+
+static SkRRect scene_rrect() {
+    return SkRRect::MakeRectXY(SkRect::MakeXYWH(10, 10, 200, 120), 25, 25);
+}
+
+static SkMatrix scene_rrect_matrix() {
+    return SkMatrix::Translate(17.5f, 9.25f).preRotate(12);
+}
+
+static SkPath scene_path() {
+    SkPath path;
+    path.moveTo(5, 200);
+    path.cubicTo(80, -40, 220, 260, 296, 15);
+    path.lineTo(150, 205);
+    path.close();
+    return path;
+}
+
+static void draw_scene(SkCanvas* canvas) {
+    canvas->clear(SK_ColorWHITE);
+
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    const SkPoint pts[] = {{0, 0}, {kW, kH}};
+    const SkColor colors[] = {SK_ColorRED, SK_ColorBLUE};
+    paint.setShader(SkGradientShader::MakeLinear(pts, colors, nullptr, 2, SkTileMode::kClamp));
+    paint.setDither(true);
+    canvas->drawRect(SkRect::MakeWH(kW, kH), paint);
+    paint.setShader(nullptr);
+    paint.setDither(false);
+
+    canvas->save();
+    canvas->concat(scene_rrect_matrix());
+    paint.setColor(0x8000FF00);
+    canvas->drawRRect(scene_rrect(), paint);
+    canvas->restore();
+
+    paint.setColor(0xC0202080);
+    canvas->drawPath(scene_path(), paint);
+
+    // A blurred layer whose filter reads well past any tile boundary.
+    SkPaint layerPaint;
+    layerPaint.setImageFilter(SkImageFilters::Blur(6, 6, nullptr));
+    canvas->saveLayer(nullptr, &layerPaint);
+    canvas->clipRect(SkRect::MakeLTRB(40, 30, 260, 180), true);
+    paint.setColor(SK_ColorBLACK);
+    canvas->drawRect(SkRect::MakeLTRB(90.5f, 45.25f, 210, 165), paint);
+    paint.setStyle(SkPaint::kStroke_Style);
+    paint.setStrokeWidth(7);
+    canvas->drawRect(SkRect::MakeLTRB(60, 50, 240, 150), paint);
+    canvas->restore();
+}
+
+// Covers the pixels within about a pixel of the edges of the scene's paths. Tiles clip a path
+// that crosses them before scan converting it, which moves its edges by a fraction of a pixel,
+// so these are the only pixels that may differ from a surface made with Raster(), and by no more
+// than kMaxEdgeDifference in any channel.
+static SkBitmap path_edges() {
+    SkBitmap edges;
+    edges.allocPixels(SkImageInfo::MakeA8(kW, kH));
+    edges.eraseColor(SK_ColorTRANSPARENT);
+
+    SkCanvas canvas(edges);
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setStyle(SkPaint::kStroke_Style);
+    paint.setStrokeWidth(3);
+    canvas.save();
+    canvas.concat(scene_rrect_matrix());
+    canvas.drawRRect(scene_rrect(), paint);
+    canvas.restore();
+    canvas.drawPath(scene_path(), paint);
+    return edges;
+}
+
+static constexpr int kMaxEdgeDifference = 128;
+
+// Returns how many pixels differ between a and b.
+static int count_differing_pixels(const SkBitmap& a, const SkBitmap& b) {
+    int differing = 0;
+    for (int y = 0; y < a.height(); ++y) {
+        for (int x = 0; x < a.width(); ++x) {
+            differing += *a.getAddr32(x, y) != *b.getAddr32(x, y);
+        }
+    }
+    return differing;
+}
+
+// Returns how many pixels differ between a and b, either anywhere off of 'edges', or on them by
+// more than kMaxEdgeDifference in some channel.
+static int count_pixels_off_by_more_than_edges(const SkBitmap& a, const SkBitmap& b,
+                                               const SkBitmap& edges) {
+    int differing = 0;
+    for (int y = 0; y < a.height(); ++y) {
+        for (int x = 0; x < a.width(); ++x) {
+            const int tolerance = *edges.getAddr8(x, y) ? kMaxEdgeDifference : 0;
+            const uint32_t pa = *a.getAddr32(x, y), pb = *b.getAddr32(x, y);
+            for (int shift = 0; shift < 32; shift += 8) {
+                const int diff = SkTAbs(int((pa >> shift) & 0xFF) - int((pb >> shift) & 0xFF));
+                if (diff > tolerance) {
+                    differing += 1;
+                    break;
+                }
+            }
+        }
+    }
+    return differing;
+}
+
+static void check_matches_raster(skiatest::Reporter* r, SkExecutor* executor, SkISize tileSize) {
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(kW, kH);
+
+    sk_sp<SkSurface> serial = SkSurfaces::Raster(info);
+    sk_sp<SkSurface> tiled = SkSurfaces::RasterTiled(info, executor, tileSize);
+    REPORTER_ASSERT(r, serial && tiled);
+
+    draw_scene(serial->getCanvas());
+    draw_scene(tiled->getCanvas());
+
+    SkBitmap expected, actual;
+    expected.allocPixels(info);
+    actual.allocPixels(info);
+    sk_sp<SkImage> snapshot = tiled->makeImageSnapshot();
+    REPORTER_ASSERT(r, serial->readPixels(expected, 0, 0));
+    REPORTER_ASSERT(r, snapshot->readPixels(nullptr, actual.pixmap(), 0, 0));
+
+    // Every pixel is compared: those off of the paths' edges must match exactly, and those on
+    // them within the bound that SkSurfaces::RasterTiled() documents.
+    int differing = count_pixels_off_by_more_than_edges(expected, actual, path_edges());
+    REPORTER_ASSERT(r, differing == 0, "%d pixels differ by more than tiling allows", differing);
+
+    // Drawing after a snapshot must not disturb it.
+    tiled->getCanvas()->drawColor(0x40FF0000);
+    SkBitmap after;
+    after.allocPixels(info);
+    REPORTER_ASSERT(r, tiled->readPixels(after, 0, 0));
+    REPORTER_ASSERT(r, count_differing_pixels(after, actual) > 0);
+    REPORTER_ASSERT(r, snapshot->readPixels(nullptr, after.pixmap(), 0, 0));
+    REPORTER_ASSERT(r, ToolUtils::equal_pixels(after, actual));
+}
+
+DEF_TEST(SurfaceRasterTiled_MatchesRaster, r) {
+    std::unique_ptr<SkExecutor> pool = SkExecutor::MakeFIFOThreadPool(4);
+    check_matches_raster(r, pool.get(), {64, 64});
+    check_matches_raster(r, pool.get(), {37, 301});
+    check_matches_raster(r, nullptr, {kW, kH});
+}
+
+DEF_TEST(SurfaceRasterTiled_OpenLayerNotFlushed, r) {
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(8, 8);
+    std::unique_ptr<SkExecutor> pool = SkExecutor::MakeFIFOThreadPool(2);
+    sk_sp<SkSurface> surface = SkSurfaces::RasterTiled(info, pool.get(), {4, 4});
+    SkCanvas* canvas = surface->getCanvas();
+
+    canvas->clear(SK_ColorBLUE);
+    canvas->saveLayer(nullptr, nullptr);
+    canvas->clear(SK_ColorRED);
+
+    // Like a raster canvas, pixels drawn into an open layer aren't visible until its restore.
+    SkBitmap bm;
+    bm.allocPixels(info);
+    REPORTER_ASSERT(r, surface->readPixels(bm, 0, 0));
+    REPORTER_ASSERT(r, bm.getColor(3, 5) == SK_ColorBLUE);
+
+    canvas->restore();
+    REPORTER_ASSERT(r, surface->readPixels(bm, 0, 0));
+    REPORTER_ASSERT(r, bm.getColor(3, 5) == SK_ColorRED);
+}
+
+DEF_TEST(SurfaceRasterTiled_WritePixels, r) {
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(8, 8);
+    sk_sp<SkSurface> surface = SkSurfaces::RasterTiled(info, nullptr, {2, 2});
+    surface->getCanvas()->clear(SK_ColorGREEN);
+
+    SkBitmap src;
+    src.allocPixels(info.makeWH(2, 2));
+    src.eraseColor(SK_ColorRED);
+    surface->writePixels(src, 0, 0);
+
+    SkBitmap bm;
+    bm.allocPixels(info);
+    REPORTER_ASSERT(r, surface->readPixels(bm, 0, 0));
+    REPORTER_ASSERT(r, bm.getColor(1, 1) == SK_ColorRED);
+    REPORTER_ASSERT(r, bm.getColor(6, 6) == SK_ColorGREEN);
+
+    REPORTER_ASSERT(r, !SkSurfaces::RasterTiled(info, nullptr, {0, 4}));
+}
+
+// Each flush collapses the matrix and clip changes it has rasterized past, which must leave the
+// canvas in the same state for the draws that follow.
+DEF_TEST(SurfaceRasterTiled_StateAcrossFlushes, r) {
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(96, 80);
+    std::unique_ptr<SkExecutor> pool = SkExecutor::MakeFIFOThreadPool(2);
+    sk_sp<SkSurface> serial = SkSurfaces::Raster(info);
+    sk_sp<SkSurface> tiled = SkSurfaces::RasterTiled(info, pool.get(), {32, 16});
+
+    SkBitmap expected, actual;
+    expected.allocPixels(info);
+    actual.allocPixels(info);
+    for (SkSurface* surface : {serial.get(), tiled.get()}) {
+        SkCanvas* canvas = surface->getCanvas();
+        canvas->clear(SK_ColorWHITE);
+        SkPaint paint;
+        for (int i = 0; i < 40; ++i) {
+            if (i % 10 == 0) {
+                canvas->save();
+                canvas->clipRect(SkRect::MakeXYWH(i, i / 2, 80, 70));
+            }
+            canvas->translate(1, 0.5f);
+            if (i % 7 == 0) {
+                canvas->clipRect(SkRect::MakeXYWH(-2, -1, 90, 75));
+            }
+            if (i % 13 == 0) {
+                SkCanvasPriv::ResetClip(canvas);
+            }
+            canvas->save();
+            canvas->scale(1.5f, 1);
+            paint.setColor(SkColorSetARGB(0x80, i * 6, 0xFF - i * 6, 0x40));
+            canvas->drawRect(SkRect::MakeWH(6, 5), paint);
+            canvas->restore();
+            if (i % 10 == 9) {
+                canvas->restore();
+            }
+            // Reading flushes the tiled surface's canvas.
+            REPORTER_ASSERT(r, surface->readPixels(actual, 0, 0));
+        }
+    }
+    REPORTER_ASSERT(r, serial->readPixels(expected, 0, 0));
+    REPORTER_ASSERT(r, tiled->readPixels(actual, 0, 0));
+    REPORTER_ASSERT(r, ToolUtils::equal_pixels(expected, actual));
+}
+
+// A nested picture's clear() fills the whole canvas, not just its cull rect, so it can't be split
+// into tiles that each quick-reject the picture on their own.
+DEF_TEST(SurfaceRasterTiled_NestedPictureClear, r) {
+    SkPictureRecorder recorder;
+    SkCanvas* c = recorder.beginRecording(SkRect::MakeXYWH(10, 10, 20, 20));
+    c->clear(SK_ColorBLUE);
+    SkPaint paint;
+    paint.setColor(SK_ColorRED);
+    c->drawRect(SkRect::MakeXYWH(12, 12, 10, 10), paint);
+    c->drawRect(SkRect::MakeXYWH(20, 16, 8, 9), paint);
+    sk_sp<SkPicture> picture = recorder.finishRecordingAsPicture();
+
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(64, 48);
+    std::unique_ptr<SkExecutor> pool = SkExecutor::MakeFIFOThreadPool(2);
+    sk_sp<SkSurface> serial = SkSurfaces::Raster(info);
+    sk_sp<SkSurface> tiled = SkSurfaces::RasterTiled(info, pool.get(), {16, 16});
+    for (SkSurface* surface : {serial.get(), tiled.get()}) {
+        surface->getCanvas()->clear(SK_ColorGREEN);
+        surface->getCanvas()->drawPicture(picture);
+    }
+
+    SkBitmap expected, actual;
+    expected.allocPixels(info);
+    actual.allocPixels(info);
+    REPORTER_ASSERT(r, serial->readPixels(expected, 0, 0));
+    REPORTER_ASSERT(r, tiled->readPixels(actual, 0, 0));
+    REPORTER_ASSERT(r, expected.getColor(60, 40) == SK_ColorBLUE);
+    REPORTER_ASSERT(r, ToolUtils::equal_pixels(expected, actual));
+}
@@ -5,17 +5,22 @@
  * found in the LICENSE file.
  */
 
+#include "include/core/SkBitmap.h"
 #include "include/core/SkBlendMode.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
 #include "include/core/SkColorFilter.h"
+#include "include/core/SkImage.h"
 #include "include/core/SkImageFilter.h"
 #include "include/core/SkImageInfo.h"
+#include "include/core/SkMatrix.h"
 #include "include/core/SkPaint.h"
 #include "include/core/SkPicture.h"
 #include "include/core/SkPictureRecorder.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkRegion.h"
+#include "include/core/SkSamplingOptions.h"
 #include "include/core/SkScalar.h"
 #include "include/core/SkSurface.h"
 #include "include/effects/SkImageFilters.h"
@@ -28,6 +33,7 @@
 
 #include <array>
 #include <cstddef>
+#include <cstring>
 
 static const int W = 1920, H = 1080;
 
@@ -426,3 +432,205 @@ DEF_TEST(savelayer_srcmode_alpha, r) {
     do_savelayer_srcmode(r, 0x80FF0000);
 }
 
+
+DEF_TEST(RecordOpts_NoopRedundantStateOps, r) {
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+
+    recorder.setMatrix(SkMatrix::Scale(2, 2));           // 0: replaced by 1 before any use
+    recorder.setMatrix(SkMatrix::Translate(10, 10));     // 1
+    recorder.save();                                     // 2
+        recorder.clipRect(SkRect::MakeWH(100, 100));     // 3
+        recorder.drawRect(SkRect::MakeWH(50, 50), SkPaint());  // 4
+        recorder.translate(5, 5);                        // 5: restored before any use
+        recorder.clipRect(SkRect::MakeWH(10, 10));       // 6: restored before any draw
+    recorder.restore();                                  // 7
+    recorder.drawRect(SkRect::MakeWH(50, 50), SkPaint());  // 8
+    recorder.clipRect(SkRect::MakeWH(10, 10));           // 9: nothing draws after it
+    recorder.scale(3, 3);                                // 10: nothing draws after it
+
+    REPORTER_ASSERT(r, 5 == SkRecordNoopRedundantStateOps(&record));
+    assert_type<SkRecords::NoOp>(r, record, 0);
+    assert_type<SkRecords::SetM44>(r, record, 1);
+    assert_type<SkRecords::ClipRect>(r, record, 3);
+    for (int i : {5, 6, 9, 10}) {
+        assert_type<SkRecords::NoOp>(r, record, i);
+    }
+}
+
+DEF_TEST(RecordOpts_NoopContainingRectClips, r) {
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+
+    recorder.clipRect(SkRect::MakeWH(200, 200));                 // 0: contains 1
+    recorder.clipRect(SkRect::MakeXYWH(10, 10, 50, 50));         // 1
+    recorder.clipRect(SkRect::MakeXYWH(10, 10, 50, 50));         // 2: same as 1
+    recorder.clipRect(SkRect::MakeWH(100, 100), true);           // 3: AA clips stay
+    recorder.clipRect(SkRect::MakeWH(300, 300), SkClipOp::kDifference);  // 4: not an intersect
+    recorder.drawRect(SkRect::MakeWH(50, 50), SkPaint());        // 5
+    recorder.translate(10, 10);                                  // 6
+    recorder.clipRect(SkRect::MakeWH(200, 200));                 // 7: different matrix
+    recorder.drawRect(SkRect::MakeWH(50, 50), SkPaint());        // 8
+
+    REPORTER_ASSERT(r, 2 == SkRecordNoopRedundantStateOps(&record));
+    assert_type<SkRecords::NoOp>(r, record, 0);
+    assert_type<SkRecords::ClipRect>(r, record, 1);
+    assert_type<SkRecords::NoOp>(r, record, 2);
+    assert_type<SkRecords::ClipRect>(r, record, 3);
+    assert_type<SkRecords::ClipRect>(r, record, 4);
+    assert_type<SkRecords::ClipRect>(r, record, 7);
+}
+
+DEF_TEST(RecordOpts_CullOccludedDraws, r) {
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+
+    SkPaint opaque, translucent, aa;
+    translucent.setAlphaf(0.5f);
+    aa.setAntiAlias(true);
+
+    recorder.drawRect(SkRect::MakeWH(10, 10), opaque);            // 0: covered by 2
+    recorder.drawOval(SkRect::MakeLTRB(5, 5, 20, 20), aa);        // 1: AA, so its bounds are fuzzy
+    recorder.drawRect(SkRect::MakeWH(50, 50), opaque);            // 2
+    recorder.drawRect(SkRect::MakeWH(100, 100), translucent);     // 3: doesn't cover anything
+    recorder.drawAnnotation(SkRect::MakeWH(10, 10), "key", nullptr);  // 4: never culled
+    recorder.drawRect(SkRect::MakeXYWH(40, 40, 80, 80), opaque);  // 5: doesn't contain 2
+    recorder.clipRect(SkRect::MakeWH(500, 500));                  // 6: ends the run
+    recorder.drawRect(SkRect::MakeWH(10, 10), opaque);            // 7: covered by 8
+    recorder.drawPaint(opaque);                                   // 8
+
+    REPORTER_ASSERT(r, 2 == SkRecordCullOccludedDraws(&record));
+    assert_type<SkRecords::NoOp>(r, record, 0);
+    assert_type<SkRecords::DrawOval>(r, record, 1);
+    assert_type<SkRecords::DrawRect>(r, record, 2);
+    assert_type<SkRecords::DrawRect>(r, record, 3);
+    assert_type<SkRecords::DrawAnnotation>(r, record, 4);
+    assert_type<SkRecords::DrawRect>(r, record, 5);
+    assert_type<SkRecords::ClipRect>(r, record, 6);
+    assert_type<SkRecords::NoOp>(r, record, 7);
+    assert_type<SkRecords::DrawPaint>(r, record, 8);
+}
+
+DEF_TEST(RecordOpts_MergeDrawRects, r) {
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+
+    SkPaint red, blue;
+    red.setColor(SK_ColorRED);
+    blue.setColor(SK_ColorBLUE);
+
+    recorder.drawRect(SkRect::MakeXYWH(0, 0, 10, 10), red);       // 0
+    recorder.drawRect(SkRect::MakeXYWH(20, 0, 10, 10), red);      // 1: merged into 0
+    recorder.drawRect(SkRect::MakeXYWH(10, 0, 10, 10), red);      // 2: merged into 0
+    recorder.drawRect(SkRect::MakeXYWH(5, 5, 10, 10), red);       // 3: overlaps 0
+    recorder.drawRect(SkRect::MakeXYWH(40, 0, 10, 10), blue);     // 4: different paint
+    recorder.drawRect(SkRect::MakeXYWH(60, 0, 10.5f, 10), blue);  // 5: not on pixel edges
+
+    REPORTER_ASSERT(r, 2 == SkRecordMergeDrawRects(&record));
+    const SkRecords::DrawRegion* merged = assert_type<SkRecords::DrawRegion>(r, record, 0);
+    REPORTER_ASSERT(r, merged->paint == red);
+    REPORTER_ASSERT(r, merged->region.isRect());
+    REPORTER_ASSERT(r, merged->region.getBounds() == SkIRect::MakeWH(30, 10));
+    assert_type<SkRecords::NoOp>(r, record, 1);
+    assert_type<SkRecords::NoOp>(r, record, 2);
+    for (int i : {3, 4, 5}) {
+        assert_type<SkRecords::DrawRect>(r, record, i);
+    }
+}
+
+DEF_TEST(RecordOpts_MergeDrawImageRects, r) {
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(16, 16);
+    bitmap.eraseColor(SK_ColorGREEN);
+    sk_sp<SkImage> image = bitmap.asImage();
+    SkPaint translucent;
+    translucent.setAlphaf(0.5f);
+
+    const SkSamplingOptions nearest, linear(SkFilterMode::kLinear);
+    recorder.drawImageRect(image, SkRect::MakeWH(16, 16), SkRect::MakeWH(32, 32), nearest,
+                           &translucent, SkCanvas::kFast_SrcRectConstraint);      // 0
+    recorder.drawImageRect(image, SkRect::MakeWH(8, 8), SkRect::MakeXYWH(0, 40, 32, 32), nearest,
+                           &translucent, SkCanvas::kFast_SrcRectConstraint);      // 1: merged
+    recorder.drawImageRect(image, SkRect::MakeWH(16, 16), SkRect::MakeWH(32, 32), linear,
+                           &translucent, SkCanvas::kFast_SrcRectConstraint);      // 2: sampling
+    recorder.drawImageRect(image, SkRect::MakeWH(16, 16), SkRect::MakeWH(32, 32), linear,
+                           nullptr, SkCanvas::kFast_SrcRectConstraint);           // 3: paint
+
+    REPORTER_ASSERT(r, 1 == SkRecordMergeDrawImageRects(&record));
+    const auto* set = assert_type<SkRecords::DrawEdgeAAImageSet>(r, record, 0);
+    REPORTER_ASSERT(r, set->count == 2);
+    REPORTER_ASSERT(r, set->paint && *set->paint == translucent);
+    REPORTER_ASSERT(r, set->sampling == nearest);
+    REPORTER_ASSERT(r, set->set[1].fSrcRect == SkRect::MakeWH(8, 8));
+    REPORTER_ASSERT(r, set->set[1].fDstRect == SkRect::MakeXYWH(0, 40, 32, 32));
+    assert_type<SkRecords::NoOp>(r, record, 1);
+    assert_type<SkRecords::DrawImageRect>(r, record, 2);
+    assert_type<SkRecords::DrawImageRect>(r, record, 3);
+}
+
+// Draws a frame that every optimization in SkRecordOptimize() has something to do to.
+static void draw_optimizable_frame(SkCanvas* canvas, const sk_sp<SkImage>& image) {
+    SkPaint paint;
+    paint.setColor(SK_ColorBLUE);
+    canvas->drawRect(SkRect::MakeWH(20, 20), paint);
+    canvas->drawPaint(SkPaint(SkColors::kWhite));
+
+    for (int i = 0; i < 4; i++) {
+        canvas->setMatrix(SkMatrix::Translate(i, 0));
+        canvas->setMatrix(SkMatrix::I());
+        canvas->clipRect(SkRect::MakeWH(64, 64));
+        paint.setColor(i % 2 ? SK_ColorRED : SK_ColorGREEN);
+        for (int j = 0; j < 4; j++) {
+            canvas->drawRect(SkRect::MakeXYWH(4 + j * 12, 4 + i * 12, 10, 10), paint);
+        }
+    }
+
+    paint.setAlphaf(0.75f);
+    for (int j = 0; j < 4; j++) {
+        canvas->drawImageRect(image, SkRect::MakeWH(4, 4), SkRect::MakeXYWH(j * 15, 50, 13, 13),
+                              SkSamplingOptions(), &paint, SkCanvas::kStrict_SrcRectConstraint);
+    }
+}
+
+DEF_TEST(RecordOpts_OptimizedPictureDrawsTheSame, r) {
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(8, 8);
+    bitmap.eraseColor(0x8000FF00);
+    bitmap.erase(SK_ColorMAGENTA, SkIRect::MakeWH(4, 4));
+    sk_sp<SkImage> image = bitmap.asImage();
+
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(64, 64);
+    sk_sp<SkSurface> direct = SkSurfaces::Raster(info);
+    draw_optimizable_frame(direct->getCanvas(), image);
+
+    SkPictureRecorder recorder;
+    recorder.setCullOccludedDraws(true);
+    draw_optimizable_frame(recorder.beginRecording(64, 64), image);
+    sk_sp<SkPicture> picture = recorder.finishRecordingAsPicture();
+
+    const SkPictureRecorder::OptimizationStats& stats = recorder.optimizationStats();
+    REPORTER_ASSERT(r, stats.fRecordedOps == 2 + 4 * 7 + 4);
+    REPORTER_ASSERT(r, stats.fCulledDraws == 1);
+    REPORTER_ASSERT(r, stats.fRedundantStateOps == 4);
+    REPORTER_ASSERT(r, stats.fMergedDraws == 4 * 3 + 3);
+    REPORTER_ASSERT(r, stats.fRemovedOps ==
+                       stats.fCulledDraws + stats.fRedundantStateOps + stats.fMergedDraws);
+    REPORTER_ASSERT(r, picture->approximateOpCount() ==
+                       stats.fRecordedOps - stats.fRemovedOps);
+
+    sk_sp<SkSurface> played = SkSurfaces::Raster(info);
+    played->getCanvas()->drawPicture(picture);
+
+    SkBitmap expected, actual;
+    expected.allocPixels(info);
+    actual.allocPixels(info);
+    REPORTER_ASSERT(r, direct->readPixels(expected, 0, 0));
+    REPORTER_ASSERT(r, played->readPixels(actual, 0, 0));
+    for (int y = 0; y < info.height(); y++) {
+        REPORTER_ASSERT(r, !memcmp(expected.getAddr32(0, y), actual.getAddr32(0, y),
+                                   info.minRowBytes()), "row %d differs", y);
+    }
+}
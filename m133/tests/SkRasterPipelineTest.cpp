@@ -15,7 +15,9 @@
 #include "src/sksl/tracing/SkSLTraceHook.h"
 #include "tests/Test.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstdlib>
 #include <numeric>
 
 using namespace skia_private;
@@ -2417,6 +2419,66 @@ DEF_TEST(SkRasterPipeline_MixTest, r) {
     }
 }
 
+DEF_TEST(SkRasterPipeline_MadAndClampTest, r) {
+    // Allocate space for 5 dest and 10 source slots.
+    alignas(64) float slots[15 * SkRasterPipeline_kMaxStride_highp];
+    const int N = SkOpts::raster_pipeline_highp_stride;
+
+    struct TernaryOp {
+        int numSlotsAffected;
+        SkRasterPipelineOp stage;
+        bool isMad;  // otherwise, clamp
+    };
+
+    static const TernaryOp kTernaryOps[] = {
+        {1, SkRasterPipelineOp::mad_float,      true},
+        {2, SkRasterPipelineOp::mad_2_floats,   true},
+        {3, SkRasterPipelineOp::mad_3_floats,   true},
+        {4, SkRasterPipelineOp::mad_4_floats,   true},
+        {5, SkRasterPipelineOp::mad_n_floats,   true},
+        {1, SkRasterPipelineOp::clamp_float,    false},
+        {2, SkRasterPipelineOp::clamp_2_floats, false},
+        {3, SkRasterPipelineOp::clamp_3_floats, false},
+        {4, SkRasterPipelineOp::clamp_4_floats, false},
+        {5, SkRasterPipelineOp::clamp_n_floats, false},
+    };
+
+    for (const TernaryOp& op : kTernaryOps) {
+        // Fill the three operands with small integers, so that every result is exact.
+        const int count = op.numSlotsAffected * N;
+        float* a = &slots[0];
+        float* b = &slots[1 * count];
+        float* c = &slots[2 * count];
+        for (int idx = 0; idx < count; ++idx) {
+            a[idx] = (float)(idx % 7 - 3);
+            b[idx] = (float)(idx % 5 - 4);
+            c[idx] = (float)(idx % 3 + 1);
+        }
+        float expected[5 * SkRasterPipeline_kMaxStride_highp];
+        for (int idx = 0; idx < count; ++idx) {
+            expected[idx] = op.isMad ? a[idx] * b[idx] + c[idx]
+                                     : std::min(std::max(a[idx], b[idx]), c[idx]);
+        }
+
+        SkArenaAlloc alloc(/*firstHeapAllocation=*/256);
+        SkRasterPipeline p(&alloc);
+        p.append(SkRasterPipelineOp::set_base_pointer, &slots[0]);
+        if (op.numSlotsAffected > 4) {
+            SkRasterPipeline_TernaryOpCtx ctx;
+            ctx.dst = 0;
+            ctx.delta = count * sizeof(float);
+            p.append(op.stage, SkRPCtxUtils::Pack(ctx, &alloc));
+        } else {
+            p.append(op.stage, slots);
+        }
+        p.run(0,0,1,1);
+
+        for (int idx = 0; idx < count; ++idx) {
+            REPORTER_ASSERT(r, a[idx] == expected[idx]);
+        }
+    }
+}
+
 DEF_TEST(SkRasterPipeline_MixIntTest, r) {
     // Allocate space for 5 dest and 10 source slots.
     alignas(64) int slots[15 * SkRasterPipeline_kMaxStride_highp];
@@ -3450,3 +3512,73 @@ DEF_TEST(SkRasterPipeline_stack_rewind, r) {
         stack.validate(r);
     }
 }
+
+extern bool gForceHighPrecisionRasterPipeline;
+
+DEF_SERIAL_TEST(SkRasterPipeline_gradient_matches_across_targets, r) {
+    // Each SkOpts target has its own gradient lookup (permutes for a few stops, gathers for many),
+    // so check that they all agree with the portable default. This switches the global stage
+    // tables, which is why it has to be a serial test.
+    using Target = SkOpts::RasterPipelineTarget;
+    constexpr int kWidth = 64;
+    const bool forceHighp = gForceHighPrecisionRasterPipeline;
+
+    for (bool highp : {false, true}) {
+        for (int stops : {3, 8, 9, 16, 17, 24}) {
+            // Pad the stop arrays the same way SkGradientBaseShader does.
+            float fs[4][32] = {}, bs[4][32] = {}, ts[32] = {};
+            for (int i = 0; i < stops; i++) {
+                ts[i] = (float)i / stops;
+                for (int c = 0; c < 4; c++) {
+                    fs[c][i] = ((i * 7 + c * 3) % 11) / 11.0f - 0.5f;
+                    bs[c][i] = ((i * 5 + c) % 13) / 26.0f;
+                }
+            }
+            SkRasterPipeline_GradientCtx ctx;
+            ctx.stopCount = stops;
+            for (int c = 0; c < 4; c++) {
+                ctx.fs[c] = fs[c];
+                ctx.bs[c] = bs[c];
+            }
+            ctx.ts = ts;
+
+            const float matrix[] = {1.0f / kWidth, 0, 0, 0, 1, 0};
+
+            auto draw = [&](Target target, uint32_t* pixels) {
+                SkOpts::SetRasterPipelineTarget(target);
+                SkRasterPipeline_MemoryCtx dst = {pixels, 0};
+
+                SkRasterPipeline_<256> p;
+                p.append(SkRasterPipelineOp::seed_shader);
+                p.append(SkRasterPipelineOp::matrix_2x3, matrix);
+                p.append(SkRasterPipelineOp::gradient, &ctx);
+                p.append(SkRasterPipelineOp::clamp_01);
+                p.append(SkRasterPipelineOp::store_8888, &dst);
+                p.run(0,0,kWidth,1);
+            };
+
+            gForceHighPrecisionRasterPipeline = highp;
+            uint32_t expected[kWidth];
+            draw(Target::kDefault, expected);
+
+            for (Target target : {Target::kHSW, Target::kSKX, Target::kLASX}) {
+                if (!SkOpts::SupportsRasterPipelineTarget(target)) {
+                    continue;
+                }
+                uint32_t actual[kWidth];
+                draw(target, actual);
+                for (int x = 0; x < kWidth; x++) {
+                    for (int shift : {0, 8, 16, 24}) {
+                        int e = (expected[x] >> shift) & 0xff,
+                            a = (actual  [x] >> shift) & 0xff;
+                        // FMA and approximate math can round a little differently per target.
+                        REPORTER_ASSERT(r, std::abs(e - a) <= 1,
+                                        "stops=%d highp=%d x=%d: %d vs %d", stops, highp, x, e, a);
+                    }
+                }
+            }
+        }
+    }
+    gForceHighPrecisionRasterPipeline = forceHighp;
+    SkOpts::SetRasterPipelineTarget(Target::kNative);
+}
@@ -9,6 +9,7 @@
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
 #include "include/core/SkColorSpace.h"
+#include "include/core/SkGraphics.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkMatrix.h"
@@ -24,15 +25,18 @@
 #include "src/core/SkCachedData.h"
 #include "src/core/SkMipmap.h"
 #include "src/core/SkResourceCache.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/image/SkImage_Base.h"
 #include "src/lazy/SkDiscardableMemoryPool.h"
 #include "tests/Test.h"
 
 #include <array>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <initializer_list>
 #include <memory>
+#include <vector>
 
 ////////////////////////////////////////////////////////////////////////////////////////
 
@@ -242,14 +246,17 @@ struct TestRec : SkResourceCache::Rec {
     TestKey fKey;
     int*    fFlags;
     bool    fCanBePurged;
+    double  fCost = 0;
+    size_t  fBytes = 1024;  // Just need a value.
 
     TestRec(int sharedID, int32_t data, int* flagPtr) : fKey(sharedID, data), fFlags(flagPtr) {
         fCanBePurged = false;
     }
 
     const Key& getKey() const override { return fKey; }
-    size_t bytesUsed() const override { return 1024; /* just need a value */ }
+    size_t bytesUsed() const override { return fBytes; }
     bool canBePurged() override { return fCanBePurged; }
+    double cost() const override { return fCost; }
     void postAddInstall(void*) override {
         *fFlags |= kDidInstall;
     }
@@ -306,3 +313,289 @@ DEF_TEST(ResourceCache_purge, reporter) {
         }
     }
 }
+
+/*
+ *  The cost-aware policy keeps a rec that was expensive to make while cheap ones come and go,
+ *  where LRU would purge it as soon as enough newer recs were added.
+ */
+DEF_TEST(ResourceCache_costAwareEviction, reporter) {
+    using Policy = SkResourceCache::EvictionPolicy;
+    auto visitor = [](const SkResourceCache::Rec&, void*) { return true; };
+
+    for (Policy policy : {Policy::kLRU, Policy::kCostAware}) {
+        // Room for four TestRecs.
+        SkResourceCache cache(4 * 1024 + 512);
+        REPORTER_ASSERT(reporter, cache.setEvictionPolicy(policy) == Policy::kLRU);
+
+        int flags = 0;
+        auto add = [&](int32_t data, double cost) {
+            auto rec = std::make_unique<TestRec>(1, data, &flags);
+            rec->fCanBePurged = true;
+            rec->fCost = cost;
+            cache.add(rec.release());
+        };
+
+        add(0, 1e6);
+        for (int32_t i = 1; i <= 10; ++i) {
+            add(i, 0);
+        }
+        REPORTER_ASSERT(reporter, cache.getTotalBytesUsed() < cache.getTotalByteLimit());
+        const bool keptExpensive = cache.find(TestKey(1, 0), visitor, nullptr);
+        REPORTER_ASSERT(reporter, keptExpensive == (policy == Policy::kCostAware));
+        REPORTER_ASSERT(reporter, cache.find(TestKey(1, 10), visitor, nullptr));
+
+        // Among recs that cost the same, the one used more often is kept.
+        cache.purgeAll();
+        add(100, 1000);
+        add(101, 1000);
+        for (int i = 0; i < 3; ++i) {
+            REPORTER_ASSERT(reporter, cache.find(TestKey(1, 100), visitor, nullptr));
+        }
+        add(102, 1000);
+        add(103, 1000);
+        add(104, 1000);
+        REPORTER_ASSERT(reporter, cache.find(TestKey(1, 100), visitor, nullptr));
+        REPORTER_ASSERT(reporter, !cache.find(TestKey(1, 101), visitor, nullptr));
+    }
+
+    using GraphicsPolicy = SkGraphics::ResourceCacheEvictionPolicy;
+    const GraphicsPolicy prev =
+            SkGraphics::SetResourceCacheEvictionPolicy(GraphicsPolicy::kCostAware);
+    REPORTER_ASSERT(reporter,
+                    SkGraphics::GetResourceCacheEvictionPolicy() == GraphicsPolicy::kCostAware);
+    SkGraphics::SetResourceCacheEvictionPolicy(prev);
+}
+
+static SkGraphics::ResourceCacheShardStats sum_shard_stats() {
+    SkGraphics::ResourceCacheShardStats total = {};
+    for (int i = 0; i < SkGraphics::GetResourceCacheShardCount(); ++i) {
+        SkGraphics::ResourceCacheShardStats stats = SkGraphics::GetResourceCacheShardStats(i);
+        total.fBytesUsed += stats.fBytesUsed;
+        total.fByteLimit += stats.fByteLimit;
+        total.fCount += stats.fCount;
+        total.fHits += stats.fHits;
+        total.fMisses += stats.fMisses;
+    }
+    return total;
+}
+
+/*
+ *  The global cache is sharded; adds and finds from many threads must all land in the right
+ *  shard, and the shards together must account for the whole cache.
+ */
+DEF_TEST(ResourceCache_shards, reporter) {
+    REPORTER_ASSERT(reporter, SkGraphics::GetResourceCacheShardCount() > 0);
+    REPORTER_ASSERT(reporter,
+                    sum_shard_stats().fByteLimit == SkGraphics::GetResourceCacheTotalByteLimit());
+
+    // Other tests may be using the global cache at the same time, so use our own shared ID and
+    // only check for our own entries.
+    constexpr int kSharedID = 0x5eed;
+    constexpr int kCount = 256;
+    int flags[kCount] = {};
+
+    SkTaskGroup().batch(kCount, [&](int i) {
+        auto rec = std::make_unique<TestRec>(kSharedID, i, &flags[i]);
+        rec->fCanBePurged = true;
+        SkResourceCache::Add(rec.release());
+    });
+    for (int i = 0; i < kCount; ++i) {
+        REPORTER_ASSERT(reporter, flags[i] & TestRec::kDidInstall);
+    }
+
+    const SkGraphics::ResourceCacheShardStats before = sum_shard_stats();
+    std::atomic<int> found{0};
+    SkTaskGroup().batch(kCount, [&](int i) {
+        auto visitor = [](const SkResourceCache::Rec&, void*) { return true; };
+        found += SkResourceCache::Find(TestKey(kSharedID, i), visitor, nullptr);
+        SkResourceCache::Find(TestKey(kSharedID, kCount + i), visitor, nullptr);
+    });
+    const SkGraphics::ResourceCacheShardStats after = sum_shard_stats();
+
+    // Entries may have been purged by other tests, but every key after kCount is a miss.
+    REPORTER_ASSERT(reporter, after.fHits - before.fHits >= (uint64_t)found.load());
+    REPORTER_ASSERT(reporter, after.fMisses - before.fMisses >= (uint64_t)kCount);
+
+    SkResourceCache::PostPurgeSharedID(kSharedID);
+    SkResourceCache::CheckMessages();
+    found = 0;
+    for (int i = 0; i < kCount; ++i) {
+        auto visitor = [](const SkResourceCache::Rec&, void*) { return true; };
+        found += SkResourceCache::Find(TestKey(kSharedID, i), visitor, nullptr);
+    }
+    REPORTER_ASSERT(reporter, found == 0);
+}
+
+/*
+ *  The shards share one budget: an entry larger than one shard's slice of it must still be
+ *  cached, by making room across the shards, without going over the total.
+ */
+DEF_SERIAL_TEST(ResourceCache_shardsShareBudget, reporter) {
+    constexpr size_t kLimit = 1024 * 1024;
+    const size_t prevLimit = SkGraphics::SetResourceCacheTotalByteLimit(kLimit);
+    SkGraphics::PurgeResourceCache();
+    REPORTER_ASSERT(reporter, SkResourceCache::GetEffectiveSingleAllocationByteLimit() == kLimit);
+
+    constexpr int kSharedID = 0xb166;
+    constexpr int kSmallCount = 512;
+    int smallFlags[kSmallCount] = {};
+    for (int i = 0; i < kSmallCount; ++i) {
+        auto rec = std::make_unique<TestRec>(kSharedID, i, &smallFlags[i]);
+        rec->fCanBePurged = true;
+        SkResourceCache::Add(rec.release());
+    }
+    REPORTER_ASSERT(reporter, SkResourceCache::GetTotalBytesUsed() <= kLimit);
+
+    int bigFlags = 0;
+    auto big = std::make_unique<TestRec>(kSharedID, kSmallCount, &bigFlags);
+    big->fCanBePurged = true;
+    big->fBytes = kLimit * 3 / 4;
+    SkResourceCache::Add(big.release());
+
+    auto visitor = [](const SkResourceCache::Rec&, void*) { return true; };
+    REPORTER_ASSERT(reporter, SkResourceCache::Find(TestKey(kSharedID, kSmallCount), visitor,
+                                                    nullptr));
+    REPORTER_ASSERT(reporter, SkResourceCache::GetTotalBytesUsed() <= kLimit);
+
+    // Room was made across the shards, not just in the one the big entry went to.
+    int shardsWithSmall = 0;
+    for (int i = 0; i < SkGraphics::GetResourceCacheShardCount(); ++i) {
+        shardsWithSmall += SkGraphics::GetResourceCacheShardStats(i).fCount > 0;
+    }
+    REPORTER_ASSERT(reporter, shardsWithSmall == SkGraphics::GetResourceCacheShardCount());
+
+    const SkGraphics::ResourceCacheShardStats outOfRange =
+            SkGraphics::GetResourceCacheShardStats(SkGraphics::GetResourceCacheShardCount());
+    REPORTER_ASSERT(reporter, outOfRange.fCount == 0 && outOfRange.fByteLimit == 0);
+
+    SkGraphics::SetResourceCacheTotalByteLimit(prevLimit);
+    SkResourceCache::PostPurgeSharedID(kSharedID);
+    SkResourceCache::CheckMessages();
+}
+
+// Returns the shard that each of the first count keys of sharedID goes to, found by adding recs
+// too small for anything to be purged. Leaves the recs in the cache.
+static std::vector<int> find_key_shards(int sharedID, int count) {
+    static int gFlags;
+    std::vector<int> shardOf(count, -1);
+    for (int i = 0; i < count; ++i) {
+        std::vector<int> counts;
+        for (int j = 0; j < SkGraphics::GetResourceCacheShardCount(); ++j) {
+            counts.push_back(SkGraphics::GetResourceCacheShardStats(j).fCount);
+        }
+        auto rec = std::make_unique<TestRec>(sharedID, i, &gFlags);
+        rec->fCanBePurged = true;
+        rec->fBytes = 1;
+        SkResourceCache::Add(rec.release());
+        for (int j = 0; j < SkGraphics::GetResourceCacheShardCount(); ++j) {
+            if (SkGraphics::GetResourceCacheShardStats(j).fCount > counts[j]) {
+                shardOf[i] = j;
+            }
+        }
+    }
+    return shardOf;
+}
+
+/*
+ *  A shard may borrow the budget that the others aren't using, but has to give it back once they
+ *  use it, so the shards never go over the total together.
+ */
+DEF_SERIAL_TEST(ResourceCache_shardsReturnBorrowedBudget, reporter) {
+    constexpr size_t kLimit = 1024 * 1024;
+    constexpr size_t kRecBytes = 16 * 1024;
+    const int shardCount = SkGraphics::GetResourceCacheShardCount();
+    const size_t prevLimit = SkGraphics::SetResourceCacheTotalByteLimit(kLimit);
+    SkGraphics::PurgeResourceCache();
+
+    constexpr int kSharedID = 0xb167;
+    constexpr int kKeyCount = 1024;
+    const std::vector<int> shardOf = find_key_shards(kSharedID, kKeyCount);
+    SkGraphics::PurgeResourceCache();
+
+    int flags = 0;
+    auto add = [&](int data) {
+        auto rec = std::make_unique<TestRec>(kSharedID, data, &flags);
+        rec->fCanBePurged = true;
+        rec->fBytes = kRecBytes;
+        SkResourceCache::Add(rec.release());
+    };
+
+    // Shard 0 fills the whole budget.
+    for (int i = 0; i < kKeyCount; ++i) {
+        if (shardOf[i] == 0) {
+            add(i);
+        }
+    }
+    const size_t slice = SkGraphics::GetResourceCacheShardStats(0).fByteLimit;
+    const size_t borrowed = SkGraphics::GetResourceCacheShardStats(0).fBytesUsed;
+    REPORTER_ASSERT(reporter, shardCount == 1 || borrowed > slice);
+
+    // Then the others fill their slices, which shard 0 has to give back.
+    for (int i = 0; i < kKeyCount; ++i) {
+        if (shardOf[i] != 0) {
+            add(i);
+            REPORTER_ASSERT(reporter, SkResourceCache::GetTotalBytesUsed() <= kLimit,
+                            "%zu", SkResourceCache::GetTotalBytesUsed());
+        }
+    }
+    REPORTER_ASSERT(reporter, shardCount == 1 ||
+                              SkGraphics::GetResourceCacheShardStats(0).fBytesUsed < borrowed);
+
+    SkGraphics::SetResourceCacheTotalByteLimit(prevLimit);
+    SkResourceCache::PostPurgeSharedID(kSharedID);
+    SkResourceCache::CheckMessages();
+}
+
+/*
+ *  Find() doesn't move what it finds in the LRU right away, but it must still be kept over recs
+ *  that weren't found when the cache next purges.
+ */
+DEF_SERIAL_TEST(ResourceCache_findKeepsRecentlyUsed, reporter) {
+    constexpr size_t kLimit = 1024 * 1024;
+    constexpr size_t kRecBytes = 16 * 1024;
+    const size_t prevLimit = SkGraphics::SetResourceCacheTotalByteLimit(kLimit);
+    SkGraphics::PurgeResourceCache();
+
+    constexpr int kSharedID = 0xb168;
+    constexpr int kKeyCount = 1024;
+    const std::vector<int> shardOf = find_key_shards(kSharedID, kKeyCount);
+    SkGraphics::PurgeResourceCache();
+
+    // Just enough keys in shard 0 to go over the budget with the last one.
+    std::vector<int> keys;
+    for (int i = 0; i < kKeyCount && keys.size() < kLimit / kRecBytes; ++i) {
+        if (shardOf[i] == 0) {
+            keys.push_back(i);
+        }
+    }
+    REPORTER_ASSERT(reporter, keys.size() == kLimit / kRecBytes);
+
+    int flags = 0;
+    auto add = [&](int data) {
+        auto rec = std::make_unique<TestRec>(kSharedID, data, &flags);
+        rec->fCanBePurged = true;
+        rec->fBytes = kRecBytes;
+        SkResourceCache::Add(rec.release());
+    };
+    auto visitor = [](const SkResourceCache::Rec&, void*) { return true; };
+    auto find = [&](int data) {
+        return SkResourceCache::Find(TestKey(kSharedID, data), visitor, nullptr);
+    };
+
+    for (size_t i = 0; i + 1 < keys.size(); ++i) {
+        add(keys[i]);
+    }
+    const uint64_t hits = SkGraphics::GetResourceCacheShardStats(0).fHits;
+    REPORTER_ASSERT(reporter, find(keys[0]));
+    REPORTER_ASSERT(reporter, SkGraphics::GetResourceCacheShardStats(0).fHits == hits + 1);
+
+    // The oldest rec was found, so the next oldest is purged instead.
+    add(keys.back());
+    REPORTER_ASSERT(reporter, find(keys[0]));
+    REPORTER_ASSERT(reporter, !find(keys[1]));
+    REPORTER_ASSERT(reporter, find(keys.back()));
+
+    SkGraphics::SetResourceCacheTotalByteLimit(prevLimit);
+    SkResourceCache::PostPurgeSharedID(kSharedID);
+    SkResourceCache::CheckMessages();
+}
@@ -6,6 +6,7 @@
  */
 
 #include "include/core/SkAlphaType.h"
+#include "include/core/SkBitmap.h"
 #include "include/core/SkBlendMode.h"
 #include "include/core/SkBlender.h"
 #include "include/core/SkCanvas.h"
@@ -14,7 +15,10 @@
 #include "include/core/SkColorFilter.h"
 #include "include/core/SkColorType.h"
 #include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkGraphics.h"
 #include "include/core/SkImageInfo.h"
+#include "include/core/SkM44.h"
 #include "include/core/SkPaint.h"
 #include "include/core/SkPixmap.h"
 #include "include/core/SkRefCnt.h"
@@ -25,6 +29,7 @@
 #include "include/core/SkStream.h"
 #include "include/core/SkString.h"
 #include "include/core/SkSurface.h"
+#include "include/core/SkTraceMemoryDump.h"
 #include "include/core/SkTypes.h"
 #include "include/effects/SkBlenders.h"
 #include "include/effects/SkGradientShader.h"
@@ -51,6 +56,9 @@
 #include "src/gpu/ganesh/GrPixmap.h"
 #include "src/gpu/ganesh/SurfaceFillContext.h"
 #include "src/gpu/ganesh/effects/GrSkSLFP.h"
+#include "src/sksl/SkSLCompiler.h"
+#include "src/sksl/SkSLModuleLoader.h"
+#include "src/sksl/SkSLProgramKind.h"
 #include "src/sksl/SkSLString.h"
 #include "tests/CtsEnforcement.h"
 #include "tests/Test.h"
@@ -59,6 +67,7 @@
 #include <cstdint>
 #include <functional>
 #include <initializer_list>
+#include <iterator>
 #include <memory>
 #include <string>
 #include <thread>
@@ -1293,6 +1302,134 @@ DEF_TEST(SkRuntimeEffectThreaded, r) {
     }
 }
 
+DEF_SERIAL_TEST(SkRuntimeEffectCache, r) {
+    // The cache is shared with every other test, so these effects' SkSL must not match theirs, and
+    // only counters, which never go down, are compared with earlier values.
+    auto sksl = [](int i) {
+        return SkStringPrintf("uniform half uCacheTest%d; half4 main(float2 p) { return half4(1); }",
+                              i);
+    };
+    auto make = [](SkString sksl) {
+        return SkMakeCachedRuntimeEffect(SkRuntimeEffect::MakeForShader, std::move(sksl));
+    };
+
+    const SkGraphics::RuntimeEffectCacheStats before = SkGraphics::GetRuntimeEffectCacheStats();
+    sk_sp<SkRuntimeEffect> cached = make(sksl(0));
+    REPORTER_ASSERT(r, cached);
+    REPORTER_ASSERT(r, make(sksl(0)) == cached);
+    SkGraphics::RuntimeEffectCacheStats stats = SkGraphics::GetRuntimeEffectCacheStats();
+    REPORTER_ASSERT(r, stats.fHits > before.fHits);
+    REPORTER_ASSERT(r, stats.fMisses > before.fMisses);
+    REPORTER_ASSERT(r, stats.fCount > 0 && stats.fBytesUsed > 0);
+
+    // A pinned effect is found for its SkSL even when the cache has no budget at all.
+    sk_sp<SkRuntimeEffect> pinned = SkRuntimeEffect::MakeForShader(sksl(1)).effect;
+    REPORTER_ASSERT(r, pinned);
+    SkGraphics::PinRuntimeEffect(pinned);
+    const size_t prevLimit = SkGraphics::SetRuntimeEffectCacheByteLimit(0);
+    REPORTER_ASSERT(r, SkGraphics::GetRuntimeEffectCacheByteLimit() == 0);
+    REPORTER_ASSERT(r, make(sksl(1)) == pinned);
+    stats = SkGraphics::GetRuntimeEffectCacheStats();
+    REPORTER_ASSERT(r, stats.fPinnedCount > 0);
+    REPORTER_ASSERT(r, stats.fEvictions > before.fEvictions);
+
+    // Nothing else is kept, so the same SkSL is compiled again.
+    sk_sp<SkRuntimeEffect> unpinned = make(sksl(2));
+    REPORTER_ASSERT(r, unpinned && make(sksl(2)) != unpinned);
+
+    // Unpinning makes the effect purgeable like any other.
+    SkGraphics::UnpinRuntimeEffect(pinned.get());
+    REPORTER_ASSERT(r, make(sksl(1)) != pinned);
+
+    // An effect larger than its shard's slice of the limit is kept as long as it fits in the
+    // whole limit.
+    sk_sp<SkRuntimeEffect> uncached = SkRuntimeEffect::MakeForShader(sksl(3)).effect;
+    REPORTER_ASSERT(r, uncached);
+    SkGraphics::SetRuntimeEffectCacheByteLimit(
+            2 * SkRuntimeEffectPriv::ApproximateSizeInBytes(*uncached));
+    sk_sp<SkRuntimeEffect> large = make(sksl(3));
+    REPORTER_ASSERT(r, large && make(sksl(3)) == large);
+
+    // A shard that borrows most of the limit gives it back as the other shards fill their own
+    // slices, so together they stay within the limit.
+    sk_sp<SkRuntimeEffect> small = SkRuntimeEffect::MakeForShader(sksl(4)).effect;
+    REPORTER_ASSERT(r, small);
+    const size_t smallBytes = SkRuntimeEffectPriv::ApproximateSizeInBytes(*small);
+    const size_t limit = 64 * smallBytes;
+    SkGraphics::PurgeRuntimeEffectCache();
+    SkGraphics::SetRuntimeEffectCacheByteLimit(limit);
+    SkString borrowing = sksl(5);
+    borrowing.appendf("// %s", std::string(limit * 3 / 4 / 16, 'x').c_str());
+    REPORTER_ASSERT(r, make(borrowing));
+    stats = SkGraphics::GetRuntimeEffectCacheStats();
+    REPORTER_ASSERT(r, stats.fCount == 1 && stats.fBytesUsed > limit / 2);
+    for (int i = 0; i < 256; ++i) {
+        REPORTER_ASSERT(r, make(sksl(100 + i)));
+        stats = SkGraphics::GetRuntimeEffectCacheStats();
+        REPORTER_ASSERT(r, stats.fBytesUsed <= stats.fByteLimit,
+                        "%zu > %zu", stats.fBytesUsed, stats.fByteLimit);
+    }
+    SkGraphics::SetRuntimeEffectCacheByteLimit(prevLimit);
+
+    // The cache's usage is reported with the rest of Skia's caches.
+    class Dump : public SkTraceMemoryDump {
+    public:
+        void dumpNumericValue(const char* dumpName, const char* valueName, const char*,
+                              uint64_t) override {
+            if (SkString("skia/sk_runtime_effect_cache") == SkString(dumpName)) {
+                fSawSize |= SkString("size") == SkString(valueName);
+                fSawEvictions |= SkString("evictions") == SkString(valueName);
+            }
+        }
+        void setMemoryBacking(const char*, const char*, const char*) override {}
+        void setDiscardableMemoryBacking(const char*, const SkDiscardableMemory&) override {}
+        LevelOfDetail getRequestedDetails() const override { return kLight_LevelOfDetail; }
+
+        bool fSawSize = false;
+        bool fSawEvictions = false;
+    } dump;
+    SkGraphics::DumpMemoryStatistics(&dump);
+    REPORTER_ASSERT(r, dump.fSawSize && dump.fSawEvictions);
+}
+
+DEF_TEST(SkSLModuleLoaderPreloadModules, r) {
+    // Preload modules on a thread pool while other threads load the same modules themselves. The
+    // per-module locks must hand every thread the same module for each program kind.
+    static constexpr SkSL::ProgramKind kKinds[] = {
+            SkSL::ProgramKind::kFragment,
+            SkSL::ProgramKind::kVertex,
+            SkSL::ProgramKind::kCompute,
+            SkSL::ProgramKind::kGraphiteFragment,
+            SkSL::ProgramKind::kGraphiteVertexES2,
+            SkSL::ProgramKind::kRuntimeShader,
+            SkSL::ProgramKind::kPrivateRuntimeBlender,
+    };
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    SkSL::ModuleLoader::PreloadModules(kKinds, *executor);
+
+    constexpr int kNumThreads = 8;
+    const SkSL::Module* modules[kNumThreads][std::size(kKinds)] = {};
+    std::thread threads[kNumThreads];
+    for (int t = 0; t < kNumThreads; ++t) {
+        threads[t] = std::thread([&modules, t]() {
+            SkSL::Compiler compiler;
+            for (size_t k = 0; k < std::size(kKinds); ++k) {
+                modules[t][k] = compiler.moduleForProgramKind(kKinds[k]);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (int t = 0; t < kNumThreads; ++t) {
+        for (size_t k = 0; k < std::size(kKinds); ++k) {
+            REPORTER_ASSERT(r, modules[t][k]);
+            REPORTER_ASSERT(r, modules[t][k] == modules[0][k]);
+        }
+    }
+}
+
 DEF_TEST(SkRuntimeEffectAllowsPrivateAccess, r) {
     SkRuntimeEffect::Options defaultOptions;
     SkRuntimeEffect::Options optionsWithAccess;
@@ -1676,3 +1813,50 @@ DEF_GANESH_TEST_FOR_RENDERING_CONTEXTS(GrSkSLFP_UniformArray,
         }
     }
 }
+
+DEF_TEST(SkRuntimeEffect_PrecompiledRasterPipelinePrograms, r) {
+    // The SkSL must not match any other test's, since loaded programs are shared process-wide.
+    static constexpr char kSkSL[] =
+            "uniform half4 uColor;"
+            "half4 main(float2 xy) { return uColor * half4(fract(xy.x / 7), 1, 0.25, 1); }";
+
+    auto draw = [&](sk_sp<SkRuntimeEffect> effect, SkBitmap* bitmap) {
+        SkRuntimeShaderBuilder builder(std::move(effect));
+        builder.uniform("uColor") = SkV4{0.5f, 0.25f, 1, 1};
+        bitmap->allocPixels(SkImageInfo::MakeN32Premul(16, 4));
+        SkCanvas canvas(*bitmap);
+        SkPaint paint;
+        paint.setShader(builder.makeShader());
+        canvas.drawPaint(paint);
+    };
+
+    sk_sp<SkRuntimeEffect> original = SkRuntimeEffect::MakeForShader(SkString(kSkSL)).effect;
+    REPORTER_ASSERT(r, original);
+    sk_sp<SkData> blob = SkRuntimeEffect::SerializeRasterPipelinePrograms({&original, 1});
+    REPORTER_ASSERT(r, blob && blob->size() > 8);
+    if (!blob) {
+        return;
+    }
+
+    // Malformed blobs are rejected without loading anything.
+    REPORTER_ASSERT(r, SkRuntimeEffect::LoadRasterPipelinePrograms(nullptr) == 0);
+    REPORTER_ASSERT(r, SkRuntimeEffect::LoadRasterPipelinePrograms(
+                               SkData::MakeWithCopy(blob->data(), 8)) == 0);
+    REPORTER_ASSERT(r, SkRuntimeEffect::LoadRasterPipelinePrograms(
+                               SkData::MakeWithCopy(blob->data(), blob->size() - 1)) == 0);
+    REPORTER_ASSERT(r, SkRuntimeEffect::LoadRasterPipelinePrograms(blob) == 1);
+
+    // An effect made afterwards from the same SkSL draws exactly as the compiled original does.
+    sk_sp<SkRuntimeEffect> loaded = SkRuntimeEffect::MakeForShader(SkString(kSkSL)).effect;
+    REPORTER_ASSERT(r, loaded && loaded != original);
+    SkBitmap expected, actual;
+    draw(original, &expected);
+    draw(loaded, &actual);
+    for (int y = 0; y < expected.height(); ++y) {
+        for (int x = 0; x < expected.width(); ++x) {
+            REPORTER_ASSERT(r, *expected.getAddr32(x, y) == *actual.getAddr32(x, y),
+                            "(%d, %d): %08x != %08x", x, y,
+                            *expected.getAddr32(x, y), *actual.getAddr32(x, y));
+        }
+    }
+}
@@ -16,10 +16,14 @@
 #include "src/core/SkStrike.h"  // IWYU pragma: keep
 #include "src/core/SkStrikeCache.h"
 #include "src/core/SkStrikeSpec.h"
+#include "src/core/SkTaskGroup.h"
 #include "tests/Test.h"
 #include "tools/ToolUtils.h"
 #include "tools/fonts/FontToolUtils.h"
 
+#include <iterator>
+#include <vector>
+
 DEF_TEST(SkStrikeCache_CachePurge, Reporter) {
     SkStrikeCache cache;
 
@@ -61,3 +65,68 @@ DEF_TEST(SkStrikeCache_CachePurge, Reporter) {
 
 
 }
+
+static SkStrikeSpec make_strike_spec(SkScalar size) {
+    SkFont font;
+    font.setEdging(SkFont::Edging::kAntiAlias);
+    font.setTypeface(ToolUtils::CreatePortableTypeface("serif", SkFontStyle()));
+    font.setSize(size);
+    return SkStrikeSpec::MakeMask(font, SkPaint(), SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                                  SkScalerContextFlags::kNone, SkMatrix::I());
+}
+
+// Cache hits don't reorder the LRU list as they happen, but the strikes they found must still
+// outlive strikes nobody used when the cache purges.
+DEF_TEST(SkStrikeCache_HitsKeepStrikesAlive, Reporter) {
+    SkStrikeCache cache;
+    SkStrikeSpec a = make_strike_spec(10),
+                 b = make_strike_spec(11),
+                 c = make_strike_spec(12);
+
+    sk_sp<SkStrike> strikeA = a.findOrCreateStrike(&cache);
+    b.findOrCreateStrike(&cache);
+    c.findOrCreateStrike(&cache);
+    REPORTER_ASSERT(Reporter, cache.getCacheCountUsed() == 3);
+
+    // A is now the least recently created, but the most recently found.
+    REPORTER_ASSERT(Reporter, a.findOrCreateStrike(&cache) == strikeA);
+    strikeA.reset();
+
+    cache.setCacheCountLimit(2);
+    REPORTER_ASSERT(Reporter, cache.getCacheCountUsed() == 2);
+    REPORTER_ASSERT(Reporter, cache.findStrike(a.descriptor()) != nullptr);
+    REPORTER_ASSERT(Reporter, cache.findStrike(b.descriptor()) == nullptr);
+    REPORTER_ASSERT(Reporter, cache.findStrike(c.descriptor()) != nullptr);
+}
+
+DEF_TEST(SkStrikeCache_MultiThreadedLookup, Reporter) {
+    SkStrikeCache cache;
+    std::vector<SkStrikeSpec> specs;
+    for (int size = 8; size < 24; ++size) {
+        specs.push_back(make_strike_spec(size));
+    }
+
+    // Every thread finds (or creates) every strike, and makes some glyphs in it.
+    SkTaskGroup().batch(64, [&](int task) {
+        for (size_t i = 0; i < specs.size(); ++i) {
+            const SkStrikeSpec& spec = specs[(task + i) % specs.size()];
+            sk_sp<SkStrike> strike = spec.findOrCreateStrike(&cache);
+            REPORTER_ASSERT(Reporter, strike && strike->getDescriptor() == spec.descriptor());
+
+            const SkGlyphID glyphIDs[] = {(SkGlyphID)(task % 20), 1, 2, 3};
+            const SkGlyph* glyphs[std::size(glyphIDs)];
+            strike->metrics(glyphIDs, glyphs);
+        }
+    });
+
+    // Each strike was only created once.
+    REPORTER_ASSERT(Reporter, cache.getCacheCountUsed() == (int)specs.size());
+    for (const SkStrikeSpec& spec : specs) {
+        REPORTER_ASSERT(Reporter, cache.findStrike(spec.descriptor()) != nullptr);
+    }
+
+    // Shrinking the budget sends lookups back through the purge.
+    cache.setCacheSizeLimit(0);
+    REPORTER_ASSERT(Reporter, cache.getTotalMemoryUsed() == 0);
+    REPORTER_ASSERT(Reporter, cache.findStrike(specs[0].descriptor()) == nullptr);
+}
@@ -0,0 +1,254 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkPath.h"
+#include "include/core/SkPathTypes.h"
+#include "include/core/SkPoint.h"
+#include "include/core/SkRRect.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkSurface.h"
+#include "include/core/SkSurfaceProps.h"
+#include "src/base/SkRandom.h"
+#include "src/core/SkGeometry.h"
+#include "tests/Test.h"
+#include "tools/ToolUtils.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <functional>
+
+static constexpr int kW = 157, kH = 93;
+
+// Point samples per pixel, in each direction, for the reference coverage.
+static constexpr int kSamples = 32;
+
+// The winding number of the path around p, with curves split finely into lines.
+static int winding_at(const SkPath& path, SkPoint p) {
+    int winding = 0;
+    auto line = [&](SkPoint a, SkPoint b) {
+        if ((a.fY <= p.fY) != (b.fY <= p.fY) &&
+            a.fX + (b.fX - a.fX) * (p.fY - a.fY) / (b.fY - a.fY) > p.fX) {
+            winding += a.fY < b.fY ? 1 : -1;
+        }
+    };
+    constexpr int kLinesPerCurve = 64;
+    SkPath::Iter iter(path, true);
+    SkPoint pts[4];
+    SkPath::Verb verb;
+    while ((verb = iter.next(pts)) != SkPath::kDone_Verb) {
+        if (verb == SkPath::kLine_Verb) {
+            line(pts[0], pts[1]);
+            continue;
+        }
+        if (verb != SkPath::kQuad_Verb && verb != SkPath::kConic_Verb &&
+            verb != SkPath::kCubic_Verb) {
+            continue;
+        }
+        SkPoint prev = pts[0];
+        for (int i = 1; i <= kLinesPerCurve; ++i) {
+            const float t = (float)i / kLinesPerCurve;
+            SkPoint next;
+            if (verb == SkPath::kQuad_Verb) {
+                next = SkEvalQuadAt(pts, t);
+            } else if (verb == SkPath::kConic_Verb) {
+                next = SkConic(pts, iter.conicWeight()).evalAt(t);
+            } else {
+                SkEvalCubicAt(pts, t, &next, nullptr, nullptr);
+            }
+            line(prev, next);
+            prev = next;
+        }
+    }
+    return winding;
+}
+
+// Whether the windings in pixel (x, y) differ by two or more, as they do where edges cross.
+static bool edges_cross_in(const SkPath& path, int x, int y) {
+    int lo = INT_MAX, hi = INT_MIN;
+    for (int j = 0; j < kSamples; ++j) {
+        for (int i = 0; i < kSamples; ++i) {
+            int w = winding_at(path, {x + (i + 0.5f) / kSamples,
+                                      y + (j + 0.5f) / kSamples});
+            lo = std::min(lo, w);
+            hi = std::max(hi, w);
+        }
+    }
+    return hi - lo >= 2;
+}
+
+// Fills the path, clipped to clip, with the sparse strip rasterizer, and compares it to the
+// path's coverage found by point sampling. (The analytic AA scan converter is no reference here:
+// near the tops and bottoms of curves it can be off by more than a quarter of a pixel.) The
+// rasterizer finds the exact area each edge covers in a pixel, so it's only off by as much as
+// curves are flattened, except where edges cross: it applies the fill rule to the sum of those
+// areas, and where windings in a pixel differ by two or more, that sum isn't the covered area.
+static void check_coverage(skiatest::Reporter* r, const char* name, const SkPath& path,
+                           const SkRect& clip = SkRect::MakeWH(kW, kH)) {
+    const SkImageInfo info = SkImageInfo::MakeA8(kW, kH);
+    const SkSurfaceProps sparseProps(SkSurfaceProps::kSparseStripRasterizer_Flag,
+                                     kUnknown_SkPixelGeometry);
+    sk_sp<SkSurface> sparse = SkSurfaces::Raster(info, &sparseProps);
+    sk_sp<SkSurface> sampled =
+            SkSurfaces::Raster(SkImageInfo::MakeA8(kW * kSamples, kH * kSamples));
+    REPORTER_ASSERT(r, sparse && sampled);
+
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    sparse->getCanvas()->clipRect(clip);
+    sparse->getCanvas()->drawPath(path, paint);
+
+    paint.setAntiAlias(false);
+    sampled->getCanvas()->scale(kSamples, kSamples);
+    sampled->getCanvas()->clipRect(clip);
+    sampled->getCanvas()->drawPath(path, paint);
+
+    SkBitmap actual, samples;
+    actual.allocPixels(info);
+    samples.allocPixels(sampled->imageInfo());
+    REPORTER_ASSERT(r, sparse->readPixels(actual, 0, 0));
+    REPORTER_ASSERT(r, sampled->readPixels(samples, 0, 0));
+
+    // Flattening loses up to 1/16 of a pixel along curves, and the samples are off by up to
+    // 1/64 of a pixel in each direction.
+    constexpr int kTolerance = 20;
+    for (int y = 0; y < kH; ++y) {
+        for (int x = 0; x < kW; ++x) {
+            int sum = 0;
+            for (int j = 0; j < kSamples; ++j) {
+                for (int i = 0; i < kSamples; ++i) {
+                    sum += *samples.getAddr8(x * kSamples + i, y * kSamples + j);
+                }
+            }
+            const int expected = (sum + kSamples * kSamples / 2) / (kSamples * kSamples),
+                      a = *actual.getAddr8(x, y);
+            if (std::abs(a - expected) > kTolerance && !edges_cross_in(path, x, y)) {
+                ERRORF(r, "%s: pixel (%d, %d) is %d, expected %d", name, x, y, a, expected);
+                return;
+            }
+        }
+    }
+}
+
+DEF_TEST(SparseStripRasterizer_Coverage, r) {
+    check_coverage(r, "rect", SkPath::Rect(SkRect::MakeLTRB(10.25f, 7.5f, 120.75f, 60.6f)));
+    check_coverage(r, "integer rect", SkPath::Rect(SkRect::MakeLTRB(3, 4, 150, 90)));
+    check_coverage(r, "rrect", SkPath::RRect(SkRRect::MakeRectXY(
+                                       SkRect::MakeLTRB(5.5f, 4.25f, 150, 88), 30, 20)));
+    check_coverage(r, "circle", SkPath::Circle(77.3f, 45.1f, 40.7f));
+    check_coverage(r, "thin sliver",
+                   SkPath::Polygon({{2, 10}, {155, 30}, {155, 31.5f}, {2, 11}}, true));
+
+    for (SkPathFillType fillType : {SkPathFillType::kWinding, SkPathFillType::kEvenOdd}) {
+        SkPath star;
+        star.setFillType(fillType);
+        star.moveTo(78, 3);
+        star.lineTo(125, 90);
+        star.lineTo(10, 33);
+        star.lineTo(147, 33);
+        star.lineTo(32, 90);
+        star.close();
+        check_coverage(r, "star", star);
+
+        SkPath cubics;
+        cubics.setFillType(fillType);
+        cubics.moveTo(5, 80);
+        cubics.cubicTo(40, -30, 120, 120, 150, 10);
+        cubics.quadTo(100, 100, 20, 20);
+        cubics.conicTo(140, 40, 60, 85, 0.7f);
+        cubics.close();
+        check_coverage(r, "overlapping cubics", cubics);
+    }
+
+    check_coverage(r, "partly offscreen circle", SkPath::Circle(10, 80, 50));
+    check_coverage(r, "partly offscreen triangle",
+                   SkPath::Polygon({{-30, -20}, {200, 40}, {120, 140}}, true));
+    check_coverage(r, "clipped", SkPath::Circle(77, 45, 44.5f),
+                   SkRect::MakeLTRB(20, 15, 130, 70));
+
+    SkRandom rand;
+    for (int i = 0; i < 10; ++i) {
+        SkPath path;
+        path.moveTo(rand.nextRangeF(0, kW), rand.nextRangeF(0, kH));
+        for (int j = 0; j < 5; ++j) {
+            path.lineTo(rand.nextRangeF(0, kW), rand.nextRangeF(0, kH));
+        }
+        check_coverage(r, "random polygon", path);
+    }
+}
+
+// Inverse fills are left to the analytic AA scan converter, and anti-aliased clips are applied
+// the same way for both, so these must match it exactly.
+DEF_TEST(SparseStripRasterizer_MatchesAAA, r) {
+    auto check = [&](const char* name, const std::function<void(SkCanvas*)>& draw) {
+        const SkImageInfo info = SkImageInfo::MakeA8(kW, kH);
+        const SkSurfaceProps sparseProps(SkSurfaceProps::kSparseStripRasterizer_Flag,
+                                         kUnknown_SkPixelGeometry);
+        sk_sp<SkSurface> aaa = SkSurfaces::Raster(info);
+        sk_sp<SkSurface> sparse = SkSurfaces::Raster(info, &sparseProps);
+        REPORTER_ASSERT(r, aaa && sparse);
+
+        draw(aaa->getCanvas());
+        draw(sparse->getCanvas());
+
+        SkBitmap expected, actual;
+        expected.allocPixels(info);
+        actual.allocPixels(info);
+        REPORTER_ASSERT(r, aaa->readPixels(expected, 0, 0));
+        REPORTER_ASSERT(r, sparse->readPixels(actual, 0, 0));
+        REPORTER_ASSERT(r, ToolUtils::equal_pixels(expected, actual), "%s", name);
+    };
+
+    SkPaint paint;
+    paint.setAntiAlias(true);
+
+    check("aa clip", [&](SkCanvas* canvas) {
+        canvas->clipPath(SkPath::Circle(60, 50, 35.5f), true);
+        canvas->drawPath(SkPath::Rect(SkRect::MakeLTRB(30.5f, 10.5f, 140, 80)), paint);
+    });
+
+    check("inverse fill", [&](SkCanvas* canvas) {
+        SkPath path = SkPath::Circle(77, 45, 30);
+        path.setFillType(SkPathFillType::kInverseWinding);
+        canvas->drawPath(path, paint);
+    });
+}
+
+DEF_TEST(SparseStripRasterizer_SolidSpans, r) {
+    // The interior of a large shape is blitted as solid spans and rects, and must be opaque.
+    const SkImageInfo info = SkImageInfo::MakeA8(kW, kH);
+    const SkSurfaceProps props(SkSurfaceProps::kSparseStripRasterizer_Flag,
+                               kUnknown_SkPixelGeometry);
+    sk_sp<SkSurface> surface = SkSurfaces::Raster(info, &props);
+
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    surface->getCanvas()->drawPath(SkPath::Rect(SkRect::MakeLTRB(0.5f, 0.5f, 156.5f, 92.5f)),
+                                   paint);
+
+    SkBitmap bm;
+    bm.allocPixels(info);
+    REPORTER_ASSERT(r, surface->readPixels(bm, 0, 0));
+    for (int y = 0; y < kH; ++y) {
+        for (int x = 0; x < kW; ++x) {
+            bool edgeX = x == 0 || x == kW - 1,
+                 edgeY = y == 0 || y == kH - 1;
+            int expected = edgeX && edgeY ? 0x40 : edgeX || edgeY ? 0x80 : 0xFF;
+            if (std::abs(*bm.getAddr8(x, y) - expected) > 1) {
+                ERRORF(r, "pixel (%d, %d) is %02x, expected %02x",
+                       x, y, *bm.getAddr8(x, y), expected);
+                return;
+            }
+        }
+    }
+}
@@ -10,13 +10,19 @@
 #include "include/core/SkColorType.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkSwizzle.h"
+#include "include/private/SkEncodedInfo.h"
+#include "src/base/SkRandom.h"
+#include "src/codec/SkCodecPriv.h"
 #include "src/codec/SkSampler.h"
+#include "src/codec/SkSwizzler.h"
 #include "src/core/SkSwizzlePriv.h"
 #include "tests/Test.h"
 
 #include <cstdint>
 #include <cstring>
+#include <functional>
 #include <memory>
+#include <vector>
 
 static void check_fill(skiatest::Reporter* r,
                        const SkImageInfo& imageInfo,
@@ -246,4 +252,146 @@ DEF_TEST(UnpremulSimulatingRP, reporter) {
     }
 }
 
+// The vectorized swizzles must match their portable versions exactly, including for the
+// [0, vector width) pixels left over at the end of a row.
+DEF_TEST(SwizzleOpts_MatchPortable, r) {
+    constexpr int kMaxCount = 67;
+    SkRandom rand;
+    uint8_t src[kMaxCount * 8];
+    for (uint8_t& byte : src) {
+        byte = rand.nextU() & 0xFF;
+    }
+    uint32_t table[256];
+    for (uint32_t& color : table) {
+        color = rand.nextU();
+    }
+
+    using namespace SK_OPTS_NS;
+    auto premul = [](SkOpts::Swizzle_8888_u8 strip) {
+        return [strip](uint32_t* dst, const uint8_t* src, int count) {
+            strip(dst, src, count);
+            RGBA_to_rgbA_portable(dst, dst, count);
+        };
+    };
+    auto rgba16_to_rgbA = premul(RGBA16_to_RGBA_portable),
+         rgba16_to_bgrA = premul(RGBA16_to_BGRA_portable);
+
+    struct {
+        const char* name;
+        SkOpts::Swizzle_8888_u8 opt;
+        std::function<void(uint32_t*, const uint8_t*, int)> portable;
+    } procs8888[] = {
+        {"RGB16_to_RGB1",  SkOpts::RGB16_to_RGB1,  RGB16_to_RGB1_portable},
+        {"RGB16_to_BGR1",  SkOpts::RGB16_to_BGR1,  RGB16_to_BGR1_portable},
+        {"RGBA16_to_RGBA", SkOpts::RGBA16_to_RGBA, RGBA16_to_RGBA_portable},
+        {"RGBA16_to_BGRA", SkOpts::RGBA16_to_BGRA, RGBA16_to_BGRA_portable},
+        {"RGBA16_to_rgbA", SkOpts::RGBA16_to_rgbA, rgba16_to_rgbA},
+        {"RGBA16_to_bgrA", SkOpts::RGBA16_to_bgrA, rgba16_to_bgrA},
+    };
+    struct {
+        const char* name;
+        SkOpts::Swizzle_565_u8 opt, portable;
+    } procs565[] = {
+        {"RGB_to_565",  SkOpts::RGB_to_565,  RGB_to_565_portable},
+        {"gray_to_565", SkOpts::gray_to_565, gray_to_565_portable},
+    };
+
+    for (int count = 0; count <= kMaxCount; count++) {
+        uint32_t actual[kMaxCount], expected[kMaxCount];
+        for (const auto& proc : procs8888) {
+            proc.opt(actual, src, count);
+            proc.portable(expected, src, count);
+            REPORTER_ASSERT(r, !memcmp(actual, expected, count * sizeof(uint32_t)),
+                            "%s, count %d", proc.name, count);
+        }
+
+        SkOpts::index8_to_8888(actual, src, count, table);
+        index8_to_8888_portable(expected, src, count, table);
+        REPORTER_ASSERT(r, !memcmp(actual, expected, count * sizeof(uint32_t)),
+                        "index8_to_8888, count %d", count);
+
+        uint16_t actual565[kMaxCount], expected565[kMaxCount];
+        for (const auto& proc : procs565) {
+            proc.opt(actual565, src, count);
+            proc.portable(expected565, src, count);
+            REPORTER_ASSERT(r, !memcmp(actual565, expected565, count * sizeof(uint16_t)),
+                            "%s, count %d", proc.name, count);
+        }
+    }
+}
+
 #include "src/opts/SkOpts_RestoreTarget.h"
+
+// Sampled rows gather the pixels they keep before converting them, so they must match every
+// sampleX'th pixel of the full row, however many chunks that takes.
+DEF_TEST(Swizzler_SampledMatchesFullRow, r) {
+    constexpr int kWidth = 2999;
+    SkRandom rand;
+    std::vector<uint8_t> row(kWidth * 8);
+    for (uint8_t& byte : row) {
+        byte = rand.nextU() & 0xFF;
+    }
+    SkPMColor ctable[256];
+    for (SkPMColor& color : ctable) {
+        color = rand.nextU();
+    }
+
+    const struct {
+        SkEncodedInfo::Color color;
+        SkEncodedInfo::Alpha alpha;
+        int                  bitsPerComponent;
+        SkColorType          colorType;
+        SkAlphaType          alphaType;
+    } recs[] = {
+        {SkEncodedInfo::kGray_Color,    SkEncodedInfo::kOpaque_Alpha,   8,
+         kRGBA_8888_SkColorType, kOpaque_SkAlphaType},
+        {SkEncodedInfo::kGray_Color,    SkEncodedInfo::kOpaque_Alpha,   8,
+         kRGB_565_SkColorType,   kOpaque_SkAlphaType},
+        {SkEncodedInfo::kGrayAlpha_Color, SkEncodedInfo::kUnpremul_Alpha, 8,
+         kRGBA_8888_SkColorType, kPremul_SkAlphaType},
+        {SkEncodedInfo::kPalette_Color, SkEncodedInfo::kUnpremul_Alpha, 8,
+         kRGBA_8888_SkColorType, kPremul_SkAlphaType},
+        {SkEncodedInfo::kRGB_Color,     SkEncodedInfo::kOpaque_Alpha,   8,
+         kBGRA_8888_SkColorType, kOpaque_SkAlphaType},
+        {SkEncodedInfo::kRGB_Color,     SkEncodedInfo::kOpaque_Alpha,   8,
+         kRGB_565_SkColorType,   kOpaque_SkAlphaType},
+        {SkEncodedInfo::kRGB_Color,     SkEncodedInfo::kOpaque_Alpha,   16,
+         kRGBA_8888_SkColorType, kOpaque_SkAlphaType},
+        {SkEncodedInfo::kRGBA_Color,    SkEncodedInfo::kUnpremul_Alpha, 8,
+         kBGRA_8888_SkColorType, kPremul_SkAlphaType},
+        {SkEncodedInfo::kRGBA_Color,    SkEncodedInfo::kUnpremul_Alpha, 16,
+         kRGBA_8888_SkColorType, kPremul_SkAlphaType},
+        {SkEncodedInfo::kRGBA_Color,    SkEncodedInfo::kUnpremul_Alpha, 16,
+         kBGRA_8888_SkColorType, kUnpremul_SkAlphaType},
+        {SkEncodedInfo::kInvertedCMYK_Color, SkEncodedInfo::kOpaque_Alpha, 8,
+         kRGBA_8888_SkColorType, kOpaque_SkAlphaType},
+    };
+
+    for (const auto& rec : recs) {
+        const SkEncodedInfo encodedInfo = SkEncodedInfo::Make(kWidth, 1, rec.color, rec.alpha,
+                                                              rec.bitsPerComponent);
+        const SkImageInfo dstInfo = SkImageInfo::Make(kWidth, 1, rec.colorType, rec.alphaType);
+        const size_t bpp = dstInfo.bytesPerPixel();
+
+        std::unique_ptr<SkSwizzler> swizzler = SkSwizzler::Make(encodedInfo, ctable, dstInfo,
+                                                                SkCodec::Options());
+        REPORTER_ASSERT(r, swizzler);
+        std::vector<uint8_t> full(kWidth * bpp);
+        swizzler->swizzle(full.data(), row.data());
+
+        for (int sampleX : {2, 3, 7}) {
+            const int width = swizzler->setSampleX(sampleX);
+            std::vector<uint8_t> sampled(width * bpp);
+            swizzler->swizzle(sampled.data(), row.data());
+
+            for (int x = 0; x < width; x++) {
+                const int srcX = SkCodecPriv::GetStartCoord(sampleX) + x * sampleX;
+                if (memcmp(&sampled[x * bpp], &full[srcX * bpp], bpp)) {
+                    ERRORF(r, "color %d, bits %d, color type %d, sampleX %d: pixel %d differs",
+                           (int)rec.color, rec.bitsPerComponent, (int)rec.colorType, sampleX, x);
+                    break;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,190 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/codec/SkEncodedOrigin.h"
+#include "include/core/SkAlphaType.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkColorPriv.h"
+#include "include/core/SkColorSpace.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkMatrix.h"
+#include "include/core/SkPixmap.h"
+#include "include/core/SkPoint.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkSize.h"
+#include "include/core/SkYUVAInfo.h"
+#include "include/core/SkYUVAPixmaps.h"
+#include "include/private/base/SkTPin.h"
+#include "src/base/SkRandom.h"
+#include "src/core/SkYUVAInfoLocation.h"
+#include "src/core/SkYUVMath.h"
+#include "tests/Test.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+
+static SkYUVAPixmaps make_random_planes(const SkYUVAInfo& yuvaInfo, SkRandom* random) {
+    SkYUVAPixmaps pixmaps = SkYUVAPixmaps::Allocate(
+            SkYUVAPixmapInfo(yuvaInfo, SkYUVAPixmapInfo::DataType::kUnorm8, nullptr));
+    for (int i = 0; i < pixmaps.numPlanes(); ++i) {
+        const SkPixmap& plane = pixmaps.plane(i);
+        for (int y = 0; y < plane.height(); ++y) {
+            auto* row = static_cast<uint8_t*>(plane.writable_addr(0, y));
+            for (size_t x = 0; x < plane.info().minRowBytes(); ++x) {
+                row[x] = random->nextU() & 0xFF;
+            }
+        }
+    }
+    return pixmaps;
+}
+
+static uint8_t sample(const SkYUVAPixmaps& pixmaps,
+                      const SkYUVAInfo::YUVALocation& location,
+                      int x, int y) {
+    const SkPixmap& plane = pixmaps.plane(location.fPlane);
+    const int offset = plane.info().bytesPerPixel() == 2 &&
+                       location.fChannel == SkColorChannel::kG ? 1 : 0;
+    return static_cast<const uint8_t*>(plane.addr(x, y))[offset];
+}
+
+// Converts pixel (x, y) of pixmaps, which must have a top-left origin, one pixel at a time.
+static SkPMColor reference_pixel(const SkYUVAPixmaps& pixmaps, int x, int y) {
+    const SkYUVAInfo& yuvaInfo = pixmaps.yuvaInfo();
+    auto [ssX, ssY] = SkYUVAInfo::SubsamplingFactors(yuvaInfo.subsampling());
+    const SkYUVAInfo::YUVALocations locations = pixmaps.toYUVALocations();
+
+    const float Y = sample(pixmaps, locations[SkYUVAInfo::kY], x, y),
+                U = sample(pixmaps, locations[SkYUVAInfo::kU], x / ssX, y / ssY),
+                V = sample(pixmaps, locations[SkYUVAInfo::kV], x / ssX, y / ssY);
+    const uint8_t A = yuvaInfo.hasAlpha() ? sample(pixmaps, locations[SkYUVAInfo::kA], x, y)
+                                          : 0xFF;
+
+    float m[20];
+    SkColorMatrix_YUV2RGB(yuvaInfo.yuvColorSpace(), m);
+    auto channel = [&](int i) {
+        float c = m[5*i + 0]*Y + m[5*i + 1]*U + m[5*i + 2]*V + m[5*i + 4]*255;
+        return (U8CPU)SkTPin((int)std::lrint(c), 0, 255);
+    };
+    return SkPremultiplyARGBInline(A, channel(0), channel(1), channel(2));
+}
+
+static int max_channel_difference(SkPMColor a, SkPMColor b) {
+    int worst = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        worst = std::max(worst, std::abs((int)((a >> shift) & 0xFF) - (int)((b >> shift) & 0xFF)));
+    }
+    return worst;
+}
+
+// Odd dimensions, so the scalar tails and partial chroma samples at the edges are exercised.
+DEF_TEST(YUVToRGB_MatchesReference, r) {
+    constexpr SkISize kSize = {37, 13};
+    SkRandom random;
+
+    for (auto config : {SkYUVAInfo::PlaneConfig::kY_U_V,
+                        SkYUVAInfo::PlaneConfig::kY_V_U,
+                        SkYUVAInfo::PlaneConfig::kY_UV,
+                        SkYUVAInfo::PlaneConfig::kY_VU,
+                        SkYUVAInfo::PlaneConfig::kY_U_V_A,
+                        SkYUVAInfo::PlaneConfig::kY_UV_A}) {
+    for (auto subsampling : {SkYUVAInfo::Subsampling::k444,
+                             SkYUVAInfo::Subsampling::k422,
+                             SkYUVAInfo::Subsampling::k440,
+                             SkYUVAInfo::Subsampling::k420}) {
+    for (auto cs : {kJPEG_Full_SkYUVColorSpace,
+                    kRec601_Limited_SkYUVColorSpace,
+                    kRec709_Full_SkYUVColorSpace,
+                    kRec709_Limited_SkYUVColorSpace,
+                    kBT2020_8bit_Full_SkYUVColorSpace,
+                    kBT2020_8bit_Limited_SkYUVColorSpace}) {
+        SkYUVAInfo yuvaInfo(kSize, config, subsampling, cs);
+        SkYUVAPixmaps pixmaps = make_random_planes(yuvaInfo, &random);
+        REPORTER_ASSERT(r, pixmaps.isValid());
+
+        sk_sp<SkImage> image = SkImages::RasterFromYUVAPixmaps(pixmaps);
+        if (!image) {
+            ERRORF(r, "config %d subsampling %d cs %d: no image", (int)config, (int)subsampling,
+                   (int)cs);
+            continue;
+        }
+        REPORTER_ASSERT(r, image->dimensions() == kSize);
+        REPORTER_ASSERT(r, image->isOpaque() == !yuvaInfo.hasAlpha());
+
+        SkBitmap bm;
+        bm.allocPixels(SkImageInfo::MakeN32Premul(kSize));
+        REPORTER_ASSERT(r, image->readPixels(nullptr, bm.pixmap(), 0, 0));
+
+        int worst = 0;
+        for (int y = 0; y < kSize.height(); ++y) {
+            for (int x = 0; x < kSize.width(); ++x) {
+                worst = std::max(worst, max_channel_difference(*bm.getAddr32(x, y),
+                                                               reference_pixel(pixmaps, x, y)));
+            }
+        }
+        // Premultiplying before or after rounding may differ by one.
+        REPORTER_ASSERT(r, worst <= 1, "config %d subsampling %d cs %d: max difference %d",
+                        (int)config, (int)subsampling, (int)cs, worst);
+    }
+    }
+    }
+}
+
+DEF_TEST(YUVToRGB_Origin, r) {
+    SkRandom random;
+    const SkYUVAInfo topLeft({20, 10},
+                             SkYUVAInfo::PlaneConfig::kY_UV,
+                             SkYUVAInfo::Subsampling::k420,
+                             kJPEG_Full_SkYUVColorSpace);
+    SkYUVAPixmaps pixmaps = make_random_planes(topLeft, &random);
+    sk_sp<SkImage> upright = SkImages::RasterFromYUVAPixmaps(pixmaps);
+    REPORTER_ASSERT(r, upright);
+
+    // Planes stored 20x10 and rotated 90 degrees clockwise to display 10x20.
+    const SkYUVAInfo rotated({10, 20},
+                             SkYUVAInfo::PlaneConfig::kY_UV,
+                             SkYUVAInfo::Subsampling::k420,
+                             kJPEG_Full_SkYUVColorSpace,
+                             kRightTop_SkEncodedOrigin);
+    SkPixmap planes[SkYUVAInfo::kMaxPlanes];
+    for (int i = 0; i < pixmaps.numPlanes(); ++i) {
+        planes[i] = pixmaps.plane(i);
+    }
+    sk_sp<SkImage> image = SkImages::RasterFromYUVAPixmaps(
+            SkYUVAPixmaps::FromExternalPixmaps(rotated, planes));
+    REPORTER_ASSERT(r, image && image->dimensions() == SkISize::Make(10, 20));
+    if (!upright || !image) {
+        return;
+    }
+
+    SkBitmap expected, actual;
+    expected.allocPixels(SkImageInfo::MakeN32Premul(20, 10));
+    actual.allocPixels(SkImageInfo::MakeN32Premul(10, 20));
+    REPORTER_ASSERT(r, upright->readPixels(nullptr, expected.pixmap(), 0, 0));
+    REPORTER_ASSERT(r, image->readPixels(nullptr, actual.pixmap(), 0, 0));
+    const SkMatrix m = rotated.originMatrix();
+    for (int y = 0; y < 10; ++y) {
+        for (int x = 0; x < 20; ++x) {
+            SkPoint p = m.mapPoint({x + 0.5f, y + 0.5f});
+            REPORTER_ASSERT(r, *expected.getAddr32(x, y) ==
+                               *actual.getAddr32((int)p.fX, (int)p.fY));
+        }
+    }
+}
+
+DEF_TEST(YUVToRGB_Unsupported, r) {
+    SkRandom random;
+    // 4:1:1 subsampling is not handled.
+    const SkYUVAInfo yuvaInfo({16, 16},
+                              SkYUVAInfo::PlaneConfig::kY_U_V,
+                              SkYUVAInfo::Subsampling::k411,
+                              kJPEG_Full_SkYUVColorSpace);
+    REPORTER_ASSERT(r, !SkImages::RasterFromYUVAPixmaps(make_random_planes(yuvaInfo, &random)));
+    REPORTER_ASSERT(r, !SkImages::RasterFromYUVAPixmaps(SkYUVAPixmaps()));
+}
@@ -12,6 +12,7 @@ CODEC_TESTS = [
 
 CORE_TESTS = [
     "AAClipTest.cpp",
+    "AnalyticCoverageTest.cpp",
     "ArenaAllocTest.cpp",
     "AsADashTest.cpp",
     "AvifTest.cpp",
@@ -96,6 +97,8 @@ CORE_TESTS = [
     "RRectInPathTest.cpp",
     "RTreeTest.cpp",
     "RandomTest.cpp",
+    "RasterPipelineBlitterTest.cpp",
+    "RasterTiledSurfaceTest.cpp",
     "ReadPixelsTest.cpp",
     "RecorderTest.cpp",
     "RecordingXfermodeTest.cpp",
@@ -133,6 +136,7 @@ CORE_TESTS = [
     "SkVxTest.cpp",
     "SkXmpTest.cpp",
     "SortTest.cpp",
+    "SparseStripRasterizerTest.cpp",
     "SrcOverTest.cpp",
     "StreamTest.cpp",
     "StringTest.cpp",
@@ -146,6 +150,7 @@ CORE_TESTS = [
     "VerticesTest.cpp",
     "Writer32Test.cpp",
     "YUVCacheTest.cpp",
+    "YUVToRGBTest.cpp",
 ]
 
 CORE_CODEC_TESTS = [